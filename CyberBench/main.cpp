@@ -0,0 +1,1359 @@
+// CyberBench：运动学函数的无界面性能测试
+// 用法：CyberBench [位姿个数]
+// 在InitKine的关节限位内随机生成关节角，由正运动学得到可达位姿，
+// 对每个函数输出 ns/op、allocs/op 及单次调用耗时的 p50/p99/max。
+// 任一函数单次最大耗时超过控制周期，或任一正确性检查（标记为FAILED）未通过时返回1。
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <new>
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+
+#include "kine7.hpp"
+#include "kine_util.hpp"
+#include "kine_expanded.hpp"
+#include "diff_kine.hpp"
+#include "singular_value.hpp"
+#include "kine_solver.hpp"
+#include "ik_strategy.hpp"
+#include "trajectory.hpp"
+#include "joint_planner.hpp"
+#include "stopwatch.hpp"
+#include "KineBatch.h"
+#include "ReachMap.h"
+#include "ArmChain.h"
+#include "HandCodec.h"
+#include "RoboCodec.h"
+#include "StreamFramer.h"
+#include "ConsimuQueue.h"
+
+#include <QThread>
+#include <QThreadPool>
+
+#include "eigen3/Eigen/StdVector"
+
+typedef rpp::kine::Kine7<double> kine_type;
+typedef kine_type::mat4x4 mat4x4;
+typedef kine_type::mat6x7 mat6x7;
+typedef kine_type::vec7 mat7x1;
+typedef Eigen::Matrix<double, 6, 6> mat6x6;
+typedef std::vector<mat4x4, Eigen::aligned_allocator<mat4x4> > mat4x4_vector;
+typedef std::vector<mat6x7, Eigen::aligned_allocator<mat6x7> > mat6x7_vector;
+typedef std::vector<mat7x1, Eigen::aligned_allocator<mat7x1> > mat7x1_vector;
+typedef std::vector<kine_type::self_motion_vector,
+	Eigen::aligned_allocator<kine_type::self_motion_vector> > self_motions_vector;
+
+typedef rpp::kine::Kine7<float> kinef_type;
+typedef kinef_type::mat4x4 mat4x4f;
+typedef kinef_type::mat6x7 mat6x7f;
+typedef kinef_type::vec7 mat7x1f;
+typedef std::vector<mat4x4f, Eigen::aligned_allocator<mat4x4f> > mat4x4f_vector;
+typedef std::vector<mat7x1f, Eigen::aligned_allocator<mat7x1f> > mat7x1f_vector;
+
+const double TickBudgetMs = 250;		// 与cybersystem.h中的RobonautCommPd一致
+const int ArmMirrorAxis = 1;			// 与cyberstation.h中的ARM_MIRROR_AXIS一致
+
+//*********************** 分配计数 ***********************//
+static volatile long g_AllocCount = 0;
+
+static void CountAlloc()
+{
+#ifdef _WIN32
+	InterlockedIncrement(&g_AllocCount);
+#else
+	__sync_fetch_and_add(&g_AllocCount, 1);
+#endif
+}
+
+void *operator new(std::size_t size)
+{
+	CountAlloc();
+	void *p = malloc(size ? size : 1);
+	if (p == 0)
+	{
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void *operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void *p)
+{
+	free(p);
+}
+
+void operator delete[](void *p)
+{
+	free(p);
+}
+
+//*********************** 计时 ***********************//
+struct BenchResult
+{
+	double ns_per_op;
+	double allocs_per_op;
+	double p50_ns;
+	double p99_ns;
+	double max_ns;
+};
+
+static double g_Sink = 0;		// 防止结果被优化掉
+static bool g_OverBudget = false;
+static bool g_CheckFailed = false;
+
+// 记录一项正确性检查，返回输出用的"ok"/"FAILED"
+static const char *Check(bool ok)
+{
+	g_CheckFailed = g_CheckFailed || !ok;
+	return ok ? "ok" : "FAILED";
+}
+
+// 第一遍整体计时得到ns/op和allocs/op，第二遍逐次计时得到延迟分布
+template <typename F>
+BenchResult RunBench(const char *name, int count, F f)
+{
+	std::vector<long long> latency(count);
+	for (int i = 0; i < count && i < 100; ++i)
+	{
+		f(i);
+	}
+
+	BenchResult res;
+	long alloc_start = g_AllocCount;
+	rpp::util::Stopwatch total;
+	for (int i = 0; i < count; ++i)
+	{
+		f(i);
+	}
+	res.ns_per_op = (double)total.elapsed_ns() / count;
+	res.allocs_per_op = (double)(g_AllocCount - alloc_start) / count;
+
+	for (int i = 0; i < count; ++i)
+	{
+		rpp::util::Stopwatch sw;
+		f(i);
+		latency[i] = sw.elapsed_ns();
+	}
+	std::sort(latency.begin(), latency.end());
+	res.p50_ns = (double)latency[count / 2];
+	res.p99_ns = (double)latency[(count * 99) / 100];
+	res.max_ns = (double)latency[count - 1];
+
+	bool over = res.max_ns > TickBudgetMs * 1e6;
+	g_OverBudget = g_OverBudget || over;
+	printf("%-28s %12.1f %10.2f %12.1f %12.1f %12.1f%s\n", name, res.ns_per_op, res.allocs_per_op,
+		res.p50_ns, res.p99_ns, res.max_ns, over ? "  OVER BUDGET" : "");
+	return res;
+}
+
+//*********************** 精度 ***********************//
+// 位置误差(mm)和姿态误差(度)，姿态误差取相对旋转的转角
+static void PoseError(const mat4x4 &T, const mat4x4 &T_ref, double &mm, double &deg)
+{
+	mm = (T.block<3, 1>(0, 3) - T_ref.block<3, 1>(0, 3)).norm();
+	Eigen::Matrix3d R = T.block<3, 3>(0, 0).transpose() * T_ref.block<3, 3>(0, 0);
+	Eigen::Vector3d w(R(2, 1) - R(1, 2), R(0, 2) - R(2, 0), R(1, 0) - R(0, 1));
+	deg = std::asin(std::min(1.0, w.norm() / 2)) * 180 / 3.14159265358979323846;
+}
+
+static void PrintError(const char *name, std::vector<double> mm, std::vector<double> deg)
+{
+	if (mm.empty())
+	{
+		printf("%-28s %12s\n", name, "-");
+		return;
+	}
+	std::sort(mm.begin(), mm.end());
+	std::sort(deg.begin(), deg.end());
+	size_t n = mm.size();
+	printf("%-28s %12.2e %12.2e %12.2e %12.2e %12.2e %12.2e\n", name, mm[n / 2], mm[(n * 99) / 100], mm[n - 1],
+		deg[n / 2], deg[(n * 99) / 100], deg[n - 1]);
+}
+
+//*********************** 原来的机器人UDP包拼接（对照） ***********************//
+// RobonautControl::RoboDataCnv、RecvRoboMsg改为RoboCodec之前的逐字节拼接，原样保留，
+// 用于逐字节比较RoboCodec的结果。原来没有的传感器包编码、命令包解码按同样的写法补齐。
+#ifndef MAKEWORD
+#define MAKEWORD(a, b) ((unsigned short)(((unsigned char)(a)) | ((unsigned short)((unsigned char)(b))) << 8))
+#define MAKELONG(a, b) ((int)(((unsigned short)(a)) | ((unsigned int)((unsigned short)(b))) << 16))
+#define LOWORD(l) ((unsigned short)(((unsigned int)(l)) & 0xffff))
+#define HIWORD(l) ((unsigned short)((((unsigned int)(l)) >> 16) & 0xffff))
+#define LOBYTE(w) ((unsigned char)(((unsigned int)(w)) & 0xff))
+#define HIBYTE(w) ((unsigned char)((((unsigned int)(w)) >> 8) & 0xff))
+#endif
+
+static void RefRoboDataCnv(const int &g_nRunFlag, const CRobonautData &g_RobotCmdDeg, char cSendRobotCommandBuffer[])
+{
+	cSendRobotCommandBuffer[0] = LOBYTE(LOWORD(g_RobotCmdDeg.count));
+	cSendRobotCommandBuffer[1] = HIBYTE(LOWORD(g_RobotCmdDeg.count));
+
+	cSendRobotCommandBuffer[2] = LOBYTE(LOWORD(g_RobotCmdDeg.CtlMode));
+	cSendRobotCommandBuffer[3] = HIBYTE(LOWORD(g_RobotCmdDeg.CtlMode));
+
+	cSendRobotCommandBuffer[4] = LOBYTE(LOWORD(g_nRunFlag));
+	cSendRobotCommandBuffer[5] = HIBYTE(LOWORD(g_nRunFlag));
+
+	cSendRobotCommandBuffer[6] = LOBYTE(HIWORD(g_nRunFlag));
+	cSendRobotCommandBuffer[7] = HIBYTE(HIWORD(g_nRunFlag));
+
+	cSendRobotCommandBuffer[8] = LOBYTE(LOWORD(int(g_RobotCmdDeg.leftArmJoint[0]*10000)));
+	cSendRobotCommandBuffer[9] = HIBYTE(LOWORD(int(g_RobotCmdDeg.leftArmJoint[0]*10000)));
+	cSendRobotCommandBuffer[10] = LOBYTE(HIWORD(int(g_RobotCmdDeg.leftArmJoint[0]*10000)));
+	cSendRobotCommandBuffer[11] = HIBYTE(HIWORD(int(g_RobotCmdDeg.leftArmJoint[0]*10000)));
+
+	cSendRobotCommandBuffer[12] = LOBYTE(LOWORD(int(g_RobotCmdDeg.leftArmJoint[1]*10000)));
+	cSendRobotCommandBuffer[13] = HIBYTE(LOWORD(int(g_RobotCmdDeg.leftArmJoint[1]*10000)));
+	cSendRobotCommandBuffer[14] = LOBYTE(HIWORD(int(g_RobotCmdDeg.leftArmJoint[1]*10000)));
+	cSendRobotCommandBuffer[15] = HIBYTE(HIWORD(int(g_RobotCmdDeg.leftArmJoint[1]*10000)));
+
+	cSendRobotCommandBuffer[16] = LOBYTE(LOWORD(int(g_RobotCmdDeg.leftArmJoint[2]*10000)));
+	cSendRobotCommandBuffer[17] = HIBYTE(LOWORD(int(g_RobotCmdDeg.leftArmJoint[2]*10000)));
+	cSendRobotCommandBuffer[18] = LOBYTE(HIWORD(int(g_RobotCmdDeg.leftArmJoint[2]*10000)));
+	cSendRobotCommandBuffer[19] = HIBYTE(HIWORD(int(g_RobotCmdDeg.leftArmJoint[2]*10000)));
+
+	cSendRobotCommandBuffer[20] = LOBYTE(LOWORD(int(g_RobotCmdDeg.leftArmJoint[3]*10000)));
+	cSendRobotCommandBuffer[21] = HIBYTE(LOWORD(int(g_RobotCmdDeg.leftArmJoint[3]*10000)));
+	cSendRobotCommandBuffer[22] = LOBYTE(HIWORD(int(g_RobotCmdDeg.leftArmJoint[3]*10000)));
+	cSendRobotCommandBuffer[23] = HIBYTE(HIWORD(int(g_RobotCmdDeg.leftArmJoint[3]*10000)));
+
+	cSendRobotCommandBuffer[24] = LOBYTE(LOWORD(int(g_RobotCmdDeg.leftArmJoint[4]*10000)));
+	cSendRobotCommandBuffer[25] = HIBYTE(LOWORD(int(g_RobotCmdDeg.leftArmJoint[4]*10000)));
+	cSendRobotCommandBuffer[26] = LOBYTE(HIWORD(int(g_RobotCmdDeg.leftArmJoint[4]*10000)));
+	cSendRobotCommandBuffer[27] = HIBYTE(HIWORD(int(g_RobotCmdDeg.leftArmJoint[4]*10000)));
+
+	cSendRobotCommandBuffer[28] = LOBYTE(LOWORD(int(g_RobotCmdDeg.leftArmJoint[5]*10000)));
+	cSendRobotCommandBuffer[29] = HIBYTE(LOWORD(int(g_RobotCmdDeg.leftArmJoint[5]*10000)));
+	cSendRobotCommandBuffer[30] = LOBYTE(HIWORD(int(g_RobotCmdDeg.leftArmJoint[5]*10000)));
+	cSendRobotCommandBuffer[31] = HIBYTE(HIWORD(int(g_RobotCmdDeg.leftArmJoint[5]*10000)));
+
+	cSendRobotCommandBuffer[32] = LOBYTE(LOWORD(int(g_RobotCmdDeg.leftArmJoint[6]*10000)));
+	cSendRobotCommandBuffer[33] = HIBYTE(LOWORD(int(g_RobotCmdDeg.leftArmJoint[6]*10000)));
+	cSendRobotCommandBuffer[34] = LOBYTE(HIWORD(int(g_RobotCmdDeg.leftArmJoint[6]*10000)));
+	cSendRobotCommandBuffer[35] = HIBYTE(HIWORD(int(g_RobotCmdDeg.leftArmJoint[6]*10000)));
+
+	cSendRobotCommandBuffer[36] = LOBYTE(LOWORD(int(g_RobotCmdDeg.rightArmJoint[0]*10000)));
+	cSendRobotCommandBuffer[37] = HIBYTE(LOWORD(int(g_RobotCmdDeg.rightArmJoint[0]*10000)));
+	cSendRobotCommandBuffer[38] = LOBYTE(HIWORD(int(g_RobotCmdDeg.rightArmJoint[0]*10000)));
+	cSendRobotCommandBuffer[39] = HIBYTE(HIWORD(int(g_RobotCmdDeg.rightArmJoint[0]*10000)));
+
+	cSendRobotCommandBuffer[40] = LOBYTE(LOWORD(int(g_RobotCmdDeg.rightArmJoint[1]*10000)));
+	cSendRobotCommandBuffer[41] = HIBYTE(LOWORD(int(g_RobotCmdDeg.rightArmJoint[1]*10000)));
+	cSendRobotCommandBuffer[42] = LOBYTE(HIWORD(int(g_RobotCmdDeg.rightArmJoint[1]*10000)));
+	cSendRobotCommandBuffer[43] = HIBYTE(HIWORD(int(g_RobotCmdDeg.rightArmJoint[1]*10000)));
+
+	cSendRobotCommandBuffer[44] = LOBYTE(LOWORD(int(g_RobotCmdDeg.rightArmJoint[2]*10000)));
+	cSendRobotCommandBuffer[45] = HIBYTE(LOWORD(int(g_RobotCmdDeg.rightArmJoint[2]*10000)));
+	cSendRobotCommandBuffer[46] = LOBYTE(HIWORD(int(g_RobotCmdDeg.rightArmJoint[2]*10000)));
+	cSendRobotCommandBuffer[47] = HIBYTE(HIWORD(int(g_RobotCmdDeg.rightArmJoint[2]*10000)));
+
+	cSendRobotCommandBuffer[48] = LOBYTE(LOWORD(int(g_RobotCmdDeg.rightArmJoint[3]*10000)));
+	cSendRobotCommandBuffer[49] = HIBYTE(LOWORD(int(g_RobotCmdDeg.rightArmJoint[3]*10000)));
+	cSendRobotCommandBuffer[50] = LOBYTE(HIWORD(int(g_RobotCmdDeg.rightArmJoint[3]*10000)));
+	cSendRobotCommandBuffer[51] = HIBYTE(HIWORD(int(g_RobotCmdDeg.rightArmJoint[3]*10000)));
+
+	cSendRobotCommandBuffer[52] = LOBYTE(LOWORD(int(g_RobotCmdDeg.rightArmJoint[4]*10000)));
+	cSendRobotCommandBuffer[53] = HIBYTE(LOWORD(int(g_RobotCmdDeg.rightArmJoint[4]*10000)));
+	cSendRobotCommandBuffer[54] = LOBYTE(HIWORD(int(g_RobotCmdDeg.rightArmJoint[4]*10000)));
+	cSendRobotCommandBuffer[55] = HIBYTE(HIWORD(int(g_RobotCmdDeg.rightArmJoint[4]*10000)));
+
+	cSendRobotCommandBuffer[56] = LOBYTE(LOWORD(int(g_RobotCmdDeg.rightArmJoint[5]*10000)));
+	cSendRobotCommandBuffer[57] = HIBYTE(LOWORD(int(g_RobotCmdDeg.rightArmJoint[5]*10000)));
+	cSendRobotCommandBuffer[58] = LOBYTE(HIWORD(int(g_RobotCmdDeg.rightArmJoint[5]*10000)));
+	cSendRobotCommandBuffer[59] = HIBYTE(HIWORD(int(g_RobotCmdDeg.rightArmJoint[5]*10000)));
+
+	cSendRobotCommandBuffer[60] = LOBYTE(LOWORD(int(g_RobotCmdDeg.rightArmJoint[6]*10000)));
+	cSendRobotCommandBuffer[61] = HIBYTE(LOWORD(int(g_RobotCmdDeg.rightArmJoint[6]*10000)));
+	cSendRobotCommandBuffer[62] = LOBYTE(HIWORD(int(g_RobotCmdDeg.rightArmJoint[6]*10000)));
+	cSendRobotCommandBuffer[63] = HIBYTE(HIWORD(int(g_RobotCmdDeg.rightArmJoint[6]*10000)));
+
+	cSendRobotCommandBuffer[64] = LOBYTE(LOWORD(int(g_RobotCmdDeg.headJoint[0]*10000)));
+	cSendRobotCommandBuffer[65] = HIBYTE(LOWORD(int(g_RobotCmdDeg.headJoint[0]*10000)));
+	cSendRobotCommandBuffer[66] = LOBYTE(HIWORD(int(g_RobotCmdDeg.headJoint[0]*10000)));
+	cSendRobotCommandBuffer[67] = HIBYTE(HIWORD(int(g_RobotCmdDeg.headJoint[0]*10000)));
+
+	cSendRobotCommandBuffer[68] = LOBYTE(LOWORD(int(g_RobotCmdDeg.headJoint[1]*10000)));
+	cSendRobotCommandBuffer[69] = HIBYTE(LOWORD(int(g_RobotCmdDeg.headJoint[1]*10000)));
+	cSendRobotCommandBuffer[70] = LOBYTE(HIWORD(int(g_RobotCmdDeg.headJoint[1]*10000)));
+	cSendRobotCommandBuffer[71] = HIBYTE(HIWORD(int(g_RobotCmdDeg.headJoint[1]*10000)));
+
+	cSendRobotCommandBuffer[72] = LOBYTE(LOWORD(int(g_RobotCmdDeg.headJoint[2]*10000)));
+	cSendRobotCommandBuffer[73] = HIBYTE(LOWORD(int(g_RobotCmdDeg.headJoint[2]*10000)));
+	cSendRobotCommandBuffer[74] = LOBYTE(HIWORD(int(g_RobotCmdDeg.headJoint[2]*10000)));
+	cSendRobotCommandBuffer[75] = HIBYTE(HIWORD(int(g_RobotCmdDeg.headJoint[2]*10000)));
+
+	cSendRobotCommandBuffer[76] = LOBYTE(LOWORD(int(g_RobotCmdDeg.waistJoint[0]*10000)));
+	cSendRobotCommandBuffer[77] = HIBYTE(LOWORD(int(g_RobotCmdDeg.waistJoint[0]*10000)));
+	cSendRobotCommandBuffer[78] = LOBYTE(HIWORD(int(g_RobotCmdDeg.waistJoint[0]*10000)));
+	cSendRobotCommandBuffer[79] = HIBYTE(HIWORD(int(g_RobotCmdDeg.waistJoint[0]*10000)));
+
+	cSendRobotCommandBuffer[80] = LOBYTE(LOWORD(int(g_RobotCmdDeg.waistJoint[1]*10000)));
+	cSendRobotCommandBuffer[81] = HIBYTE(LOWORD(int(g_RobotCmdDeg.waistJoint[1]*10000)));
+	cSendRobotCommandBuffer[82] = LOBYTE(HIWORD(int(g_RobotCmdDeg.waistJoint[1]*10000)));
+	cSendRobotCommandBuffer[83] = HIBYTE(HIWORD(int(g_RobotCmdDeg.waistJoint[1]*10000)));
+}
+
+static void RefRecvRoboMsg(const char buffer[], CRobonautData &data, int &decideFlag)
+{
+	data.count = MAKEWORD(buffer[0],buffer[1]);
+	data.CtlMode = MAKEWORD(buffer[2],buffer[3]);
+
+	//左臂
+	data.leftArmJoint[0] = MAKELONG(MAKEWORD(buffer[4],buffer[5]),MAKEWORD(buffer[6],buffer[7]))*0.0001;
+	data.leftArmJoint[1] = MAKELONG(MAKEWORD(buffer[8],buffer[9]),MAKEWORD(buffer[10],buffer[11]))*0.0001;
+	data.leftArmJoint[2] = MAKELONG(MAKEWORD(buffer[12],buffer[13]),MAKEWORD(buffer[14],buffer[15]))*0.0001;
+	data.leftArmJoint[3] = MAKELONG(MAKEWORD(buffer[16],buffer[17]),MAKEWORD(buffer[18],buffer[19]))*0.0001;
+	data.leftArmJoint[4] = MAKELONG(MAKEWORD(buffer[20],buffer[21]),MAKEWORD(buffer[22],buffer[23]))*0.0001;
+	data.leftArmJoint[5] = MAKELONG(MAKEWORD(buffer[24],buffer[25]),MAKEWORD(buffer[26],buffer[27]))*0.0001;
+	data.leftArmJoint[6] = MAKELONG(MAKEWORD(buffer[28],buffer[29]),MAKEWORD(buffer[30],buffer[31]))*0.0001;
+
+	//右臂
+	data.rightArmJoint[0] = MAKELONG(MAKEWORD(buffer[32],buffer[33]),MAKEWORD(buffer[34],buffer[35]))*0.0001;
+	data.rightArmJoint[1] = MAKELONG(MAKEWORD(buffer[36],buffer[37]),MAKEWORD(buffer[38],buffer[39]))*0.0001;
+	data.rightArmJoint[2] = MAKELONG(MAKEWORD(buffer[40],buffer[41]),MAKEWORD(buffer[42],buffer[43]))*0.0001;
+	data.rightArmJoint[3] = MAKELONG(MAKEWORD(buffer[44],buffer[45]),MAKEWORD(buffer[46],buffer[47]))*0.0001;
+	data.rightArmJoint[4] = MAKELONG(MAKEWORD(buffer[48],buffer[49]),MAKEWORD(buffer[50],buffer[51]))*0.0001;
+	data.rightArmJoint[5] = MAKELONG(MAKEWORD(buffer[52],buffer[53]),MAKEWORD(buffer[54],buffer[55]))*0.0001;
+	data.rightArmJoint[6] = MAKELONG(MAKEWORD(buffer[56],buffer[57]),MAKEWORD(buffer[58],buffer[59]))*0.0001;
+
+	//头部
+	data.headJoint[0] = MAKELONG(MAKEWORD(buffer[60],buffer[61]),MAKEWORD(buffer[62],buffer[63]))*0.0001;
+	data.headJoint[1] = MAKELONG(MAKEWORD(buffer[64],buffer[65]),MAKEWORD(buffer[66],buffer[67]))*0.0001;
+	data.headJoint[2] = MAKELONG(MAKEWORD(buffer[68],buffer[69]),MAKEWORD(buffer[70],buffer[71]))*0.0001;
+
+	//腰部
+	data.waistJoint[0] = MAKELONG(MAKEWORD(buffer[72],buffer[73]),MAKEWORD(buffer[74],buffer[75]))*0.0001;
+	data.waistJoint[1] = MAKELONG(MAKEWORD(buffer[76],buffer[77]),MAKEWORD(buffer[78],buffer[79]))*0.0001;
+
+	//右臂关节力
+	data.RightJointFT[0] = MAKELONG(MAKEWORD(buffer[108],buffer[109]),MAKEWORD(buffer[110],buffer[111]))*0.0001;
+	data.RightJointFT[1] = MAKELONG(MAKEWORD(buffer[112],buffer[113]),MAKEWORD(buffer[114],buffer[115]))*0.0001;
+	data.RightJointFT[2] = MAKELONG(MAKEWORD(buffer[116],buffer[117]),MAKEWORD(buffer[118],buffer[119]))*0.0001;
+	data.RightJointFT[3] = MAKELONG(MAKEWORD(buffer[120],buffer[121]),MAKEWORD(buffer[122],buffer[123]))*0.0001;
+	data.RightJointFT[4] = MAKELONG(MAKEWORD(buffer[124],buffer[125]),MAKEWORD(buffer[126],buffer[127]))*0.0001;
+	data.RightJointFT[5] = MAKELONG(MAKEWORD(buffer[128],buffer[129]),MAKEWORD(buffer[130],buffer[131]))*0.0001;
+	data.RightJointFT[6] = MAKELONG(MAKEWORD(buffer[132],buffer[133]),MAKEWORD(buffer[134],buffer[135]))*0.0001;
+
+	//左臂关节力
+	data.LeftJointFT[0] = MAKELONG(MAKEWORD(buffer[80],buffer[81]),MAKEWORD(buffer[82],buffer[83]))*0.0001;
+	data.LeftJointFT[1] = MAKELONG(MAKEWORD(buffer[84],buffer[85]),MAKEWORD(buffer[86],buffer[87]))*0.0001;
+	data.LeftJointFT[2] = MAKELONG(MAKEWORD(buffer[88],buffer[89]),MAKEWORD(buffer[90],buffer[91]))*0.0001;
+	data.LeftJointFT[3] = MAKELONG(MAKEWORD(buffer[92],buffer[93]),MAKEWORD(buffer[94],buffer[95]))*0.0001;
+	data.LeftJointFT[4] = MAKELONG(MAKEWORD(buffer[96],buffer[97]),MAKEWORD(buffer[98],buffer[99]))*0.0001;
+	data.LeftJointFT[5] = MAKELONG(MAKEWORD(buffer[100],buffer[101]),MAKEWORD(buffer[102],buffer[103]))*0.0001;
+	data.LeftJointFT[6] = MAKELONG(MAKEWORD(buffer[104],buffer[105]),MAKEWORD(buffer[106],buffer[107]))*0.0001;
+
+	//力判断标志
+	decideFlag = MAKELONG(MAKEWORD(buffer[136],buffer[137]),MAKEWORD(buffer[138],buffer[139]));
+}
+
+static void RefPutFixed(char buffer[], int k, float x)
+{
+	buffer[k] = LOBYTE(LOWORD(int(x*10000)));
+	buffer[k+1] = HIBYTE(LOWORD(int(x*10000)));
+	buffer[k+2] = LOBYTE(HIWORD(int(x*10000)));
+	buffer[k+3] = HIBYTE(HIWORD(int(x*10000)));
+}
+
+static float RefGetFixed(const char buffer[], int k)
+{
+	return MAKELONG(MAKEWORD(buffer[k],buffer[k+1]),MAKEWORD(buffer[k+2],buffer[k+3]))*0.0001;
+}
+
+static void RefSensorCnv(const CRobonautData &data, int decideFlag, char buffer[])
+{
+	buffer[0] = LOBYTE(LOWORD(data.count));
+	buffer[1] = HIBYTE(LOWORD(data.count));
+	buffer[2] = LOBYTE(LOWORD(data.CtlMode));
+	buffer[3] = HIBYTE(LOWORD(data.CtlMode));
+	for (int i = 0; i < 7; ++i)
+	{
+		RefPutFixed(buffer, 4 + 4*i, data.leftArmJoint[i]);
+		RefPutFixed(buffer, 32 + 4*i, data.rightArmJoint[i]);
+		RefPutFixed(buffer, 80 + 4*i, data.LeftJointFT[i]);
+		RefPutFixed(buffer, 108 + 4*i, data.RightJointFT[i]);
+	}
+	for (int i = 0; i < 3; ++i) RefPutFixed(buffer, 60 + 4*i, data.headJoint[i]);
+	for (int i = 0; i < 2; ++i) RefPutFixed(buffer, 72 + 4*i, data.waistJoint[i]);
+	buffer[136] = LOBYTE(LOWORD(decideFlag));
+	buffer[137] = HIBYTE(LOWORD(decideFlag));
+	buffer[138] = LOBYTE(HIWORD(decideFlag));
+	buffer[139] = HIBYTE(HIWORD(decideFlag));
+}
+
+static void RefRecvCommand(const char buffer[], int &runFlag, CRobonautData &data)
+{
+	data.count = MAKEWORD(buffer[0],buffer[1]);
+	data.CtlMode = MAKEWORD(buffer[2],buffer[3]);
+	runFlag = MAKELONG(MAKEWORD(buffer[4],buffer[5]),MAKEWORD(buffer[6],buffer[7]));
+	for (int i = 0; i < 7; ++i)
+	{
+		data.leftArmJoint[i] = RefGetFixed(buffer, 8 + 4*i);
+		data.rightArmJoint[i] = RefGetFixed(buffer, 36 + 4*i);
+	}
+	for (int i = 0; i < 3; ++i) data.headJoint[i] = RefGetFixed(buffer, 64 + 4*i);
+	for (int i = 0; i < 2; ++i) data.waistJoint[i] = RefGetFixed(buffer, 76 + 4*i);
+}
+
+int main(int argc, char *argv[])
+{
+	int count = 2000;
+	if (argc > 1)
+	{
+		count = atoi(argv[1]);
+	}
+	if (count < 1)
+	{
+		count = 1;
+	}
+
+	// 与CyberSystem::InitKine相同的机器人参数和关节限位
+	double lower[7] = {-1.0472, -1.9199, -2.0944, -2.2689, -2.0944, -1.5708, -2.0944};
+	double upper[7] = {3.1416, 1.5708, 2.0944, 0.1745, 2.0944, 1.5708, 2.0944};
+	kine_type::angular_interval_vector joint_limits;
+	for (int i = 0; i < 7; ++i)
+	{
+		joint_limits.push_back(kine_type::angular_interval(lower[i], upper[i]));
+	}
+	rpp::kine::KineSolver<double> solver(400, 285, 300, 0, joint_limits);
+	kine_type kine = solver.kine();
+	rpp::kine::SingularityHandler<double> sh(joint_limits);
+	mat7x1 jo_min, jo_max;
+	for (int i = 0; i < 7; ++i)
+	{
+		jo_min(i) = lower[i];
+		jo_max(i) = upper[i];
+	}
+	rpp::kine::DiffKineSolver<double> diff_solver(kine, jo_min, jo_max);
+
+	// 测试数据：关节角、位姿、雅可比、自运动，以及一个控制周期后的目标
+	std::mt19937 gen(20140501);
+	std::uniform_real_distribution<double> unit(0, 1);
+	std::normal_distribution<double> noise(0, 0.01);
+	mat7x1_vector joints(count), joints_prev(count), quat_next(count);
+	mat4x4_vector poses(count);
+	mat6x7_vector jacos(count);
+	std::vector<double> arm_angles(count);
+	self_motions_vector self_motions(count);
+	for (int i = 0; i < count; ++i)
+	{
+		for (int j = 0; j < 7; ++j)
+		{
+			joints[i](j) = lower[j] + (upper[j] - lower[j]) * unit(gen);
+			joints_prev[i](j) = joints[i](j) + noise(gen);
+		}
+		poses[i] = kine.forward(joints[i]);
+		quat_next[i] = rpp::kine::t2quater(kine.forward(mat7x1(joints[i] - (joints_prev[i] - joints[i]))));
+		rpp::kine::jacobian_expanded(joints[i], jacos[i]);
+		self_motions[i] = kine.inverse(poses[i]);
+		arm_angles[i] = 0;
+		if (!self_motions[i].empty())
+		{
+			auto range = self_motions[i][0].arm_angle_range();
+			if (!range.empty())
+			{
+				arm_angles[i] = (range.begin()->lower() + range.begin()->upper()) / 2;
+			}
+		}
+	}
+
+	printf("CyberBench: %d poses, tick budget %.0f ms\n\n", count, TickBudgetMs);
+	printf("%-28s %12s %10s %12s %12s %12s\n", "function", "ns/op", "allocs/op", "p50 ns", "p99 ns", "max ns");
+
+	RunBench("Kine7::forward", count, [&](int i) {
+		g_Sink += kine.forward(joints[i])(0, 3);
+	});
+	RunBench("Kine7::forward_jacobian", count, [&](int i) {
+		mat4x4 T;
+		mat6x7 J;
+		kine.forward_jacobian(joints[i], T, J);
+		g_Sink += T(0, 3) + J(0, 0);
+	});
+	// forward_jacobian的位姿与forward比较，雅可比与中心差分（h = 1e-6 rad）比较，均取相对误差
+	{
+		const double h = 1e-6;
+		double pose_err = 0, jaco_fd_err = 0;
+		for (int i = 0; i < count; ++i)
+		{
+			mat4x4 T;
+			mat6x7 J, J_fd;
+			kine.forward_jacobian(joints[i], T, J);
+			pose_err = std::max(pose_err, (T - kine.forward(joints[i])).norm() / T.norm());
+			for (int j = 0; j < 7; ++j)
+			{
+				mat7x1 qp = joints[i], qm = joints[i];
+				qp(j) += h;
+				qm(j) -= h;
+				const mat4x4 Tp = kine.forward(qp), Tm = kine.forward(qm);
+				J_fd.block<3, 1>(0, j) = (Tp.block<3, 1>(0, 3) - Tm.block<3, 1>(0, 3)) / (2 * h);
+				// dR/dq * R^T为角速度的反对称矩阵
+				const Eigen::Matrix3d W = (Tp.block<3, 3>(0, 0) - Tm.block<3, 3>(0, 0)) / (2 * h) * T.block<3, 3>(0, 0).transpose();
+				J_fd.block<3, 1>(3, j) = Eigen::Vector3d(W(2, 1) - W(1, 2), W(0, 2) - W(2, 0), W(1, 0) - W(0, 1)) / 2;
+			}
+			jaco_fd_err = std::max(jaco_fd_err, (J - J_fd).norm() / J.norm());
+		}
+		printf("%-28s %12.2e %10.2e %s\n", "  vs forward / diff jacobian", pose_err, jaco_fd_err,
+			Check(pose_err < 1e-12 && jaco_fd_err < 1e-6));
+	}
+	RunBench("dh2t product (reference)", count, [&](int i) {
+		mat4x4 T = mat4x4::Identity();
+		for (int j = 0; j < 7; ++j)
+		{
+			T *= rpp::kine::dh2t(kine.dh()(j, 0), kine.dh()(j, 1), joints[i](j) - kine.dh()(j, 2), kine.dh()(j, 3));
+		}
+		g_Sink += T(0, 3);
+	});
+	// 展开式只适用于InitKine的机器人（长度为常数，D = 0的项已消去），通用的Kine7::forward应与它一致
+	RunBench("forward_expanded (reference)", count, [&](int i) {
+		mat4x4 T;
+		rpp::kine::forward_expanded(joints[i], T);
+		g_Sink += T(0, 3);
+	});
+	{
+		double expanded_err = 0;
+		for (int i = 0; i < count; ++i)
+		{
+			mat4x4 T;
+			rpp::kine::forward_expanded(joints[i], T);
+			expanded_err = std::max(expanded_err, (kine.forward(joints[i]) - T).norm() / T.norm());
+		}
+		printf("%-28s %12.2e %10s %s\n", "  forward vs expanded", expanded_err, "", Check(expanded_err < 1e-12));
+	}
+	rpp::kine::SvMinEstimator<double> sv_min;
+	RunBench("CalJaco", count, [&](int i) {
+		mat6x7 J;
+		rpp::kine::jacobian_expanded(joints[i], J);
+		g_Sink += sv_min(J);
+	});
+	RunBench("sv_min_svd", count, [&](int i) {
+		g_Sink += rpp::kine::sv_min_svd(jacos[i]);
+	});
+	RunBench("sv_min_eigen", count, [&](int i) {
+		g_Sink += rpp::kine::sv_min_eigen(mat6x6(jacos[i] * jacos[i].transpose()));
+	});
+	rpp::kine::SvMinInverseIteration<double> sv_inverse;
+	RunBench("sv_min_eigen (J)", count, [&](int i) {
+		g_Sink += rpp::kine::sv_min_eigen(jacos[i], mat6x6(jacos[i] * jacos[i].transpose()));
+	});
+	RunBench("SvMinInverseIteration", count, [&](int i) {
+		g_Sink += sv_inverse(mat6x6(jacos[i] * jacos[i].transpose()));
+	});
+	// 接近奇异：从随机关节角出发，使腕部（q6）、肘部（q4）或两者依次接近0（1e-2到1e-8，最后为0），
+	// 各估计方法与JacobiSVD的最大绝对误差；逆迭代沿这条路径热启动
+	{
+		const double offsets[5] = {1e-2, 1e-4, 1e-6, 1e-8, 0};
+		const char *kinds[3] = {"wrist", "elbow", "wrist + elbow"};
+		printf("%-28s %12s %12s %12s %12s\n", "near singular", "eigen(JJt)", "eigen(J)", "inverse it.", "estimator");
+		for (int kind = 0; kind < 3; ++kind)
+		{
+			double err[4] = {0, 0, 0, 0};
+			double scale = 0;
+			rpp::kine::SvMinEstimator<double> estimator;
+			for (int i = 0; i < count; ++i)
+			{
+				rpp::kine::SvMinInverseIteration<double> inverse_it;
+				for (int k = 0; k < 5; ++k)
+				{
+					mat7x1 q = joints[i];
+					if (kind != 1) q(5) = offsets[k];
+					if (kind != 0) q(3) = offsets[k];
+					mat6x7 J;
+					rpp::kine::jacobian_expanded(q, J);
+					const mat6x6 JJt = J * J.transpose();
+					const double ref = rpp::kine::sv_min_svd(J);
+					const double est[4] = {rpp::kine::sv_min_eigen(JJt), rpp::kine::sv_min_eigen(J, JJt),
+						inverse_it(JJt), estimator(J, JJt)};
+					for (int m = 0; m < 4; ++m)
+					{
+						err[m] = std::max(err[m], fabs(est[m] - ref));
+					}
+					scale = std::max(scale, J.norm());
+				}
+			}
+			printf("  %-26s %12.2e %12.2e %12.2e %12.2e %s\n", kinds[kind], err[0], err[1], err[2], err[3],
+				Check(err[3] < 1e-10 * scale));
+		}
+	}
+	BenchResult inverse_res = RunBench("Kine7::inverse", count, [&](int i) {
+		g_Sink += (double)kine.inverse(poses[i]).size();
+	});
+	RunBench("SelfMotion::get_joints", count, [&](int i) {
+		if (!self_motions[i].empty())
+		{
+			sh.update_current_joints(joints_prev[i]);
+			g_Sink += (double)self_motions[i][0].get_joints(arm_angles[i], sh).size();
+		}
+	});
+	RunBench("SelfMotion::get_joints x8", count, [&](int i) {
+		if (!self_motions[i].empty())
+		{
+			sh.update_current_joints(joints_prev[i]);
+			Eigen::Array<double, 8, 1> angles;
+			for (int j = 0; j < 8; ++j)
+			{
+				angles(j) = arm_angles[i] + 0.05 * (j - 4);
+			}
+			rpp::kine::JointSweep<double, 8> sweep;
+			self_motions[i][0].get_joints(angles, sh, sweep);
+			g_Sink += (double)sweep.mask[0];
+		}
+	});
+	// 奇异处理：默认NullTrace不产生任何代码，RingTrace只写入预分配的环形缓冲区
+	RunBench("SingularityHandler", count, [&](int i) {
+		double t1, t3;
+		sh.update_current_joints(joints_prev[i]);
+		sh.get_upper_joints(joints[i](0) + joints[i](2), t1, t3);
+		g_Sink += t1 + t3;
+	});
+	rpp::kine::TraceBuffer trace_buffer(1024);
+	rpp::kine::SingularityHandler<double, rpp::kine::RingTrace> sh_traced(joint_limits,
+		rpp::kine::RingTrace(trace_buffer));
+	RunBench("SingularityHandler traced", count, [&](int i) {
+		double t1, t3;
+		sh_traced.update_current_joints(joints_prev[i]);
+		sh_traced.get_upper_joints(joints[i](0) + joints[i](2), t1, t3);
+		g_Sink += t1 + t3;
+	});
+	printf("%-28s %12llu %10d\n", "  trace records / held", trace_buffer.total(), (int)trace_buffer.size());
+	RunBench("DiffKine", count, [&](int i) {
+		mat7x1 q;
+		g_Sink += diff_solver.solve(quat_next[i], joints[i], q).residual;
+	});
+	BenchResult calkine_res = RunBench("CalKine", count, [&](int i) {
+		double arm_angle = arm_angles[i];
+		mat7x1 last = joints_prev[i];
+		mat7x1 q;
+		g_Sink += solver.solve(poses[i], arm_angle, last, q);
+	});
+	// 控制周期内的逆解不允许分配；臂角范围超过AngularIntervalSet::MAX_SIZE个区间时会丢弃区间
+	int truncated = 0;
+	for (int i = 0; i < count; ++i)
+	{
+		for (size_t k = 0; k < self_motions[i].size(); ++k)
+		{
+			truncated += self_motions[i][k].arm_angle_range().truncated() ? 1 : 0;
+		}
+	}
+	printf("%-28s %12.2f %10.2f %s\n", "  allocs inverse / CalKine", inverse_res.allocs_per_op, calkine_res.allocs_per_op,
+		Check(inverse_res.allocs_per_op == 0 && calkine_res.allocs_per_op == 0));
+	printf("%-28s %12d %10s\n", "  truncated arm angle ranges", truncated, Check(truncated == 0));
+	// 保持不动的目标：同一位姿、同一上一次状态反复求解，命中位姿缓存
+	solver.cache().reset_stats();
+	RunBench("CalKine (cache hit)", count, [&](int i) {
+		const int k = i % rpp::kine::KineSolver<double>::cache_type::CAPACITY;
+		double arm_angle = arm_angles[k];
+		mat7x1 last = joints_prev[k];
+		mat7x1 q;
+		g_Sink += solver.solve(poses[k], arm_angle, last, q);
+	});
+	printf("%-28s %12lld %10lld\n", "  cache hit / miss", solver.cache().hits(), solver.cache().misses());
+	// 跟踪器抖动：目标在缓存的位姿附近、同一量化格内抖动（平移、转角各为量化步长的1/4以内），由缓存的关节角LM修正；
+	// 与关闭缓存时比较耗时；修正后的位姿误差应在KineSolver的误差限(0.05)内，关节角的最大差别来自臂角的不同选择，只作参考
+	{
+		const int cells = rpp::kine::KineSolver<double>::cache_type::CAPACITY;
+		mat4x4_vector jittered(count);
+		for (int i = 0; i < count; ++i)
+		{
+			// 只取与缓存的位姿在同一格内的抖动，跨格的抖动与普通的未命中相同
+			const int k = i % cells;
+			do
+			{
+				Eigen::Vector3d axis(noise(gen), noise(gen), noise(gen));
+				const double angle = solver.cache().rotation_step() / 4 * unit(gen);
+				jittered[i] = poses[k];
+				jittered[i].block<3, 3>(0, 0) = Eigen::AngleAxisd(angle, axis.normalized()).toRotationMatrix()
+					* poses[k].block<3, 3>(0, 0);
+				for (int j = 0; j < 3; ++j)
+				{
+					jittered[i](j, 3) += solver.cache().position_step() / 4 * (2 * unit(gen) - 1);
+				}
+			} while (!(solver.cache().key(jittered[i]) == solver.cache().key(poses[k])));
+		}
+		rpp::kine::KineSolver<double> uncached = solver;
+		uncached.cache().set_quantization(0, 0);
+		RunBench("CalKine (jitter, uncached)", count, [&](int i) {
+			const int k = i % cells;
+			double arm_angle = arm_angles[k];
+			mat7x1 last = joints_prev[k];
+			mat7x1 q;
+			g_Sink += uncached.solve(jittered[i], arm_angle, last, q);
+		});
+		solver.cache().reset_stats();
+		RunBench("CalKine (jitter, cached)", count, [&](int i) {
+			const int k = i % cells;
+			double arm_angle = arm_angles[k];
+			mat7x1 last = joints_prev[k];
+			mat7x1 q;
+			g_Sink += solver.solve(jittered[i], arm_angle, last, q);
+		});
+		printf("%-28s %12lld %10lld %12lld\n", "  hit / warm start / miss", solver.cache().hits(),
+			solver.cache().warm_hits(), solver.cache().misses());
+		int mismatch = 0;
+		double worst = 0, worst_pose = 0;
+		for (int i = 0; i < count; ++i)
+		{
+			const int k = i % cells;
+			double arm_angle = arm_angles[k], arm_angle_ref = arm_angles[k];
+			mat7x1 last = joints_prev[k], last_ref = joints_prev[k], q, q_ref;
+			const int status = solver.solve(jittered[i], arm_angle, last, q);
+			const int status_ref = uncached.solve(jittered[i], arm_angle_ref, last_ref, q_ref);
+			if ((status >= 0) != (status_ref >= 0))
+			{
+				mismatch++;
+			}
+			else if (status >= 0)
+			{
+				worst = std::max(worst, (q - q_ref).cwiseAbs().maxCoeff());
+				worst_pose = std::max(worst_pose, (solver.kine().forward(q) - jittered[i]).norm());
+			}
+		}
+		printf("%-28s %12d %10.2e %12.2e %s\n", "  found != / joint diff / err", mismatch, worst, worst_pose,
+			Check(mismatch == 0 && worst_pose <= 0.05));
+	}
+
+	// 逆运动学策略：与CalKine相同的位姿和上一次关节角，统计各自的成功次数
+	rpp::kine::AnalyticIk<double> analytic_ik(solver);
+	rpp::kine::DifferentialIk<double> differential_ik(diff_solver);
+	rpp::kine::HybridIk<double> hybrid_ik(analytic_ik, differential_ik);
+	rpp::kine::IkStrategy<double> *strategies[3] = { &analytic_ik, &differential_ik, &hybrid_ik };
+	for (int k = 0; k < 3; ++k)
+	{
+		rpp::kine::IkStrategy<double> *strategy = strategies[k];
+		strategy->reset_stats();
+		RunBench((std::string("IkStrategy ") + strategy->name()).c_str(), count, [&](int i) {
+			double arm_angle = arm_angles[i];
+			mat7x1 last = joints_prev[i];
+			mat7x1 q;
+			g_Sink += strategy->solve(poses[i], arm_angle, last, q);
+		});
+		printf("%-28s %12lld %10lld\n", "  solved / calls", strategy->stats().succeeded, strategy->stats().calls);
+	}
+	printf("%-28s %12lld %10lld\n", "  near singular / failed", hybrid_ik.near_singular(), hybrid_ik.analytic_failed());
+
+	// 路径规划：每步插值一次，或一次生成全部采样（100步，缓冲区复用）
+	RunBench("pose_interpolate (slerp)", count, [&](int i) {
+		g_Sink += rpp::kine::pose_interpolate(quat_next[i], quat_next[(i + 1) % count], 0.3)(3);
+	});
+	rpp::kine::Trajectory<double> traj;
+	RunBench("Trajectory::plan x100", count, [&](int i) {
+		traj.plan(quat_next[i], quat_next[(i + 1) % count], 100, rpp::kine::TIME_MIN_JERK);
+		g_Sink += traj.transform(50)(0, 3);
+	});
+	// 多路径点：3个笛卡尔路径点逐个解析求解，再按关节速度0.5 rad/s、加速度1 rad/s^2生成时间最优轨迹
+	rpp::kine::JointPlanner<double>::limits_type plan_limits;
+	for (int j = 0; j < 7; ++j)
+	{
+		plan_limits.lower(j) = lower[j];
+		plan_limits.upper(j) = upper[j];
+	}
+	plan_limits.max_velocity.setConstant(0.5);
+	plan_limits.max_acceleration.setConstant(1);
+	rpp::kine::JointPlanner<double> planner(plan_limits);
+	int plan_ok = 0;
+	RunBench("JointPlanner 3 waypoints", count, [&](int i) {
+		const int k = (i + 3 < count) ? i : 0;
+		plan_ok += (planner.plan(analytic_ik, &poses[k + 1], 3, joints[k], 0, 0.25) == rpp::kine::PLAN_OK) ? 1 : 0;
+		g_Sink += planner.duration();
+	});
+	printf("%-28s %12.1f %10d\n", "  last duration s / steps", planner.duration(), (int)planner.samples().size());
+	// 中间路径点不停顿：以1ms周期重新采样最后一条轨迹，差分求速度、加速度，与逐段停顿的总时间比较
+	{
+		const rpp::kine::JointPlanner<double>::joint_vector wp = planner.waypoints();
+		double rest_time = 0;
+		for (size_t s = 1; s < wp.size(); ++s)
+		{
+			double v = 1e300, a = 1e300;
+			for (int j = 0; j < 7; ++j)
+			{
+				const double d = fabs(wp[s](j) - wp[s - 1](j));
+				if (d <= 0) continue;
+				v = std::min(v, plan_limits.max_velocity(j) / d);
+				a = std::min(a, plan_limits.max_acceleration(j) / d);
+			}
+			if (v < 1e300) rest_time += (v * v >= a) ? 2 * sqrt(1 / a) : 1 / v + v / a;
+		}
+		const double dt = 1e-3;
+		planner.plan(&wp[0], (int)wp.size(), dt);
+		const rpp::kine::JointPlanner<double>::joint_vector &qs = planner.samples();
+		const double head = planner.segments()[0].blend, tail = planner.duration() - planner.end_blend();
+		double vel_ratio = 0, acc_ratio = 0, min_speed = 1e300;
+		for (size_t s = 0; s + 1 < qs.size(); ++s)
+		{
+			const Eigen::Matrix<double, 7, 1> qv = (qs[s + 1] - qs[s]) / dt;
+			vel_ratio = std::max(vel_ratio, qv.cwiseAbs().cwiseQuotient(plan_limits.max_velocity).maxCoeff());
+			const double t = (s + 1.5) * dt;
+			if (t > head && t < tail) min_speed = std::min(min_speed, qv.norm());
+			if (s + 2 < qs.size())
+			{
+				const Eigen::Matrix<double, 7, 1> qa = (qs[s + 2] - 2 * qs[s + 1] + qs[s]) / (dt * dt);
+				acc_ratio = std::max(acc_ratio, qa.cwiseAbs().cwiseQuotient(plan_limits.max_acceleration).maxCoeff());
+			}
+		}
+		printf("%-28s %12.3f %10.3f %s\n", "  duration / rest-to-rest s", planner.duration(), rest_time,
+			Check(planner.duration() < rest_time));
+		printf("%-28s %12.4f %10.4f %s\n", "  max vel / acc of limit", vel_ratio, acc_ratio,
+			Check(vel_ratio <= 1.001 && acc_ratio <= 1.001));
+		printf("%-28s %12.4f %10s %s\n", "  min speed rad/s", min_speed, "", Check(min_speed > 0.01));
+	}
+
+	// 单精度：同样的机器人和关节限位，误差以双精度正运动学为基准
+	kinef_type::angular_interval_vector joint_limits_f;
+	for (int i = 0; i < 7; ++i)
+	{
+		joint_limits_f.push_back(kinef_type::angular_interval((float)lower[i], (float)upper[i]));
+	}
+	rpp::kine::KineSolver<float> solver_f(400, 285, 300, 0, joint_limits_f);
+	kinef_type kine_f = solver_f.kine();
+	rpp::kine::SingularityHandler<float> sh_f(joint_limits_f);
+	rpp::kine::DiffKineSolver<float> diff_solver_f(kine_f, jo_min.cast<float>(), jo_max.cast<float>());
+	mat7x1f_vector joints_f(count), joints_prev_f(count), quat_next_f(count);
+	mat4x4f_vector poses_f(count);
+	std::vector<kinef_type::self_motion_vector> self_motions_f(count);
+	for (int i = 0; i < count; ++i)
+	{
+		joints_f[i] = joints[i].cast<float>();
+		joints_prev_f[i] = joints_prev[i].cast<float>();
+		quat_next_f[i] = quat_next[i].cast<float>();
+		poses_f[i] = poses[i].cast<float>();
+		self_motions_f[i] = kine_f.inverse(poses_f[i]);
+	}
+
+	printf("\n%-28s %12s %10s %12s %12s %12s\n", "function (float)", "ns/op", "allocs/op", "p50 ns", "p99 ns", "max ns");
+	RunBench("Kine7::forward", count, [&](int i) {
+		g_Sink += kine_f.forward(joints_f[i])(0, 3);
+	});
+	RunBench("jacobian_expanded", count, [&](int i) {
+		mat6x7f J;
+		rpp::kine::jacobian_expanded(joints_f[i], J);
+		g_Sink += J(0, 0);
+	});
+	BenchResult inverse_f_res = RunBench("Kine7::inverse", count, [&](int i) {
+		g_Sink += (double)kine_f.inverse(poses_f[i]).size();
+	});
+	RunBench("SelfMotion::get_joints x8", count, [&](int i) {
+		if (!self_motions_f[i].empty())
+		{
+			sh_f.update_current_joints(joints_prev_f[i]);
+			Eigen::Array<float, 8, 1> angles;
+			for (int j = 0; j < 8; ++j)
+			{
+				angles(j) = (float)(arm_angles[i] + 0.05 * (j - 4));
+			}
+			rpp::kine::JointSweep<float, 8> sweep;
+			self_motions_f[i][0].get_joints(angles, sh_f, sweep);
+			g_Sink += (double)sweep.mask[0];
+		}
+	});
+	RunBench("DiffKine", count, [&](int i) {
+		mat7x1f q;
+		g_Sink += diff_solver_f.solve(quat_next_f[i], joints_f[i], q).residual;
+	});
+	BenchResult calkine_f_res = RunBench("CalKine", count, [&](int i) {
+		float arm_angle = (float)arm_angles[i];
+		mat7x1f last = joints_prev_f[i];
+		mat7x1f q;
+		g_Sink += solver_f.solve(poses_f[i], arm_angle, last, q);
+	});
+	printf("%-28s %12.2f %10.2f %s\n", "  allocs inverse / CalKine", inverse_f_res.allocs_per_op, calkine_f_res.allocs_per_op,
+		Check(inverse_f_res.allocs_per_op == 0 && calkine_f_res.allocs_per_op == 0));
+
+	// 单精度的误差：正运动学与雅可比直接比较，逆解和微分运动学用双精度正运动学检验所得关节角
+	std::vector<double> fk_mm, fk_deg, ik_mm, ik_deg, dk_mm, dk_deg;
+	double jaco_err = 0;
+	int ik_ok = 0, ik_ok_f = 0, ik_refined_f = 0;
+	for (int i = 0; i < count; ++i)
+	{
+		double mm, deg;
+		PoseError(kine_f.forward(joints_f[i]).cast<double>(), kine.forward(mat7x1(joints_f[i].cast<double>())), mm, deg);
+		fk_mm.push_back(mm);
+		fk_deg.push_back(deg);
+
+		mat6x7f J;
+		rpp::kine::jacobian_expanded(joints_f[i], J);
+		jaco_err = std::max(jaco_err, (J.cast<double>() - jacos[i]).norm() / jacos[i].norm());
+
+		double arm_angle = arm_angles[i];
+		mat7x1 last = joints_prev[i], q;
+		if (solver.solve(poses[i], arm_angle, last, q) >= 0)
+		{
+			++ik_ok;
+		}
+		float arm_angle_f = (float)arm_angles[i];
+		mat7x1f last_f = joints_prev_f[i], q_f;
+		int status = solver_f.solve(poses_f[i], arm_angle_f, last_f, q_f);
+		if (status >= 0)
+		{
+			++ik_ok_f;
+			ik_refined_f += (status == rpp::kine::KINE_REFINED);
+			PoseError(kine.forward(mat7x1(q_f.cast<double>())), poses[i], mm, deg);
+			ik_mm.push_back(mm);
+			ik_deg.push_back(deg);
+		}
+
+		diff_solver_f.solve(quat_next_f[i], joints_f[i], q_f);
+		mat7x1 q_next;
+		diff_solver.solve(quat_next[i], joints[i], q_next);
+		PoseError(kine.forward(mat7x1(q_f.cast<double>())), kine.forward(q_next), mm, deg);
+		dk_mm.push_back(mm);
+		dk_deg.push_back(deg);
+	}
+	printf("\n%-28s %12s %12s %12s %12s %12s %12s\n", "float error", "p50 mm", "p99 mm", "max mm", "p50 deg", "p99 deg", "max deg");
+	PrintError("Kine7::forward", fk_mm, fk_deg);
+	PrintError("CalKine", ik_mm, ik_deg);
+	PrintError("DiffKine (vs double)", dk_mm, dk_deg);
+	printf("jacobian_expanded max relative error %.2e\n", jaco_err);
+	printf("CalKine solved: double %d, float %d (%d refined)\n", ik_ok, ik_ok_f, ik_refined_f);
+
+	// 批量逆运动学随线程数的扩展；结果应与同一求解器按顺序逐个求解完全相同
+	printf("\n%-28s %12s %12s %10s\n", "KineBatch threads", "poses/s", "speedup", "= serial");
+	mat7x1_vector serial_q(count);
+	std::vector<double> serial_arm_angle(count);
+	std::vector<int> serial_status(count);
+	{
+		rpp::kine::KineSolver<double> serial_solver = solver;
+		double arm_angle = 0;
+		mat7x1 last = joints_prev[0];
+		for (int i = 0; i < count; ++i)
+		{
+			serial_status[i] = serial_solver.solve(poses[i], arm_angle, last, serial_q[i]);
+			if (serial_status[i] < 0)
+			{
+				serial_q[i] = last;
+			}
+			serial_arm_angle[i] = arm_angle;
+		}
+	}
+	double base_rate = 0;
+	int max_threads = QThread::idealThreadCount();
+	// 1, 2, 4, ...，最后一个为idealThreadCount
+	for (int threads = 1; ; threads = std::min(threads * 2, max_threads))
+	{
+		KineBatch batch(solver, threads);
+		KineBatch::Result result;
+		batch.Solve(&poses[0], count, joints_prev[0], 0, result);
+		rpp::util::Stopwatch sw;
+		batch.Solve(&poses[0], count, joints_prev[0], 0, result);
+		double rate = count / (sw.elapsed_ns() * 1e-9);
+		if (threads == 1)
+		{
+			base_rate = rate;
+		}
+		int mismatch = 0;
+		for (int i = 0; i < count; ++i)
+		{
+			bool same = result.status[i] == serial_status[i] && result.arm_angle[i] == serial_arm_angle[i];
+			for (int j = 0; j < 7; ++j)
+			{
+				same = same && result.q[j][i] == serial_q[i](j);
+			}
+			mismatch += same ? 0 : 1;
+		}
+		printf("%-28d %12.0f %12.2f %10s\n", threads, rate, rate / base_rate, Check(mismatch == 0));
+		if (threads >= max_threads)
+		{
+			break;
+		}
+	}
+
+	// 双臂：左臂用自己的求解器（DH参数相同，关节限位为RobonautControl.h中的ROBO_LJ*），
+	// 目标为右臂目标的镜像；右臂在本线程求解，左臂顺序求解或在线程池中同时求解
+	{
+		const double left_lower_deg[7] = {-49, -100, -120, -129, -120, -90, -120};
+		const double left_upper_deg[7] = {170, 70, 120, 0, 120, 90, 120};
+		kine_type::angular_interval_vector left_limits;
+		mat7x1 left_min, left_max;
+		for (int i = 0; i < 7; ++i)
+		{
+			left_min(i) = left_lower_deg[i] * rpp::util::Constants<double>::pi / 180;
+			left_max(i) = left_upper_deg[i] * rpp::util::Constants<double>::pi / 180;
+			left_limits.push_back(kine_type::angular_interval(left_min(i), left_max(i)));
+		}
+		rpp::kine::KineSolver<double> left_solver(400, 285, 300, 0, left_limits);
+		ArmChain right_arm(2);
+		ArmChain left_arm(2);
+		right_arm.Init(solver, diff_solver, NULL);
+		left_arm.Init(left_solver, rpp::kine::DiffKineSolver<double>(left_solver.kine(), left_min, left_max), NULL);
+		mat4x4_vector left_poses(count);
+		mat7x1_vector left_prev(count);
+		for (int i = 0; i < count; ++i)
+		{
+			left_poses[i] = rpp::kine::mirror_pose(poses[i], ArmMirrorAxis);
+			left_prev[i] = rpp::kine::mirror_joints(joints_prev[i], ArmMirrorAxis);
+		}
+		QThreadPool arm_pool;
+		arm_pool.setMaxThreadCount(1);
+
+		printf("\n%-28s %12s %10s %12s %12s %12s\n", "dual arm", "ns/op", "allocs/op", "p50 ns", "p99 ns", "max ns");
+		RunBench("ArmChain right", count, [&](int i) {
+			right_arm.Reset(joints_prev[i], arm_angles[i]);
+			g_Sink += right_arm.Solve(poses[i]);
+		});
+		RunBench("ArmChain right + left", count, [&](int i) {
+			right_arm.Reset(joints_prev[i], arm_angles[i]);
+			left_arm.Reset(left_prev[i], -arm_angles[i]);
+			g_Sink += right_arm.Solve(poses[i]) + left_arm.Solve(left_poses[i]);
+		});
+		RunBench("ArmChain right + left pool", count, [&](int i) {
+			right_arm.Reset(joints_prev[i], arm_angles[i]);
+			left_arm.Reset(left_prev[i], -arm_angles[i]);
+			arm_pool.start(new ArmChainTask(left_arm, left_poses[i]));
+			g_Sink += right_arm.Solve(poses[i]);
+			arm_pool.waitForDone();
+			g_Sink += left_arm.Status();
+		});
+		// 镜像的关节角应到达镜像的位姿（mirror_joints的假设）；左臂的解直接用正运动学检查位姿误差，
+		// 并且在SendRoboMsg的左臂限位内（不会被截断）
+		int right_ok = 0;
+		int left_ok = 0;
+		int out_of_limits = 0;
+		double mirror_err = 0;
+		double left_err = 0;
+		for (int i = 0; i < count; ++i)
+		{
+			mirror_err = std::max(mirror_err,
+				(kine.forward(mat7x1(rpp::kine::mirror_joints(joints[i], ArmMirrorAxis))) - left_poses[i]).norm());
+			right_arm.Reset(joints_prev[i], arm_angles[i]);
+			left_arm.Reset(left_prev[i], -arm_angles[i]);
+			right_ok += right_arm.Solve(poses[i]) >= 0 ? 1 : 0;
+			if (left_arm.Solve(left_poses[i]) >= 0)
+			{
+				left_ok++;
+				left_err = std::max(left_err, (kine.forward(left_arm.Joints()) - left_poses[i]).norm());
+				for (int j = 0; j < 7; ++j)
+				{
+					const double deg = left_arm.Joints()(j) * 180 / rpp::util::Constants<double>::pi;
+					out_of_limits += (deg < left_lower_deg[j] - 1e-9 || deg > left_upper_deg[j] + 1e-9) ? 1 : 0;
+				}
+			}
+		}
+		printf("%-28s %12d %10d\n", "  solved right / left", right_ok, left_ok);
+		printf("%-28s %12.2e %10s %s\n", "  mirror_joints pose err", mirror_err, "", Check(mirror_err < 1e-9));
+		printf("%-28s %12.2e %10s %s\n", "  left pose err", left_err, "", Check(left_ok > 0 && left_err < 0.05));
+		printf("%-28s %12d %10s %s\n", "  left joints out of limits", out_of_limits, "", Check(out_of_limits == 0));
+	}
+
+	// 可达性地图：后台生成（并行）时OpenAsync的返回耗时、生成与重新映射的耗时，以及按位姿查询的耗时
+	{
+		const char *path = "CyberBench_ReachMap.dat";
+		const double voxel = 40;
+		const int samples = 200000;
+		QFile::remove(path);
+		ReachMap reach_map;
+		rpp::util::Stopwatch sw;
+		reach_map.OpenAsync(path, solver, voxel, samples);
+		double async_ms = sw.elapsed_ns() / 1e6;
+		bool building = reach_map.IsBuilding() && !reach_map.IsOpen() && !reach_map.IsHopeless(mat4x4::Identity());
+		bool built = reach_map.Wait();
+		double build_ms = sw.elapsed_ns() / 1e6;
+		sw.start();
+		bool mapped = reach_map.Load(path, solver);
+		double map_ms = sw.elapsed_ns() / 1e6;
+		if (built && mapped)
+		{
+			printf("\nReachMap %.0f mm, %d samples: build %.0f ms, map %.3f ms, %d reachable voxels\n",
+				voxel, samples, build_ms, map_ms, reach_map.Info().reachable);
+			printf("%-28s %12.3f %10s %s\n", "  OpenAsync returned ms", async_ms, "", Check(building));
+			int hopeless = 0;
+			RunBench("ReachMap::IsHopeless", count, [&](int i) {
+				hopeless += reach_map.IsHopeless(poses[i]) ? 1 : 0;
+			});
+			RunBench("ReachMap::Distance", count, [&](int i) {
+				g_Sink += reach_map.Distance(poses[i]);
+			});
+			printf("%-28s %12d\n", "  hopeless (reachable poses)", hopeless);
+
+			// 求解前的预检：可达的位姿不能被跳过；位置放大1.5倍的位姿大多在臂展外，被跳过的应都无解
+			int skipped = 0;
+			RunBench("ReachMap::IsUnreachable", count, [&](int i) {
+				skipped += reach_map.IsUnreachable(poses[i]) ? 1 : 0;
+			});
+			printf("%-28s %12d %10s %s\n", "  skipped (reachable poses)", skipped, "", Check(skipped == 0));
+			mat4x4_vector far_poses(poses.begin(), poses.end());
+			for (int i = 0; i < count; ++i)
+			{
+				far_poses[i].block<3, 1>(0, 3) *= 1.5;
+			}
+			RunBench("CalKine (1.5x position)", count, [&](int i) {
+				double arm_angle = arm_angles[i];
+				mat7x1 last = joints_prev[i];
+				mat7x1 q;
+				g_Sink += solver.solve(far_poses[i], arm_angle, last, q);
+			});
+			int far_skipped = 0, skipped_solved = 0;
+			for (int i = 0; i < count; ++i)
+			{
+				if (reach_map.IsUnreachable(far_poses[i]))
+				{
+					double arm_angle = arm_angles[i];
+					mat7x1 last = joints_prev[i];
+					mat7x1 q;
+					far_skipped++;
+					skipped_solved += solver.solve(far_poses[i], arm_angle, last, q) >= 0 ? 1 : 0;
+				}
+			}
+			printf("%-28s %12d %10d %s\n", "  skipped / of them solved", far_skipped, skipped_solved,
+				Check(skipped_solved == 0));
+		}
+		reach_map.Close();
+		QFile::remove(path);
+	}
+
+	// 灵巧手通信：文本包（sprintf/sscanf）与二进制包的编解码耗时及字节数
+	{
+		CHandData right, left;
+		right.count = 0;
+		left.count = 0;
+		for (int i = 0; i < 5; ++i)
+		{
+			for (int j = 0; j < 3; ++j)
+			{
+				right.joint[i][j] = (float)(10 * i + j + unit(gen));
+				left.joint[i][j] = (float)(-10 * i - j - unit(gen));
+				right.torque[i][j] = (float)noise(gen);
+				left.torque[i][j] = (float)noise(gen);
+			}
+		}
+		HandCmdState cmd_state = {80.0f, 3, 5, 0, 90, 0x9888c1, 0, 1, 0, 0};
+		HandSenseState sense_state = {0x9888c1, 1, 1};
+		char cmd_text[1024], cmd_binary[1024], sense_text[2048], sense_binary[2048];
+		int cmd_text_len = 0, cmd_binary_len = 0, sense_text_len = 0, sense_binary_len = 0;
+		printf("\n");
+		RunBench("Hand command encode text", count, [&](int i) {
+			cmd_text_len = HandCodec::EncodeTextCommand(i, right, left, cmd_state, cmd_text, sizeof(cmd_text));
+		});
+		RunBench("Hand command encode binary", count, [&](int i) {
+			cmd_binary_len = HandCodec::EncodeBinaryCommand(i, right, left, cmd_state, cmd_binary, sizeof(cmd_binary));
+		});
+		sense_text_len = HandCodec::EncodeTextSensor(right, left, sense_state, sense_text, sizeof(sense_text));
+		sense_binary_len = HandCodec::EncodeBinarySensor(right, left, sense_state, sense_binary, sizeof(sense_binary));
+		CHandData r, l;
+		HandSenseState s;
+		RunBench("Hand sensor decode text", count, [&](int) {
+			g_Sink += HandCodec::DecodeTextSensor(sense_text, r, l, s) ? r.torque[4][2] : 0;
+		});
+		RunBench("Hand sensor decode binary", count, [&](int) {
+			g_Sink += HandCodec::DecodeBinarySensor(sense_binary, sense_binary_len, r, l, s) ? r.torque[4][2] : 0;
+		});
+		// 长度头5字节另计
+		printf("%-28s %12d %10d\n", "  command bytes text / bin", cmd_text_len, cmd_binary_len);
+		printf("%-28s %12d %10d\n", "  sensor bytes text / bin", sense_text_len, sense_binary_len);
+	}
+
+	// 机器人UDP包：字段表编解码与原来逐字节拼接的耗时、结果是否逐字节相同，
+	// 及解码(编码(x))与x的最大偏差（定点截断加float舍入，应小于2/ROBO_FIXED_SCALE）
+	{
+		CRobonautData cmd;
+		for (int i = 0; i < 7; ++i)
+		{
+			cmd.leftArmJoint[i] = (float)(180 * unit(gen) - 90);
+			cmd.rightArmJoint[i] = (float)(180 * unit(gen) - 90);
+		}
+		for (int i = 0; i < 3; ++i) cmd.headJoint[i] = (float)(60 * unit(gen) - 30);
+		for (int i = 0; i < 2; ++i) cmd.waistJoint[i] = (float)(60 * unit(gen) - 30);
+		char buffer[RoboCodec::SensorSize];
+		printf("\n");
+		RunBench("RoboCodec command encode", count, [&](int i) {
+			cmd.count = i;
+			RoboCodec::EncodeCommand(i, cmd, buffer);
+			g_Sink += buffer[40];
+		});
+		RunBench("RoboDataCnv (reference)", count, [&](int i) {
+			cmd.count = i;
+			RefRoboDataCnv(i, cmd, buffer);
+			g_Sink += buffer[40];
+		});
+		CRobonautData sensor;
+		int decide = 0;
+		RoboCodec::EncodeSensor(cmd, 1, buffer);
+		RunBench("RoboCodec sensor decode", count, [&](int) {
+			RoboCodec::DecodeSensor(buffer, sensor, decide);
+			g_Sink += sensor.rightArmJoint[6];
+		});
+		RunBench("RecvRoboMsg (reference)", count, [&](int) {
+			RefRecvRoboMsg(buffer, sensor, decide);
+			g_Sink += sensor.rightArmJoint[6];
+		});
+
+		// 与原来的逐字节拼接逐字节比较：随机数据编码，随机字节解码（解码结果按位比较）
+		{
+			std::uniform_int_distribution<int> byte(0, 255);
+			char a[RoboCodec::SensorSize], b[RoboCodec::SensorSize];
+			CRobonautData x, y;
+			int encode_diff = 0, decode_diff = 0;
+			auto random_fixed = [&](float v[], int n, double range) {
+				for (int k = 0; k < n; ++k) v[k] = (float)(range * (2 * unit(gen) - 1));
+			};
+			auto same = [&](const float u[], const float v[], int n) {
+				return memcmp(u, v, n*sizeof(float)) == 0;
+			};
+			for (int t = 0; t < count; ++t)
+			{
+				x.count = (int)(gen() & 0x7FFFFFFF);
+				x.CtlMode = (int)(gen() & 0xFFFF);
+				random_fixed(x.leftArmJoint, 7, 180);
+				random_fixed(x.rightArmJoint, 7, 180);
+				random_fixed(x.headJoint, 3, 180);
+				random_fixed(x.waistJoint, 2, 180);
+				random_fixed(x.LeftJointFT, 7, 200000);
+				random_fixed(x.RightJointFT, 7, 200000);
+				const int flag = (int)gen();
+				RoboCodec::EncodeCommand(flag, x, a);
+				RefRoboDataCnv(flag, x, b);
+				encode_diff += memcmp(a, b, RoboCodec::CommandSize) != 0;
+				RoboCodec::EncodeSensor(x, flag, a);
+				RefSensorCnv(x, flag, b);
+				encode_diff += memcmp(a, b, RoboCodec::SensorSize) != 0;
+
+				for (int k = 0; k < RoboCodec::SensorSize; ++k) a[k] = (char)byte(gen);
+				int fa = 0, fb = 0;
+				RoboCodec::DecodeSensor(a, x, fa);
+				RefRecvRoboMsg(a, y, fb);
+				decode_diff += !(x.count == y.count && x.CtlMode == y.CtlMode && fa == fb &&
+					same(x.leftArmJoint, y.leftArmJoint, 7) && same(x.rightArmJoint, y.rightArmJoint, 7) &&
+					same(x.headJoint, y.headJoint, 3) && same(x.waistJoint, y.waistJoint, 2) &&
+					same(x.LeftJointFT, y.LeftJointFT, 7) && same(x.RightJointFT, y.RightJointFT, 7));
+				RoboCodec::DecodeCommand(a, fa, x);
+				RefRecvCommand(a, fb, y);
+				decode_diff += !(x.count == y.count && x.CtlMode == y.CtlMode && fa == fb &&
+					same(x.leftArmJoint, y.leftArmJoint, 7) && same(x.rightArmJoint, y.rightArmJoint, 7) &&
+					same(x.headJoint, y.headJoint, 3) && same(x.waistJoint, y.waistJoint, 2));
+			}
+			printf("%-28s %12d %10s\n", "  encode != reference", encode_diff, Check(encode_diff == 0));
+			printf("%-28s %12d %10s\n", "  decode != reference", decode_diff, Check(decode_diff == 0));
+		}
+		int run = 0;
+		RoboCodec::EncodeCommand(7, cmd, buffer);
+		RoboCodec::DecodeCommand(buffer, run, sensor);
+		double worst = 0;
+		auto compare = [&](const float a[], const float b[], int n) {
+			for (int k = 0; k < n; ++k) worst = std::max(worst, fabs((double)a[k] - b[k]));
+		};
+		compare(sensor.leftArmJoint, cmd.leftArmJoint, 7);
+		compare(sensor.rightArmJoint, cmd.rightArmJoint, 7);
+		compare(sensor.headJoint, cmd.headJoint, 3);
+		compare(sensor.waistJoint, cmd.waistJoint, 2);
+		printf("%-28s %12.2e %10s\n", "  round trip error (deg)", worst,
+			Check(run == 7 && sensor.count == cmd.count && worst < 2.0/ROBO_FIXED_SCALE));
+	}
+
+	// 接收分帧：文本格式的灵巧手传感器帧连续到达，每次recv得到一个以太网帧的数据（1460字节），
+	// 与帧的边界无关；计入复制到接收缓冲的时间（代替recv）
+	{
+		CHandData right, left;
+		right.count = 0;
+		left.count = 0;
+		for (int i = 0; i < 5; ++i)
+		{
+			for (int j = 0; j < 3; ++j)
+			{
+				right.joint[i][j] = (float)(10 * i + j + unit(gen));
+				left.joint[i][j] = (float)(-10 * i - j - unit(gen));
+				right.torque[i][j] = (float)noise(gen);
+				left.torque[i][j] = (float)noise(gen);
+			}
+		}
+		HandSenseState sense_state = {0x9888c1, 1, 1};
+		char sense[2048];
+		const int sense_len = HandCodec::EncodeTextSensor(right, left, sense_state, sense, sizeof(sense));
+		std::string stream;
+		for (int k = 0; k < 64; ++k)
+		{
+			char head[FRAME_HEAD_LEN];
+			StreamFramer::WriteHead(sense_len, head);
+			stream.append(head, FRAME_HEAD_LEN);
+			stream.append(sense, sense_len);
+		}
+		StreamFramer framer(4096);
+		size_t pos = 0;
+		int frames = 0;
+		printf("\n");
+		RunBench("StreamFramer hand frame", count, [&](int) {
+			const char *frame = NULL;
+			int len = 0;
+			while (framer.NextFrame(frame, len) != StreamFramer::Complete)
+			{
+				int space = 0;
+				char *dst = framer.WriteSpace(space);
+				const int n = (int)std::min<size_t>(std::min(space, 1460), stream.size() - pos);
+				memcpy(dst, &stream[pos], n);
+				framer.Commit(n);
+				pos = (pos + n) % stream.size();
+			}
+			g_Sink += len + frame[len - 1];
+			++frames;
+		});
+		printf("%-28s %12d %10d\n", "  frames / buffer moves", frames, framer.Moves());
+	}
+
+	// 预测仿真应答与指令的对应：现有仿真的20项应答按顺序对应，超时的指令留在队列中不错位，回传计数的21项应答按计数对应
+	{
+		const long long ms = 1000000LL;
+		const char *legacy = "%d,1.0,2.0,3.0,4.0,5.0,6.0,7.0,8.0,9.0,10.0,11.0,12.0,13.0,14.0,15.0,16.0,17.0,18.0,%d.0";
+		char line[256];
+		CRobonautData safe;
+		int reply_count = 0, collision = 0;
+		ConsimuQueue queue;
+		bool order_ok = true;
+		for (int k = 1; k <= 3; ++k)
+		{
+			queue.Push(k, k * ms);
+			queue.Sent();
+		}
+		for (int k = 1; k <= 3; ++k)
+		{
+			sprintf(line, legacy, k % 2, k);
+			queue.OnReply(line, 10 * ms);
+			order_ok = order_ok && queue.TakeReply(reply_count, collision, safe) && reply_count == k &&
+				collision == k % 2 && safe.waistJoint[1] == (float)k && safe.leftArmJoint[0] == 1.0f;
+		}
+		// 第4条超时后第5条才发出：第4条的应答迟到时丢弃，第5条的应答仍对应第5条
+		queue.Push(4, 20 * ms);
+		queue.Push(5, (21 + CONSIMU_TIMEOUT_MS) * ms);
+		sprintf(line, legacy, 0, 4);
+		queue.OnReply(line, (22 + CONSIMU_TIMEOUT_MS) * ms);
+		const bool late_dropped = !queue.TakeReply(reply_count, collision, safe);
+		sprintf(line, legacy, 0, 5);
+		queue.OnReply(line, (23 + CONSIMU_TIMEOUT_MS) * ms);
+		order_ok = order_ok && late_dropped && queue.TakeReply(reply_count, collision, safe) && reply_count == 5;
+		// 回传计数：第6条没有应答，第7条的应答到达后第6条计入超时
+		queue.Push(6, 300 * ms);
+		queue.Push(7, 301 * ms);
+		queue.OnReply("7,1,1.0,2.0,3.0,4.0,5.0,6.0,7.0,8.0,9.0,10.0,11.0,12.0,13.0,14.0,15.0,16.0,17.0,18.0,19.0", 305 * ms);
+		order_ok = order_ok && queue.TakeReply(reply_count, collision, safe) && reply_count == 7 && collision == 1;
+		queue.OnReply("1,2,3", 306 * ms);
+		ConsimuStats stats = queue.Stats();
+		printf("\n%-28s %12d %10d %s\n", "ConsimuQueue replies / bad", stats.replies, stats.bad,
+			Check(order_ok && stats.replies == 6 && stats.bad == 1 && stats.pending == 0 && stats.expired == 0));
+		printf("%-28s %12d %10s %s\n", "  timeouts", stats.timeouts, "", Check(stats.timeouts == 2));
+		// 仿真停止应答：超时的指令不占在途名额，最早的指令超过CONSIMU_STALL_MS后要求重新连接
+		bool stalled = false;
+		int pushed = 0;
+		for (long long t = 400; t <= 400 + CONSIMU_STALL_MS + 20 && !stalled; t += 10)
+		{
+			pushed += queue.Push(1000 + (int)t, t * ms) ? 1 : 0;
+			stalled = queue.Stalled((t + 10) * ms);
+		}
+		stats = queue.Stats();
+		const int waiting = stats.pending + stats.expired;
+		queue.CountStall();
+		stats = queue.Stats();
+		printf("%-28s %12d %10d %s\n", "  stalled: queued / sent", waiting, pushed,
+			Check(stalled && waiting == pushed && pushed > CONSIMU_MAX_PENDING && stats.pending + stats.expired == 0 && stats.stalls == 1));
+		RunBench("ConsimuQueue legacy reply", count, [&](int i) {
+			queue.Push(i, 0);
+			queue.OnReply(line, ms);
+			g_Sink += queue.TakeReply(reply_count, collision, safe) ? safe.waistJoint[1] : 0;
+		});
+	}
+
+	printf("\n(checksum %g)\n", g_Sink);
+	return (g_OverBudget || g_CheckFailed) ? 1 : 0;
+}
@@ -0,0 +1,121 @@
+#include "ArmChain.h"
+
+#include "ReachMap.h"
+
+ArmChain::ArmChain(int strategy)
+	: m_AnalyticIk(m_Solver), m_DifferentialIk(m_DiffSolver), m_HybridIk(m_AnalyticIk, m_DifferentialIk),
+	m_pReachMap(NULL), m_LastArmAngle(0), m_bInit(false),
+	m_Status(rpp::kine::KINE_OK), m_bOutOfWorkspace(false), m_Distance(0)
+{
+	m_LastJoint.setZero();
+
+	m_pFirst = &m_AnalyticIk;
+	m_pStrategy = &Select(strategy);
+}
+
+ArmChain::strategy_type &ArmChain::Select(int strategy)
+{
+	if (strategy == 0)
+	{
+		return m_AnalyticIk;
+	}
+	else if (strategy == 1)
+	{
+		return m_DifferentialIk;
+	}
+	return m_HybridIk;
+}
+
+void ArmChain::Init(const solver_type &solver, const diff_solver_type &diff_solver, const ReachMap *reach_map)
+{
+	// 策略保存的是成员的地址，赋值后仍然有效
+	m_Solver = solver;
+	m_DiffSolver = diff_solver;
+	m_pReachMap = reach_map;
+	m_bInit = false;
+}
+
+void ArmChain::Reset(const vec7 &joint_angle, double arm_angle)
+{
+	m_LastJoint = joint_angle;
+	m_LastArmAngle = arm_angle;
+	m_bInit = false;
+}
+
+void ArmChain::Restart()
+{
+	m_bInit = false;
+}
+
+rpp::kine::KineStatus ArmChain::Solve(const mat4x4 &T)
+{
+	m_bOutOfWorkspace = false;
+
+	// 一定不可达的目标不求逆解
+	if (m_pReachMap != NULL && m_pReachMap->IsUnreachable(T))
+	{
+		m_Status = rpp::kine::KINE_NO_SELF_MOTION;
+		m_bOutOfWorkspace = true;
+		m_Distance = m_pReachMap->Distance(T);
+		return m_Status;
+	}
+
+	vec7 q;
+	m_Status = (m_bInit ? m_pStrategy : m_pFirst)->solve(T, m_LastArmAngle, m_LastJoint, q);
+	if (m_Status >= 0)
+	{
+		m_bInit = true;
+		return m_Status;
+	}
+
+	// 边界附近地图由随机采样生成，不能据此拒绝求解，只在无解时说明原因
+	if (m_pReachMap != NULL && m_pReachMap->IsHopeless(T))
+	{
+		m_bOutOfWorkspace = true;
+		m_Distance = m_pReachMap->Distance(T);
+	}
+	return m_Status;
+}
+
+const ArmChain::vec7 &ArmChain::Joints() const
+{
+	return m_LastJoint;
+}
+
+double ArmChain::ArmAngle() const
+{
+	return m_LastArmAngle;
+}
+
+rpp::kine::KineStatus ArmChain::Status() const
+{
+	return m_Status;
+}
+
+bool ArmChain::OutOfWorkspace() const
+{
+	return m_bOutOfWorkspace;
+}
+
+double ArmChain::Distance() const
+{
+	return m_Distance;
+}
+
+const ArmChain::strategy_type &ArmChain::Strategy() const
+{
+	return *m_pStrategy;
+}
+
+
+
+ArmChainTask::ArmChainTask(ArmChain &chain, const ArmChain::mat4x4 &T)
+	: m_Chain(chain), m_Target(T)
+{
+	setAutoDelete(true);
+}
+
+void ArmChainTask::run()
+{
+	m_Chain.Solve(m_Target);
+}
@@ -0,0 +1,79 @@
+#ifndef ARMCHAIN_H
+#define ARMCHAIN_H
+
+#include <QRunnable>
+
+#include "ik_strategy.hpp"
+
+class ReachMap;
+
+// 一条手臂的逆运动学链：各自的求解器、逆运动学策略和上一次的关节角、臂角。
+// 两条臂的链不共享状态，可以在不同线程中同时求解（见ArmChainTask）；
+// 目标位姿在该手臂自己的基坐标系中，关节限位由Init的求解器给出（左臂见ROBO_LJ*_MIN/MAX）
+class ArmChain
+{
+public:
+	typedef rpp::kine::KineSolver<double> solver_type;
+	typedef rpp::kine::DiffKineSolver<double> diff_solver_type;
+	typedef rpp::kine::IkStrategy<double> strategy_type;
+	typedef solver_type::mat4x4 mat4x4;
+	typedef solver_type::vec7 vec7;
+
+	// strategy与KineStrategy相同：0解析，1微分（首次解析求解），2解析为主、奇异附近及无解时微分
+	explicit ArmChain(int strategy);
+
+	// 复制求解器；reach_map为该手臂的可达性地图（与solver的参数相同），可以为NULL
+	void Init(const solver_type &solver, const diff_solver_type &diff_solver, const ReachMap *reach_map);
+	// 设置参考关节角和臂角，下一次先解析求解
+	void Reset(const vec7 &joint_angle, double arm_angle);
+	// 清除微分逆运动学的参考，下一次先解析求解
+	void Restart();
+
+	// 求解目标位姿T，成功时更新参考关节角，无解时保持上一次的值；不输出日志，可在工作线程中调用
+	rpp::kine::KineStatus Solve(const mat4x4 &T);
+
+	const vec7 &Joints() const;					// 上一次成功的关节角
+	double ArmAngle() const;
+	rpp::kine::KineStatus Status() const;		// 上一次Solve的结果
+	bool OutOfWorkspace() const;				// 上一次无解，且目标在可达性地图中明显不可达
+	double Distance() const;					// 上一次的目标到可达边界的距离(mm)，只在OutOfWorkspace时计算
+	const strategy_type &Strategy() const;		// 当前的策略，统计耗时和成功次数
+
+private:
+	ArmChain(const ArmChain &);
+	ArmChain &operator=(const ArmChain &);
+
+	strategy_type &Select(int strategy);		// 只在构造函数中使用，m_HybridIk之前的成员已构造
+
+	solver_type m_Solver;
+	diff_solver_type m_DiffSolver;
+	rpp::kine::AnalyticIk<double> m_AnalyticIk;
+	rpp::kine::DifferentialIk<double> m_DifferentialIk;
+	rpp::kine::HybridIk<double> m_HybridIk;
+	strategy_type *m_pFirst;		// 没有参考关节角时使用
+	strategy_type *m_pStrategy;
+
+	const ReachMap *m_pReachMap;
+	vec7 m_LastJoint;
+	double m_LastArmAngle;
+	bool m_bInit;
+	rpp::kine::KineStatus m_Status;
+	bool m_bOutOfWorkspace;
+	double m_Distance;
+};
+
+// 在线程池中求解一次，目标位姿在构造时复制
+class ArmChainTask : public QRunnable
+{
+public:
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+	ArmChainTask(ArmChain &chain, const ArmChain::mat4x4 &T);
+	void run();
+
+private:
+	ArmChain &m_Chain;
+	ArmChain::mat4x4 m_Target;
+};
+
+#endif
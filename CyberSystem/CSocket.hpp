@@ -244,6 +244,29 @@ namespace sockconn{
 				return false;
 			}
 		}
+
+		SOCKET GetSocket() const
+		{
+			return m_socket;
+		}
+
+		// Receive one datagram, called by LinkReactor when the socket is readable
+		// No message box here, it runs in the reactor thread
+		// Return the number of bytes received, -1 on error
+		int RecvFrom(char RecvBuf[], int RecvBuf_Len)
+		{
+			if (m_bInitStus == false)
+			{
+				return -1;
+			}
+			int iLen = sizeof(m_RecvAddr);
+			int recv_byte = recvfrom(m_socket, RecvBuf, RecvBuf_Len, 0, (SOCKADDR *)&m_RecvAddr, &iLen);
+			if (recv_byte == SOCKET_ERROR)
+			{
+				return -1;
+			}
+			return recv_byte;
+		}
 	};
 
 
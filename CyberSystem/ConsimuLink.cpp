@@ -0,0 +1,171 @@
+#include "ConsimuLink.h"
+#include <stdio.h>
+#include <string.h>
+#include <QMutexLocker>
+#include "stopwatch.hpp"
+
+ConsimuLink::ConsimuLink()
+{
+	m_bConnected = false;
+	m_bBroken = false;
+	m_IP[0] = '\0';
+	m_nPort = 0;
+	m_SendBuffer[0] = '\0';
+}
+
+ConsimuLink::~ConsimuLink()
+{
+	Disconnect();
+}
+
+int ConsimuLink::Connect(char *IP, UINT nPort)
+{
+	Disconnect();
+
+	strncpy(m_IP, IP, sizeof(m_IP) - 1);
+	m_IP[sizeof(m_IP) - 1] = '\0';
+	m_nPort = nPort;
+	int ret = m_Socket.ConnectServer(m_IP, m_nPort);
+	if (ret != 0)
+	{
+		return ret;
+	}
+
+	QMutexLocker locker(&m_Mutex);
+	m_Queue.Reset();
+	m_bBroken = false;
+	m_bConnected = true;
+	return 0;
+}
+
+void ConsimuLink::Disconnect()
+{
+	if (m_bConnected == false)
+	{
+		return;
+	}
+	m_bConnected = false;
+
+	shutdown(m_Socket.m_hSocket, SD_BOTH);
+	closesocket(m_Socket.m_hSocket);
+	m_Socket.m_hSocket = NULL;
+
+	QMutexLocker locker(&m_Mutex);
+	m_Queue.Drop();
+}
+
+// 在途指令的应答已无法与之后的指令区分，只能丢掉连接重新开始
+int ConsimuLink::Reconnect()
+{
+	Disconnect();
+
+	int ret = m_Socket.ConnectServer(m_IP, m_nPort);
+	QMutexLocker locker(&m_Mutex);
+	m_Queue.CountStall();
+	if (ret != 0)
+	{
+		return ret;
+	}
+	m_bBroken = false;
+	m_bConnected = true;
+	return 0;
+}
+
+bool ConsimuLink::IsConnected() const
+{
+	return m_bConnected;
+}
+
+bool ConsimuLink::IsStalled() const
+{
+	QMutexLocker locker(&m_Mutex);
+	return m_bConnected && (m_bBroken || m_Queue.Stalled(rpp::util::Stopwatch::now()));
+}
+
+bool ConsimuLink::Send(int count, const CRobonautData &cmd)
+{
+	if (m_bConnected == false)
+	{
+		return false;
+	}
+
+	{
+		// 先登记再发送，应答不会早于登记
+		QMutexLocker locker(&m_Mutex);
+		if (m_Queue.Push(count, rpp::util::Stopwatch::now()) == false)
+		{
+			return false;
+		}
+	}
+
+	int len = sprintf(m_SendBuffer, "%d,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f\n",count,
+		cmd.leftArmJoint[0],cmd.leftArmJoint[1],cmd.leftArmJoint[2],cmd.leftArmJoint[3],
+		cmd.leftArmJoint[4],cmd.leftArmJoint[5],cmd.leftArmJoint[6],cmd.rightArmJoint[0],
+		cmd.rightArmJoint[1],cmd.rightArmJoint[2],cmd.rightArmJoint[3],cmd.rightArmJoint[4],
+		cmd.rightArmJoint[5],cmd.rightArmJoint[6],cmd.headJoint[0],cmd.headJoint[1],
+		cmd.headJoint[2],cmd.waistJoint[0],cmd.waistJoint[1]);
+
+	// 指令为'\n'结尾的文本行，不加长度头
+	int ret = m_Socket.SendBytes(m_SendBuffer, len);
+
+	QMutexLocker locker(&m_Mutex);
+	if (ret != 0)
+	{
+		// 没有发出，去掉刚登记的指令
+		m_Queue.Unpush();
+		return false;
+	}
+	m_Queue.Sent();
+	return true;
+}
+
+bool ConsimuLink::TakeReply(int &count, int &collision, CRobonautData &safe)
+{
+	QMutexLocker locker(&m_Mutex);
+	return m_Queue.TakeReply(count, collision, safe);
+}
+
+ConsimuStats ConsimuLink::GetStats() const
+{
+	QMutexLocker locker(&m_Mutex);
+	return m_Queue.Stats();
+}
+
+SOCKET ConsimuLink::Socket() const
+{
+	return m_Socket.m_hSocket;
+}
+
+// 应答为'\n'结尾的文本行，由接收缓冲分帧，行前的'\0'填充已跳过。
+// 一次收到的几个应答按同一个接收时刻计算时延
+bool ConsimuLink::OnReadable()
+{
+	if (m_Socket.ReceiveAvailable() != 0)
+	{
+		// 连接断开
+		QMutexLocker locker(&m_Mutex);
+		m_bBroken = true;
+		return false;
+	}
+	const long long now = rpp::util::Stopwatch::now();
+
+	const char *line = NULL;
+	int len = 0;
+	StreamFramer::Result result;
+	while ((result = m_Socket.Framer().NextLine(line, len)) == StreamFramer::Complete)
+	{
+		if (len > 0)
+		{
+			QMutexLocker locker(&m_Mutex);
+			m_Queue.OnReply(line, now);
+		}
+	}
+	if (result == StreamFramer::Invalid)
+	{
+		// 行超过缓冲容量，数据流已无法分帧，不再接收，由所有者重新连接
+		QMutexLocker locker(&m_Mutex);
+		m_bBroken = true;
+		return false;
+	}
+	return true;
+}
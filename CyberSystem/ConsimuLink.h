@@ -0,0 +1,49 @@
+#ifndef CONSIMULINK_H
+#define CONSIMULINK_H
+
+#include <QMutex>
+#include "LinkReactor.h"
+#include "SocketBlockClient.h"
+#include "ConsimuQueue.h"
+
+// 与预测仿真的异步连接。Send发送指令后立即返回，应答由LinkReactor接收，由ConsimuQueue与在途指令对应，
+// 应答格式和超时策略见ConsimuQueue。控制周期用TakeReply取最新的应答。
+// 连接后由所有者加入LinkReactor，Disconnect及Reconnect之前先从中Remove。
+class ConsimuLink : public ReactorLink
+{
+public:
+	ConsimuLink();
+	~ConsimuLink();
+
+	int Connect(char *IP, UINT nPort);		// 成功返回0
+	void Disconnect();						// 关闭连接，统计保留到下次连接
+	bool IsConnected() const;
+	// 仿真停止应答超过CONSIMU_STALL_MS，或反应器已因连接断开、数据流错位不再接收。所有者应Remove后Reconnect
+	bool IsStalled() const;
+	int Reconnect();						// 按上次Connect的地址重新连接，统计保留；成功返回0
+
+	// 发送第count条指令（计数、左臂、右臂、头部、腰部关节角），不等待应答。未连接、在途指令已满或发送失败时返回false
+	bool Send(int count, const CRobonautData &cmd);
+	// 自上次调用后有新的应答时返回true，输出其对应的指令计数、碰撞标志及安全关节角（只写关节角）
+	bool TakeReply(int &count, int &collision, CRobonautData &safe);
+	ConsimuStats GetStats() const;
+
+	SOCKET Socket() const;
+	bool OnReadable();		// 在反应器线程中接收应答
+
+private:
+	ConsimuLink(const ConsimuLink &);
+	ConsimuLink &operator=(const ConsimuLink &);
+
+	CSocketBlockClient m_Socket;
+	bool m_bConnected;
+	char m_IP[64];
+	UINT m_nPort;
+	char m_SendBuffer[ORDER_BUF_LEN];
+
+	mutable QMutex m_Mutex;		// 保护以下成员，反应器线程与控制周期共用
+	bool m_bBroken;				// OnReadable返回了false
+	ConsimuQueue m_Queue;
+};
+
+#endif
@@ -0,0 +1,223 @@
+#include "ConsimuQueue.h"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+ConsimuQueue::ConsimuQueue()
+{
+	Reset();
+}
+
+void ConsimuQueue::Reset()
+{
+	m_Head = 0;
+	m_Size = 0;
+	m_Expired = 0;
+	m_bNewReply = false;
+	m_ReplyCount = 0;
+	m_ReplyCollision = 0;
+	for (int i = 0; i < 19; ++i)
+	{
+		m_ReplyJoint[i] = 0;
+	}
+	memset(&m_Stats, 0, sizeof(m_Stats));
+	m_RttTotal = 0;
+}
+
+void ConsimuQueue::Drop()
+{
+	m_Head = 0;
+	m_Size = 0;
+	m_Expired = 0;
+	m_Stats.pending = 0;
+	m_Stats.expired = 0;
+}
+
+void ConsimuQueue::CountStall()
+{
+	++m_Stats.stalls;
+	Drop();
+}
+
+ConsimuQueue::Pending &ConsimuQueue::At(int k)
+{
+	return m_Pending[(m_Head + k) % CONSIMU_QUEUE_LEN];
+}
+
+void ConsimuQueue::Pop(int n)
+{
+	m_Head = (m_Head + n) % CONSIMU_QUEUE_LEN;
+	m_Size -= n;
+	m_Expired = std::max(m_Expired - n, 0);
+	m_Stats.pending = m_Size - m_Expired;
+	m_Stats.expired = m_Expired;
+}
+
+bool ConsimuQueue::Push(int count, long long now)
+{
+	// 超时的指令不再占用在途的名额，仿真变慢时仍能继续发送
+	while (m_Expired < m_Size && now - At(m_Expired).sendNs > CONSIMU_TIMEOUT_MS * 1000000LL)
+	{
+		++m_Expired;
+		++m_Stats.timeouts;
+	}
+	m_Stats.pending = m_Size - m_Expired;
+	m_Stats.expired = m_Expired;
+	if (m_Size - m_Expired >= CONSIMU_MAX_PENDING || m_Size == CONSIMU_QUEUE_LEN)
+	{
+		++m_Stats.skipped;
+		return false;
+	}
+	Pending &p = At(m_Size);
+	p.count = count;
+	p.sendNs = now;
+	++m_Size;
+	m_Stats.pending = m_Size - m_Expired;
+	return true;
+}
+
+void ConsimuQueue::Unpush()
+{
+	if (m_Size > m_Expired)
+	{
+		--m_Size;
+		m_Stats.pending = m_Size - m_Expired;
+	}
+}
+
+void ConsimuQueue::Sent()
+{
+	++m_Stats.sent;
+}
+
+bool ConsimuQueue::Stalled(long long now) const
+{
+	return m_Size > 0 && now - m_Pending[m_Head].sendNs > CONSIMU_STALL_MS * 1000000LL;
+}
+
+void ConsimuQueue::OnReply(const char *line, long long now)
+{
+	// 按逗号数区分两种格式
+	int commas = 0;
+	for (const char *c = line; *c != '\0'; ++c)
+	{
+		commas += (*c == ',') ? 1 : 0;
+	}
+	const bool echoed = (commas == 20);
+	int count = 0;
+	int collision = 0;
+	float joint[19];
+	bool ok = false;
+	if (echoed)
+	{
+		ok = sscanf(line, "%d,%d,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f", &count, &collision,
+			&joint[0], &joint[1], &joint[2], &joint[3], &joint[4], &joint[5], &joint[6],
+			&joint[7], &joint[8], &joint[9], &joint[10], &joint[11], &joint[12], &joint[13],
+			&joint[14], &joint[15], &joint[16], &joint[17], &joint[18]) == 21;
+	}
+	else if (commas == 19)
+	{
+		ok = sscanf(line, "%d,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f", &collision,
+			&joint[0], &joint[1], &joint[2], &joint[3], &joint[4], &joint[5], &joint[6],
+			&joint[7], &joint[8], &joint[9], &joint[10], &joint[11], &joint[12], &joint[13],
+			&joint[14], &joint[15], &joint[16], &joint[17], &joint[18]) == 20;
+	}
+	if (ok == false)
+	{
+		++m_Stats.bad;
+		return;
+	}
+	++m_Stats.replies;
+
+	// 队列为空或找不到回传的计数时，是重新连接前的指令的应答
+	int k = 0;
+	if (echoed)
+	{
+		while (k < m_Size && At(k).count != count)
+		{
+			++k;
+		}
+	}
+	if (k >= m_Size)
+	{
+		return;
+	}
+	// 回传计数时，跳过的更早的指令不会再有应答，其中未标记的计入超时
+	m_Stats.timeouts += std::max(k - m_Expired, 0);
+	const bool expired = k < m_Expired;
+	const Pending p = At(k);
+	Pop(k + 1);
+
+	const double ms = (now - p.sendNs) * 1e-6;
+	m_Stats.lastMs = ms;
+	m_Rtt[m_RttTotal % CONSIMU_RTT_SAMPLES] = (float)ms;
+	++m_RttTotal;
+
+	if (expired)
+	{
+		// 已在Push中计入超时
+		return;
+	}
+	if (ms > CONSIMU_TIMEOUT_MS)
+	{
+		// 在下一次Push标记之前超时到达，对应的是过时的指令
+		++m_Stats.timeouts;
+		return;
+	}
+	m_bNewReply = true;
+	m_ReplyCount = p.count;
+	m_ReplyCollision = collision;
+	for (int i = 0; i < 19; ++i)
+	{
+		m_ReplyJoint[i] = joint[i];
+	}
+}
+
+bool ConsimuQueue::TakeReply(int &count, int &collision, CRobonautData &safe)
+{
+	if (m_bNewReply == false)
+	{
+		return false;
+	}
+	m_bNewReply = false;
+
+	count = m_ReplyCount;
+	collision = m_ReplyCollision;
+	for (int i = 0; i < 7; ++i)
+	{
+		safe.leftArmJoint[i] = m_ReplyJoint[i];
+		safe.rightArmJoint[i] = m_ReplyJoint[7 + i];
+	}
+	for (int i = 0; i < 3; ++i)
+	{
+		safe.headJoint[i] = m_ReplyJoint[14 + i];
+	}
+	for (int i = 0; i < 2; ++i)
+	{
+		safe.waistJoint[i] = m_ReplyJoint[17 + i];
+	}
+	return true;
+}
+
+ConsimuStats ConsimuQueue::Stats() const
+{
+	ConsimuStats stats = m_Stats;
+
+	const int n = std::min(m_RttTotal, CONSIMU_RTT_SAMPLES);
+	if (n > 0)
+	{
+		float rtt[CONSIMU_RTT_SAMPLES];
+		double sum = 0;
+		for (int i = 0; i < n; ++i)
+		{
+			rtt[i] = m_Rtt[i];
+			sum += rtt[i];
+		}
+		std::sort(rtt, rtt + n);
+		stats.meanMs = sum / n;
+		stats.p50Ms = rtt[n / 2];
+		stats.p99Ms = rtt[(n * 99) / 100];
+		stats.maxMs = rtt[n - 1];
+	}
+	return stats;
+}
@@ -0,0 +1,81 @@
+#ifndef CONSIMUQUEUE_H
+#define CONSIMUQUEUE_H
+
+#include "SocketDefine.h"
+#include "RobonautData.h"
+
+// 应答时延的统计样本数，统计最近的应答
+#define CONSIMU_RTT_SAMPLES 1024
+
+struct ConsimuStats
+{
+	int sent;			// 发送的指令数
+	int replies;		// 收到的应答数
+	int timeouts;		// 超过CONSIMU_TIMEOUT_MS未应答的指令，其应答到达时丢弃
+	int skipped;		// 在途指令已满而未发送的周期
+	int bad;			// 格式错误的应答
+	int stalls;			// 仿真停止应答超过CONSIMU_STALL_MS而重新连接的次数
+	int pending;		// 当前在途、未超时的指令数
+	int expired;		// 当前已超时、仍在等待应答的指令数
+	double lastMs;		// 最近一次应答的往返时延
+	double meanMs;		// 以下为最近CONSIMU_RTT_SAMPLES个应答的统计
+	double p50Ms;
+	double p99Ms;
+	double maxMs;
+};
+
+// 预测仿真的指令与应答的对应，不涉及套接字，也不加锁，由ConsimuLink加锁使用。
+// 仿真对每条指令按顺序应答一次，应答有两种格式：
+// 1. "碰撞标志,19个安全关节角"（20项）：现有仿真的格式，按顺序对应最早的在途指令；
+// 2. "计数,碰撞标志,19个安全关节角"（21项）：回传指令计数，对应该计数的指令，更早的指令不会再有应答。
+// 超时的指令只做标记、计入超时，仍留在队列中等待其应答，之后的应答因此不会错位；
+// 它的应答到达时出队丢弃。仿真停止应答时最早的指令越来越旧，超过CONSIMU_STALL_MS后Stalled返回true，
+// 由所有者重新连接并Drop，清空队列。
+class ConsimuQueue
+{
+public:
+	ConsimuQueue();
+
+	void Reset();			// 清空队列和统计
+	void Drop();			// 清空队列（重新连接后旧指令不会再有应答），统计保留
+	void CountStall();		// 仿真停止应答而重新连接，计入stalls并Drop
+
+	// 登记第count条指令。先把发出超过CONSIMU_TIMEOUT_MS的指令标记为超时；
+	// 未超时的指令已有CONSIMU_MAX_PENDING条或队列已满时不登记，计入skipped并返回false
+	bool Push(int count, long long now);
+	void Unpush();			// 撤销最近一次Push（指令没有发出）
+	void Sent();			// 指令已发出
+
+	void OnReply(const char *line, long long now);
+	bool Stalled(long long now) const;
+
+	// 自上次调用后有新的应答时返回true，输出其对应的指令计数、碰撞标志及安全关节角（只写关节角）
+	bool TakeReply(int &count, int &collision, CRobonautData &safe);
+	ConsimuStats Stats() const;
+
+private:
+	struct Pending
+	{
+		int count;
+		long long sendNs;
+	};
+
+	Pending &At(int k);				// 队首之后第k条
+	void Pop(int n);				// 出队n条
+
+	Pending m_Pending[CONSIMU_QUEUE_LEN];		// 环形队列，按发送顺序
+	int m_Head;
+	int m_Size;
+	int m_Expired;			// 队首起已超时的指令数，超时的指令总在队列前部
+
+	bool m_bNewReply;
+	int m_ReplyCount;
+	int m_ReplyCollision;
+	float m_ReplyJoint[19];		// 左臂7、右臂7、头部3、腰部2
+
+	ConsimuStats m_Stats;
+	float m_Rtt[CONSIMU_RTT_SAMPLES];		// 最近应答的往返时延(ms)，环形
+	int m_RttTotal;
+};
+
+#endif
@@ -0,0 +1,113 @@
+#include "DeviceLinks.h"
+#include <string.h>
+#include "RoboCodec.h"
+
+RoboSenseLink::RoboSenseLink(sockconn::CUdpServer &server)
+	: m_Server(server)
+{
+	m_Sense.decideFlag = 0;
+}
+
+SOCKET RoboSenseLink::Socket() const
+{
+	return m_Server.GetSocket();
+}
+
+bool RoboSenseLink::OnReadable()
+{
+	char buffer[ORDER_BUF_LEN];
+	int len = m_Server.RecvFrom(buffer, sizeof(buffer));
+	if (len >= RoboCodec::SensorSize)
+	{
+		RoboCodec::DecodeSensor(buffer, m_Sense.data, m_Sense.decideFlag);
+		m_Latest.Put(m_Sense);
+	}
+	// UDP的接收错误（如对方端口不可达）不影响之后的数据报，继续监视
+	return true;
+}
+
+Mailbox<RoboSense> &RoboSenseLink::Latest()
+{
+	return m_Latest;
+}
+
+HandSenseLink::HandSenseLink(CSocketBlockClient &socket, HandCodec &codec)
+	: m_Socket(socket)
+	, m_Codec(codec)
+{
+	memset(&m_Sense, 0, sizeof(m_Sense));
+}
+
+SOCKET HandSenseLink::Socket() const
+{
+	return m_Socket.m_hSocket;
+}
+
+bool HandSenseLink::OnReadable()
+{
+	if (m_Socket.ReceiveAvailable() != 0)
+	{
+		return false;
+	}
+
+	// 帧在接收缓冲中直接解码，文本包其后有'\0'
+	bool decoded = false;
+	const char *frame = NULL;
+	int len = 0;
+	StreamFramer::Result result;
+	while ((result = m_Socket.Framer().NextFrame(frame, len)) == StreamFramer::Complete)
+	{
+		if (m_Codec.DecodeSensor(frame, len, m_Sense.right, m_Sense.left, m_Sense.state))
+		{
+			decoded = true;
+		}
+	}
+	if (decoded)
+	{
+		m_Latest.Put(m_Sense);
+	}
+	// 数据流错位后找不到下一帧的边界，与连接断开同样处理，由所有者重新连接
+	return result != StreamFramer::Invalid;
+}
+
+Mailbox<HandSense> &HandSenseLink::Latest()
+{
+	return m_Latest;
+}
+
+VisionLink::VisionLink(CSocketBlockClient &socket)
+	: m_Socket(socket)
+{
+}
+
+SOCKET VisionLink::Socket() const
+{
+	return m_Socket.m_hSocket;
+}
+
+bool VisionLink::OnReadable()
+{
+	if (m_Socket.ReceiveAvailable() != 0)
+	{
+		return false;
+	}
+
+	VisionSense sense;
+	bool received = false;
+	const char *record = NULL;
+	while (m_Socket.Framer().NextFixed(VISION_DATA_LEN, record) == StreamFramer::Complete)
+	{
+		memcpy(sense.data, record, sizeof(sense.data));
+		received = true;
+	}
+	if (received)
+	{
+		m_Latest.Put(sense);
+	}
+	return true;
+}
+
+Mailbox<VisionSense> &VisionLink::Latest()
+{
+	return m_Latest;
+}
@@ -0,0 +1,89 @@
+#ifndef DEVICELINKS_H
+#define DEVICELINKS_H
+
+#include "LinkReactor.h"
+#include "SocketBlockClient.h"
+#include "CSocket.hpp"
+#include "RobonautData.h"
+#include "HandCodec.h"
+
+// 机器人宇航员传感器包解码后的最新值
+struct RoboSense
+{
+	CRobonautData data;		// 只写传感器包中的字段
+	int decideFlag;			// 力判断标志
+};
+
+// 灵巧手传感器包解码后的最新值
+struct HandSense
+{
+	CHandData right;
+	CHandData left;
+	HandSenseState state;
+};
+
+// 视觉的最新位姿，与RecvViData的输出相同
+struct VisionSense
+{
+	double data[7];
+};
+
+// 机器人宇航员的UDP传感器包，一个数据报一个包，不足RoboCodec::SensorSize字节的丢弃
+class RoboSenseLink : public ReactorLink
+{
+public:
+	explicit RoboSenseLink(sockconn::CUdpServer &server);
+
+	SOCKET Socket() const;
+	bool OnReadable();
+	Mailbox<RoboSense> &Latest();
+
+private:
+	RoboSenseLink(const RoboSenseLink &);
+	RoboSenseLink &operator=(const RoboSenseLink &);
+
+	sockconn::CUdpServer &m_Server;
+	RoboSense m_Sense;
+	Mailbox<RoboSense> m_Latest;
+};
+
+// 灵巧手传感器连接，长度头分帧。每个包都经过codec解码，因此格式协商与原来相同；
+// 协商结果在反应器线程中写入，由发送命令的定时器读取，只是一个枚举值，格式最多晚一个周期改变
+class HandSenseLink : public ReactorLink
+{
+public:
+	HandSenseLink(CSocketBlockClient &socket, HandCodec &codec);
+
+	SOCKET Socket() const;
+	bool OnReadable();
+	Mailbox<HandSense> &Latest();
+
+private:
+	HandSenseLink(const HandSenseLink &);
+	HandSenseLink &operator=(const HandSenseLink &);
+
+	CSocketBlockClient &m_Socket;
+	HandCodec &m_Codec;
+	HandSense m_Sense;		// 解码失败的包不修改
+	Mailbox<HandSense> m_Latest;
+};
+
+// 视觉连接，VISION_DATA_LEN字节的定长记录，一次收到多个时只保留最后一个
+class VisionLink : public ReactorLink
+{
+public:
+	explicit VisionLink(CSocketBlockClient &socket);
+
+	SOCKET Socket() const;
+	bool OnReadable();
+	Mailbox<VisionSense> &Latest();
+
+private:
+	VisionLink(const VisionLink &);
+	VisionLink &operator=(const VisionLink &);
+
+	CSocketBlockClient &m_Socket;
+	Mailbox<VisionSense> m_Latest;
+};
+
+#endif
@@ -0,0 +1,386 @@
+#include "HandCodec.h"
+#include "SocketDefine.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+#define snprintf _snprintf
+#endif
+
+#define HAND_PACKET_COMMAND 1
+#define HAND_PACKET_SENSOR 2
+
+// 二进制包的布局，按1字节对齐
+#pragma pack(push, 1)
+struct HandPacketHeader
+{
+	unsigned int magic;			// HAND_BINARY_MAGIC
+	unsigned short version;		// HAND_PROTOCOL_VERSION
+	unsigned short type;		// HAND_PACKET_COMMAND/HAND_PACKET_SENSOR
+	int count;					// 包序号
+	unsigned int length;		// 数据长度，不含头和CRC
+};
+
+struct HandCmdHand
+{
+	float joint[5][3];
+	float velocity[5][3];
+	int controller;
+	int stiffness;
+	int thumb;
+	int thumbAngle;
+	int runFlag;
+};
+
+struct HandCmdPayload
+{
+	HandCmdHand hand[2];		// 0右手，1左手
+	int init;
+	int enable;
+	int stop;
+	int impedanceIndex;
+};
+
+struct HandSensePayload
+{
+	float joint[2][5][3];		// 0右手，1左手
+	float torque[2][5][3];
+	int runFlag;
+	int rightFlag;
+	int leftFlag;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(HandPacketHeader) == 16, "hand packet header must be 16 bytes");
+static_assert(sizeof(HandCmdPayload) == 296, "hand command layout changed");
+static_assert(sizeof(HandSensePayload) == 252, "hand sensor layout changed");
+
+// CRC32（多项式0xEDB88320）查找表，程序启动时生成
+static unsigned int s_CrcTable[256];
+static bool InitCrcTable()
+{
+	for (unsigned int i = 0; i < 256; ++i)
+	{
+		unsigned int c = i;
+		for (int k = 0; k < 8; ++k)
+		{
+			c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+		}
+		s_CrcTable[i] = c;
+	}
+	return true;
+}
+static const bool s_bCrcTableInit = InitCrcTable();
+
+// 写头、数据和CRC，返回总字节数
+static int WritePacket(unsigned short type, int count, const void *payload, unsigned int length, char buffer[], int size)
+{
+	const int total = (int)(sizeof(HandPacketHeader) + length + sizeof(unsigned int));
+	if (size < total)
+	{
+		return -1;
+	}
+	HandPacketHeader head;
+	head.magic = HAND_BINARY_MAGIC;
+	head.version = HAND_PROTOCOL_VERSION;
+	head.type = type;
+	head.count = count;
+	head.length = length;
+	memcpy(buffer, &head, sizeof(head));
+	memcpy(buffer + sizeof(head), payload, length);
+	const unsigned int crc = HandCodec::Crc32(buffer, (int)(sizeof(head) + length));
+	memcpy(buffer + sizeof(head) + length, &crc, sizeof(crc));
+	return total;
+}
+
+// 检查头、长度和CRC后取出数据
+static bool ReadPacket(const char buffer[], int length, unsigned short type, int &count, void *payload,
+	unsigned int payloadLength)
+{
+	const int total = (int)(sizeof(HandPacketHeader) + payloadLength + sizeof(unsigned int));
+	if (length < total)
+	{
+		return false;
+	}
+	HandPacketHeader head;
+	memcpy(&head, buffer, sizeof(head));
+	if (head.magic != HAND_BINARY_MAGIC || head.version != HAND_PROTOCOL_VERSION ||
+		head.type != type || head.length != payloadLength)
+	{
+		return false;
+	}
+	unsigned int crc;
+	memcpy(&crc, buffer + sizeof(head) + payloadLength, sizeof(crc));
+	if (crc != HandCodec::Crc32(buffer, (int)(sizeof(head) + payloadLength)))
+	{
+		return false;
+	}
+	count = head.count;
+	memcpy(payload, buffer + sizeof(head), payloadLength);
+	return true;
+}
+
+HandCodec::HandCodec()
+	: m_bBinaryEnabled(true)
+	, m_SendFormat(Text)
+{
+}
+
+void HandCodec::SetBinaryEnabled(bool enabled)
+{
+	m_bBinaryEnabled = enabled;
+	if (!enabled)
+	{
+		m_SendFormat = Text;
+	}
+}
+
+HandCodec::Format HandCodec::SendFormat() const
+{
+	return m_SendFormat;
+}
+
+int HandCodec::EncodeCommand(int count, const CHandData &right, const CHandData &left, const HandCmdState &state,
+	char buffer[], int size) const
+{
+	if (m_SendFormat == Binary)
+	{
+		return EncodeBinaryCommand(count, right, left, state, buffer, size);
+	}
+	return EncodeTextCommand(count, right, left, state, buffer, size);
+}
+
+bool HandCodec::DecodeSensor(const char buffer[], int length, CHandData &right, CHandData &left, HandSenseState &state)
+{
+	CHandData r = right, l = left;
+	HandSenseState s;
+	if (IsBinary(buffer, length))
+	{
+		// 版本不一致或校验错误的包丢弃，并退回文本发送
+		if (!DecodeBinarySensor(buffer, length, r, l, s))
+		{
+			m_SendFormat = Text;
+			return false;
+		}
+		if (m_bBinaryEnabled)
+		{
+			m_SendFormat = Binary;
+		}
+	}
+	else
+	{
+		if (!DecodeTextSensor(buffer, r, l, s))
+		{
+			return false;
+		}
+		m_SendFormat = Text;
+	}
+	right = r;
+	left = l;
+	state = s;
+	return true;
+}
+
+int HandCodec::EncodeTextCommand(int count, const CHandData &right, const CHandData &left, const HandCmdState &state,
+	char buffer[], int size)
+{
+	const float Vel = state.velocity;
+	int ret = snprintf(buffer, size, "PackageID:  %d\r\nPackageHead: %x %d\r\nfloat %f, %f, %f, %f, %f, %f\r\nfloat %f, %f, %f, %f, %f, %f\r\nfloat %f, %f, %f, %f, %f, %f\r\nfloat %f, %f, %f, %f, %f, %f\r\nfloat %f, %f, %f, %f, %f, %f\r\nint   %x, %d, %x, %d, %x, 0, 0, 0, 0\r\nfloat %f, %f, %f, %f, %f, %f\r\nfloat %f, %f, %f, %f, %f, %f\r\nfloat %f, %f, %f, %f, %f, %f\r\nfloat %f, %f, %f, %f, %f, %f\r\nfloat %f, %f, %f, %f, %f, %f\r\nint   %x, %d, %x, %d, %x, %d, %d, %d, %d\r\nPackageEnd: %x\r\n",
+		count,
+		PackageHead,0,
+		right.joint[0][0], right.joint[0][1], right.joint[0][2], Vel, Vel, Vel,
+		right.joint[1][0], right.joint[1][1], right.joint[1][2], Vel, Vel, Vel,
+		right.joint[2][0], right.joint[2][1], right.joint[2][2], Vel, Vel, Vel,
+		right.joint[3][0], right.joint[3][1], right.joint[3][2], Vel, Vel, Vel,
+		right.joint[4][0], right.joint[4][1], right.joint[4][2], Vel, Vel, Vel,
+		state.controller,state.stiffness,state.thumb,state.thumbAngle,state.runFlag,
+		left.joint[0][0], left.joint[0][1], left.joint[0][2], Vel, Vel, Vel,
+		left.joint[1][0], left.joint[1][1], left.joint[1][2], Vel, Vel, Vel,
+		left.joint[2][0], left.joint[2][1], left.joint[2][2], Vel, Vel, Vel,
+		left.joint[3][0], left.joint[3][1], left.joint[3][2], Vel, Vel, Vel,
+		left.joint[4][0], left.joint[4][1], left.joint[4][2], Vel, Vel, Vel,
+		state.controller,state.stiffness,state.thumb,state.thumbAngle,state.runFlag,
+		state.init,state.enable,state.stop,state.impedanceIndex,
+		PackageEnd);
+	// 截断时_snprintf返回-1，C99的snprintf返回所需长度
+	if (ret < 0 || ret >= size)
+	{
+		return -1;
+	}
+	return ret;
+}
+
+int HandCodec::EncodeBinaryCommand(int count, const CHandData &right, const CHandData &left, const HandCmdState &state,
+	char buffer[], int size)
+{
+	HandCmdPayload payload;
+	const CHandData *hands[2] = {&right, &left};
+	for (int h = 0; h < 2; ++h)
+	{
+		HandCmdHand &hand = payload.hand[h];
+		for (int i = 0; i < 5; ++i)
+		{
+			for (int j = 0; j < 3; ++j)
+			{
+				hand.joint[i][j] = hands[h]->joint[i][j];
+				hand.velocity[i][j] = state.velocity;
+			}
+		}
+		hand.controller = state.controller;
+		hand.stiffness = state.stiffness;
+		hand.thumb = state.thumb;
+		hand.thumbAngle = state.thumbAngle;
+		hand.runFlag = state.runFlag;
+	}
+	payload.init = state.init;
+	payload.enable = state.enable;
+	payload.stop = state.stop;
+	payload.impedanceIndex = state.impedanceIndex;
+	return WritePacket(HAND_PACKET_COMMAND, count, &payload, sizeof(payload), buffer, size);
+}
+
+bool HandCodec::DecodeBinaryCommand(const char buffer[], int length, int &count, CHandData &right, CHandData &left,
+	HandCmdState &state)
+{
+	HandCmdPayload payload;
+	if (!ReadPacket(buffer, length, HAND_PACKET_COMMAND, count, &payload, sizeof(payload)))
+	{
+		return false;
+	}
+	CHandData *hands[2] = {&right, &left};
+	for (int h = 0; h < 2; ++h)
+	{
+		memcpy(hands[h]->joint, payload.hand[h].joint, sizeof(payload.hand[h].joint));
+	}
+	const HandCmdHand &hand = payload.hand[0];
+	state.velocity = hand.velocity[0][0];
+	state.controller = hand.controller;
+	state.stiffness = hand.stiffness;
+	state.thumb = hand.thumb;
+	state.thumbAngle = hand.thumbAngle;
+	state.runFlag = hand.runFlag;
+	state.init = payload.init;
+	state.enable = payload.enable;
+	state.stop = payload.stop;
+	state.impedanceIndex = payload.impedanceIndex;
+	return true;
+}
+
+int HandCodec::EncodeTextSensor(const CHandData &right, const CHandData &left, const HandSenseState &state,
+	char buffer[], int size)
+{
+	int n = snprintf(buffer, size, "Package-ID: %d\r\n", right.count);
+	const CHandData *hands[2] = {&right, &left};
+	for (int h = 0; h < 2 && n >= 0 && n < size; ++h)
+	{
+		for (int i = 0; i < 5 && n >= 0 && n < size; ++i)
+		{
+			const float *a = hands[h]->joint[i];
+			const float *t = hands[h]->torque[i];
+			int ret = snprintf(buffer + n, size - n, "F%d:[Angle] %f, %f, %f\r\n  [Torque] %f, %f, %f\r\n",
+				i + 1, a[0], a[1], a[2], t[0], t[1], t[2]);
+			n = (ret < 0) ? -1 : n + ret;
+		}
+	}
+	if (n >= 0 && n < size)
+	{
+		int ret = snprintf(buffer + n, size - n, "   [State] %x, %d, %d\r\n", state.runFlag, state.rightFlag, state.leftFlag);
+		n = (ret < 0) ? -1 : n + ret;
+	}
+	if (n < 0 || n >= size)
+	{
+		return -1;
+	}
+	return n;
+}
+
+int HandCodec::EncodeBinarySensor(const CHandData &right, const CHandData &left, const HandSenseState &state,
+	char buffer[], int size)
+{
+	HandSensePayload payload;
+	memcpy(payload.joint[0], right.joint, sizeof(right.joint));
+	memcpy(payload.joint[1], left.joint, sizeof(left.joint));
+	memcpy(payload.torque[0], right.torque, sizeof(right.torque));
+	memcpy(payload.torque[1], left.torque, sizeof(left.torque));
+	payload.runFlag = state.runFlag;
+	payload.rightFlag = state.rightFlag;
+	payload.leftFlag = state.leftFlag;
+	return WritePacket(HAND_PACKET_SENSOR, right.count, &payload, sizeof(payload), buffer, size);
+}
+
+bool HandCodec::DecodeTextSensor(const char buffer[], CHandData &right, CHandData &left, HandSenseState &state)
+{
+	int ret = sscanf(buffer,"Package-ID: %d\r\nF1:[Angle] %f, %f, %f\r\n  [Torque] %f, %f, %f\r\nF2:[Angle] %f, %f, %f\r\n  [Torque] %f, %f, %f\r\nF3:[Angle] %f, %f, %f\r\n  [Torque] %f, %f, %f\r\nF4:[Angle] %f, %f, %f\r\n  [Torque] %f, %f, %f\r\nF5:[Angle] %f, %f, %f\r\n  [Torque] %f, %f, %f\r\nF1:[Angle] %f, %f, %f\r\n  [Torque] %f, %f, %f\r\nF2:[Angle] %f, %f, %f\r\n  [Torque] %f, %f, %f\r\nF3:[Angle] %f, %f, %f\r\n  [Torque] %f, %f, %f\r\nF4:[Angle] %f, %f, %f\r\n  [Torque] %f, %f, %f\r\nF5:[Angle] %f, %f, %f\r\n  [Torque] %f, %f, %f\r\n   [State] %x, %d, %d\r\n",
+
+		&(right.count),
+
+		&(right.joint[0][0]),&(right.joint[0][1]),&(right.joint[0][2]),
+		&(right.torque[0][0]),&(right.torque[0][1]),&(right.torque[0][2]),
+		&(right.joint[1][0]),&(right.joint[1][1]),&(right.joint[1][2]),
+		&(right.torque[1][0]),&(right.torque[1][1]),&(right.torque[1][2]),
+		&(right.joint[2][0]),&(right.joint[2][1]),&(right.joint[2][2]),
+		&(right.torque[2][0]),&(right.torque[2][1]),&(right.torque[2][2]),
+		&(right.joint[3][0]),&(right.joint[3][1]),&(right.joint[3][2]),
+		&(right.torque[3][0]),&(right.torque[3][1]),&(right.torque[3][2]),
+		&(right.joint[4][0]),&(right.joint[4][1]),&(right.joint[4][2]),
+		&(right.torque[4][0]),&(right.torque[4][1]),&(right.torque[4][2]),
+
+		&(left.joint[0][0]),&(left.joint[0][1]),&(left.joint[0][2]),
+		&(left.torque[0][0]),&(left.torque[0][1]),&(left.torque[0][2]),
+		&(left.joint[1][0]),&(left.joint[1][1]),&(left.joint[1][2]),
+		&(left.torque[1][0]),&(left.torque[1][1]),&(left.torque[1][2]),
+		&(left.joint[2][0]),&(left.joint[2][1]),&(left.joint[2][2]),
+		&(left.torque[2][0]),&(left.torque[2][1]),&(left.torque[2][2]),
+		&(left.joint[3][0]),&(left.joint[3][1]),&(left.joint[3][2]),
+		&(left.torque[3][0]),&(left.torque[3][1]),&(left.torque[3][2]),
+		&(left.joint[4][0]),&(left.joint[4][1]),&(left.joint[4][2]),
+		&(left.torque[4][0]),&(left.torque[4][1]),&(left.torque[4][2]),
+
+		&(state.runFlag),&(state.rightFlag),&(state.leftFlag));
+
+	// 包序号、60个关节角/力矩和3个状态字
+	return ret == 64;
+}
+
+bool HandCodec::DecodeBinarySensor(const char buffer[], int length, CHandData &right, CHandData &left,
+	HandSenseState &state)
+{
+	HandSensePayload payload;
+	int count;
+	if (!ReadPacket(buffer, length, HAND_PACKET_SENSOR, count, &payload, sizeof(payload)))
+	{
+		return false;
+	}
+	right.count = count;
+	memcpy(right.joint, payload.joint[0], sizeof(right.joint));
+	memcpy(left.joint, payload.joint[1], sizeof(left.joint));
+	memcpy(right.torque, payload.torque[0], sizeof(right.torque));
+	memcpy(left.torque, payload.torque[1], sizeof(left.torque));
+	state.runFlag = payload.runFlag;
+	state.rightFlag = payload.rightFlag;
+	state.leftFlag = payload.leftFlag;
+	return true;
+}
+
+bool HandCodec::IsBinary(const char buffer[], int length)
+{
+	unsigned int magic;
+	if (length < (int)sizeof(HandPacketHeader))
+	{
+		return false;
+	}
+	memcpy(&magic, buffer, sizeof(magic));
+	return magic == HAND_BINARY_MAGIC;
+}
+
+unsigned int HandCodec::Crc32(const void *data, int length)
+{
+	const unsigned char *p = (const unsigned char *)data;
+	unsigned int c = 0xFFFFFFFFu;
+	for (int i = 0; i < length; ++i)
+	{
+		c = s_CrcTable[(c ^ p[i]) & 0xFF] ^ (c >> 8);
+	}
+	return c ^ 0xFFFFFFFFu;
+}
@@ -0,0 +1,81 @@
+#ifndef HANDCODEC_H
+#define HANDCODEC_H
+
+#include "RobonautData.h"
+
+// 灵巧手服务器的二进制协议版本，头中版本号不同的包按文本协议处理
+#define HAND_PROTOCOL_VERSION 1
+#define HAND_BINARY_MAGIC 0x42484153		// "SAHB"
+
+// 灵巧手控制命令中除关节角外的状态字
+struct HandCmdState
+{
+	float velocity;			// 各关节速度
+	int controller;			// 控制器模式，CONTROLLER_*
+	int stiffness;
+	int thumb;				// THUMB_BRAKE/THUMB_RELEASE
+	int thumbAngle;
+	int runFlag;
+	int init;				// 以下四个只在左手一行中发送
+	int enable;
+	int stop;
+	int impedanceIndex;
+};
+
+// 灵巧手传感器数据中除关节角、力矩外的状态字
+struct HandSenseState
+{
+	int runFlag;
+	int rightFlag;
+	int leftFlag;
+};
+
+// 灵巧手通信的编解码：原有的sprintf/sscanf文本包，以及定长的二进制包。
+// 二进制包：16字节头（标识、版本、类型、包序号、数据长度），float32的关节角/速度或关节角/力矩数组，
+// int32状态字，末尾4字节CRC32；字节序为小端（两端均为x86）。
+// 协商：旧的服务器只认文本包，因此命令先按文本发送，收到一个版本一致、校验正确的二进制传感器包后
+// 改为二进制发送，之后再收到文本包则退回文本。
+class HandCodec
+{
+public:
+	enum Format
+	{
+		Text,
+		Binary
+	};
+
+	HandCodec();
+
+	void SetBinaryEnabled(bool enabled);	// false时始终按文本发送
+	Format SendFormat() const;
+
+	// 按当前协商的格式编码控制命令，返回字节数，失败返回-1
+	int EncodeCommand(int count, const CHandData &right, const CHandData &left, const HandCmdState &state,
+		char buffer[], int size) const;
+	// 根据包头识别格式并解码传感器数据，同时更新协商结果；文本包须以'\0'结尾。失败时不修改输出
+	bool DecodeSensor(const char buffer[], int length, CHandData &right, CHandData &left, HandSenseState &state);
+
+	// 两种格式的编解码，传感器数据的编码供仿真和测试使用
+	static int EncodeTextCommand(int count, const CHandData &right, const CHandData &left, const HandCmdState &state,
+		char buffer[], int size);
+	static int EncodeBinaryCommand(int count, const CHandData &right, const CHandData &left, const HandCmdState &state,
+		char buffer[], int size);
+	static bool DecodeBinaryCommand(const char buffer[], int length, int &count, CHandData &right, CHandData &left,
+		HandCmdState &state);
+	static int EncodeTextSensor(const CHandData &right, const CHandData &left, const HandSenseState &state,
+		char buffer[], int size);
+	static int EncodeBinarySensor(const CHandData &right, const CHandData &left, const HandSenseState &state,
+		char buffer[], int size);
+	static bool DecodeTextSensor(const char buffer[], CHandData &right, CHandData &left, HandSenseState &state);
+	static bool DecodeBinarySensor(const char buffer[], int length, CHandData &right, CHandData &left,
+		HandSenseState &state);
+
+	static bool IsBinary(const char buffer[], int length);
+	static unsigned int Crc32(const void *data, int length);
+
+private:
+	bool m_bBinaryEnabled;
+	Format m_SendFormat;
+};
+
+#endif
@@ -0,0 +1,118 @@
+#include "KineBatch.h"
+
+#include <algorithm>
+#include <QRunnable>
+#include <QThread>
+
+namespace
+{
+	// 求解[begin, end)段位姿的自运动
+	class KineBatchTask : public QRunnable
+	{
+	public:
+		KineBatchTask(KineBatch::solver_type &solver, const KineBatch::mat4x4 *poses,
+			std::size_t begin, std::size_t end, KineBatch::self_motion_vector *self_motions)
+			: m_Solver(solver), m_Poses(poses), m_Begin(begin), m_End(end), m_SelfMotions(self_motions)
+		{
+			setAutoDelete(true);
+		}
+
+		void run()
+		{
+			for (std::size_t i = m_Begin; i < m_End; ++i)
+			{
+				m_SelfMotions[i] = m_Solver.kine().inverse(m_Poses[i]);
+			}
+		}
+
+	private:
+		KineBatch::solver_type &m_Solver;
+		const KineBatch::mat4x4 *m_Poses;
+		std::size_t m_Begin;
+		std::size_t m_End;
+		KineBatch::self_motion_vector *m_SelfMotions;		// 各段写入互不重叠的下标
+	};
+}
+
+KineBatch::KineBatch(const solver_type &solver, int thread_count)
+{
+	if (thread_count <= 0)
+	{
+		thread_count = QThread::idealThreadCount();
+	}
+	if (thread_count < 1)
+	{
+		thread_count = 1;
+	}
+	for (int i = 0; i < thread_count; ++i)
+	{
+		m_Solvers.push_back(solver);
+		m_Solvers.back().cache().set_quantization(0, 0);
+	}
+	m_Pool.setMaxThreadCount(thread_count);
+}
+
+KineBatch::~KineBatch()
+{
+	m_Pool.waitForDone();
+}
+
+int KineBatch::ThreadCount() const
+{
+	return (int)m_Solvers.size();
+}
+
+void KineBatch::Solve(const mat4x4 *poses, std::size_t count,
+	const vec7 &last_joint_angle, double last_arm_angle, Result &result)
+{
+	// 预先分配，线程中只写入不分配
+	for (int j = 0; j < 7; ++j)
+	{
+		result.q[j].resize(count);
+	}
+	result.arm_angle.resize(count);
+	result.status.resize(count);
+	m_SelfMotions.resize(count);
+	if (count == 0)
+	{
+		return;
+	}
+
+	std::size_t n = m_Solvers.size();
+	if (n > count)
+	{
+		n = count;
+	}
+	std::size_t chunk = (count + n - 1) / n;
+	for (std::size_t t = 0; t < n; ++t)
+	{
+		std::size_t begin = t * chunk;
+		std::size_t end = std::min(begin + chunk, count);
+		if (begin >= end)
+		{
+			break;
+		}
+		m_Pool.start(new KineBatchTask(m_Solvers[t], poses, begin, end, &m_SelfMotions[0]));
+	}
+	m_Pool.waitForDone();
+
+	// 按顺序选解，与KineSolver::solve相同
+	solver_type &solver = m_Solvers[0];
+	vec7 last_joint = last_joint_angle;
+	vec7 q;
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		int status = solver.solve(poses[i], m_SelfMotions[i], last_arm_angle, last_joint, q);
+		if (status < 0)
+		{
+			// 无解时保持上一次的值
+			q = last_joint;
+		}
+		for (int j = 0; j < 7; ++j)
+		{
+			result.q[j][i] = q[j];
+		}
+		result.arm_angle[i] = last_arm_angle;
+		result.status[i] = status;
+	}
+}
@@ -0,0 +1,51 @@
+#ifndef KINEBATCH_H
+#define KINEBATCH_H
+
+#include <vector>
+#include <QThreadPool>
+#include "eigen3/Eigen/StdVector"
+
+#include "kine_solver.hpp"
+
+// 批量逆运动学。每个解以上一个解为参考，选解只能按顺序进行，因此分两步：
+// 与参考无关的Kine7::inverse（耗时的大部分）分段由线程池求解，每个线程使用各自的KineSolver副本；
+// 之后在调用线程中按顺序选解。结果与按顺序逐个调用KineSolver::solve相同，与线程数无关
+class KineBatch
+{
+public:
+	typedef rpp::kine::KineSolver<double> solver_type;
+	typedef solver_type::mat4x4 mat4x4;
+	typedef solver_type::vec7 vec7;
+	typedef solver_type::self_motion_vector self_motion_vector;
+
+	// 结果按关节分列存放（SoA），q[j][i]为第i个位姿的第j个关节角
+	struct Result
+	{
+		std::vector<double> q[7];
+		std::vector<double> arm_angle;
+		std::vector<int> status;		// rpp::kine::KineStatus
+	};
+
+	// thread_count <= 0 时使用QThread::idealThreadCount()
+	explicit KineBatch(const solver_type &solver, int thread_count = 0);
+	~KineBatch();
+
+	// 按顺序求解count个位姿，第一个以last_joint_angle和last_arm_angle为参考，之后以上一个解为参考
+	void Solve(const mat4x4 *poses, std::size_t count,
+		const vec7 &last_joint_angle, double last_arm_angle, Result &result);
+
+	int ThreadCount() const;
+
+private:
+	KineBatch(const KineBatch &);
+	KineBatch &operator=(const KineBatch &);
+
+	// 每个线程一个求解器，求解器含固定大小的Eigen矩阵，需按16字节对齐；
+	// 副本不使用位姿缓存，结果只取决于参数
+	std::vector<solver_type, Eigen::aligned_allocator<solver_type> > m_Solvers;
+	// 各位姿的自运动，在线程中写入，Solve之间复用
+	std::vector<self_motion_vector, Eigen::aligned_allocator<self_motion_vector> > m_SelfMotions;
+	QThreadPool m_Pool;
+};
+
+#endif
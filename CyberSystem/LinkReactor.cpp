@@ -0,0 +1,211 @@
+#include "LinkReactor.h"
+
+LinkReactor::LinkReactor()
+{
+	for (int i = 0; i < LINK_MAX_LINKS; ++i)
+	{
+		m_Links[i] = NULL;
+	}
+	m_LinkCount = 0;
+	m_Rounds = 0;
+	m_Wakeups = 0;
+	m_bStop = false;
+}
+
+LinkReactor::~LinkReactor()
+{
+	Stop();
+}
+
+bool LinkReactor::Add(ReactorLink *link)
+{
+	Configure(link->Socket());
+
+	QMutexLocker locker(&m_Mutex);
+	for (int i = 0; i < m_LinkCount; ++i)
+	{
+		if (m_Links[i] == link)
+		{
+			return true;
+		}
+	}
+	if (m_LinkCount == LINK_MAX_LINKS)
+	{
+		return false;
+	}
+	// 正在select的一轮结束后才开始监视
+	m_Links[m_LinkCount++] = link;
+	m_Changed.wakeAll();
+	if (!isRunning())
+	{
+		start();
+	}
+	return true;
+}
+
+void LinkReactor::Remove(ReactorLink *link)
+{
+	QMutexLocker locker(&m_Mutex);
+	int i = 0;
+	while (i < m_LinkCount && m_Links[i] != link)
+	{
+		++i;
+	}
+	if (i == m_LinkCount)
+	{
+		return;
+	}
+	for (; i + 1 < m_LinkCount; ++i)
+	{
+		m_Links[i] = m_Links[i + 1];
+	}
+	m_Links[--m_LinkCount] = NULL;
+
+	// 当前一轮可能还在使用link，等它结束；在反应器线程中（OnReadable内）调用时不需要等
+	if (!isRunning() || QThread::currentThread() == this)
+	{
+		return;
+	}
+	const int round = m_Rounds;
+	while (m_Rounds == round)
+	{
+		m_Served.wait(&m_Mutex);
+	}
+}
+
+void LinkReactor::Stop()
+{
+	{
+		QMutexLocker locker(&m_Mutex);
+		m_bStop = true;
+		m_Changed.wakeAll();
+	}
+	wait();
+
+	QMutexLocker locker(&m_Mutex);
+	m_bStop = false;
+}
+
+int LinkReactor::Wakeups() const
+{
+	QMutexLocker locker(&m_Mutex);
+	return m_Wakeups;
+}
+
+void LinkReactor::Configure(SOCKET s)
+{
+	int type = 0;
+	int len = sizeof(type);
+	if (getsockopt(s, SOL_SOCKET, SO_TYPE, (char *)&type, &len) == SOCKET_ERROR)
+	{
+		return;
+	}
+
+	int rcvbuf = LINK_RCVBUF_LEN;
+	setsockopt(s, SOL_SOCKET, SO_RCVBUF, (const char *)&rcvbuf, sizeof(rcvbuf));
+	if (type == SOCK_STREAM)
+	{
+		// 命令和传感器包都很小，不等待合并，立即发出
+		int nodelay = 1;
+		setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (const char *)&nodelay, sizeof(nodelay));
+		int sndbuf = LINK_SNDBUF_LEN;
+		setsockopt(s, SOL_SOCKET, SO_SNDBUF, (const char *)&sndbuf, sizeof(sndbuf));
+	}
+}
+
+// 每一轮：复制连接表，select等待可读（最多LINK_WAKE_MS），依次调用可读连接的OnReadable，
+// 去掉已断开的连接后通知等待的Remove
+void LinkReactor::run()
+{
+	ReactorLink *links[LINK_MAX_LINKS];
+	while (true)
+	{
+		int count = 0;
+		{
+			QMutexLocker locker(&m_Mutex);
+			if (m_bStop)
+			{
+				break;
+			}
+			if (m_LinkCount == 0)
+			{
+				// 没有连接时select立即出错返回，改为等待Add
+				++m_Rounds;
+				m_Served.wakeAll();
+				m_Changed.wait(&m_Mutex, LINK_WAKE_MS);
+				continue;
+			}
+			count = m_LinkCount;
+			for (int i = 0; i < count; ++i)
+			{
+				links[i] = m_Links[i];
+			}
+		}
+
+		fd_set readSet;
+		FD_ZERO(&readSet);
+		SOCKET maxSocket = 0;
+		for (int i = 0; i < count; ++i)
+		{
+			SOCKET s = links[i]->Socket();
+			FD_SET(s, &readSet);
+			if (s > maxSocket)
+			{
+				maxSocket = s;
+			}
+		}
+		timeval timeout;
+		timeout.tv_sec = 0;
+		timeout.tv_usec = LINK_WAKE_MS * 1000;
+		// Winsock忽略第一个参数
+		int ready = select((int)maxSocket + 1, &readSet, NULL, NULL, &timeout);
+
+		ReactorLink *closed[LINK_MAX_LINKS];
+		int closedCount = 0;
+		if (ready > 0)
+		{
+			for (int i = 0; i < count; ++i)
+			{
+				if (FD_ISSET(links[i]->Socket(), &readSet) && !links[i]->OnReadable())
+				{
+					closed[closedCount++] = links[i];
+				}
+			}
+		}
+		else if (ready == SOCKET_ERROR)
+		{
+			// 有套接字已被关闭而未Remove，等其所有者处理
+			msleep(LINK_WAKE_MS);
+		}
+
+		QMutexLocker locker(&m_Mutex);
+		if (ready > 0)
+		{
+			++m_Wakeups;
+		}
+		for (int i = 0; i < closedCount; ++i)
+		{
+			// 对方关闭后套接字一直可读，不再监视
+			int j = 0;
+			while (j < m_LinkCount && m_Links[j] != closed[i])
+			{
+				++j;
+			}
+			for (; j + 1 < m_LinkCount; ++j)
+			{
+				m_Links[j] = m_Links[j + 1];
+			}
+			if (j < m_LinkCount)
+			{
+				m_Links[--m_LinkCount] = NULL;
+			}
+		}
+		++m_Rounds;
+		m_Served.wakeAll();
+	}
+
+	// Remove不必再等
+	QMutexLocker locker(&m_Mutex);
+	++m_Rounds;
+	m_Served.wakeAll();
+}
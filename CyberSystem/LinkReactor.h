@@ -0,0 +1,118 @@
+#ifndef LINKREACTOR_H
+#define LINKREACTOR_H
+
+#include <winsock2.h>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QWaitCondition>
+#include "SocketDefine.h"
+
+// 最新值信箱：接收线程写入解码后的消息，控制周期只取最新的一个，不排队也不等待
+template <typename T>
+class Mailbox
+{
+public:
+	Mailbox()
+		: m_Puts(0)
+		, m_Taken(0)
+		, m_Overwritten(0)
+	{
+	}
+
+	void Put(const T &value)
+	{
+		QMutexLocker locker(&m_Mutex);
+		if (m_Puts != m_Taken)
+		{
+			// 上一个消息还没有取走
+			++m_Overwritten;
+		}
+		m_Value = value;
+		++m_Puts;
+	}
+
+	// 自上次Take后有新消息时复制并返回true，否则不修改value
+	bool Take(T &value)
+	{
+		QMutexLocker locker(&m_Mutex);
+		if (m_Puts == m_Taken)
+		{
+			return false;
+		}
+		value = m_Value;
+		m_Taken = m_Puts;
+		return true;
+	}
+
+	int Puts() const
+	{
+		QMutexLocker locker(&m_Mutex);
+		return m_Puts;
+	}
+
+	int Overwritten() const			// 未被取走就被新消息覆盖的消息数
+	{
+		QMutexLocker locker(&m_Mutex);
+		return m_Overwritten;
+	}
+
+private:
+	Mailbox(const Mailbox &);
+	Mailbox &operator=(const Mailbox &);
+
+	mutable QMutex m_Mutex;
+	T m_Value;
+	int m_Puts;
+	int m_Taken;		// 最近一次Take时的m_Puts
+	int m_Overwritten;
+};
+
+// 由LinkReactor驱动的接收连接。Socket()可读时在反应器线程中调用OnReadable，
+// OnReadable只调用一次recv，因此不会阻塞；返回false表示连接已断开，反应器随后不再监视该连接
+class ReactorLink
+{
+public:
+	virtual ~ReactorLink() {}
+	virtual SOCKET Socket() const = 0;
+	virtual bool OnReadable() = 0;
+};
+
+// 所有设备连接的接收线程：用select同时等待各连接的套接字，可读时由连接自己分帧、解码并写入信箱。
+// 控制周期和界面只读信箱，不再在套接字上阻塞；发送仍在调用者的线程中进行。
+// 连接的套接字由其所有者创建和关闭：关闭之前先Remove，Remove返回后反应器不会再访问它。
+class LinkReactor : public QThread
+{
+public:
+	LinkReactor();
+	~LinkReactor();
+
+	// 开始监视link，并按LinkReactor::Configure设置其套接字；第一次Add时启动线程
+	bool Add(ReactorLink *link);
+	// 停止监视link，等待反应器结束当前的一轮；link未在监视中时直接返回
+	void Remove(ReactorLink *link);
+	void Stop();			// 结束线程，已添加的连接保留，下次Add时重新启动
+
+	int Wakeups() const;	// select返回可读的次数
+
+	// TCP：关闭Nagle算法，设置收发缓冲；UDP：设置接收缓冲
+	static void Configure(SOCKET s);
+
+protected:
+	void run();
+
+private:
+	LinkReactor(const LinkReactor &);
+	LinkReactor &operator=(const LinkReactor &);
+
+	mutable QMutex m_Mutex;		// 保护以下成员
+	QWaitCondition m_Changed;	// 添加了连接或要求停止
+	QWaitCondition m_Served;	// 结束了一轮
+	ReactorLink *m_Links[LINK_MAX_LINKS];
+	int m_LinkCount;
+	int m_Rounds;
+	int m_Wakeups;
+	bool m_bStop;
+};
+
+#endif
@@ -0,0 +1,207 @@
+#include "PlanBuffer.h"
+
+#include <QRunnable>
+#include <QMutexLocker>
+
+#include "stopwatch.hpp"
+
+class PlanSolveTask : public QRunnable
+{
+public:
+	explicit PlanSolveTask(PlanBuffer &buffer) : m_Buffer(buffer)
+	{
+		setAutoDelete(true);
+	}
+
+	void run()
+	{
+		m_Buffer.Solve();
+	}
+
+private:
+	PlanBuffer &m_Buffer;
+};
+
+PlanBuffer::PlanBuffer()
+	: m_bWaypoints(false), m_ArmAngle(0), m_Period(0), m_MinDuration(0), m_State(Empty),
+	m_WaypointStatus(rpp::kine::PLAN_OK), m_FailedIndex(-1), m_FailedResidual(0), m_SolveMs(0)
+{
+	m_JointRef.setZero();
+	m_Pool.setMaxThreadCount(1);
+}
+
+PlanBuffer::~PlanBuffer()
+{
+	m_Pool.waitForDone();
+}
+
+void PlanBuffer::Start(const solver_type &solver, const trajectory_type &traj, const vec7 &joint_ref)
+{
+	// 后台线程只访问成员中的副本
+	m_Pool.waitForDone();
+	m_bWaypoints = false;
+	m_Solver = solver;
+	m_Poses = traj.poses();
+	m_Transforms = traj.transforms();
+	m_Joints.resize(m_Poses.size());
+	m_JointRef = joint_ref;
+	Prepare();
+	m_Pool.start(new PlanSolveTask(*this));
+}
+
+void PlanBuffer::StartWaypoints(const ik_solver_type &solver, const pose_vector &waypoints, const vec7 &joint_ref,
+	double arm_angle, const planner_type::limits_type &limits, double period, double min_duration)
+{
+	m_Pool.waitForDone();
+	m_bWaypoints = true;
+	m_IkSolver = solver;
+	m_Planner.limits() = limits;
+	m_Transforms.assign(waypoints.begin(), waypoints.end());
+	m_Poses.clear();
+	m_Joints.clear();
+	m_JointRef = joint_ref;
+	m_ArmAngle = arm_angle;
+	m_Period = period;
+	m_MinDuration = min_duration;
+	Prepare();
+	m_Pool.start(new PlanSolveTask(*this));
+}
+
+void PlanBuffer::Prepare()
+{
+	QMutexLocker locker(&m_Mutex);
+	m_State = Solving;
+	m_WaypointStatus = rpp::kine::PLAN_OK;
+	m_FailedIndex = -1;
+	m_FailedResidual = 0;
+	m_SolveMs = 0;
+}
+
+void PlanBuffer::Wait()
+{
+	m_Pool.waitForDone();
+}
+
+void PlanBuffer::Clear()
+{
+	m_Pool.waitForDone();
+	QMutexLocker locker(&m_Mutex);
+	m_State = Empty;
+	m_Poses.clear();
+	m_Transforms.clear();
+	m_Joints.clear();
+}
+
+void PlanBuffer::Solve()
+{
+	rpp::util::Stopwatch sw;
+	if (m_bWaypoints)
+	{
+		SolveWaypoints();
+	}
+	else
+	{
+		SolveTrajectory();
+	}
+
+	QMutexLocker locker(&m_Mutex);
+	m_SolveMs = sw.elapsed_ns() / 1e6;
+	m_State = (m_FailedIndex < 0) ? Ready : Failed;
+}
+
+void PlanBuffer::SolveTrajectory()
+{
+	vec7 q_ref = m_JointRef;
+	for (std::size_t i = 0; i < m_Poses.size(); ++i)
+	{
+		vec7 &q = m_Joints[i];
+		solver_type::result_type result = m_Solver.solve(m_Poses[i], q_ref, q);
+
+		// 位姿偏差的判据与CyberSystem::DiffKine相同，关节角按机器人的关节限位检查
+		double tolerance = (result.lambda == 0) ? 0.5 : 2;
+		bool ok = (result.pose - m_Transforms[i]).norm() < tolerance;
+		for (int j = 0; j < 7 && ok; ++j)
+		{
+			ok = (q(j) >= m_Solver.lower()(j) && q(j) <= m_Solver.upper()(j));
+		}
+		if (!ok)
+		{
+			m_FailedIndex = (int)i;
+			m_FailedResidual = result.residual;
+			return;
+		}
+		q_ref = q;
+	}
+}
+
+void PlanBuffer::SolveWaypoints()
+{
+	// 路径点用解析逆运动学，相邻路径点可以相距较远
+	rpp::kine::AnalyticIk<double> ik(m_IkSolver);
+	m_WaypointStatus = m_Planner.plan(ik, m_Transforms.empty() ? NULL : &m_Transforms[0], (int)m_Transforms.size(),
+		m_JointRef, m_ArmAngle, m_Period, m_MinDuration);
+	if (m_WaypointStatus != rpp::kine::PLAN_OK)
+	{
+		m_FailedIndex = (m_Planner.failed_index() < 0) ? 0 : m_Planner.failed_index();
+		return;
+	}
+
+	// 执行时显示的位姿
+	m_Joints = m_Planner.samples();
+	m_Poses.resize(m_Joints.size());
+	for (std::size_t i = 0; i < m_Joints.size(); ++i)
+	{
+		m_Poses[i] = rpp::kine::t2quater(m_IkSolver.kine().forward(m_Joints[i]));
+	}
+}
+
+PlanBuffer::State PlanBuffer::GetState() const
+{
+	QMutexLocker locker(&m_Mutex);
+	return m_State;
+}
+
+int PlanBuffer::Size() const
+{
+	return (int)m_Joints.size();
+}
+
+const PlanBuffer::vec7 &PlanBuffer::Joints(int i) const
+{
+	return m_Joints[i];
+}
+
+const PlanBuffer::vec7 &PlanBuffer::Pose(int i) const
+{
+	return m_Poses[i];
+}
+
+bool PlanBuffer::IsWaypointPlan() const
+{
+	return m_bWaypoints;
+}
+
+rpp::kine::PlanStatus PlanBuffer::WaypointStatus() const
+{
+	return m_WaypointStatus;
+}
+
+int PlanBuffer::FailedIndex() const
+{
+	return m_FailedIndex;
+}
+
+double PlanBuffer::FailedResidual() const
+{
+	return m_FailedResidual;
+}
+
+double PlanBuffer::Duration() const
+{
+	return m_Planner.duration();
+}
+
+double PlanBuffer::SolveMs() const
+{
+	return m_SolveMs;
+}
@@ -0,0 +1,92 @@
+#ifndef PLANBUFFER_H
+#define PLANBUFFER_H
+
+#include <vector>
+#include <QMutex>
+#include <QThreadPool>
+#include "eigen3/Eigen/StdVector"
+
+#include "diff_kine.hpp"
+#include "kine_solver.hpp"
+#include "trajectory.hpp"
+#include "joint_planner.hpp"
+
+// 关节空间的规划缓冲：执行前在后台线程中求解整条规划并检查每个采样，
+// 执行时每个周期只读取下一个关节角。两种规划：
+// 1. Start：笛卡尔空间的采样（Trajectory），用微分逆运动学逐点求解，检查位姿偏差和关节限位；
+// 2. StartWaypoints：笛卡尔路径点，逐个解析求解后由JointPlanner按关节速度、加速度限制生成关节轨迹，
+//    直线段之间用抛物线过渡，中间路径点处不停顿（从路径点附近圆滑经过），只在起点和终点静止
+class PlanBuffer
+{
+public:
+	typedef rpp::kine::DiffKineSolver<double> solver_type;
+	typedef rpp::kine::KineSolver<double> ik_solver_type;
+	typedef rpp::kine::Trajectory<double> trajectory_type;
+	typedef rpp::kine::JointPlanner<double> planner_type;
+	typedef solver_type::vec7 vec7;
+	typedef planner_type::pose_vector pose_vector;
+
+	enum State
+	{
+		Empty,			// 没有规划
+		Solving,		// 后台求解中
+		Ready,			// 全部采样可行，可以执行
+		Failed			// 有采样不可行，见FailedIndex
+	};
+
+	PlanBuffer();
+	~PlanBuffer();
+
+	// 复制求解器和规划的采样，在后台线程中从joint_ref开始求解；之前的求解先结束
+	void Start(const solver_type &solver, const trajectory_type &traj, const vec7 &joint_ref);
+	// 复制求解器和路径点，在后台线程中从joint_ref开始求解，采样周期period(s)，总时间不少于min_duration(s)
+	void StartWaypoints(const ik_solver_type &solver, const pose_vector &waypoints, const vec7 &joint_ref,
+		double arm_angle, const planner_type::limits_type &limits, double period, double min_duration);
+	void Wait();
+	void Clear();
+
+	State GetState() const;
+	// 以下只在GetState() == Ready或Failed后使用
+	int Size() const;
+	const vec7 &Joints(int i) const;
+	const vec7 &Pose(int i) const;			// 第i个采样的位姿[x, y, z, eta, e1, e2, e3]
+	bool IsWaypointPlan() const;
+	rpp::kine::PlanStatus WaypointStatus() const;
+	int FailedIndex() const;			// 第一个不可行的采样（路径点规划为路径点，0为起点），Ready时为-1
+	double FailedResidual() const;		// 该采样的位姿残差
+	double Duration() const;			// 路径点规划的总时间(s)
+	double SolveMs() const;				// 整条规划的求解耗时
+
+private:
+	PlanBuffer(const PlanBuffer &);
+	PlanBuffer &operator=(const PlanBuffer &);
+
+	friend class PlanSolveTask;
+	void Solve();				// 在后台线程中执行
+	void SolveTrajectory();
+	void SolveWaypoints();
+	void Prepare();
+
+	bool m_bWaypoints;
+	solver_type m_Solver;
+	ik_solver_type m_IkSolver;
+	planner_type m_Planner;
+	trajectory_type::pose_vector m_Poses;
+	trajectory_type::transform_vector m_Transforms;		// 笛卡尔采样或路径点的齐次变换
+	std::vector<vec7, Eigen::aligned_allocator<vec7> > m_Joints;
+	vec7 m_JointRef;
+	double m_ArmAngle;
+	double m_Period;
+	double m_MinDuration;
+
+	mutable QMutex m_Mutex;		// 保护m_State，后台线程写完缓冲后再改变状态
+	State m_State;
+	rpp::kine::PlanStatus m_WaypointStatus;
+	int m_FailedIndex;
+	double m_FailedResidual;
+	double m_SolveMs;
+
+	QThreadPool m_Pool;
+};
+
+#endif
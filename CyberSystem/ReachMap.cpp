@@ -0,0 +1,547 @@
+#include "ReachMap.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include "eigen3/Eigen/StdVector"
+
+namespace
+{
+	const int ReachMapVersion = 1;
+
+	typedef rpp::kine::Kine7<double> kine_type;
+	typedef std::vector<kine_type, Eigen::aligned_allocator<kine_type> > kine_vector;
+
+	unsigned long long SplitMix64(unsigned long long x)
+	{
+		x += 0x9E3779B97F4A7C15ULL;
+		x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+		return x ^ (x >> 31);
+	}
+
+	// 第i个采样的关节角，由下标散列得到，地图与线程个数无关
+	kine_type::vec7 SampleJoints(const ReachMap::Header &header, int i)
+	{
+		kine_type::vec7 q;
+		for (int j = 0; j < 7; ++j)
+		{
+			double u = (double)(SplitMix64((unsigned long long)i * 7 + j) >> 11) / 9007199254740992.0;
+			q(j) = header.limits[j] + (header.limits[7 + j] - header.limits[j]) * u;
+		}
+		return q;
+	}
+
+	// 位姿T的腕部中心（末端沿自身z轴退回L3）所在体素的下标，地图范围外返回-1
+	int VoxelIndex(const ReachMap::Header &header, const ReachMap::mat4x4 &T)
+	{
+		const double L3 = header.dh[13];
+		int index = 0;
+		int stride = 1;
+		for (int k = 0; k < 3; ++k)
+		{
+			double p = T(k, 3) - L3 * T(k, 2);
+			int i = (int)std::floor((p - header.origin[k]) / header.voxel + 0.5);
+			if (i < 0 || i >= header.size[k])
+			{
+				return -1;
+			}
+			index += i * stride;
+			stride *= header.size[k];
+		}
+		return index;
+	}
+
+	// 第[begin, end)个采样，first[v]记录落入体素v的第一个（下标最小的）采样
+	class SampleTask : public QRunnable
+	{
+	public:
+		SampleTask(const kine_type &kine, const ReachMap::Header &header, int begin, int end,
+			std::vector<int> &first)
+			: m_Kine(kine), m_Header(header), m_Begin(begin), m_End(end), m_First(first)
+		{
+			setAutoDelete(true);
+		}
+
+		void run()
+		{
+			for (int i = m_Begin; i < m_End; ++i)
+			{
+				int v = VoxelIndex(m_Header, m_Kine.forward(SampleJoints(m_Header, i)));
+				if (v >= 0 && m_First[v] < 0)
+				{
+					m_First[v] = i;
+				}
+			}
+		}
+
+	private:
+		const kine_type &m_Kine;
+		const ReachMap::Header &m_Header;
+		int m_Begin;
+		int m_End;
+		std::vector<int> &m_First;		// 每个线程一份，结束后合并
+	};
+
+	// 可达体素reachable[begin, end)：对其第一个采样求逆解，记录肘关节在限位内的自运动中最宽的臂角范围
+	class MarginTask : public QRunnable
+	{
+	public:
+		MarginTask(kine_type &kine, const ReachMap::Header &header, const std::vector<int> &first,
+			const std::vector<int> &reachable, int begin, int end, std::vector<ReachMap::Voxel> &voxels)
+			: m_Kine(kine), m_Header(header), m_First(first), m_Reachable(reachable),
+			m_Begin(begin), m_End(end), m_Voxels(voxels)
+		{
+			setAutoDelete(true);
+		}
+
+		void run()
+		{
+			const double PI = rpp::util::Constants<double>::pi;
+			kine_type::angular_interval elbow(m_Header.limits[3], m_Header.limits[10]);
+			for (int k = m_Begin; k < m_End; ++k)
+			{
+				int v = m_Reachable[k];
+				kine_type::self_motion_vector self_motions =
+					m_Kine.inverse(m_Kine.forward(SampleJoints(m_Header, m_First[v])));
+				double width = 0;
+				for (std::size_t i = 0; i < self_motions.size(); ++i)
+				{
+					if (!elbow.contains(self_motions[i].elbow_joint()))
+					{
+						continue;
+					}
+					kine_type::angular_interval_set range = self_motions[i].arm_angle_range();
+					double w = 0;
+					for (auto it = range.begin(); it != range.end(); ++it)
+					{
+						w += it->upper() - it->lower();
+					}
+					width = std::max(width, w);
+				}
+				m_Voxels[v].margin = (unsigned short)std::min(65535.0, width / (2 * PI) * 65535 + 0.5);
+			}
+		}
+
+	private:
+		kine_type &m_Kine;
+		const ReachMap::Header &m_Header;
+		const std::vector<int> &m_First;
+		const std::vector<int> &m_Reachable;
+		int m_Begin;
+		int m_End;
+		std::vector<ReachMap::Voxel> &m_Voxels;		// 各段写入互不重叠的体素
+	};
+
+	// 体素c的26邻域，超出地图的跳过
+	int Neighbors(const ReachMap::Header &header, int c, int *u)
+	{
+		const int nx = header.size[0];
+		const int ny = header.size[1];
+		const int nz = header.size[2];
+		int x = c % nx;
+		int y = (c / nx) % ny;
+		int z = c / (nx * ny);
+		int count = 0;
+		for (int dz = -1; dz <= 1; ++dz)
+		{
+			for (int dy = -1; dy <= 1; ++dy)
+			{
+				for (int dx = -1; dx <= 1; ++dx)
+				{
+					if ((dx == 0 && dy == 0 && dz == 0) || x + dx < 0 || x + dx >= nx
+						|| y + dy < 0 || y + dy >= ny || z + dz < 0 || z + dz >= nz)
+					{
+						continue;
+					}
+					u[count++] = c + (dz * ny + dy) * nx + dx;
+				}
+			}
+		}
+		return count;
+	}
+
+	// 多源广度优先：每个体素到最近的可达性不同的体素的步数（26邻域），可达为正
+	void FillDistance(const ReachMap::Header &header, std::vector<ReachMap::Voxel> &voxels)
+	{
+		const int n = header.size[0] * header.size[1] * header.size[2];
+		std::vector<int> dist(n, -1);
+		std::vector<int> queue;
+		queue.reserve(n);
+		int u[26];
+
+		// 边界体素：邻域内有可达性不同的体素
+		for (int c = 0; c < n; ++c)
+		{
+			int count = Neighbors(header, c, u);
+			for (int i = 0; i < count; ++i)
+			{
+				if (voxels[u[i]].reached != voxels[c].reached)
+				{
+					dist[c] = 1;
+					queue.push_back(c);
+					break;
+				}
+			}
+		}
+		// 在可达性相同的体素中逐层扩展
+		for (std::size_t head = 0; head < queue.size(); ++head)
+		{
+			int c = queue[head];
+			int count = Neighbors(header, c, u);
+			for (int i = 0; i < count; ++i)
+			{
+				if (dist[u[i]] < 0 && voxels[u[i]].reached == voxels[c].reached)
+				{
+					dist[u[i]] = dist[c] + 1;
+					queue.push_back(u[i]);
+				}
+			}
+		}
+		for (int c = 0; c < n; ++c)
+		{
+			int d = (dist[c] < 0 || dist[c] > 127) ? 127 : dist[c];
+			voxels[c].distance = (signed char)(voxels[c].reached ? d : -d);
+		}
+	}
+}
+
+ReachMap::BuildThread::BuildThread(ReachMap &map)
+	: m_Map(map)
+{
+}
+
+void ReachMap::BuildThread::run()
+{
+	m_Map.OpenFile(m_Map.m_BuildPath, m_Map.m_BuildSolver, m_Map.m_BuildVoxel,
+		m_Map.m_BuildSamples, m_Map.m_BuildThreadCount);
+}
+
+ReachMap::ReachMap()
+	: m_Header(NULL), m_Reach(0), m_WristOffset(0), m_BuildThread(*this), m_BuildVoxel(0),
+	m_BuildSamples(0), m_BuildThreadCount(0)
+{
+}
+
+ReachMap::~ReachMap()
+{
+	Close();
+}
+
+void ReachMap::FillHeader(Header &header, const solver_type &solver, double voxel, int samples)
+{
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, "REACHMAP", 8);
+	header.version = ReachMapVersion;
+	const Eigen::Array<double, 7, 4> &dh = solver.kine().dh();
+	for (int i = 0; i < 7; ++i)
+	{
+		header.dh[i] = (float)dh(i, 1);
+		header.dh[7 + i] = (float)dh(i, 3);
+		header.limits[i] = (float)solver.joint_limits()[i].lower();
+		header.limits[7 + i] = (float)solver.joint_limits()[i].upper();
+	}
+	int half = (int)std::ceil(Reach(solver) / voxel) + 1;
+	for (int k = 0; k < 3; ++k)
+	{
+		header.size[k] = 2 * half + 1;
+		header.origin[k] = (float)(-half * voxel);
+	}
+	header.voxel = (float)voxel;
+	header.samples = samples;
+}
+
+// 前六个关节的连杆长度之和，腕部中心不会更远
+double ReachMap::Reach(const solver_type &solver)
+{
+	const Eigen::Array<double, 7, 4> &dh = solver.kine().dh();
+	double reach = 0;
+	for (int i = 0; i < 6; ++i)
+	{
+		reach += std::fabs(dh(i, 1)) + std::fabs(dh(i, 3));
+	}
+	return reach;
+}
+
+bool ReachMap::Build(const QString &path, const solver_type &solver, double voxel,
+	int samples, int thread_count)
+{
+	if (thread_count <= 0)
+	{
+		thread_count = QThread::idealThreadCount();
+	}
+	if (thread_count < 1)
+	{
+		thread_count = 1;
+	}
+	Header header;
+	FillHeader(header, solver, voxel, samples);
+	const int n = header.size[0] * header.size[1] * header.size[2];
+
+	// 每个线程一份运动学（逆解会修改内部状态），按16字节对齐
+	kine_vector kines(thread_count, solver.kine());
+	QThreadPool pool;
+	pool.setMaxThreadCount(thread_count);
+
+	// 采样：按下标分段，段内按顺序记录第一个落入的采样，合并时取下标最小的一段
+	std::vector<int> first(n, -1);
+	{
+		std::vector<std::vector<int> > firsts(thread_count, std::vector<int>(n, -1));
+		int chunk = (samples + thread_count - 1) / thread_count;
+		for (int t = 0; t < thread_count; ++t)
+		{
+			int begin = t * chunk;
+			int end = std::min(begin + chunk, samples);
+			if (begin >= end)
+			{
+				break;
+			}
+			pool.start(new SampleTask(kines[t], header, begin, end, firsts[t]));
+		}
+		pool.waitForDone();
+		for (int v = 0; v < n; ++v)
+		{
+			for (int t = 0; t < thread_count && first[v] < 0; ++t)
+			{
+				first[v] = firsts[t][v];
+			}
+		}
+	}
+
+	std::vector<Voxel> voxels(n);
+	std::vector<int> reachable;
+	for (int v = 0; v < n; ++v)
+	{
+		voxels[v].reached = (first[v] >= 0 ? 1 : 0);
+		voxels[v].distance = 0;
+		voxels[v].margin = 0;
+		if (first[v] >= 0)
+		{
+			reachable.push_back(v);
+		}
+	}
+	header.reachable = (int)reachable.size();
+
+	// 臂角范围：逆解较慢，按可达体素分段
+	int count = (int)reachable.size();
+	int chunk = (count + thread_count - 1) / thread_count;
+	for (int t = 0; t < thread_count; ++t)
+	{
+		int begin = t * chunk;
+		int end = std::min(begin + chunk, count);
+		if (begin >= end)
+		{
+			break;
+		}
+		pool.start(new MarginTask(kines[t], header, first, reachable, begin, end, voxels));
+	}
+	pool.waitForDone();
+
+	FillDistance(header, voxels);
+
+	QFile file(path);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		return false;
+	}
+	qint64 bytes = (qint64)n * sizeof(Voxel);
+	bool ret = file.write((const char *)&header, sizeof(header)) == (qint64)sizeof(header)
+		&& file.write((const char *)&voxels[0], bytes) == bytes;
+	file.close();
+	return ret;
+}
+
+bool ReachMap::Load(const QString &path, const solver_type &solver)
+{
+	m_BuildThread.wait();
+	m_Reach = Reach(solver);
+	m_WristOffset = solver.kine().dh()(6, 3);
+	return Map(path, solver);
+}
+
+bool ReachMap::Map(const QString &path, const solver_type &solver)
+{
+	Unmap();
+	m_File.setFileName(path);
+	if (!m_File.open(QIODevice::ReadOnly))
+	{
+		return false;
+	}
+	qint64 size = m_File.size();
+	uchar *data = (size >= (qint64)sizeof(Header) ? m_File.map(0, size) : NULL);
+	if (data == NULL)
+	{
+		Unmap();
+		return false;
+	}
+
+	// 与当前机器人参数生成的文件头比较
+	const Header *header = (const Header *)data;
+	Header expected;
+	FillHeader(expected, solver, header->voxel, header->samples);
+	qint64 n = (qint64)header->size[0] * header->size[1] * header->size[2];
+	if (memcmp(header->magic, expected.magic, sizeof(expected.magic)) != 0
+		|| header->version != expected.version
+		|| memcmp(header->size, expected.size, sizeof(expected.size)) != 0
+		|| memcmp(header->dh, expected.dh, sizeof(expected.dh)) != 0
+		|| memcmp(header->limits, expected.limits, sizeof(expected.limits)) != 0
+		|| size != (qint64)sizeof(Header) + n * (qint64)sizeof(Voxel))
+	{
+		Unmap();
+		return false;
+	}
+	m_Header.storeRelease(header);
+	return true;
+}
+
+bool ReachMap::Open(const QString &path, const solver_type &solver, double voxel,
+	int samples, int thread_count)
+{
+	m_BuildThread.wait();
+	m_Reach = Reach(solver);
+	m_WristOffset = solver.kine().dh()(6, 3);
+	return OpenFile(path, solver, voxel, samples, thread_count);
+}
+
+bool ReachMap::OpenFile(const QString &path, const solver_type &solver, double voxel,
+	int samples, int thread_count)
+{
+	if (Map(path, solver) && m_Header.load()->voxel == (float)voxel && m_Header.load()->samples == samples)
+	{
+		return true;
+	}
+	// 文件映射时不能覆盖
+	Unmap();
+	return Build(path, solver, voxel, samples, thread_count) && Map(path, solver);
+}
+
+void ReachMap::OpenAsync(const QString &path, const solver_type &solver, double voxel,
+	int samples, int thread_count)
+{
+	m_BuildThread.wait();
+	m_Reach = Reach(solver);
+	m_WristOffset = solver.kine().dh()(6, 3);
+	// 已有的文件只需映射，不必启动线程
+	if (Map(path, solver) && m_Header.load()->voxel == (float)voxel && m_Header.load()->samples == samples)
+	{
+		return;
+	}
+	Unmap();
+	m_BuildSolver = solver;
+	m_BuildPath = path;
+	m_BuildVoxel = voxel;
+	m_BuildSamples = samples;
+	m_BuildThreadCount = thread_count;
+	m_BuildThread.start(QThread::LowPriority);
+}
+
+bool ReachMap::IsBuilding() const
+{
+	return m_BuildThread.isRunning();
+}
+
+bool ReachMap::Wait()
+{
+	m_BuildThread.wait();
+	return IsOpen();
+}
+
+void ReachMap::Close()
+{
+	m_BuildThread.wait();
+	Unmap();
+}
+
+void ReachMap::Unmap()
+{
+	m_Header.storeRelease(NULL);
+	if (m_File.isOpen())
+	{
+		m_File.close();
+	}
+}
+
+bool ReachMap::IsOpen() const
+{
+	return m_Header.loadAcquire() != NULL;
+}
+
+const ReachMap::Header &ReachMap::Info() const
+{
+	return *m_Header.loadAcquire();
+}
+
+const ReachMap::Voxel *ReachMap::Find(const Header *header, const mat4x4 &T) const
+{
+	int v = VoxelIndex(*header, T);
+	return v < 0 ? NULL : (const Voxel *)(header + 1) + v;
+}
+
+double ReachMap::Distance(const mat4x4 &T) const
+{
+	const Header *header = m_Header.loadAcquire();
+	if (header == NULL)
+	{
+		return 0;
+	}
+	const Voxel *voxel = Find(header, T);
+	return (voxel ? voxel->distance : -127) * (double)header->voxel;
+}
+
+bool ReachMap::IsReachable(const mat4x4 &T) const
+{
+	const Header *header = m_Header.loadAcquire();
+	if (header == NULL)
+	{
+		return true;
+	}
+	const Voxel *voxel = Find(header, T);
+	return voxel != NULL && voxel->reached != 0;
+}
+
+bool ReachMap::IsHopeless(const mat4x4 &T) const
+{
+	const Header *header = m_Header.loadAcquire();
+	if (header == NULL)
+	{
+		return false;
+	}
+	const Voxel *voxel = Find(header, T);
+	return voxel == NULL || voxel->distance <= -2;
+}
+
+bool ReachMap::IsUnreachable(const mat4x4 &T) const
+{
+	if (m_Reach > 0)
+	{
+		// 腕部中心：末端沿自身z轴退回L3
+		const Eigen::Vector3d wrist = T.block<3, 1>(0, 3) - m_WristOffset * T.block<3, 1>(0, 2);
+		if (wrist.norm() > m_Reach)
+		{
+			return true;
+		}
+	}
+	const Header *header = m_Header.loadAcquire();
+	if (header == NULL)
+	{
+		return false;
+	}
+	const Voxel *voxel = Find(header, T);
+	return voxel != NULL && voxel->distance <= -UnreachableVoxels;
+}
+
+double ReachMap::ArmAngleMargin(const mat4x4 &T) const
+{
+	const double PI = rpp::util::Constants<double>::pi;
+	const Header *header = m_Header.loadAcquire();
+	if (header == NULL)
+	{
+		return 2 * PI;
+	}
+	const Voxel *voxel = Find(header, T);
+	return voxel ? voxel->margin * 2 * PI / 65535 : 0;
+}
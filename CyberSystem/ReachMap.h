@@ -0,0 +1,122 @@
+#ifndef REACHMAP_H
+#define REACHMAP_H
+
+#include <QAtomicPointer>
+#include <QFile>
+#include <QString>
+#include <QThread>
+
+#include "kine_solver.hpp"
+
+// 腕部中心的可达工作空间体素地图：
+// 1. 在关节限位内均匀采样关节角，正运动学得到腕部中心，标记所在体素；
+// 2. 对每个可达体素取一个落入的采样位姿求逆解，记录臂角可行范围的宽度；
+// 3. 计算每个体素到可达边界的有符号距离。
+// 地图保存为文件，启动时用QFile::map映射，不需要读入和解析；查询只计算一次下标，O(1)。
+// 地图由随机采样生成，采样没有落到的可达位姿会被标为不可达，因此边界附近只作提示，不能据此拒绝求解；
+// 只有IsUnreachable（超出臂展，或离采样到的体素UnreachableVoxels个体素以上）可以跳过求解
+class ReachMap
+{
+public:
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+	typedef rpp::kine::KineSolver<double> solver_type;
+	typedef solver_type::mat4x4 mat4x4;
+
+	enum { DefaultSamples = 2000000 };
+	// 可达的位姿离采样到的体素不会这么远：默认采样下可达体素平均落入约百个采样，
+	// 漏掉的只是边界上的零星体素
+	enum { UnreachableVoxels = 4 };
+
+	// 文件头，其后为size[0]*size[1]*size[2]个Voxel，x方向下标变化最快
+	struct Header
+	{
+		char magic[8];			// "REACHMAP"
+		int version;
+		int size[3];			// 各方向的体素个数
+		float origin[3];		// 第一个体素的中心(mm)
+		float voxel;			// 体素边长(mm)
+		float dh[14];			// DH表各行的a和d，判断地图是否对应当前机器人
+		float limits[14];		// 各关节限位的下限和上限
+		int samples;			// 采样个数
+		int reachable;			// 可达体素个数
+	};
+	struct Voxel
+	{
+		unsigned char reached;		// 有采样落入该体素
+		signed char distance;		// 到可达边界的有符号距离（体素，26邻域），可达为正，限制在±127
+		unsigned short margin;		// 臂角可行范围的宽度，65535对应2pi
+	};
+
+	ReachMap();
+	~ReachMap();
+
+	// 映射path；文件不存在或与solver的机器人参数、voxel、samples不符时重新生成
+	bool Open(const QString &path, const solver_type &solver, double voxel = 20,
+		int samples = DefaultSamples, int thread_count = 0);
+	// 生成地图写入path，thread_count <= 0 时使用QThread::idealThreadCount()
+	static bool Build(const QString &path, const solver_type &solver, double voxel,
+		int samples, int thread_count = 0);
+	// 与Open相同，但需要生成时在后台线程中生成后映射，立即返回；生成完成前地图没有打开
+	void OpenAsync(const QString &path, const solver_type &solver, double voxel = 20,
+		int samples = DefaultSamples, int thread_count = 0);
+	bool IsBuilding() const;
+	bool Wait();				// 等待后台生成结束，返回地图是否已打开
+	// 映射path，与solver的机器人参数不符时返回false
+	bool Load(const QString &path, const solver_type &solver);
+	void Close();				// 先等待后台生成结束
+
+	bool IsOpen() const;
+	const Header &Info() const;
+
+	// 按位姿T的腕部中心查询；地图没有打开（包括正在后台生成）时一律视为可达。
+	// 查询可以与后台生成同时在其他线程中进行
+	double Distance(const mat4x4 &T) const;			// 到可达边界的有符号距离(mm)
+	bool IsReachable(const mat4x4 &T) const;
+	bool IsHopeless(const mat4x4 &T) const;			// 离可达区域两个体素以上，求逆解多半失败
+	// 一定不可达，可以不求逆解：腕部中心超出臂展（地图没有打开时也判断），或离可达区域UnreachableVoxels个体素以上
+	bool IsUnreachable(const mat4x4 &T) const;
+	double ArmAngleMargin(const mat4x4 &T) const;		// 臂角可行范围的宽度(rad)
+
+private:
+	ReachMap(const ReachMap &);
+	ReachMap &operator=(const ReachMap &);
+
+	// 在后台调用ReachMap::Open，使用OpenAsync时复制的求解器
+	class BuildThread : public QThread
+	{
+	public:
+		explicit BuildThread(ReachMap &map);
+
+	protected:
+		void run();
+
+	private:
+		ReachMap &m_Map;
+	};
+
+	static void FillHeader(Header &header, const solver_type &solver, double voxel, int samples);
+	static double Reach(const solver_type &solver);		// 肩部（基坐标原点）到腕部中心的最大距离(mm)
+	// Open、Load和Close的实现，不等待后台生成，后台线程中也调用
+	bool OpenFile(const QString &path, const solver_type &solver, double voxel, int samples, int thread_count);
+	bool Map(const QString &path, const solver_type &solver);
+	void Unmap();
+	const Voxel *Find(const Header *header, const mat4x4 &T) const;		// 地图范围外返回0
+
+	QFile m_File;				// 映射在文件关闭时解除，保持打开；生成期间只由后台线程访问
+	// 体素紧接在文件头之后。映射完成后才写入，查询只读一次，因此可以与后台生成同时进行
+	QAtomicPointer<const Header> m_Header;
+	// Open、OpenAsync或Load时由求解器得到：臂展（0表示未知）和腕部中心到末端的距离L3
+	double m_Reach;
+	double m_WristOffset;
+
+	BuildThread m_BuildThread;
+	// OpenAsync的参数；求解器复制一份，控制线程同时在使用原来的求解器
+	solver_type m_BuildSolver;
+	QString m_BuildPath;
+	double m_BuildVoxel;
+	int m_BuildSamples;
+	int m_BuildThreadCount;
+};
+
+#endif
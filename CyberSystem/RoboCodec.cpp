@@ -0,0 +1,186 @@
+#include "RoboCodec.h"
+
+#include <cstring>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define ROBO_CODEC_SSE2
+#include <emmintrin.h>
+#endif
+
+#define ROBO_MEMBER(m) offsetof(CRobonautData, m)
+
+const RoboField RoboCodec::CommandTable[] =
+{
+	{0, 1, U16, ROBO_MEMBER(count)},
+	{2, 1, U16, ROBO_MEMBER(CtlMode)},
+	{8, 7, Fixed, ROBO_MEMBER(leftArmJoint)},
+	{36, 7, Fixed, ROBO_MEMBER(rightArmJoint)},
+	{64, 3, Fixed, ROBO_MEMBER(headJoint)},
+	{76, 2, Fixed, ROBO_MEMBER(waistJoint)}
+};
+const int RoboCodec::CommandFields = sizeof(RoboCodec::CommandTable)/sizeof(RoboCodec::CommandTable[0]);
+
+const RoboField RoboCodec::SensorTable[] =
+{
+	{0, 1, U16, ROBO_MEMBER(count)},
+	{2, 1, U16, ROBO_MEMBER(CtlMode)},
+	{4, 7, Fixed, ROBO_MEMBER(leftArmJoint)},
+	{32, 7, Fixed, ROBO_MEMBER(rightArmJoint)},
+	{60, 3, Fixed, ROBO_MEMBER(headJoint)},
+	{72, 2, Fixed, ROBO_MEMBER(waistJoint)},
+	{80, 7, Fixed, ROBO_MEMBER(LeftJointFT)},
+	{108, 7, Fixed, ROBO_MEMBER(RightJointFT)}
+};
+const int RoboCodec::SensorFields = sizeof(RoboCodec::SensorTable)/sizeof(RoboCodec::SensorTable[0]);
+
+// 运行标志、力判断标志等不在CRobonautData中的int32
+static void PutI32(char dst[], int v)
+{
+	unsigned int u = (unsigned int)v;
+	dst[0] = (char)(u & 0xFF);
+	dst[1] = (char)((u >> 8) & 0xFF);
+	dst[2] = (char)((u >> 16) & 0xFF);
+	dst[3] = (char)((u >> 24) & 0xFF);
+}
+
+static int GetI32(const char src[])
+{
+	const unsigned char *p = (const unsigned char *)src;
+	return (int)(p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24));
+}
+
+void RoboCodec::EncodeCommand(int runFlag, const CRobonautData &data, char buffer[])
+{
+	Encode(CommandTable, CommandFields, data, buffer);
+	PutI32(&buffer[4], runFlag);
+}
+
+void RoboCodec::DecodeCommand(const char buffer[], int &runFlag, CRobonautData &data)
+{
+	Decode(CommandTable, CommandFields, buffer, data);
+	runFlag = GetI32(&buffer[4]);
+}
+
+void RoboCodec::EncodeSensor(const CRobonautData &data, int decideFlag, char buffer[])
+{
+	Encode(SensorTable, SensorFields, data, buffer);
+	PutI32(&buffer[136], decideFlag);
+}
+
+void RoboCodec::DecodeSensor(const char buffer[], CRobonautData &data, int &decideFlag)
+{
+	// 4..135的33个定点数在包中连续，一次转换后再按定长复制到各成员（顺序同SensorTable）；
+	// 按字段表逐段转换时7、3、2个的短段都要走重叠或逐个转换，按表变长复制则要调用memcpy，都比原来的逐个拼接慢
+	float values[SensorFixedCount];
+	Decode(SensorTable, 2, buffer, data);
+	FixedToFloat(&buffer[4], SensorFixedCount, values);
+	memcpy(data.leftArmJoint, &values[0], sizeof(data.leftArmJoint));
+	memcpy(data.rightArmJoint, &values[7], sizeof(data.rightArmJoint));
+	memcpy(data.headJoint, &values[14], sizeof(data.headJoint));
+	memcpy(data.waistJoint, &values[17], sizeof(data.waistJoint));
+	memcpy(data.LeftJointFT, &values[19], sizeof(data.LeftJointFT));
+	memcpy(data.RightJointFT, &values[26], sizeof(data.RightJointFT));
+	decideFlag = GetI32(&buffer[136]);
+}
+
+void RoboCodec::Encode(const RoboField table[], int fields, const CRobonautData &data, char buffer[])
+{
+	const char *base = (const char *)&data;
+	for (int f = 0; f < fields; ++f)
+	{
+		const RoboField &field = table[f];
+		char *dst = &buffer[field.offset];
+		if (field.type == Fixed)
+		{
+			FloatToFixed((const float *)(base + field.member), field.count, dst);
+		}
+		else
+		{
+			// int成员只发送低16位
+			const int *src = (const int *)(base + field.member);
+			for (int i = 0; i < field.count; ++i)
+			{
+				dst[2*i] = (char)(src[i] & 0xFF);
+				dst[2*i + 1] = (char)((src[i] >> 8) & 0xFF);
+			}
+		}
+	}
+}
+
+void RoboCodec::Decode(const RoboField table[], int fields, const char buffer[], CRobonautData &data)
+{
+	char *base = (char *)&data;
+	for (int f = 0; f < fields; ++f)
+	{
+		const RoboField &field = table[f];
+		const char *src = &buffer[field.offset];
+		if (field.type == Fixed)
+		{
+			FixedToFloat(src, field.count, (float *)(base + field.member));
+		}
+		else
+		{
+			const unsigned char *p = (const unsigned char *)src;
+			int *dst = (int *)(base + field.member);
+			for (int i = 0; i < field.count; ++i)
+			{
+				dst[i] = p[2*i] | (p[2*i + 1] << 8);
+			}
+		}
+	}
+}
+
+// 原来的int(x*10000)：float乘int，标量部分照原样写，无论x87还是SSE2都与原来逐字节拼接的结果一致；
+// SSE2时编译器同样按float相乘再截断，因此4个一组的_mm_mul_ps与之逐位相同
+void RoboCodec::FloatToFixed(const float src[], int n, char dst[])
+{
+	int i = 0;
+#ifdef ROBO_CODEC_SSE2
+	const __m128 scale = _mm_set1_ps((float)ROBO_FIXED_SCALE);
+	for (; i + 4 <= n; i += 4)
+	{
+		_mm_storeu_si128((__m128i *)&dst[4*i], _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(&src[i]), scale)));
+	}
+	if (i < n && n >= 4)
+	{
+		// 余下不足4个时，最后4个重叠着再转换一次，代替逐个转换
+		i = n - 4;
+		_mm_storeu_si128((__m128i *)&dst[4*i], _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(&src[i]), scale)));
+		i = n;
+	}
+#endif
+	for (; i < n; ++i)
+	{
+		PutI32(&dst[4*i], int(src[i]*ROBO_FIXED_SCALE));
+	}
+}
+
+// 原来的MAKELONG(...)*0.0001：int32乘0.0001（double）后转为float
+void RoboCodec::FixedToFloat(const char src[], int n, float dst[])
+{
+	const double inv_scale = 1.0/ROBO_FIXED_SCALE;
+	int i = 0;
+#ifdef ROBO_CODEC_SSE2
+	const __m128d scale = _mm_set1_pd(inv_scale);
+	for (; i + 4 <= n; i += 4)
+	{
+		const __m128i v = _mm_loadu_si128((const __m128i *)&src[4*i]);
+		const __m128 lo = _mm_cvtpd_ps(_mm_mul_pd(_mm_cvtepi32_pd(v), scale));
+		const __m128 hi = _mm_cvtpd_ps(_mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(v, 8)), scale));
+		_mm_storeu_ps(&dst[i], _mm_movelh_ps(lo, hi));
+	}
+	if (i < n && n >= 4)
+	{
+		i = n - 4;
+		const __m128i v = _mm_loadu_si128((const __m128i *)&src[4*i]);
+		const __m128 lo = _mm_cvtpd_ps(_mm_mul_pd(_mm_cvtepi32_pd(v), scale));
+		const __m128 hi = _mm_cvtpd_ps(_mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(v, 8)), scale));
+		_mm_storeu_ps(&dst[i], _mm_movelh_ps(lo, hi));
+		i = n;
+	}
+#endif
+	for (; i < n; ++i)
+	{
+		dst[i] = (float)(GetI32(&src[4*i])*inv_scale);
+	}
+}
@@ -0,0 +1,58 @@
+#ifndef ROBOCODEC_H
+#define ROBOCODEC_H
+
+#include <cstddef>
+#include "RobonautData.h"
+
+// 关节角、关节力按定点数传输：int32 = 角度*ROBO_FIXED_SCALE，截断取整
+#define ROBO_FIXED_SCALE 10000
+
+// 机器人UDP包中连续的一组字段
+struct RoboField
+{
+	int offset;			// 包中的字节偏移
+	int count;			// 元素个数，连续存放
+	int type;			// RoboCodec::FieldType
+	size_t member;		// CRobonautData中的成员偏移
+};
+
+// 机器人宇航员中控UDP包的编解码，由字段表驱动。
+// 所有字段按小端存放：U16为无符号16位，Fixed为float与int32定点数的转换，
+// 整个关节数组一次转换（SSE2时每次4个）。定点转换与原来逐字节拼接的int(x*10000)、MAKELONG(...)*0.0001逐位一致。
+// 命令包：0计数，2控制方式，4运行标志(int32)，8左臂7关节，36右臂7关节，64头部3关节，76腰部2关节，共84字节；
+// 传感器包：0计数，2控制方式，4左臂，32右臂，60头部，72腰部，80左臂关节力，108右臂关节力，136力判断标志(int32)，共140字节。
+class RoboCodec
+{
+public:
+	enum FieldType
+	{
+		U16,
+		Fixed
+	};
+	enum
+	{
+		CommandSize = 84,
+		SensorSize = 140,
+		SensorFixedCount = 33		// 传感器包4..135连续的定点数
+	};
+
+	static void EncodeCommand(int runFlag, const CRobonautData &data, char buffer[]);
+	static void DecodeCommand(const char buffer[], int &runFlag, CRobonautData &data);
+	static void EncodeSensor(const CRobonautData &data, int decideFlag, char buffer[]);
+	static void DecodeSensor(const char buffer[], CRobonautData &data, int &decideFlag);
+
+	// 按字段表编解码，不在表中的字节不变
+	static void Encode(const RoboField table[], int fields, const CRobonautData &data, char buffer[]);
+	static void Decode(const RoboField table[], int fields, const char buffer[], CRobonautData &data);
+
+	// n个float与小端int32定点数之间的转换
+	static void FloatToFixed(const float src[], int n, char dst[]);
+	static void FixedToFloat(const char src[], int n, float dst[]);
+
+	static const RoboField CommandTable[];
+	static const int CommandFields;
+	static const RoboField SensorTable[];
+	static const int SensorFields;
+};
+
+#endif
@@ -6,9 +6,9 @@
 
 
 // declare global variable for interconnection
-extern CRobonautData g_RobotCmdDeg;     //ȫֻ˿ָλǶ
-extern CRobonautData g_SRobotCmdDeg;    //͵İȫ˿ָλǶ
-extern CRobonautData g_RobotSensorDeg;  //ȫֻ˴ݵλǶ
+extern CRobonautData g_RobotCmdDeg;     //全局机器人控制指令单位角度
+extern CRobonautData g_SRobotCmdDeg;    //发送的安全机器人控制指令单位角度
+extern CRobonautData g_RobotSensorDeg;  //全局机器人传感器数据单位角度
 
 // declare global variable for interconnection
 extern float rTrackerRealPose[6];
@@ -30,17 +30,20 @@ RobonautControl *g_pRobonautCtrl;
 // Collision flag
 int g_nCollisionFlag=0;
 
-//ը־λ333أ222
+//爆炸标志位333关，222开
 int g_nRunFlag=222; 
 
 
 RobonautControl::RobonautControl()
+	: m_RoboSenseLink(m_ServerSocketRobo)
+	, m_HandSenseLink(m_ReceiveClientHand, m_HandCodec)
 {
 	g_pRobonautCtrl = this;
 
 	// Initialize data
 	m_bConsimuSockConn = false;
 	m_nPCount = 0;
+	m_nPReplyCount = 0;
 
 	m_nRCount = 0;
 
@@ -55,13 +58,15 @@ RobonautControl::RobonautControl()
 	m_HandInit = 0;
 	m_HandEnable = 0;
 	m_HandStop = 0;
+	m_HandCodec.SetBinaryEnabled(HAND_BINARY_PROTOCOL != 0);
 }
 
 RobonautControl::~RobonautControl()
 {
-	closesocket(m_ClientSocketPredictive.m_hSocket);
+	// 先停止接收，之后才能关闭套接字
+	m_LinkReactor.Stop();
+	m_ConsimuLink.Disconnect();
 	WSACleanup();
-	m_ClientSocketPredictive.m_hSocket = NULL;
 
 	m_ServerSocketRobo.CloseSock();
 	m_ClientSocketRobo.CloseSock();
@@ -69,6 +74,13 @@ RobonautControl::~RobonautControl()
 
 
 
+LinkReactor &RobonautControl::Reactor()
+{
+	return m_LinkReactor;
+}
+
+
+
 //*********************** Consimulation Options ***********************//
 // When there is no Socket Conncted(m_bConsimuSockConn == false), then Connect
 // If Connect Success, Return True
@@ -80,9 +92,10 @@ bool RobonautControl::ConnConsimu()
 		UINT PREDICTIVE_Port = PREDICTIVE_PORT; 
 		char *pPREDICTIVE_IP = PREDICTIVE_IP;
 
-		int ret = m_ClientSocketPredictive.ConnectServer(pPREDICTIVE_IP,PREDICTIVE_Port);
+		int ret = m_ConsimuLink.Connect(pPREDICTIVE_IP,PREDICTIVE_Port);
 		if (ret == 0)
 		{
+			m_LinkReactor.Add(&m_ConsimuLink);
 			QMessageBox::about(NULL, "About", "Communication is connected");
 			m_bConsimuSockConn = true;
 		}
@@ -92,9 +105,10 @@ bool RobonautControl::ConnConsimu()
 
 
 
-// TODO(CJH): Add Disconnect Function
 bool RobonautControl::DisConnConsimu()
 {
+	m_LinkReactor.Remove(&m_ConsimuLink);
+	m_ConsimuLink.Disconnect();
 	m_bConsimuSockConn = false;
 	return true;
 }
@@ -103,68 +117,38 @@ bool RobonautControl::DisConnConsimu()
 
 // TODO(CJH): Do not Use Global Variable
 // Send Consimulation Msg, when Consimulation Socket is Connected
+// 不等待应答：先取上次发送以来到达的应答（碰撞标志、安全关节角），再发送本周期的指令
 bool RobonautControl::SendConsimuMsg()
 {
 	if (m_bConsimuSockConn == true)
 	{
-		for (int i=0;i<7;i++)
+		if (m_ConsimuLink.IsStalled())
 		{
-			g_RobotCmdDeg.rightArmJoint[i] = g_rightArmJointBuf[i];
-			g_RobotCmdDeg.leftArmJoint[i] = g_leftArmJointBuf[i];
-		}
-		m_nPCount++;
-
-		// get the format data sending to simulation
-		sprintf(cSendbufferp, "%d,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f\n",m_nPCount,
-			g_RobotCmdDeg.leftArmJoint[0],g_RobotCmdDeg.leftArmJoint[1],g_RobotCmdDeg.leftArmJoint[2],g_RobotCmdDeg.leftArmJoint[3],
-			g_RobotCmdDeg.leftArmJoint[4],g_RobotCmdDeg.leftArmJoint[5],g_RobotCmdDeg.leftArmJoint[6],g_RobotCmdDeg.rightArmJoint[0],
-			g_RobotCmdDeg.rightArmJoint[1],g_RobotCmdDeg.rightArmJoint[2],g_RobotCmdDeg.rightArmJoint[3],g_RobotCmdDeg.rightArmJoint[4],
-			g_RobotCmdDeg.rightArmJoint[5],g_RobotCmdDeg.rightArmJoint[6],g_RobotCmdDeg.headJoint[0],g_RobotCmdDeg.headJoint[1],
-			g_RobotCmdDeg.headJoint[2],g_RobotCmdDeg.waistJoint[0],g_RobotCmdDeg.waistJoint[1]);
-
-		int retSendData= m_ClientSocketPredictive.SendData(cSendbufferp);
-
-		int retReceiveData = m_ClientSocketPredictive.ReceiveData(cRevbufferp);
-
-		sscanf(cRevbufferp, "%d,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f\n",&g_nCollisionFlag,
-			&g_SRobotCmdDeg.leftArmJoint[0],&g_SRobotCmdDeg.leftArmJoint[1],&g_SRobotCmdDeg.leftArmJoint[2],&g_SRobotCmdDeg.leftArmJoint[3],
-			&g_SRobotCmdDeg.leftArmJoint[4],&g_SRobotCmdDeg.leftArmJoint[5],&g_SRobotCmdDeg.leftArmJoint[6],&g_SRobotCmdDeg.rightArmJoint[0],
-			&g_SRobotCmdDeg.rightArmJoint[1],&g_SRobotCmdDeg.rightArmJoint[2],&g_SRobotCmdDeg.rightArmJoint[3],&g_SRobotCmdDeg.rightArmJoint[4],
-			&g_SRobotCmdDeg.rightArmJoint[5],&g_SRobotCmdDeg.rightArmJoint[6],&g_SRobotCmdDeg.headJoint[0],&g_SRobotCmdDeg.headJoint[1],
-			&g_SRobotCmdDeg.headJoint[2],&g_SRobotCmdDeg.waistJoint[0],&g_SRobotCmdDeg.waistJoint[1]);
-
-		if(retReceiveData==0)
-		{
-			QString strReceiveData;
-			strReceiveData = QString("CollisionFlag: %1\r\n").arg(g_nCollisionFlag);
-
-			if (g_nCollisionFlag!=0)
+			// 仿真停止应答或反应器已不再接收（连接断开、数据流错位）：重新连接，清空在途指令，之后的应答不会与旧指令错位
+			m_LinkReactor.Remove(&m_ConsimuLink);
+			if (m_ConsimuLink.Reconnect() != 0)
 			{
-				//				       g_RobotCmdDeg.flag=FALSE;		
+				m_bConsimuSockConn = false;
+				return false;
 			}
-			//SetDlgItemText(IDC_EDITCOLLISIONFLAG,strReceiveData);
-
-		}	
-		float mmmionij=0.0;
+			m_LinkReactor.Add(&m_ConsimuLink);
+		}
 
-		if (g_nCollisionFlag!=0)
+		int reply_count = 0;
+		if (m_ConsimuLink.TakeReply(reply_count, g_nCollisionFlag, g_SRobotCmdDeg))
 		{
-			mmmionij=1;
+			m_nPReplyCount = reply_count;
 		}
-		else
-		{
 
-			mmmionij=0;
-		}
-		
-		// Send and Recv Success
-		if (retSendData == 0 && retReceiveData == 0)
+		for (int i=0;i<7;i++)
 		{
-			return true;
-		}
-		else{
-			return false;
+			g_RobotCmdDeg.rightArmJoint[i] = g_rightArmJointBuf[i];
+			g_RobotCmdDeg.leftArmJoint[i] = g_leftArmJointBuf[i];
 		}
+		m_nPCount++;
+
+		// Send Success, the reply is taken by a later call
+		return m_ConsimuLink.Send(m_nPCount, g_RobotCmdDeg);
 	}
 
 	// Socket is not Connected
@@ -173,13 +157,23 @@ bool RobonautControl::SendConsimuMsg()
 	}
 }
 
+ConsimuStats RobonautControl::GetConsimuStats() const
+{
+	return m_ConsimuLink.GetStats();
+}
+
 
 
 //*********************** Robonaut control Options ***********************//
 bool RobonautControl::ConnRobo()
 {
+	m_LinkReactor.Remove(&m_RoboSenseLink);
 	bool ret_server = m_ServerSocketRobo.Init(ROB_TELE_IP, ROB_TELE_PORT);
 	bool ret_client = m_ClientSocketRobo.Init(ROB_CONTRL_IP, ROB_CONTRL_PORT);
+	if (ret_server == true)
+	{
+		m_LinkReactor.Add(&m_RoboSenseLink);
+	}
 	return (ret_server && ret_client);
 }
 
@@ -187,6 +181,7 @@ bool RobonautControl::ConnRobo()
 // TODO(CJH): How to disconnect a socket
 bool RobonautControl::DisConnRobo()
 {
+	m_LinkReactor.Remove(&m_RoboSenseLink);
 	bool ret_server = m_ServerSocketRobo.CloseSock();
 	bool ret_client = m_ClientSocketRobo.CloseSock();
 	return (ret_server && ret_client);
@@ -196,62 +191,16 @@ bool RobonautControl::DisConnRobo()
 // TODO(CJH): Do not use global variable
 bool RobonautControl::RecvRoboMsg()
 {
-	bool ret_flag = m_ServerSocketRobo.Recv(cRevbufferp,sizeof(cRevbufferp));
-
-	if (ret_flag == true)
+	RoboSense sense;
+	if (m_RoboSenseLink.Latest().Take(sense) == false)
 	{
-		g_RobotSensorDeg.count = MAKEWORD(cRevbufferp[0],cRevbufferp[1]);
-		g_RobotSensorDeg.CtlMode = MAKEWORD(cRevbufferp[2],cRevbufferp[3]);
-
-		//
-		g_RobotSensorDeg.leftArmJoint[0] = MAKELONG(MAKEWORD(cRevbufferp[4],cRevbufferp[5]),MAKEWORD(cRevbufferp[6],cRevbufferp[7]))*0.0001;
-		g_RobotSensorDeg.leftArmJoint[1] = MAKELONG(MAKEWORD(cRevbufferp[8],cRevbufferp[9]),MAKEWORD(cRevbufferp[10],cRevbufferp[11]))*0.0001;
-		g_RobotSensorDeg.leftArmJoint[2] = MAKELONG(MAKEWORD(cRevbufferp[12],cRevbufferp[13]),MAKEWORD(cRevbufferp[14],cRevbufferp[15]))*0.0001;
-		g_RobotSensorDeg.leftArmJoint[3] = MAKELONG(MAKEWORD(cRevbufferp[16],cRevbufferp[17]),MAKEWORD(cRevbufferp[18],cRevbufferp[19]))*0.0001;
-		g_RobotSensorDeg.leftArmJoint[4] = MAKELONG(MAKEWORD(cRevbufferp[20],cRevbufferp[21]),MAKEWORD(cRevbufferp[22],cRevbufferp[23]))*0.0001;
-		g_RobotSensorDeg.leftArmJoint[5] = MAKELONG(MAKEWORD(cRevbufferp[24],cRevbufferp[25]),MAKEWORD(cRevbufferp[26],cRevbufferp[27]))*0.0001;
-		g_RobotSensorDeg.leftArmJoint[6] = MAKELONG(MAKEWORD(cRevbufferp[28],cRevbufferp[29]),MAKEWORD(cRevbufferp[30],cRevbufferp[31]))*0.0001;		
-
-		//ұ
-		g_RobotSensorDeg.rightArmJoint[0] = MAKELONG(MAKEWORD(cRevbufferp[32],cRevbufferp[33]),MAKEWORD(cRevbufferp[34],cRevbufferp[35]))*0.0001;
-		g_RobotSensorDeg.rightArmJoint[1] = MAKELONG(MAKEWORD(cRevbufferp[36],cRevbufferp[37]),MAKEWORD(cRevbufferp[38],cRevbufferp[39]))*0.0001;
-		g_RobotSensorDeg.rightArmJoint[2] = MAKELONG(MAKEWORD(cRevbufferp[40],cRevbufferp[41]),MAKEWORD(cRevbufferp[42],cRevbufferp[43]))*0.0001;
-		g_RobotSensorDeg.rightArmJoint[3] = MAKELONG(MAKEWORD(cRevbufferp[44],cRevbufferp[45]),MAKEWORD(cRevbufferp[46],cRevbufferp[47]))*0.0001;
-		g_RobotSensorDeg.rightArmJoint[4] = MAKELONG(MAKEWORD(cRevbufferp[48],cRevbufferp[49]),MAKEWORD(cRevbufferp[50],cRevbufferp[51]))*0.0001;
-		g_RobotSensorDeg.rightArmJoint[5] = MAKELONG(MAKEWORD(cRevbufferp[52],cRevbufferp[53]),MAKEWORD(cRevbufferp[54],cRevbufferp[55]))*0.0001;
-		g_RobotSensorDeg.rightArmJoint[6] = MAKELONG(MAKEWORD(cRevbufferp[56],cRevbufferp[57]),MAKEWORD(cRevbufferp[58],cRevbufferp[59]))*0.0001;	
-
-		//ͷ
-		g_RobotSensorDeg.headJoint[0] = MAKELONG(MAKEWORD(cRevbufferp[60],cRevbufferp[61]),MAKEWORD(cRevbufferp[62],cRevbufferp[63]))*0.0001;
-		g_RobotSensorDeg.headJoint[1] = MAKELONG(MAKEWORD(cRevbufferp[64],cRevbufferp[65]),MAKEWORD(cRevbufferp[66],cRevbufferp[67]))*0.0001;
-		g_RobotSensorDeg.headJoint[2] = MAKELONG(MAKEWORD(cRevbufferp[68],cRevbufferp[69]),MAKEWORD(cRevbufferp[70],cRevbufferp[71]))*0.0001;
-
-		//
-		g_RobotSensorDeg.waistJoint[0] = MAKELONG(MAKEWORD(cRevbufferp[72],cRevbufferp[73]),MAKEWORD(cRevbufferp[74],cRevbufferp[75]))*0.0001;
-		g_RobotSensorDeg.waistJoint[1] = MAKELONG(MAKEWORD(cRevbufferp[76],cRevbufferp[77]),MAKEWORD(cRevbufferp[78],cRevbufferp[79]))*0.0001;
-
-		//ұ۹ؽ
-		g_RobotSensorDeg.RightJointFT[0] = MAKELONG(MAKEWORD(cRevbufferp[108],cRevbufferp[109]),MAKEWORD(cRevbufferp[110],cRevbufferp[111]))*0.0001;;
-		g_RobotSensorDeg.RightJointFT[1] = MAKELONG(MAKEWORD(cRevbufferp[112],cRevbufferp[113]),MAKEWORD(cRevbufferp[114],cRevbufferp[115]))*0.0001;;
-		g_RobotSensorDeg.RightJointFT[2] = MAKELONG(MAKEWORD(cRevbufferp[116],cRevbufferp[117]),MAKEWORD(cRevbufferp[118],cRevbufferp[119]))*0.0001;;
-		g_RobotSensorDeg.RightJointFT[3] = MAKELONG(MAKEWORD(cRevbufferp[120],cRevbufferp[121]),MAKEWORD(cRevbufferp[122],cRevbufferp[123]))*0.0001;;
-		g_RobotSensorDeg.RightJointFT[4] = MAKELONG(MAKEWORD(cRevbufferp[124],cRevbufferp[125]),MAKEWORD(cRevbufferp[126],cRevbufferp[127]))*0.0001;;
-		g_RobotSensorDeg.RightJointFT[5] = MAKELONG(MAKEWORD(cRevbufferp[128],cRevbufferp[129]),MAKEWORD(cRevbufferp[130],cRevbufferp[131]))*0.0001;;
-		g_RobotSensorDeg.RightJointFT[6] = MAKELONG(MAKEWORD(cRevbufferp[132],cRevbufferp[133]),MAKEWORD(cRevbufferp[134],cRevbufferp[135]))*0.0001;;
-
-		//۹ؽ
-		g_RobotSensorDeg.LeftJointFT[0] = MAKELONG(MAKEWORD(cRevbufferp[80],cRevbufferp[81]),MAKEWORD(cRevbufferp[82],cRevbufferp[83]))*0.0001;
-		g_RobotSensorDeg.LeftJointFT[1] = MAKELONG(MAKEWORD(cRevbufferp[84],cRevbufferp[85]),MAKEWORD(cRevbufferp[86],cRevbufferp[87]))*0.0001;
-		g_RobotSensorDeg.LeftJointFT[2] = MAKELONG(MAKEWORD(cRevbufferp[88],cRevbufferp[89]),MAKEWORD(cRevbufferp[90],cRevbufferp[91]))*0.0001;
-		g_RobotSensorDeg.LeftJointFT[3] = MAKELONG(MAKEWORD(cRevbufferp[92],cRevbufferp[93]),MAKEWORD(cRevbufferp[94],cRevbufferp[95]))*0.0001;
-		g_RobotSensorDeg.LeftJointFT[4] = MAKELONG(MAKEWORD(cRevbufferp[96],cRevbufferp[97]),MAKEWORD(cRevbufferp[98],cRevbufferp[99]))*0.0001;
-		g_RobotSensorDeg.LeftJointFT[5] = MAKELONG(MAKEWORD(cRevbufferp[100],cRevbufferp[101]),MAKEWORD(cRevbufferp[102],cRevbufferp[103]))*0.0001;
-		g_RobotSensorDeg.LeftJointFT[6] = MAKELONG(MAKEWORD(cRevbufferp[104],cRevbufferp[105]),MAKEWORD(cRevbufferp[106],cRevbufferp[107]))*0.0001;
-
-		//жϱ־
-		m_DecideFlag = MAKELONG(MAKEWORD(cRevbufferp[136],cRevbufferp[137]),MAKEWORD(cRevbufferp[138],cRevbufferp[139]));
+		return false;
 	}
-	return ret_flag;
+
+	// 关节角、关节力及力判断标志，其余字段在传感器包中没有，保持不变
+	g_RobotSensorDeg = sense.data;
+	m_DecideFlag = sense.decideFlag;
+	return true;
 }
 
 // TODO(CJH): change
@@ -267,17 +216,17 @@ bool RobonautControl::SendRoboMsg()
 		g_RobotCmdDeg.leftArmJoint[i] = g_leftArmJointBuf[i];
 	}
 	
-	// λ
-	SETRANGE(g_RobotCmdDeg.leftArmJoint[0], -49, 170);
-	SETRANGE(g_RobotCmdDeg.leftArmJoint[1], -100, 70);
-	SETRANGE(g_RobotCmdDeg.leftArmJoint[2], -120, 120);
-	SETRANGE(g_RobotCmdDeg.leftArmJoint[3], -129, 0);
-	SETRANGE(g_RobotCmdDeg.leftArmJoint[4], -120, 120);
-	SETRANGE(g_RobotCmdDeg.leftArmJoint[5], -90, 90);
-	SETRANGE(g_RobotCmdDeg.leftArmJoint[6], -120, 120);
+	// 限位
+	SETRANGE(g_RobotCmdDeg.leftArmJoint[0], ROBO_LJ0_MIN, ROBO_LJ0_MAX);
+	SETRANGE(g_RobotCmdDeg.leftArmJoint[1], ROBO_LJ1_MIN, ROBO_LJ1_MAX);
+	SETRANGE(g_RobotCmdDeg.leftArmJoint[2], ROBO_LJ2_MIN, ROBO_LJ2_MAX);
+	SETRANGE(g_RobotCmdDeg.leftArmJoint[3], ROBO_LJ3_MIN, ROBO_LJ3_MAX);
+	SETRANGE(g_RobotCmdDeg.leftArmJoint[4], ROBO_LJ4_MIN, ROBO_LJ4_MAX);
+	SETRANGE(g_RobotCmdDeg.leftArmJoint[5], ROBO_LJ5_MIN, ROBO_LJ5_MAX);
+	SETRANGE(g_RobotCmdDeg.leftArmJoint[6], ROBO_LJ6_MIN, ROBO_LJ6_MAX);
 	ADDCOUNT(g_RobotCmdDeg.count, 1000);
 
-	// תΪɷ͵buffer		
+	// 转换数据为可发送的buffer		
 	RoboDataCnv(g_nRunFlag, g_RobotCmdDeg, cSendRobotCommandBuffer);
 	
 	bool ret_flag = m_ClientSocketRobo.Send(cSendRobotCommandBuffer, sizeof(cSendRobotCommandBuffer)); 
@@ -293,7 +242,7 @@ bool RobonautControl::SendRoboMsg()
 		QMessageBox::about(NULL, "About", "Send Error!");  
 	}
 
-	//
+	//保存数据
 	CString cstemp;
 	cstemp.Format(_T("%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\r\n"),
 		g_RobotCmdDeg.rightArmJoint[0],g_RobotCmdDeg.rightArmJoint[1],g_RobotCmdDeg.rightArmJoint[2],
@@ -311,117 +260,7 @@ bool RobonautControl::SendRoboMsg()
 // TODO(CJH): change function input name
 void RobonautControl::RoboDataCnv(const int &g_nRunFlag, const CRobonautData &g_RobotCmdDeg, char cSendRobotCommandBuffer[])
 {
-	cSendRobotCommandBuffer[0] = LOBYTE(LOWORD(g_RobotCmdDeg.count));         //??????
-	cSendRobotCommandBuffer[1] = HIBYTE(LOWORD(g_RobotCmdDeg.count));         //??????
-
-	cSendRobotCommandBuffer[2] = LOBYTE(LOWORD(g_RobotCmdDeg.CtlMode));         //????:??(1)/????(2)
-	cSendRobotCommandBuffer[3] = HIBYTE(LOWORD(g_RobotCmdDeg.CtlMode));         //????:??(1)/????(2)
-
-	cSendRobotCommandBuffer[4] = LOBYTE(LOWORD(g_nRunFlag));  //
-	cSendRobotCommandBuffer[5] = HIBYTE(LOWORD(g_nRunFlag));   
-
-	cSendRobotCommandBuffer[6] = LOBYTE(HIWORD(g_nRunFlag));  //
-	cSendRobotCommandBuffer[7] = HIBYTE(HIWORD(g_nRunFlag));   
-
-	//??
-	cSendRobotCommandBuffer[8] = LOBYTE(LOWORD(int(g_RobotCmdDeg.leftArmJoint[0]*10000)));         //??1???
-	cSendRobotCommandBuffer[9] = HIBYTE(LOWORD(int(g_RobotCmdDeg.leftArmJoint[0]*10000)));         
-	cSendRobotCommandBuffer[10] = LOBYTE(HIWORD(int(g_RobotCmdDeg.leftArmJoint[0]*10000)));         
-	cSendRobotCommandBuffer[11] = HIBYTE(HIWORD(int(g_RobotCmdDeg.leftArmJoint[0]*10000)));         
-
-	cSendRobotCommandBuffer[12] = LOBYTE(LOWORD(int(g_RobotCmdDeg.leftArmJoint[1]*10000)));         //??2???
-	cSendRobotCommandBuffer[13] = HIBYTE(LOWORD(int(g_RobotCmdDeg.leftArmJoint[1]*10000)));         
-	cSendRobotCommandBuffer[14] = LOBYTE(HIWORD(int(g_RobotCmdDeg.leftArmJoint[1]*10000)));        
-	cSendRobotCommandBuffer[15] = HIBYTE(HIWORD(int(g_RobotCmdDeg.leftArmJoint[1]*10000)));        
-
-	cSendRobotCommandBuffer[16] = LOBYTE(LOWORD(int(g_RobotCmdDeg.leftArmJoint[2]*10000)));        //??3???
-	cSendRobotCommandBuffer[17] = HIBYTE(LOWORD(int(g_RobotCmdDeg.leftArmJoint[2]*10000)));        
-	cSendRobotCommandBuffer[18] = LOBYTE(HIWORD(int(g_RobotCmdDeg.leftArmJoint[2]*10000)));        
-	cSendRobotCommandBuffer[19] = HIBYTE(HIWORD(int(g_RobotCmdDeg.leftArmJoint[2]*10000)));  
-
-	cSendRobotCommandBuffer[20] = LOBYTE(LOWORD(int(g_RobotCmdDeg.leftArmJoint[3]*10000)));        //??4???
-	cSendRobotCommandBuffer[21] = HIBYTE(LOWORD(int(g_RobotCmdDeg.leftArmJoint[3]*10000)));        
-	cSendRobotCommandBuffer[22] = LOBYTE(HIWORD(int(g_RobotCmdDeg.leftArmJoint[3]*10000)));        
-	cSendRobotCommandBuffer[23] = HIBYTE(HIWORD(int(g_RobotCmdDeg.leftArmJoint[3]*10000)));        
-
-	cSendRobotCommandBuffer[24] = LOBYTE(LOWORD(int(g_RobotCmdDeg.leftArmJoint[4]*10000)));        //??5???  
-	cSendRobotCommandBuffer[25] = HIBYTE(LOWORD(int(g_RobotCmdDeg.leftArmJoint[4]*10000)));        
-	cSendRobotCommandBuffer[26] = LOBYTE(HIWORD(int(g_RobotCmdDeg.leftArmJoint[4]*10000)));        
-	cSendRobotCommandBuffer[27] = HIBYTE(HIWORD(int(g_RobotCmdDeg.leftArmJoint[4]*10000)));        
-
-	cSendRobotCommandBuffer[28] = LOBYTE(LOWORD(int(g_RobotCmdDeg.leftArmJoint[5]*10000)));        //??6???   
-	cSendRobotCommandBuffer[29] = HIBYTE(LOWORD(int(g_RobotCmdDeg.leftArmJoint[5]*10000)));        
-	cSendRobotCommandBuffer[30] = LOBYTE(HIWORD(int(g_RobotCmdDeg.leftArmJoint[5]*10000)));        
-	cSendRobotCommandBuffer[31] = HIBYTE(HIWORD(int(g_RobotCmdDeg.leftArmJoint[5]*10000)));       
-
-	cSendRobotCommandBuffer[32] = LOBYTE(LOWORD(int(g_RobotCmdDeg.leftArmJoint[6]*10000)));          //?????   
-	cSendRobotCommandBuffer[33] = HIBYTE(LOWORD(int(g_RobotCmdDeg.leftArmJoint[6]*10000)));         
-	cSendRobotCommandBuffer[34] = LOBYTE(HIWORD(int(g_RobotCmdDeg.leftArmJoint[6]*10000)));         
-	cSendRobotCommandBuffer[35] = HIBYTE(HIWORD(int(g_RobotCmdDeg.leftArmJoint[6]*10000))); 	
-
-	//??
-	cSendRobotCommandBuffer[36] = LOBYTE(LOWORD(int(g_RobotCmdDeg.rightArmJoint[0]*10000)));         //??1???
-	cSendRobotCommandBuffer[37] = HIBYTE(LOWORD(int(g_RobotCmdDeg.rightArmJoint[0]*10000)));         
-	cSendRobotCommandBuffer[38] = LOBYTE(HIWORD(int(g_RobotCmdDeg.rightArmJoint[0]*10000)));         
-	cSendRobotCommandBuffer[39] = HIBYTE(HIWORD(int(g_RobotCmdDeg.rightArmJoint[0]*10000)));         
-
-	cSendRobotCommandBuffer[40] = LOBYTE(LOWORD(int(g_RobotCmdDeg.rightArmJoint[1]*10000)));         //??2???
-	cSendRobotCommandBuffer[41] = HIBYTE(LOWORD(int(g_RobotCmdDeg.rightArmJoint[1]*10000)));         
-	cSendRobotCommandBuffer[42] = LOBYTE(HIWORD(int(g_RobotCmdDeg.rightArmJoint[1]*10000)));        
-	cSendRobotCommandBuffer[43] = HIBYTE(HIWORD(int(g_RobotCmdDeg.rightArmJoint[1]*10000)));        
-
-	cSendRobotCommandBuffer[44] = LOBYTE(LOWORD(int(g_RobotCmdDeg.rightArmJoint[2]*10000)));        //??3???
-	cSendRobotCommandBuffer[45] = HIBYTE(LOWORD(int(g_RobotCmdDeg.rightArmJoint[2]*10000)));        
-	cSendRobotCommandBuffer[46] = LOBYTE(HIWORD(int(g_RobotCmdDeg.rightArmJoint[2]*10000)));        
-	cSendRobotCommandBuffer[47] = HIBYTE(HIWORD(int(g_RobotCmdDeg.rightArmJoint[2]*10000)));  
-
-	cSendRobotCommandBuffer[48] = LOBYTE(LOWORD(int(g_RobotCmdDeg.rightArmJoint[3]*10000)));        //??4???
-	cSendRobotCommandBuffer[49] = HIBYTE(LOWORD(int(g_RobotCmdDeg.rightArmJoint[3]*10000)));        
-	cSendRobotCommandBuffer[50] = LOBYTE(HIWORD(int(g_RobotCmdDeg.rightArmJoint[3]*10000)));        
-	cSendRobotCommandBuffer[51] = HIBYTE(HIWORD(int(g_RobotCmdDeg.rightArmJoint[3]*10000)));        
-
-	cSendRobotCommandBuffer[52] = LOBYTE(LOWORD(int(g_RobotCmdDeg.rightArmJoint[4]*10000)));        //??5???  
-	cSendRobotCommandBuffer[53] = HIBYTE(LOWORD(int(g_RobotCmdDeg.rightArmJoint[4]*10000)));        
-	cSendRobotCommandBuffer[54] = LOBYTE(HIWORD(int(g_RobotCmdDeg.rightArmJoint[4]*10000)));        
-	cSendRobotCommandBuffer[55] = HIBYTE(HIWORD(int(g_RobotCmdDeg.rightArmJoint[4]*10000)));        
-
-	cSendRobotCommandBuffer[56] = LOBYTE(LOWORD(int(g_RobotCmdDeg.rightArmJoint[5]*10000)));        //??6???   
-	cSendRobotCommandBuffer[57] = HIBYTE(LOWORD(int(g_RobotCmdDeg.rightArmJoint[5]*10000)));        
-	cSendRobotCommandBuffer[58] = LOBYTE(HIWORD(int(g_RobotCmdDeg.rightArmJoint[5]*10000)));        
-	cSendRobotCommandBuffer[59] = HIBYTE(HIWORD(int(g_RobotCmdDeg.rightArmJoint[5]*10000)));       
-
-	cSendRobotCommandBuffer[60] = LOBYTE(LOWORD(int(g_RobotCmdDeg.rightArmJoint[6]*10000)));          
-	cSendRobotCommandBuffer[61] = HIBYTE(LOWORD(int(g_RobotCmdDeg.rightArmJoint[6]*10000)));         
-	cSendRobotCommandBuffer[62] = LOBYTE(HIWORD(int(g_RobotCmdDeg.rightArmJoint[6]*10000)));         
-	cSendRobotCommandBuffer[63] = HIBYTE(HIWORD(int(g_RobotCmdDeg.rightArmJoint[6]*10000))); 
-
-	//??
-	cSendRobotCommandBuffer[64] = LOBYTE(LOWORD(int(g_RobotCmdDeg.headJoint[0]*10000)));         //??1???
-	cSendRobotCommandBuffer[65] = HIBYTE(LOWORD(int(g_RobotCmdDeg.headJoint[0]*10000)));         
-	cSendRobotCommandBuffer[66] = LOBYTE(HIWORD(int(g_RobotCmdDeg.headJoint[0]*10000)));         
-	cSendRobotCommandBuffer[67] = HIBYTE(HIWORD(int(g_RobotCmdDeg.headJoint[0]*10000)));         
-
-	cSendRobotCommandBuffer[68] = LOBYTE(LOWORD(int(g_RobotCmdDeg.headJoint[1]*10000)));         //??2???
-	cSendRobotCommandBuffer[69] = HIBYTE(LOWORD(int(g_RobotCmdDeg.headJoint[1]*10000)));         
-	cSendRobotCommandBuffer[70] = LOBYTE(HIWORD(int(g_RobotCmdDeg.headJoint[1]*10000)));        
-	cSendRobotCommandBuffer[71] = HIBYTE(HIWORD(int(g_RobotCmdDeg.headJoint[1]*10000)));        
-
-	cSendRobotCommandBuffer[72] = LOBYTE(LOWORD(int(g_RobotCmdDeg.headJoint[2]*10000)));        //??3???
-	cSendRobotCommandBuffer[73] = HIBYTE(LOWORD(int(g_RobotCmdDeg.headJoint[2]*10000)));        
-	cSendRobotCommandBuffer[74] = LOBYTE(HIWORD(int(g_RobotCmdDeg.headJoint[2]*10000)));        
-	cSendRobotCommandBuffer[75] = HIBYTE(HIWORD(int(g_RobotCmdDeg.headJoint[2]*10000)));
-
-	//??
-
-	cSendRobotCommandBuffer[76] = LOBYTE(LOWORD(int(g_RobotCmdDeg.waistJoint[0]*10000)));         //??1???
-	cSendRobotCommandBuffer[77] = HIBYTE(LOWORD(int(g_RobotCmdDeg.waistJoint[0]*10000)));         
-	cSendRobotCommandBuffer[78] = LOBYTE(HIWORD(int(g_RobotCmdDeg.waistJoint[0]*10000)));         
-	cSendRobotCommandBuffer[79] = HIBYTE(HIWORD(int(g_RobotCmdDeg.waistJoint[0]*10000)));         
-
-	cSendRobotCommandBuffer[80] = LOBYTE(LOWORD(int(g_RobotCmdDeg.waistJoint[1]*10000)));         //??2???
-	cSendRobotCommandBuffer[81] = HIBYTE(LOWORD(int(g_RobotCmdDeg.waistJoint[1]*10000)));         
-	cSendRobotCommandBuffer[82] = LOBYTE(HIWORD(int(g_RobotCmdDeg.waistJoint[1]*10000)));        
-	cSendRobotCommandBuffer[83] = HIBYTE(HIWORD(int(g_RobotCmdDeg.waistJoint[1]*10000))); 
+	RoboCodec::EncodeCommand(g_nRunFlag, g_RobotCmdDeg, cSendRobotCommandBuffer);
 }
 
 // TODO(CJH): Parse Buffer from command buffer
@@ -461,41 +300,59 @@ bool RobonautControl::ConnHand()
 	UINT HandCommand_Port = HAND_COMMAND_PORT; 
 	UINT HandSensor_Port = HAND_SENSE_PORT;
 
+	m_LinkReactor.Remove(&m_HandSenseLink);
 	int send_ret = m_SendClientHand.ConnectServer((LPSTR)(LPCTSTR)Hand_ip,HandCommand_Port);
 	int recv_ret = m_ReceiveClientHand.ConnectServer(Hand_ip,HandSensor_Port);
 
+	if (!send_ret)
+	{
+		LinkReactor::Configure(m_SendClientHand.m_hSocket);
+	}
+	if (!recv_ret)
+	{
+		m_LinkReactor.Add(&m_HandSenseLink);
+	}
 	return (!send_ret && !recv_ret);
 }
 
 bool RobonautControl::DisConnHand()
 {
-	return false;
+	m_LinkReactor.Remove(&m_HandSenseLink);
+	if (m_SendClientHand.m_hSocket != NULL)
+	{
+		closesocket(m_SendClientHand.m_hSocket);
+		m_SendClientHand.m_hSocket = NULL;
+	}
+	if (m_ReceiveClientHand.m_hSocket != NULL)
+	{
+		closesocket(m_ReceiveClientHand.m_hSocket);
+		m_ReceiveClientHand.m_hSocket = NULL;
+	}
+	return true;
 }
 
 bool RobonautControl::SendHandMsg(const CHandData &RHandSensor, const CHandData &LHandSensor, int HCount)
 {
-	float Vel = 80.0;
-
-	int RobotRunFlag = 0x9888c1;
-
-	sprintf(m_SendHandCommandBuffer, "PackageID:  %d\r\nPackageHead: %x %d\r\nfloat %f, %f, %f, %f, %f, %f\r\nfloat %f, %f, %f, %f, %f, %f\r\nfloat %f, %f, %f, %f, %f, %f\r\nfloat %f, %f, %f, %f, %f, %f\r\nfloat %f, %f, %f, %f, %f, %f\r\nint   %x, %d, %x, %d, %x, 0, 0, 0, 0\r\nfloat %f, %f, %f, %f, %f, %f\r\nfloat %f, %f, %f, %f, %f, %f\r\nfloat %f, %f, %f, %f, %f, %f\r\nfloat %f, %f, %f, %f, %f, %f\r\nfloat %f, %f, %f, %f, %f, %f\r\nint   %x, %d, %x, %d, %x, %d, %d, %d, %d\r\nPackageEnd: %x\r\n",
-		HCount,
-		PackageHead,0,
-		RHandSensor.joint[0][0], RHandSensor.joint[0][1], RHandSensor.joint[0][2], Vel, Vel, Vel,
-		RHandSensor.joint[1][0], RHandSensor.joint[1][1], RHandSensor.joint[1][2], Vel, Vel, Vel,
-		RHandSensor.joint[2][0], RHandSensor.joint[2][1], RHandSensor.joint[2][2], Vel, Vel, Vel,
-		RHandSensor.joint[3][0], RHandSensor.joint[3][1], RHandSensor.joint[3][2], Vel, Vel, Vel,
-		RHandSensor.joint[4][0], RHandSensor.joint[4][1], RHandSensor.joint[4][2], Vel, Vel, Vel,
-		CONTROLLER_IMPEDANCE,5,THUMB_BRAKE,90,RobotRunFlag,
-		LHandSensor.joint[0][0], LHandSensor.joint[0][1], LHandSensor.joint[0][2], Vel, Vel, Vel,
-		LHandSensor.joint[1][0], LHandSensor.joint[1][1], LHandSensor.joint[1][2], Vel, Vel, Vel,
-		LHandSensor.joint[2][0], LHandSensor.joint[2][1], LHandSensor.joint[2][2], Vel, Vel, Vel,
-		LHandSensor.joint[3][0], LHandSensor.joint[3][1], LHandSensor.joint[3][2], Vel, Vel, Vel,
-		LHandSensor.joint[4][0], LHandSensor.joint[4][1], LHandSensor.joint[4][2], Vel, Vel, Vel,
-		CONTROLLER_IMPEDANCE,5,THUMB_BRAKE,90,RobotRunFlag,m_HandInit,m_HandEnable,m_HandStop,m_Impedance_Index,
-		PackageEnd);
-
-	int ret = m_SendClientHand.SendData2(m_SendHandCommandBuffer);
+	HandCmdState state;
+	state.velocity = 80.0;
+	state.controller = CONTROLLER_IMPEDANCE;
+	state.stiffness = 5;
+	state.thumb = THUMB_BRAKE;
+	state.thumbAngle = 90;
+	state.runFlag = 0x9888c1;
+	state.init = m_HandInit;
+	state.enable = m_HandEnable;
+	state.stop = m_HandStop;
+	state.impedanceIndex = m_Impedance_Index;
+
+	// 按协商的格式编码，文本包与原来的格式相同
+	int len = m_HandCodec.EncodeCommand(HCount, RHandSensor, LHandSensor, state,
+		m_SendHandCommandBuffer, sizeof(m_SendHandCommandBuffer));
+	if (len < 0)
+	{
+		return false;
+	}
+	int ret = m_SendClientHand.SendFrame(m_SendHandCommandBuffer, len);
 
 	m_HandInit = 0;
 	m_HandEnable = 0;
@@ -504,51 +361,17 @@ bool RobonautControl::SendHandMsg(const CHandData &RHandSensor, const CHandData
 	return !ret;
 }
 
+// 传感器包由反应器解码（文本或二进制，收到二进制包后命令也改为二进制发送），这里只取最新的一个
 bool RobonautControl::RecvHandMsg(CHandData &RHandSensor, CHandData &LHandSensor)
 {
-	char buffer[2048]={0};
-
-	int RealRobotRunFlag=0;
-        
-	int ret = m_ReceiveClientHand.ReceiveData2(buffer);
-	int RightFlag,LeftFlag;
-				
-	if(ret==0)
-	{					
-		sscanf(buffer,"Package-ID: %d\r\nF1:[Angle] %f, %f, %f\r\n  [Torque] %f, %f, %f\r\nF2:[Angle] %f, %f, %f\r\n  [Torque] %f, %f, %f\r\nF3:[Angle] %f, %f, %f\r\n  [Torque] %f, %f, %f\r\nF4:[Angle] %f, %f, %f\r\n  [Torque] %f, %f, %f\r\nF5:[Angle] %f, %f, %f\r\n  [Torque] %f, %f, %f\r\nF1:[Angle] %f, %f, %f\r\n  [Torque] %f, %f, %f\r\nF2:[Angle] %f, %f, %f\r\n  [Torque] %f, %f, %f\r\nF3:[Angle] %f, %f, %f\r\n  [Torque] %f, %f, %f\r\nF4:[Angle] %f, %f, %f\r\n  [Torque] %f, %f, %f\r\nF5:[Angle] %f, %f, %f\r\n  [Torque] %f, %f, %f\r\n   [State] %x, %d, %d\r\n",
-
-			&(RHandSensor.count),
-
-			&(RHandSensor.joint[0][0]),&(RHandSensor.joint[0][1]),&(RHandSensor.joint[0][2]),
-			&(RHandSensor.torque[0][0]),&(RHandSensor.torque[0][1]),&(RHandSensor.torque[0][2]),
-			&(RHandSensor.joint[1][0]),&(RHandSensor.joint[1][1]),&(RHandSensor.joint[1][2]),
-			&(RHandSensor.torque[1][0]),&(RHandSensor.torque[1][1]),&(RHandSensor.torque[1][2]),
-			&(RHandSensor.joint[2][0]),&(RHandSensor.joint[2][1]),&(RHandSensor.joint[2][2]),
-			&(RHandSensor.torque[2][0]),&(RHandSensor.torque[2][1]),&(RHandSensor.torque[2][2]),
-			&(RHandSensor.joint[3][0]),&(RHandSensor.joint[3][1]),&(RHandSensor.joint[3][2]),
-			&(RHandSensor.torque[3][0]),&(RHandSensor.torque[3][1]),&(RHandSensor.torque[3][2]),
-			&(RHandSensor.joint[4][0]),&(RHandSensor.joint[4][1]),&(RHandSensor.joint[4][2]),
-			&(RHandSensor.torque[4][0]),&(RHandSensor.torque[4][1]),&(RHandSensor.torque[4][2]),
-
-			&(LHandSensor.joint[0][0]),&(LHandSensor.joint[0][1]),&(LHandSensor.joint[0][2]),
-			&(LHandSensor.torque[0][0]),&(LHandSensor.torque[0][1]),&(LHandSensor.torque[0][2]),
-			&(LHandSensor.joint[1][0]),&(LHandSensor.joint[1][1]),&(LHandSensor.joint[1][2]),
-			&(LHandSensor.torque[1][0]),&(LHandSensor.torque[1][1]),&(LHandSensor.torque[1][2]),
-			&(LHandSensor.joint[2][0]),&(LHandSensor.joint[2][1]),&(LHandSensor.joint[2][2]),
-			&(LHandSensor.torque[2][0]),&(LHandSensor.torque[2][1]),&(LHandSensor.torque[2][2]),
-			&(LHandSensor.joint[3][0]),&(LHandSensor.joint[3][1]),&(LHandSensor.joint[3][2]),
-			&(LHandSensor.torque[3][0]),&(LHandSensor.torque[3][1]),&(LHandSensor.torque[3][2]),
-			&(LHandSensor.joint[4][0]),&(LHandSensor.joint[4][1]),&(LHandSensor.joint[4][2]),
-			&(LHandSensor.torque[4][0]),&(LHandSensor.torque[4][1]),&(LHandSensor.torque[4][2]),
-
-			&RealRobotRunFlag,&RightFlag,&LeftFlag);
-
-		return true;
-	}
-
-	else{
+	HandSense sense;
+	if (m_HandSenseLink.Latest().Take(sense) == false)
+	{
 		return false;
 	}
+	RHandSensor = sense.right;
+	LHandSensor = sense.left;
+	return true;
 }
 
 void RobonautControl::setHandInit(bool ctrl_flag)
@@ -610,4 +433,9 @@ void RobonautControl::setHandMode(HandMode handmode)
 		m_HandMode = CONTROLLER_RESET;
 		break;
 	}
+}
+
+bool RobonautControl::IsHandBinary() const
+{
+	return m_HandCodec.SendFormat() == HandCodec::Binary;
 }
\ No newline at end of file
@@ -4,8 +4,13 @@
 #define NOMINMAX		// In Order to Use max(a, b) and min(a, b)
 
 #include "SocketBlockClient.h"
+#include "ConsimuLink.h"
+#include "LinkReactor.h"
+#include "DeviceLinks.h"
 #include "CSocket.hpp"
 #include "RobonautData.h"
+#include "HandCodec.h"
+#include "RoboCodec.h"
 
 
 #include <QMessageBox>
@@ -38,6 +43,37 @@
 #define  ROBO_J6_MIN -120
 #define  ROBO_J6_MAX 120
 
+// left arm, same sign convention as the right arm; SendRoboMsg clamps the left command to these
+#define  ROBO_LJ0_MIN -49
+#define  ROBO_LJ0_MAX 170
+#define  ROBO_LJ1_MIN -100
+#define  ROBO_LJ1_MAX 70
+#define  ROBO_LJ2_MIN -120
+#define  ROBO_LJ2_MAX 120
+#define  ROBO_LJ3_MIN -129
+#define  ROBO_LJ3_MAX 0
+#define  ROBO_LJ4_MIN -120
+#define  ROBO_LJ4_MAX 120
+#define  ROBO_LJ5_MIN -90
+#define  ROBO_LJ5_MAX 90
+#define  ROBO_LJ6_MIN -120
+#define  ROBO_LJ6_MAX 120
+
+// define max velocity (degree/s) and acceleration (degree/s^2) for every joint, used by waypoint planning
+#define  ROBO_J0_VEL_MAX 20
+#define  ROBO_J1_VEL_MAX 20
+#define  ROBO_J2_VEL_MAX 25
+#define  ROBO_J3_VEL_MAX 25
+#define  ROBO_J4_VEL_MAX 30
+#define  ROBO_J5_VEL_MAX 30
+#define  ROBO_J6_VEL_MAX 30
+#define  ROBO_J0_ACC_MAX 20
+#define  ROBO_J1_ACC_MAX 20
+#define  ROBO_J2_ACC_MAX 25
+#define  ROBO_J3_ACC_MAX 25
+#define  ROBO_J4_ACC_MAX 30
+#define  ROBO_J5_ACC_MAX 30
+#define  ROBO_J6_ACC_MAX 30
 
 
 #define  ROBO_J0_MIN_SLI -6000
@@ -62,13 +98,20 @@ public:
 	~RobonautControl();
 	enum HandMode{Position, Impedance, Soft, ZeroForce, Reset};
 
+	//*********************** Link Reactor ***********************//
+public:
+	LinkReactor &Reactor(); // 视觉连接由CyberSystem加入
+private:
+	LinkReactor m_LinkReactor; // 所有连接的接收线程，解码到各连接的最新值信箱
+
 	//*********************** Consimu Options ***********************//
 public:
 	bool ConnConsimu(); // Initialize the connection
 	bool DisConnConsimu(); // Disconnect
 	bool SendConsimuMsg(); //	Return true: Send Success
+	ConsimuStats GetConsimuStats() const;
 private:	
-	CSocketBlockClient m_ClientSocketPredictive; // ͨ
+	ConsimuLink m_ConsimuLink; // 仿真通信，应答由反应器异步接收
 
 
 	//*********************** Robonaut Options ***********************//
@@ -76,13 +119,14 @@ public:
 	bool ConnRobo(); // Initialize the control connection
 	bool DisConnRobo(); // Disconnect
 	bool SendRoboMsg(); // timer of RoboCtrl
-	bool RecvRoboMsg();
+	bool RecvRoboMsg(); // 取最新的传感器包，没有新包时返回false，不等待
 	void RoboDataCnv(const int &src_flag, const CRobonautData &src_data, char dst_buf[]);
 	void BuffParse();
 private:	
-	sockconn::CUdpClient m_ClientSocketRobo; // Ա
-	sockconn::CUdpServer m_ServerSocketRobo; // Ա
+	sockconn::CUdpClient m_ClientSocketRobo; // 机器人宇航员发送数据
+	sockconn::CUdpServer m_ServerSocketRobo; // 机器人宇航员接收数据
 	int m_DecideFlag;
+	RoboSenseLink m_RoboSenseLink; // 传感器包由反应器接收
 
 	//*********************** Hand Options ***********************//
 public:
@@ -90,20 +134,23 @@ public:
 	bool ConnHand();
 	bool DisConnHand();
 	bool SendHandMsg(const CHandData &RHandCmd, const CHandData &LHandCmd, int HCount);
-	bool RecvHandMsg(CHandData &RHandSensor, CHandData &LHandSensor);
+	bool RecvHandMsg(CHandData &RHandSensor, CHandData &LHandSensor); // 取最新的传感器包，不等待
 	void setHandInit(bool);
 	void setHandEnable(bool);
 	void setHandEmergency(bool);
 	void setHandMode(HandMode);
+	bool IsHandBinary() const;		// 当前是否按二进制包发送
 
 private:
 	CSocketBlockClient m_SendClientHand;		// Send Hand Data
 	CSocketBlockClient m_ReceiveClientHand;		// Receive Hand Data
 	char m_SendHandCommandBuffer[1024];		// Hand Command Send Buffer
+	HandCodec m_HandCodec;		// 文本/二进制包的编解码及协商
+	HandSenseLink m_HandSenseLink;		// 传感器包由反应器接收
 
 	int m_HandInit;		// 0: Out/1: Initialized
 	int m_HandEnable;		// 0: Out/1: Initialized
-	int m_HandStop;		// 1Ϊͣ2Ϊȡͣ
+	int m_HandStop;		// 1为急停，2为取消急停
 	int m_Impedance_Index;		// 0: Out/1: Initialized
 	int m_HandMode;
 
@@ -111,6 +158,7 @@ private:
 
 public:
 	int m_nPCount; // consimulation communication counter
+	int m_nPReplyCount; // m_nPCount of the latest consimulation reply
 	bool m_bConsimuSockConn; //		True: Consimulation Socket is Created
 	// TODO(CJH): Delete
 	bool m_bRoboCtrlInitFini; // robonaut control connection is ok
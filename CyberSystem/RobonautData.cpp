@@ -18,9 +18,9 @@ static char THIS_FILE[]=__FILE__;
 
 
 // declare global variable for interconnection
-CRobonautData g_RobotCmdDeg;     //ȫֻ˿ָλǶ
-CRobonautData g_SRobotCmdDeg;    //͵İȫ˿ָλǶ
-CRobonautData g_RobotSensorDeg;  //ȫֻ˴ݵλǶ
+CRobonautData g_RobotCmdDeg;     //全局机器人控制指令单位角度
+CRobonautData g_SRobotCmdDeg;    //发送的安全机器人控制指令单位角度
+CRobonautData g_RobotSensorDeg;  //全局机器人传感器数据单位角度
 
 
 CRobonautData::CRobonautData()
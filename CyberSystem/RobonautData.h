@@ -32,25 +32,25 @@ public:
 public:
 	int count;
 //	BOOL flag;
-	float leftArmJoint[7];   //۹ؽڽǶ
-	float leftArmCartes[6];  //۵ѿ
-    float rightArmJoint[7];  //ұ۹ؽڽǶ
-    float rightArmCartes[6];  //ұ۵ѿ
+	float leftArmJoint[7];   //左臂关节角度
+	float leftArmCartes[6];  //左臂笛卡尔坐标
+    float rightArmJoint[7];  //右臂关节角度
+    float rightArmCartes[6];  //右臂笛卡尔坐标
 	float leftArmMatrix[4][4];
     float rightArmMatrix[4][4];
-	CHandData leftHandJoint;   //ֹؽڽǶ
-	CHandData rightHandJoint;  //ֹؽڽǶ 
+	CHandData leftHandJoint;   //左手关节角度
+	CHandData rightHandJoint;  //右手关节角度 
 
-	float waistJoint[2];   //ؽڽǶ 0ת 1
-	float headJoint[3];   //ͷؽڽǶ 0 1 2ת
+	float waistJoint[2];   //腰部关节角度 0旋转 1俯仰
+	float headJoint[3];   //头部关节角度 0俯仰 1侧摆 2旋转
 
-	float RightJointFT[7];//ұ۹ؽ
-	float LeftJointFT[7];//۹ؽ
+	float RightJointFT[7];//右臂关节力矩
+	float LeftJointFT[7];//左臂关节力矩
 
-	float RightCasteFT[6];//ұ۵ѿ
-	float LeftCasteFT[6];//۵ѿ
+	float RightCasteFT[6];//右臂笛卡尔力矩
+	float LeftCasteFT[6];//左臂笛卡尔力矩
 
-	int CtlMode; //Ʒʽ1λã2迹
+	int CtlMode; //控制方式1是位置，2是阻抗
 };
 
 #endif // !defined(AFX_ROBONAUTDATA_H__73D7F6AB_B63B_4C80_A9DC_E7DA699D79C4__INCLUDED_)
@@ -20,6 +20,7 @@ static char THIS_FILE[]=__FILE__;
 //////////////////////////////////////////////////////////////////////
 
 CSocketBlockClient::CSocketBlockClient()
+	: m_Framer(FRAME_BUF_LEN)
 {
 	m_bInit=TRUE;
 	m_hSocket=NULL;
@@ -30,8 +31,8 @@ CSocketBlockClient::CSocketBlockClient()
 	{
 		TRACE("Initilize Error!\n");
 		m_bInit=FALSE;
-		QMessageBox::about(NULL, "About", "socket ʼ");
-		//::MessageBox(NULL,"socket ʼ","ʾϢ",NULL);
+		QMessageBox::about(NULL, "About", "socket 初始化错误");
+		//::MessageBox(NULL,"socket 初始化错误","提示信息",NULL);
 	}
 }
 
@@ -46,8 +47,8 @@ int CSocketBlockClient::ConnectServer(char *IP, UINT nPort)
 {
 	if(!m_bInit)
 	{
-		QMessageBox::about(NULL, "About", "winsock ʼ!");
-		//::MessageBox(NULL,"winsock ʼ!","ʾ",NULL);
+		QMessageBox::about(NULL, "About", "winsock 初始化错误!");
+		//::MessageBox(NULL,"winsock 初始化错误!","错误提示",NULL);
 		return 1;
 	}
 
@@ -63,6 +64,8 @@ int CSocketBlockClient::ConnectServer(char *IP, UINT nPort)
 		ASSERT(m_hSocket!=NULL);
 	}
 	
+	m_Framer.Clear();
+
 	m_addr.sin_family = AF_INET;
 	m_addr.sin_addr.S_un.S_addr = inet_addr(IP);
 	m_addr.sin_port = htons(nPort);
@@ -79,298 +82,205 @@ int CSocketBlockClient::ConnectServer(char *IP, UINT nPort)
 	return 0;
 }
 
+// 字符串按长度头加数据发送。原来的SendData用数据覆盖了长度头，发出的是数据及其后5个'\0'
 int CSocketBlockClient::SendData(char *buff)
 {
-	if(!m_bInit)
-	{
-		QMessageBox::about(NULL, "About", "winsock ʼ!");
-		//::MessageBox(NULL,"winsock ʼ!","ʾ",NULL);
-		return 1;
-	}
-
-	char lastbuf[ORDER_BUF_LEN]={0};
-	char headlen[5]={0};
-	int end =0;
-	char *dataBegin=NULL;
-	int dataLen=strlen(buff);
-
-	////////////////////////////
-	itoa(dataLen,headlen,10);
-	int totalLen=dataLen+5;
-	int hbit=strlen(headlen);
-	strcpy(lastbuf,headlen);
+	return SendFrame(buff, strlen(buff));
+}
 
-	while(hbit<5)
-	{
-		lastbuf[hbit]=' ';
-		hbit++;
-	}
+int CSocketBlockClient::SendData2(char *buff)
+{
+	return SendFrame(buff, strlen(buff));
+}
 
-//	strcat(lastbuf,buff);
-	strncpy(lastbuf,buff,ORDER_BUF_LEN);
+// 收一帧，复制到buff（SENSE_BUF_LEN字节）并以'\0'结尾
+int CSocketBlockClient::ReceiveData(char *buff)
+{
+	int len = 0;
+	return ReceiveFrame(buff, SENSE_BUF_LEN, len);
+}
 
-	dataBegin=lastbuf;
+int CSocketBlockClient::ReceiveData2(char *buff)
+{
+	int len = 0;
+	return ReceiveFrame(buff, SENSE_BUF_LEN2, len);
+}
 
-	for(int j=0;j<totalLen/ORDER_BUF_LEN;j++)
+// 视觉数据：定长的7个double，失败时不修改vision_data
+int CSocketBlockClient::RecvViData(double vision_data[])
+{
+	const char *record = NULL;
+	int len = VISION_DATA_LEN;
+	int ret = ReceiveNext(FrameFixed, record, len);
+	if (ret != 0)
 	{
-		end=send(m_hSocket,dataBegin,ORDER_BUF_LEN,0); 
-		if(end==SOCKET_ERROR)
-		{
-			return 1;
-		}
-		dataBegin+=ORDER_BUF_LEN;
+		return ret;
 	}
-	if(totalLen%ORDER_BUF_LEN)
-	{
-		end=send(m_hSocket,dataBegin,totalLen%ORDER_BUF_LEN,0); 
-		if(end==SOCKET_ERROR)
-		{
-			return 1;
-		}
-	}
-	
+	memcpy(vision_data, record, 7 * sizeof(double));
 	return 0;
-
 }
 
-int CSocketBlockClient::SendData2(char *buff)
+int CSocketBlockClient::SendFrame(const char *buff, int len)
 {
 	if(!m_bInit)
 	{
-		QMessageBox::about(NULL, "About", "winsock ʼ!");
-		//::MessageBox(NULL,"winsock ʼ!","ʾ",NULL);
+		QMessageBox::about(NULL, "About", "winsock 初始化错误!");
 		return 1;
 	}
 
-	char lastbuf[ORDER_BUF_LEN2]={0};
-	char headlen[5]={0};
-	int end =0;
-	char *dataBegin=NULL;
-	int dataLen=strlen(buff);
+	char head[FRAME_HEAD_LEN];
+	if(!StreamFramer::WriteHead(len, head))
+	{
+		return 1;
+	}
 
-	////////////////////////////
-	itoa(dataLen,headlen,10);
-	int totalLen=dataLen+5;
-	int hbit=strlen(headlen);
-	strcpy(lastbuf,headlen);
+	// 长度头与数据一起发送，数据不复制
+	WSABUF bufs[2];
+	bufs[0].buf = head;
+	bufs[0].len = FRAME_HEAD_LEN;
+	bufs[1].buf = const_cast<char *>(buff);
+	bufs[1].len = len;
+	return SendAll(bufs, 2);
+}
 
-	while(hbit<5)
+int CSocketBlockClient::SendBytes(const char *buff, int len)
+{
+	if(!m_bInit)
 	{
-		lastbuf[hbit]=' ';
-		hbit++;
+		QMessageBox::about(NULL, "About", "winsock 初始化错误!");
+		return 1;
 	}
 
-	strcat(lastbuf,buff);
-
-	dataBegin=lastbuf;
+	WSABUF buf;
+	buf.buf = const_cast<char *>(buff);
+	buf.len = len;
+	return SendAll(&buf, 1);
+}
 
-	for(int j=0;j<totalLen/ORDER_BUF_LEN2;j++)
+int CSocketBlockClient::ReceiveFrame(char *buff, int size, int &len)
+{
+	const char *frame = NULL;
+	int ret = ReceiveFrame(frame, len);
+	if(ret != 0)
 	{
-		end=send(m_hSocket,dataBegin,ORDER_BUF_LEN2,0); 
-		if(end==SOCKET_ERROR)
-		{
-			return 1;
-		}
-		dataBegin+=ORDER_BUF_LEN2;
+		return ret;
 	}
-	if(totalLen%ORDER_BUF_LEN2)
+	if(len >= size)
 	{
-		end=send(m_hSocket,dataBegin,totalLen%ORDER_BUF_LEN2,0); 
-		if(end==SOCKET_ERROR)
-		{
-			return 1;
-		}
+		return 1;
 	}
-
+	// 文本包按字符串解析
+	memcpy(buff, frame, len);
+	buff[len] = 0;
 	return 0;
+}
 
+int CSocketBlockClient::ReceiveFrame(const char *&frame, int &len)
+{
+	return ReceiveNext(FrameHead, frame, len);
 }
 
-int CSocketBlockClient::ReceiveData(char *buff)
+int CSocketBlockClient::ReceiveLine(const char *&line, int &len)
+{
+	return ReceiveNext(FrameLine, line, len);
+}
+
+int CSocketBlockClient::ReceiveFixed(int size, const char *&record)
+{
+	int len = size;
+	return ReceiveNext(FrameFixed, record, len);
+}
+
+// 缓冲中已有完整的帧时直接返回，否则接收后再分帧
+int CSocketBlockClient::ReceiveNext(int mode, const char *&frame, int &len)
 {
 	if(!m_bInit)
 	{
-		QMessageBox::about(NULL, "About", "winsock ʼ!");
-		//::MessageBox(NULL,"winsock ʼ!","ʾ",NULL);
+		QMessageBox::about(NULL, "About", "winsock 初始化错误!");
 		return 1;
 	}
-	CString msg;
-	char headLen[6]={0};
-	char tmp[SENSE_BUF_LEN+1]={0};
-	char* p=buff;
-//	int nByteThisTime;
-	int nByteRev = 0;
-	int ret=recv(m_hSocket,tmp,FIRST_REV_BYTES,0);
-	
-	
-	strncpy(buff,&tmp[0],FIRST_REV_BYTES);
-	/*nByteThisTime = ret;
-	nByteRev += nByteThisTime;
-*/
-	if(ret==SOCKET_ERROR)
+
+	while(true)
 	{
-		int result=GetLastError();
-		if(result==WSAECONNRESET)
+		StreamFramer::Result result;
+		if(mode == FrameHead)
 		{
-			return WSAECONNRESET;
+			result = m_Framer.NextFrame(frame, len);
 		}
-	}
-
-/*	strncpy(headLen,tmp,5);
-	int dataLen=atoi(headLen);
-	int totalLen=dataLen+5;
-
-	strcpy(buff,&tmp[5]);
-
-	while(nByteRev<totalLen)
-	{
-		for(int j=0;j<(totalLen-nByteRev)/SENSE_BUF_LEN;j++)
+		else if(mode == FrameLine)
 		{
-			ret=recv(m_hSocket,tmp,SENSE_BUF_LEN,0);
-			
-			if(ret==SOCKET_ERROR)
-			{
-				int result=GetLastError();
-				if(result==WSAECONNRESET)
-				{
-					return WSAECONNRESET;
-				}
-			}
-
-			nByteThisTime = ret;
-			strncat(buff,&tmp[0],nByteThisTime);
-			nByteRev += nByteThisTime;
+			result = m_Framer.NextLine(frame, len);
 		}
-		if((totalLen-nByteRev)%SENSE_BUF_LEN)
+		else
 		{
-			ret=recv(m_hSocket,tmp,(totalLen-nByteRev)%SENSE_BUF_LEN,0);
-			
-			if(ret==SOCKET_ERROR)
-			{
-				int result=GetLastError();
-				if(result==WSAECONNRESET)
-				{
-					return WSAECONNRESET;
-				}
-			}
-			
-			nByteThisTime = ret;
-			strncat(buff,&tmp[0],nByteThisTime);
-			nByteRev += nByteThisTime;
+			result = m_Framer.NextFixed(len, frame);
 		}
-	}
-*/
-	return 0;
-}
-
-int CSocketBlockClient::RecvViData(double vision_data[])
-{
-	if(!m_bInit)
-	{
-		QMessageBox::about(NULL, "About", "winsock ʼ!");
-		//::MessageBox(NULL,"winsock ʼ!","ʾ",NULL);
-		return 0;
-	}
-
-	// TODO(CJH): 
-	char ViRecvBuf[VISION_DATA_LEN+1]={0};
-	int ret = recv(m_hSocket, ViRecvBuf, VISION_DATA_LEN, 0);
 
-	if(ret==SOCKET_ERROR)
-	{
-		int result=GetLastError();
-		if(result==WSAECONNRESET)
+		if(result == StreamFramer::Complete)
 		{
-			return WSAECONNRESET;
+			return 0;
+		}
+		if(result == StreamFramer::Invalid)
+		{
+			// 数据流错位后找不到下一帧的边界，不从中间继续接收；重新连接（ConnectServer清空缓冲）之前一直返回错误
+			return 1;
 		}
-	}
-
-	double *Vibuffer = (double *)ViRecvBuf;
 
-	for (int i = 0; i < 7; ++i)
-	{
-		vision_data[i] = *(Vibuffer + i);
+		int ret = ReceiveAvailable();
+		if(ret != 0)
+		{
+			return ret;
+		}
 	}
-
 }
 
-int CSocketBlockClient::ReceiveData2(char *buff)
+int CSocketBlockClient::ReceiveAvailable()
 {
-	if(!m_bInit)
+	int size = 0;
+	char *space = m_Framer.WriteSpace(size);
+	int ret = recv(m_hSocket, space, size, 0);
+	if(ret == SOCKET_ERROR)
+	{
+		int error = GetLastError();
+		return (error == WSAECONNRESET) ? WSAECONNRESET : 1;
+	}
+	if(ret == 0)
 	{
-		QMessageBox::about(NULL, "About", "winsock ʼ!");
-		//::MessageBox(NULL,"winsock ʼ!","ʾ",NULL);
+		// 对方已关闭
 		return 1;
 	}
-	CString msg;
-	char headLen[6]={0};
-	char tmp[SENSE_BUF_LEN2+1]={0};
-	char* p=buff;
-	int nByteThisTime;
-	int nByteRev = 0;
-
-	int ret=recv(m_hSocket,tmp,300,0);
-
+	m_Framer.Commit(ret);
+	return 0;
+}
 
-	nByteThisTime = ret;
-	nByteRev += nByteThisTime;
+StreamFramer &CSocketBlockClient::Framer()
+{
+	return m_Framer;
+}
 
-	if(ret==SOCKET_ERROR)
+// send只发出一部分时继续发送余下的部分
+int CSocketBlockClient::SendAll(WSABUF bufs[], int count)
+{
+	while(count > 0)
 	{
-		int result=GetLastError();
-		if(result==WSAECONNRESET)
+		DWORD sent = 0;
+		if(WSASend(m_hSocket, bufs, count, &sent, 0, NULL, NULL) == SOCKET_ERROR)
 		{
-			return WSAECONNRESET;
+			return 1;
 		}
-	}
-
-	strncpy(headLen,tmp,5);
-	int dataLen=atoi(headLen);
-	int totalLen=dataLen+5;
-
-	strcpy(buff,&tmp[5]);
-
-	while(nByteRev<totalLen)
-	{
-		for(int j=0;j<(totalLen-nByteRev)/SENSE_BUF_LEN2;j++)
+		while(count > 0 && sent >= bufs[0].len)
 		{
-			ret=recv(m_hSocket,tmp,SENSE_BUF_LEN2,0);
-
-			if(ret==SOCKET_ERROR)
-			{
-				int result=GetLastError();
-				if(result==WSAECONNRESET)
-				{
-					return WSAECONNRESET;
-				}
-			}
-
-			nByteThisTime = ret;
-			strncat(buff,&tmp[0],nByteThisTime);
-			nByteRev += nByteThisTime;
+			sent -= bufs[0].len;
+			++bufs;
+			--count;
 		}
-		if((totalLen-nByteRev)%SENSE_BUF_LEN2)
+		if(count > 0)
 		{
-			ret=recv(m_hSocket,tmp,(totalLen-nByteRev)%SENSE_BUF_LEN2,0);
-
-			if(ret==SOCKET_ERROR)
-			{
-				int result=GetLastError();
-				if(result==WSAECONNRESET)
-				{
-					return WSAECONNRESET;
-				}
-			}
-
-			nByteThisTime = ret;
-			strncat(buff,&tmp[0],nByteThisTime);
-			nByteRev += nByteThisTime;
+			bufs[0].buf += sent;
+			bufs[0].len -= sent;
 		}
 	}
-
 	return 0;
-
-
 }
 
 void CSocketBlockClient::GetError(DWORD error)
@@ -380,33 +290,33 @@ void CSocketBlockClient::GetError(DWORD error)
 	switch(error)
 	{
 	case WSANOTINITIALISED:
-		strcpy(strError,"ʼ");
+		strcpy(strError,"初始化错误");
 		break;
 	case WSAENOTCONN:
-		strcpy(strError,"Էû");
+		strcpy(strError,"对方没有启动");
 		break;
 	case WSAEWOULDBLOCK :
-		strcpy(strError,"ԷѾر");
+		strcpy(strError,"对方已经关闭");
 		break;
 	case WSAECONNREFUSED:
-		strcpy(strError,"ӵĳԱܾ");
+		strcpy(strError,"连接的尝试被拒绝");
 		break;
 	case WSAENOTSOCK:
-		strcpy(strError,"һ׽ϳһ");
+		strcpy(strError,"在一个非套接字上尝试了一个操作");
 		break;
 	case WSAEADDRINUSE:
-		strcpy(strError,"ضĵַʹ");
+		strcpy(strError,"特定的地址已在使用中");
 		break;
 	case WSAECONNRESET:
-		strcpy(strError,"ӱر");
+		strcpy(strError,"与主机的连接被关闭");
 		break;
 
 	case 3:
-		strcpy(strError,"׽ַǿգsocketǷӳɹ?");
+		strcpy(strError,"套接字非空，检查socket是否已连接成功?");
 		break;
 
 	default:
-		strcpy(strError,"ͼ"); 
+		strcpy(strError,"哈哈，低级错误"); 
 	}
 	
 	//AfxMessageBox(strError);
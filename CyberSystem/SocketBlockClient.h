@@ -10,6 +10,7 @@
 
 #include <winsock2.h>
 #include "SocketDefine.h"
+#include "StreamFramer.h"
 
 
 class CSocketBlockClient  
@@ -26,6 +27,18 @@ public:
 
 	int SendData(char* buff);	
 	int SendData2(char* buff);	
+	// 5字节长度头加数据，数据可以是二进制；部分发送时继续发送余下的部分
+	int SendFrame(const char* buff, int len);
+	int SendBytes(const char* buff, int len);		// 不加长度头
+	// 接收一帧：长度头加数据、'\n'结尾的文本行或定长记录。frame指向接收缓冲内部，
+	// 到下一次接收之前有效，其后有'\0'。一个连接只用一种分帧方式
+	int ReceiveFrame(const char* &frame, int &len);
+	int ReceiveLine(const char* &line, int &len);
+	int ReceiveFixed(int size, const char* &record);
+	int ReceiveFrame(char* buff, int size, int &len);		// 复制到buff并以'\0'结尾
+	// 只recv一次到接收缓冲，由LinkReactor在select报告可读后调用，不会阻塞；之后用Framer()分帧
+	int ReceiveAvailable();
+	StreamFramer &Framer();
 	int ConnectServer(char* IP,UINT nPort);		
 	void GetError(DWORD error);
 public:
@@ -34,6 +47,17 @@ public:
 	UINT m_uPort;												
 	BOOL m_bInit;								
 
+private:
+	enum FrameMode
+	{
+		FrameHead,
+		FrameLine,
+		FrameFixed
+	};
+	int ReceiveNext(int mode, const char* &frame, int &len);
+	int SendAll(WSABUF bufs[], int count);
+
+	StreamFramer m_Framer;		// 接收缓冲
 
 };
 
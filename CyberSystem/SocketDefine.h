@@ -10,21 +10,28 @@
 #define SENSE_BUF_LEN2 2048
 
 #define FIRST_REV_BYTES 300
+#define FRAME_BUF_LEN 4096		// 接收分帧缓冲，一帧最多FRAME_BUF_LEN字节（含长度头）
 
 #define VISION_DATA_LEN 56
 
+// 接收反应器
+#define LINK_RCVBUF_LEN 65536		// 各连接的内核接收缓冲
+#define LINK_SNDBUF_LEN 65536		// TCP连接的内核发送缓冲，控制周期的send不会因缓冲满而阻塞
+#define LINK_WAKE_MS 10				// select的超时，增删连接最多等待这么久
+#define LINK_MAX_LINKS 8
+
 
 //UDP
 
-#define ROB_VISION_IP "172.16.13.30" //ӾIP
-#define ROB_VISION_PORT 8891//ȫӾŷ˿
-#define ROB_VISION_PORT2 8890//Ӿŷ˿
+#define ROB_VISION_IP "172.16.13.30" //视觉IP
+#define ROB_VISION_PORT 8891//全局视觉伺服端口
+#define ROB_VISION_PORT2 8890//手眼视觉伺服端口
 
-//Ӿ忨
+//视觉计算机插卡
 #define PLATFORM_PORT2 9898
 #define SERVER_PLATFORM_IP2 "172.16.13.179"
 
-//2ƽֿ̨
+//卫星2平台手控制
 //#define HAND_SERVER_IP "127.0.0.1"
 
 
@@ -33,28 +40,33 @@
 
 
 //*********************** In Use ***********************//
-// Ա
-#define ROB_CONTRL_IP "172.16.13.155" // пIP
-#define ROB_CONTRL_PORT 6500 // пض˿
-
-#define ROB_TELE_IP "172.16.13.65" // ңƶIP
-#define ROB_TELE_PORT 5500  // ңƶ˿
-
-// Ԥ
-#define PREDICTIVE_IP "127.0.0.1"		// ԤIP
-#define PREDICTIVE_PORT 8001			// Ԥ˿
-
-// 
-#define HAND_SERVER_IP "172.16.13.179"		// IP
-#define HAND_COMMAND_PORT 9001		// ֽտ˿
-#define HAND_SENSE_PORT 9002		// ַʹݶ˿
-
-#define PackageHead 0x9876b1		// ݰͷ
-#define PackageEnd 0x9876b2			// ݰβ
+// 连接宇航员
+#define ROB_CONTRL_IP "172.16.13.155" // 中控IP
+#define ROB_CONTRL_PORT 6500 // 中控端口
+
+#define ROB_TELE_IP "172.16.13.65" // 遥操作控制端IP
+#define ROB_TELE_PORT 5500  // 遥操作控制端口
+
+// 连接预测仿真
+#define PREDICTIVE_IP "127.0.0.1"		// 预测仿真IP
+#define PREDICTIVE_PORT 8001			// 预测仿真端口
+#define CONSIMU_TIMEOUT_MS 200			// 预测仿真应答超时，超时的指令标记后仍等待其应答，超时的应答不再使用
+#define CONSIMU_MAX_PENDING 4			// 最多在途（未超时）的指令数，达到时不再发送
+#define CONSIMU_QUEUE_LEN 64			// 在途及超时后仍在等待应答的指令最多这么多条
+#define CONSIMU_STALL_MS 1000			// 最早的指令超过这么久仍未应答时认为仿真已停止，重新连接
+
+// 连接灵巧手
+#define HAND_SERVER_IP "172.16.13.179"		// 灵巧手IP
+#define HAND_COMMAND_PORT 9001		// 灵巧手接收控制命令端口
+#define HAND_SENSE_PORT 9002		// 灵巧手发送传感器数据端口
+
+#define PackageHead 0x9876b1		// 灵巧手数据包头
+#define PackageEnd 0x9876b2			// 灵巧手数据包尾
 #define THUMB_BRAKE	0				// 
 #define THUMB_RELEASE 0x8972CC01
+#define HAND_BINARY_PROTOCOL 1		// 1: 服务器支持时改用二进制包，0: 始终使用文本包
 
-// 
+// 连接相机
 #define VISION_SENSE_IP "127.0.0.1"
 #define VISION_SENSE_PORT 6000
 
@@ -0,0 +1,183 @@
+#include "StreamFramer.h"
+#include <stdio.h>
+#include <string.h>
+
+StreamFramer::StreamFramer(int capacity)
+{
+	m_Capacity = capacity > FRAME_HEAD_LEN ? capacity : FRAME_HEAD_LEN + 1;
+	m_Data = new char[m_Capacity + 1];
+	m_Begin = 0;
+	m_End = 0;
+	m_Hold = -1;
+	m_HoldByte = 0;
+	m_Moves = 0;
+}
+
+StreamFramer::~StreamFramer()
+{
+	delete [] m_Data;
+}
+
+char *StreamFramer::WriteSpace(int &size)
+{
+	Restore();
+	if (m_Begin == m_End)
+	{
+		m_Begin = 0;
+		m_End = 0;
+	}
+	else if (m_Begin > 0 && m_Capacity - m_End < m_Capacity / 4)
+	{
+		// 写位置接近末尾：未取出的部分移到开头
+		memmove(m_Data, &m_Data[m_Begin], m_End - m_Begin);
+		m_End -= m_Begin;
+		m_Begin = 0;
+		++m_Moves;
+	}
+	size = m_Capacity - m_End;
+	return &m_Data[m_End];
+}
+
+void StreamFramer::Commit(int n)
+{
+	m_End += n;
+}
+
+StreamFramer::Result StreamFramer::NextFrame(const char *&frame, int &len)
+{
+	Restore();
+	if (m_End - m_Begin < FRAME_HEAD_LEN)
+	{
+		return Incomplete;
+	}
+
+	// 长度头：数字之后只能是空格
+	const char *head = &m_Data[m_Begin];
+	int dataLen = 0;
+	int i = 0;
+	for (; i < FRAME_HEAD_LEN && head[i] >= '0' && head[i] <= '9'; ++i)
+	{
+		dataLen = dataLen * 10 + (head[i] - '0');
+	}
+	if (i == 0)
+	{
+		return Invalid;
+	}
+	for (; i < FRAME_HEAD_LEN; ++i)
+	{
+		if (head[i] != ' ')
+		{
+			return Invalid;
+		}
+	}
+	if (FRAME_HEAD_LEN + dataLen > m_Capacity)
+	{
+		return Invalid;
+	}
+	if (m_End - m_Begin < FRAME_HEAD_LEN + dataLen)
+	{
+		return Incomplete;
+	}
+
+	const int begin = m_Begin + FRAME_HEAD_LEN;
+	frame = Take(begin, dataLen, begin + dataLen);
+	len = dataLen;
+	return Complete;
+}
+
+StreamFramer::Result StreamFramer::NextLine(const char *&line, int &len)
+{
+	Restore();
+	while (m_Begin < m_End && m_Data[m_Begin] == '\0')
+	{
+		++m_Begin;
+	}
+
+	const char *end = (const char *)memchr(&m_Data[m_Begin], '\n', m_End - m_Begin);
+	if (end == NULL)
+	{
+		return (m_End - m_Begin >= m_Capacity) ? Invalid : Incomplete;
+	}
+
+	int lineLen = (int)(end - &m_Data[m_Begin]);
+	if (lineLen > 0 && m_Data[m_Begin + lineLen - 1] == '\r')
+	{
+		--lineLen;
+	}
+	const int begin = m_Begin;
+	line = Take(begin, lineLen, (int)(end - m_Data) + 1);
+	len = lineLen;
+	return Complete;
+}
+
+StreamFramer::Result StreamFramer::NextFixed(int size, const char *&record)
+{
+	Restore();
+	if (size <= 0 || size > m_Capacity)
+	{
+		return Invalid;
+	}
+	if (m_End - m_Begin < size)
+	{
+		return Incomplete;
+	}
+	const int begin = m_Begin;
+	record = Take(begin, size, begin + size);
+	return Complete;
+}
+
+void StreamFramer::Clear()
+{
+	m_Begin = 0;
+	m_End = 0;
+	m_Hold = -1;
+}
+
+int StreamFramer::Size() const
+{
+	return m_End - m_Begin;
+}
+
+int StreamFramer::Capacity() const
+{
+	return m_Capacity;
+}
+
+int StreamFramer::Moves() const
+{
+	return m_Moves;
+}
+
+bool StreamFramer::WriteHead(int len, char head[])
+{
+	if (len < 0 || len > FRAME_MAX_LEN)
+	{
+		return false;
+	}
+	char digits[16];
+	int n = sprintf(digits, "%d", len);
+	memcpy(head, digits, n);
+	for (; n < FRAME_HEAD_LEN; ++n)
+	{
+		head[n] = ' ';
+	}
+	return true;
+}
+
+void StreamFramer::Restore()
+{
+	if (m_Hold >= 0)
+	{
+		m_Data[m_Hold] = m_HoldByte;
+		m_Hold = -1;
+	}
+}
+
+const char *StreamFramer::Take(int begin, int len, int next)
+{
+	m_Begin = next;
+	m_Hold = begin + len;
+	m_HoldByte = m_Data[m_Hold];
+	m_Data[m_Hold] = '\0';
+	return &m_Data[begin];
+}
@@ -0,0 +1,61 @@
+#ifndef STREAMFRAMER_H
+#define STREAMFRAMER_H
+
+// 长度头：十进制长度，空格补足5字节，其后为数据
+#define FRAME_HEAD_LEN 5
+#define FRAME_MAX_LEN 99999
+
+// TCP字节流的接收缓冲及分帧。recv直接写入缓冲的空闲部分，分帧时不复制数据：
+// 取出的帧指向缓冲内部，到下一次调用本类的函数之前有效，帧后临时写入'\0'，文本帧可直接按字符串解析。
+// 缓冲是环形使用的：读写位置向后推进，写位置到达末尾时只把未取出的部分（最多一个不完整的帧）
+// 移到开头再继续写，因此每一帧总是连续存放的。
+// 三种分帧方式，一个连接只用其中一种：
+// 1. NextFrame：FRAME_HEAD_LEN字节的长度头加数据，数据可以是二进制；
+// 2. NextLine：以'\n'结尾的文本行，跳过行前的'\0'填充；
+// 3. NextFixed：定长的记录。
+class StreamFramer
+{
+public:
+	enum Result
+	{
+		Incomplete,		// 没有完整的帧，需要继续接收
+		Complete,
+		Invalid			// 长度头错误或帧超过缓冲容量，数据流已无法分帧，应Clear后重新连接
+	};
+
+	explicit StreamFramer(int capacity);
+	~StreamFramer();
+
+	// 可写入的连续空间，recv写入n字节后调用Commit(n)；缓冲已满时size为0
+	char *WriteSpace(int &size);
+	void Commit(int n);
+
+	Result NextFrame(const char *&frame, int &len);
+	Result NextLine(const char *&line, int &len);
+	Result NextFixed(int size, const char *&record);
+
+	void Clear();
+	int Size() const;			// 已接收、尚未取出的字节数
+	int Capacity() const;		// 一帧（含长度头）的最大字节数
+	int Moves() const;			// 写位置回到开头时移动数据的次数
+
+	// 把长度写成FRAME_HEAD_LEN字节的长度头，len超出范围时返回false
+	static bool WriteHead(int len, char head[]);
+
+private:
+	StreamFramer(const StreamFramer &);
+	StreamFramer &operator=(const StreamFramer &);
+
+	void Restore();			// 恢复上一帧后被'\0'覆盖的字节
+	const char *Take(int begin, int len, int next);		// 取出[begin, begin + len)，读位置移到next
+
+	char *m_Data;
+	int m_Capacity;
+	int m_Begin;		// 读位置
+	int m_End;			// 写位置，m_Data[m_End]之后至少保留一个字节用于'\0'
+	int m_Hold;			// 被'\0'覆盖的位置，没有时为-1
+	char m_HoldByte;
+	int m_Moves;
+};
+
+#endif
@@ -0,0 +1,288 @@
+#ifndef ARM_ANGLE_HPP__
+#define ARM_ANGLE_HPP__
+#include <cmath>
+#include <limits>
+#include "eigen3/Eigen/Eigen"
+#include "angular_interval.hpp"
+#include "kine7.hpp"
+namespace rpp
+{
+    namespace kine
+    {
+        // picks the arm angle of a self-motion whose joints are closest to the
+        // previous command. The cost
+        //     |q(psi) - q_prev|^2 + w * (psi - psi_prev)^2
+        // has several local minima over the feasible range (one per branch and
+        // interval, and the joint-limit edges), so it is first swept on a coarse
+        // grid: at least sweep_points arm angles spread over the feasible
+        // intervals by length, plus psi_prev when it is feasible, SWEEP_LANES at
+        // a time through SelfMotion's arm-angle sweep. Golden section then only
+        // refines between the two grid neighbours of the best sample, where a
+        // single minimum is a fair assumption. The number of evaluated arm angles
+        // never exceeds max_evaluations (the sweep itself always runs), so the
+        // cost per tick is bounded.
+        // The best sample of every shoulder/wrist branch is kept as a fallback,
+        // for when the chosen joints fail the caller's pose check.
+        template <typename T>
+        class ArmAngleOptimizer
+        {
+        public:
+            typedef T value_type;
+            typedef Eigen::Matrix<value_type, 7, 1> vec7;
+            typedef SelfMotion<value_type> self_motion;
+            typedef typename self_motion::angular_interval_set angular_interval_set;
+
+            enum { SWEEP_LANES = 8 };
+            enum { BRANCHES = JointSweep<value_type, SWEEP_LANES>::BRANCHES };
+            // one point per interval and psi_prev fit in any sweep
+            enum { MAX_SAMPLES = ((angular_interval_set::MAX_SIZE + 1 + SWEEP_LANES - 1)/SWEEP_LANES)*SWEEP_LANES };
+            struct candidate_type
+            {
+                value_type arm_angle;
+                value_type cost;
+                vec7 joints;
+            };
+            typedef ::rpp::util::FixedVector<candidate_type, BRANCHES> candidate_vector;
+            struct result_type
+            {
+                bool found;
+                value_type arm_angle;
+                value_type cost;
+                vec7 joints;
+                int evaluations;
+                // the best sample of each branch by increasing cost, the result
+                // itself excluded
+                candidate_vector fallbacks;
+            };
+
+            ArmAngleOptimizer(const int max_evaluations = 24,
+                    const int sweep_points = 16,
+                    const value_type arm_angle_weight = value_type(0.1))
+                : _max_evaluations(max_evaluations),
+                _sweep_points((std::min)(sweep_points, (int)MAX_SAMPLES)),
+                _arm_angle_weight(arm_angle_weight) {}
+
+            template <typename F>
+            result_type optimize(self_motion &sm, F &sh,
+                    const value_type last_arm_angle, const vec7 &last_joints) const
+            {
+                result_type res;
+                res.found = false;
+                res.cost = std::numeric_limits<value_type>::infinity();
+                res.evaluations = 0;
+                const angular_interval_set range = sm.arm_angle_range();
+                if (range.empty()) return res;
+
+                samples_type samples;
+                make_samples(range, last_arm_angle, samples);
+                const int n = (int)samples.size();
+
+                // coarse sweep, the best sample of every branch
+                candidate_type branch_best[BRANCHES];
+                int branch_sample[BRANCHES];
+                for (int b = 0; b < BRANCHES; ++b)
+                {
+                    branch_best[b].cost = std::numeric_limits<value_type>::infinity();
+                    branch_sample[b] = -1;
+                }
+                for (int k = 0; k < n; k += SWEEP_LANES)
+                {
+                    Eigen::Array<value_type, SWEEP_LANES, 1> angles;
+                    for (int i = 0; i < SWEEP_LANES; ++i)
+                        angles(i) = samples[(std::min)(k + i, n - 1)].arm_angle;
+                    JointSweep<value_type, SWEEP_LANES> sweep;
+                    sm.get_joints(angles, sh, sweep);
+                    for (int i = 0; i < SWEEP_LANES && k + i < n; ++i)
+                    {
+                        ++res.evaluations;
+                        const value_type d = wrap(angles(i) - last_arm_angle);
+                        const value_type c_psi = _arm_angle_weight*d*d;
+                        for (int b = 0; b < BRANCHES; ++b)
+                        {
+                            if (!(sweep.mask[i] & (1 << b))) continue;
+                            const vec7 q = sweep.joints[b].row(i).transpose();
+                            const value_type c = (q - last_joints).squaredNorm() + c_psi;
+                            if (c < branch_best[b].cost)
+                            {
+                                branch_best[b].arm_angle = angles(i);
+                                branch_best[b].cost = c;
+                                branch_best[b].joints = q;
+                                branch_sample[b] = k + i;
+                            }
+                        }
+                    }
+                }
+                int best = -1;
+                for (int b = 0; b < BRANCHES; ++b)
+                    if (branch_sample[b] >= 0 && (best < 0 || branch_best[b].cost < branch_best[best].cost))
+                        best = b;
+                if (best < 0) return res;
+                res.found = true;
+                res.arm_angle = branch_best[best].arm_angle;
+                res.cost = branch_best[best].cost;
+                res.joints = branch_best[best].joints;
+
+                // golden section between the grid neighbours of the best sample
+                if (res.evaluations + 2 <= _max_evaluations)
+                {
+                    const value_type R = value_type(0.6180339887498949);
+                    value_type a = samples[branch_sample[best]].lower;
+                    value_type b = samples[branch_sample[best]].upper;
+                    value_type x1 = b - R*(b - a);
+                    value_type x2 = a + R*(b - a);
+                    value_type f1 = cost(sm, sh, x1, last_arm_angle, last_joints, res);
+                    value_type f2 = cost(sm, sh, x2, last_arm_angle, last_joints, res);
+                    while (res.evaluations < _max_evaluations)
+                    {
+                        if (f1 <= f2)
+                        {
+                            b = x2;
+                            x2 = x1;
+                            f2 = f1;
+                            x1 = b - R*(b - a);
+                            f1 = cost(sm, sh, x1, last_arm_angle, last_joints, res);
+                        }
+                        else
+                        {
+                            a = x1;
+                            x1 = x2;
+                            f1 = f2;
+                            x2 = a + R*(b - a);
+                            f2 = cost(sm, sh, x2, last_arm_angle, last_joints, res);
+                        }
+                    }
+                }
+                res.arm_angle = wrap(res.arm_angle);
+
+                // fallbacks by increasing cost, the sweep's best is one unless the
+                // golden section did not improve on it
+                for (int b = 0; b < BRANCHES; ++b)
+                {
+                    if (branch_sample[b] < 0) continue;
+                    candidate_type c = branch_best[b];
+                    c.arm_angle = wrap(c.arm_angle);
+                    if (c.cost == res.cost && c.arm_angle == res.arm_angle) continue;
+                    std::size_t j = res.fallbacks.size();
+                    res.fallbacks.push_back(c);
+                    for (; j > 0 && res.fallbacks[j - 1].cost > c.cost; --j)
+                        res.fallbacks[j] = res.fallbacks[j - 1];
+                    res.fallbacks[j] = c;
+                }
+                return res;
+            }
+            // the cost the search minimises, for joints changed afterwards (e.g.
+            // polished by Kine7::refine) and still attributed to arm_angle
+            value_type cost(const vec7 &q, const value_type arm_angle,
+                    const value_type last_arm_angle, const vec7 &last_joints) const
+            {
+                const value_type d = wrap(arm_angle - last_arm_angle);
+                return (q - last_joints).squaredNorm() + _arm_angle_weight*d*d;
+            }
+        private:
+            // a grid point and its neighbours inside the same feasible interval,
+            // all in the branch [l, l + length] of the interval
+            struct sample_type
+            {
+                sample_type() {}
+                sample_type(const value_type a, const value_type l, const value_type u)
+                    : arm_angle(a), lower(l), upper(u) {}
+                value_type arm_angle;
+                value_type lower;
+                value_type upper;
+            };
+            typedef ::rpp::util::FixedVector<sample_type, MAX_SAMPLES> samples_type;
+
+            static value_type wrap(value_type a)
+            {
+                const value_type PI = ::rpp::util::Constants<value_type>::pi;
+                a = fmod(a + PI, 2*PI);
+                if (a < 0) a += 2*PI;
+                return a - PI;
+            }
+            // an interval crossing +-pi has lower > upper
+            static value_type length(const typename angular_interval_set::const_iterator it)
+            {
+                const value_type PI = ::rpp::util::Constants<value_type>::pi;
+                const value_type len = it->upper() - it->lower();
+                return len < 0 ? len + 2*PI : len;
+            }
+            // the sweep rounded up to whole lanes, one point per interval and the
+            // rest by length, evenly inside each interval. psi_prev is inserted
+            // in order into the interval containing it.
+            void make_samples(const angular_interval_set &range, const value_type last_arm_angle,
+                    samples_type &samples) const
+            {
+                const value_type PI = ::rpp::util::Constants<value_type>::pi;
+                const int n_intervals = (int)range.size();
+                const int with_prev = range.contains(last_arm_angle) ? 1 : 0;
+                int n = (std::max)(_sweep_points, n_intervals + with_prev);
+                n = ((n + SWEEP_LANES - 1)/SWEEP_LANES)*SWEEP_LANES;
+                value_type total = 0;
+                for (auto it = range.begin(); it != range.end(); ++it)
+                    total += length(it);
+                const int spare = n - n_intervals - with_prev;
+                for (auto it = range.begin(); it != range.end(); ++it)
+                {
+                    const value_type l = it->lower();
+                    const value_type len = length(it);
+                    const int m = 1 + (total > 0 ? (int)(spare*len/total) : 0);
+                    bool prev = with_prev && it->contains(last_arm_angle);
+                    value_type p = 0;
+                    if (prev)
+                    {
+                        // express psi_prev in the same branch as [l, l + len]
+                        p = l + fmod(last_arm_angle - l, 2*PI);
+                        if (p < l) p += 2*PI;
+                        if (p > l + len) p = l + len;
+                    }
+                    const std::size_t first = samples.size();
+                    for (int j = 0; j < m; ++j)
+                    {
+                        const value_type x = l + len*(j + value_type(0.5))/m;
+                        if (prev && p <= x)
+                        {
+                            samples.push_back(sample_type(p, l, l + len));
+                            prev = false;
+                        }
+                        samples.push_back(sample_type(x, l, l + len));
+                    }
+                    if (prev) samples.push_back(sample_type(p, l, l + len));
+                    for (std::size_t k = first; k < samples.size(); ++k)
+                    {
+                        if (k > first) samples[k].lower = samples[k - 1].arm_angle;
+                        if (k + 1 < samples.size()) samples[k].upper = samples[k + 1].arm_angle;
+                    }
+                }
+            }
+            // one get_joints() call, keeps the best candidate in res, returns its cost
+            template <typename F>
+            value_type cost(self_motion &sm, F &sh, const value_type arm_angle,
+                    const value_type last_arm_angle, const vec7 &last_joints,
+                    result_type &res) const
+            {
+                ++res.evaluations;
+                const value_type d = wrap(arm_angle - last_arm_angle);
+                const value_type c_psi = _arm_angle_weight*d*d;
+                value_type best = std::numeric_limits<value_type>::infinity();
+                auto joints = sm.get_joints(arm_angle, sh);
+                for (auto it = joints.begin(); it != joints.end(); ++it)
+                {
+                    const value_type c = (*it - last_joints).squaredNorm() + c_psi;
+                    if (c < best) best = c;
+                    if (c < res.cost)
+                    {
+                        res.found = true;
+                        res.cost = c;
+                        res.arm_angle = arm_angle;
+                        res.joints = *it;
+                    }
+                }
+                return best;
+            }
+            int _max_evaluations;
+            int _sweep_points;
+            value_type _arm_angle_weight;
+        };
+    }
+}
+#endif // ARM_ANGLE_HPP__
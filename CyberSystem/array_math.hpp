@@ -0,0 +1,244 @@
+#ifndef ARRAY_MATH_HPP__
+#define ARRAY_MATH_HPP__
+#include <cmath>
+#include "eigen3/Eigen/Eigen"
+#ifdef EIGEN_VECTORIZE_SSE2
+#include <emmintrin.h>
+#endif
+namespace rpp
+{
+    namespace util
+    {
+        // atan2 and acos over fixed-size Eigen arrays. The arctangent is the Cephes
+        // one: |y|/|x| is reduced to [0, 0.66] with a single division, then a 4/5
+        // rational approximation; about one ulp from std::atan2 in double.
+        // float uses the shorter Cephes atanf polynomial on [0, tan(pi/8)].
+        // With SSE2 two doubles or four floats are evaluated per instruction, the
+        // scalar kernels below run the same steps for the remaining lanes.
+        template <typename T>
+        struct AtanCoeffs
+        {
+            static T p(const T z)
+            {
+                return (((T(-8.750608600031904122785e-1)*z
+                    + T(-1.615753718733365076637e1))*z
+                    + T(-7.500855792314704667340e1))*z
+                    + T(-1.228866684490136173410e2))*z
+                    + T(-6.485021904942025371773e1);
+            }
+            static T q(const T z)
+            {
+                return ((((z + T(2.485846490142306297962e1))*z
+                    + T(1.650270098316988542046e2))*z
+                    + T(4.328810604912902668951e2))*z
+                    + T(4.853903996359136964868e2))*z
+                    + T(1.945506571482613964425e2);
+            }
+        };
+
+        template <typename T>
+        T atan2_kernel(const T y, const T x)
+        {
+            const T PI = T(3.14159265358979323846);
+            const T PI_2 = T(1.57079632679489661923);
+            const T PI_4 = T(0.78539816339744830962);
+            const T MOREBITS = T(6.123233995736765886130e-17);
+            const T ax = std::fabs(x);
+            const T ay = std::fabs(y);
+            T num = ay, den = ax, base = 0, more = 0;
+            if (ay > T(2.41421356237309504880)*ax)
+            {
+                num = -ax;
+                den = ay;
+                base = PI_2;
+                more = MOREBITS;
+            }
+            else if (ay > T(0.66)*ax)
+            {
+                num = ay - ax;
+                den = ay + ax;
+                base = PI_4;
+                more = T(0.5)*MOREBITS;
+            }
+            if (den == 0) den = 1;
+            const T r = num/den;
+            const T z = r*r;
+            T t = base + (r*z*AtanCoeffs<T>::p(z)/AtanCoeffs<T>::q(z) + r + more);
+            if (x < 0) t = PI - t;
+            return y < 0 || (y == 0 && 1/y < 0) ? -t : t;
+        }
+
+        inline float atan2_kernel(const float y, const float x)
+        {
+            const float ax = std::fabs(x);
+            const float ay = std::fabs(y);
+            float num = ay, den = ax, base = 0;
+            if (ay > 2.414213562373095f*ax)
+            {
+                num = -ax;
+                den = ay;
+                base = 1.5707963267948966f;
+            }
+            else if (ay > 0.4142135623730950f*ax)
+            {
+                num = ay - ax;
+                den = ay + ax;
+                base = 0.7853981633974483f;
+            }
+            if (den == 0) den = 1;
+            const float r = num/den;
+            const float z = r*r;
+            float t = base + ((((8.05374449538e-2f*z - 1.38776856032e-1f)*z
+                + 1.99777106478e-1f)*z - 3.33329491539e-1f)*z*r + r);
+            if (x < 0) t = 3.14159265358979323846f - t;
+            return y < 0 || (y == 0 && 1/y < 0) ? -t : t;
+        }
+
+#ifdef EIGEN_VECTORIZE_SSE2
+        inline __m128d atan2_kernel(const __m128d y, const __m128d x)
+        {
+            const __m128d sign = _mm_set1_pd(-0.0);
+            const __m128d zero = _mm_setzero_pd();
+            const __m128d one = _mm_set1_pd(1.0);
+            const __m128d ax = _mm_andnot_pd(sign, x);
+            const __m128d ay = _mm_andnot_pd(sign, y);
+            const __m128d big = _mm_cmpgt_pd(ay, _mm_mul_pd(_mm_set1_pd(2.41421356237309504880), ax));
+            const __m128d mid = _mm_andnot_pd(big, _mm_cmpgt_pd(ay, _mm_mul_pd(_mm_set1_pd(0.66), ax)));
+            const __m128d other = _mm_andnot_pd(_mm_or_pd(big, mid), _mm_cmpeq_pd(zero, zero));
+            __m128d num = _mm_or_pd(_mm_or_pd(_mm_and_pd(big, _mm_xor_pd(sign, ax)),
+                        _mm_and_pd(mid, _mm_sub_pd(ay, ax))), _mm_and_pd(other, ay));
+            __m128d den = _mm_or_pd(_mm_or_pd(_mm_and_pd(big, ay),
+                        _mm_and_pd(mid, _mm_add_pd(ay, ax))), _mm_and_pd(other, ax));
+            const __m128d den0 = _mm_cmpeq_pd(den, zero);
+            den = _mm_or_pd(_mm_andnot_pd(den0, den), _mm_and_pd(den0, one));
+            const __m128d r = _mm_div_pd(num, den);
+            const __m128d z = _mm_mul_pd(r, r);
+            __m128d p = _mm_set1_pd(-8.750608600031904122785e-1);
+            p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(-1.615753718733365076637e1));
+            p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(-7.500855792314704667340e1));
+            p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(-1.228866684490136173410e2));
+            p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(-6.485021904942025371773e1));
+            __m128d q = _mm_add_pd(z, _mm_set1_pd(2.485846490142306297962e1));
+            q = _mm_add_pd(_mm_mul_pd(q, z), _mm_set1_pd(1.650270098316988542046e2));
+            q = _mm_add_pd(_mm_mul_pd(q, z), _mm_set1_pd(4.328810604912902668951e2));
+            q = _mm_add_pd(_mm_mul_pd(q, z), _mm_set1_pd(4.853903996359136964868e2));
+            q = _mm_add_pd(_mm_mul_pd(q, z), _mm_set1_pd(1.945506571482613964425e2));
+            const __m128d base = _mm_or_pd(_mm_and_pd(big, _mm_set1_pd(1.57079632679489661923)),
+                    _mm_and_pd(mid, _mm_set1_pd(0.78539816339744830962)));
+            const __m128d more = _mm_or_pd(_mm_and_pd(big, _mm_set1_pd(6.123233995736765886130e-17)),
+                    _mm_and_pd(mid, _mm_set1_pd(3.061616997868382943065e-17)));
+            __m128d t = _mm_add_pd(base, _mm_add_pd(_mm_add_pd(
+                        _mm_div_pd(_mm_mul_pd(_mm_mul_pd(r, z), p), q), r), more));
+            const __m128d xneg = _mm_cmplt_pd(x, zero);
+            t = _mm_or_pd(_mm_andnot_pd(xneg, t),
+                    _mm_and_pd(xneg, _mm_sub_pd(_mm_set1_pd(3.14159265358979323846), t)));
+            // t >= 0 here, take the sign of y (this also keeps atan2(-0, x) = -0 or -pi)
+            return _mm_or_pd(t, _mm_and_pd(sign, y));
+        }
+
+        inline __m128 atan2_kernel(const __m128 y, const __m128 x)
+        {
+            const __m128 sign = _mm_set1_ps(-0.0f);
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 one = _mm_set1_ps(1.0f);
+            const __m128 ax = _mm_andnot_ps(sign, x);
+            const __m128 ay = _mm_andnot_ps(sign, y);
+            const __m128 big = _mm_cmpgt_ps(ay, _mm_mul_ps(_mm_set1_ps(2.414213562373095f), ax));
+            const __m128 mid = _mm_andnot_ps(big, _mm_cmpgt_ps(ay, _mm_mul_ps(_mm_set1_ps(0.4142135623730950f), ax)));
+            const __m128 other = _mm_andnot_ps(_mm_or_ps(big, mid), _mm_cmpeq_ps(zero, zero));
+            const __m128 num = _mm_or_ps(_mm_or_ps(_mm_and_ps(big, _mm_xor_ps(sign, ax)),
+                        _mm_and_ps(mid, _mm_sub_ps(ay, ax))), _mm_and_ps(other, ay));
+            __m128 den = _mm_or_ps(_mm_or_ps(_mm_and_ps(big, ay),
+                        _mm_and_ps(mid, _mm_add_ps(ay, ax))), _mm_and_ps(other, ax));
+            const __m128 den0 = _mm_cmpeq_ps(den, zero);
+            den = _mm_or_ps(_mm_andnot_ps(den0, den), _mm_and_ps(den0, one));
+            const __m128 r = _mm_div_ps(num, den);
+            const __m128 z = _mm_mul_ps(r, r);
+            __m128 p = _mm_set1_ps(8.05374449538e-2f);
+            p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(-1.38776856032e-1f));
+            p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(1.99777106478e-1f));
+            p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(-3.33329491539e-1f));
+            const __m128 base = _mm_or_ps(_mm_and_ps(big, _mm_set1_ps(1.5707963267948966f)),
+                    _mm_and_ps(mid, _mm_set1_ps(0.7853981633974483f)));
+            __m128 t = _mm_add_ps(base, _mm_add_ps(_mm_mul_ps(_mm_mul_ps(p, z), r), r));
+            const __m128 xneg = _mm_cmplt_ps(x, zero);
+            t = _mm_or_ps(_mm_andnot_ps(xneg, t),
+                    _mm_and_ps(xneg, _mm_sub_ps(_mm_set1_ps(3.14159265358979323846f), t)));
+            return _mm_or_ps(t, _mm_and_ps(sign, y));
+        }
+#endif
+
+        template <typename T, int N>
+        void array_atan2(const Eigen::Array<T, N, 1> &y, const Eigen::Array<T, N, 1> &x,
+                Eigen::Array<T, N, 1> &res)
+        {
+            for (int i = 0; i < N; ++i)
+                res(i) = atan2_kernel(y(i), x(i));
+        }
+
+        // acos(x) = atan2(sqrt((1 - x)(1 + x)), x), NaN for |x| > 1 as std::acos
+        template <typename T, int N>
+        void array_acos(const Eigen::Array<T, N, 1> &x, Eigen::Array<T, N, 1> &res)
+        {
+            for (int i = 0; i < N; ++i)
+                res(i) = atan2_kernel(std::sqrt((1 - x(i))*(1 + x(i))), x(i));
+        }
+
+#ifdef EIGEN_VECTORIZE_SSE2
+        template <int N>
+        void array_atan2(const Eigen::Array<double, N, 1> &y, const Eigen::Array<double, N, 1> &x,
+                Eigen::Array<double, N, 1> &res)
+        {
+            int i = 0;
+            for (; i + 1 < N; i += 2)
+                _mm_storeu_pd(res.data() + i,
+                        atan2_kernel(_mm_loadu_pd(y.data() + i), _mm_loadu_pd(x.data() + i)));
+            for (; i < N; ++i)
+                res(i) = atan2_kernel(y(i), x(i));
+        }
+
+        template <int N>
+        void array_acos(const Eigen::Array<double, N, 1> &x, Eigen::Array<double, N, 1> &res)
+        {
+            const __m128d one = _mm_set1_pd(1.0);
+            int i = 0;
+            for (; i + 1 < N; i += 2)
+            {
+                const __m128d v = _mm_loadu_pd(x.data() + i);
+                const __m128d s = _mm_sqrt_pd(_mm_mul_pd(_mm_sub_pd(one, v), _mm_add_pd(one, v)));
+                _mm_storeu_pd(res.data() + i, atan2_kernel(s, v));
+            }
+            for (; i < N; ++i)
+                res(i) = atan2_kernel(std::sqrt((1 - x(i))*(1 + x(i))), x(i));
+        }
+
+        template <int N>
+        void array_atan2(const Eigen::Array<float, N, 1> &y, const Eigen::Array<float, N, 1> &x,
+                Eigen::Array<float, N, 1> &res)
+        {
+            int i = 0;
+            for (; i + 3 < N; i += 4)
+                _mm_storeu_ps(res.data() + i,
+                        atan2_kernel(_mm_loadu_ps(y.data() + i), _mm_loadu_ps(x.data() + i)));
+            for (; i < N; ++i)
+                res(i) = atan2_kernel(y(i), x(i));
+        }
+
+        template <int N>
+        void array_acos(const Eigen::Array<float, N, 1> &x, Eigen::Array<float, N, 1> &res)
+        {
+            const __m128 one = _mm_set1_ps(1.0f);
+            int i = 0;
+            for (; i + 3 < N; i += 4)
+            {
+                const __m128 v = _mm_loadu_ps(x.data() + i);
+                const __m128 s = _mm_sqrt_ps(_mm_mul_ps(_mm_sub_ps(one, v), _mm_add_ps(one, v)));
+                _mm_storeu_ps(res.data() + i, atan2_kernel(s, v));
+            }
+            for (; i < N; ++i)
+                res(i) = atan2_kernel(std::sqrt((1 - x(i))*(1 + x(i))), x(i));
+        }
+#endif
+    }
+}
+#endif // ARRAY_MATH_HPP__
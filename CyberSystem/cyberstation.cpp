@@ -305,7 +305,7 @@ void CyberStation::CalRGloCoeff(const double RGloCaliData[4][5][4])
 		m_GesData[i][4][2] = RGloCaliData[i][4][3];
 	}
 
-	// ָǶȱ궨
+	// 四手指弯曲角度标定
 	for(int i = 1; i < 5; ++i)
 	{
 		for (int j = 0; j < 2; ++j)
@@ -314,12 +314,12 @@ void CyberStation::CalRGloCoeff(const double RGloCaliData[4][5][4])
 			m_RGloCaliB[i][j] = 75.0 - m_RGloCaliK[i][j]*m_GesData[1][i][j];
 		}
 	}
-	// ĴָǶȱ궨
+	// 大拇指弯曲角度标定
 	m_RGloCaliK[0][0] = HandAcces/(m_GesData[1][0][0] - m_GesData[2][0][0]);
 	m_RGloCaliB[0][0] = 75.0 - m_RGloCaliK[0][0]*m_GesData[1][0][0];
 	m_RGloCaliK[0][1] = HandAcces/(m_GesData[3][0][1] - m_GesData[2][0][1]);
 	m_RGloCaliB[0][1] = 75.0 - m_RGloCaliK[0][1]*m_GesData[3][0][1];
-	// ָڽǶ
+	// 各手指侧摆角度
 	m_RGloCaliK[0][2] = 0;
 	m_RGloCaliB[0][2] = 0;
 	m_RGloCaliK[1][2] = 12.0/(71.0 - 167.0);
@@ -474,6 +474,25 @@ mat4x4 CyberStation::GetRRawTraData()
 
 
 
+mat4x4 CyberStation::GetLRawTraData()
+{
+	m_pLeftRcvr->update();
+	m_pLeftTracker->getLogicalDevice(0)->getTransform(&LTraXForm);
+	LTraXForm.getTransform(LFormMat);
+
+	mat4x4 Mat;
+	for (int i = 0; i < 4; i++)
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			Mat(i, j) = LFormMat[i][j];
+		}
+	}
+	return Mat;
+}
+
+
+
 // Calculate Transformation Matrxi,
 // TODO(CJH): Without Add Left Tracker Calibration
 void CyberStation::CalRTraCoef(const double RPose[], const int &len_RPose)
@@ -595,9 +614,46 @@ void CyberStation::CalRTraCoef(const mat4x4 &R_Mat)
 }
 
 
+// 左跟踪器的标定与右跟踪器相同，LPose为右臂坐标系下的标定位置；
+// 映射到机器人时再关于ARM_MIRROR_AXIS镜像，见LTraMapping
 void CyberStation::CalLTraCoef(const double LPose[], const int &len_LPose)
 {
+	// Use Euler Angle
+	if (len_LPose == 6)
+	{
+		// Device Calibration: Step 1
+		// position matrix calculate
+		LTransCoeffMat << 0, 1, 0, LPose[0] - LFormMat[1][3],
+			0, 0, 1, LPose[1] - LFormMat[2][3],
+			1, 0, 0, LPose[2] - LFormMat[0][3],
+			0, 0, 0, 1;
 
+		// Device Calibration: Step 2
+		// orient data of a special pose
+		mat3x3 LOriMat;
+		LOriMat << 1, 0, 0,
+			0, 0, 1,
+			0, -1, 0;
+		mat3x3 LOOnMat;
+		LOOnMat << 0, 1, 0,
+			0, 0, 1,
+			1, 0, 0;
+		mat3x3 LOSMat;
+		for (int i = 0; i < 3; i++)
+		{
+			for (int j = 0; j < 3; j++)
+			{
+				LOSMat(i, j) = LFormMat[i][j];
+			}
+		}
+		LRotCoeffMat = LOSMat.inverse()*LOOnMat*LOriMat;
+
+		// Motion Mapping
+		CalRTraMapCoeff();
+
+		// Indicate: Left Tracker Calibration is Finished
+		m_bLTraCaliFin = true;
+	}
 }
 
 void CyberStation::CalLTraCoef(const mat4x4 &L_Mat)
@@ -667,8 +723,8 @@ mat4x4 CyberStation::GetRTraRealData()
 
 		// Get Cyber Data in a Special Coordination
 		// translation data
-		mat4x4 RTransMat;		// ӳ
-		mat4x4 RTransMat_bf;		// ӳǰ
+		mat4x4 RTransMat;		// 映射后
+		mat4x4 RTransMat_bf;		// 映射前
 		RTransMat_bf(0, 3) = TransCoeffMat(0, 0)*RFormMat[0][3] + TransCoeffMat(0, 1)*RFormMat[1][3]
 		+ TransCoeffMat(0, 2)*RFormMat[2][3] + TransCoeffMat(0, 3);
 		RTransMat_bf(1, 3) = TransCoeffMat(1, 0)*RFormMat[0][3] + TransCoeffMat(1, 1)*RFormMat[1][3]
@@ -697,10 +753,10 @@ mat4x4 CyberStation::GetRTraRealData()
 			}
 		}
 
-		// õӳֵ
+		// 得到映射后的值
 		RTraMapping(RTransMat_bf, RTransMat);	
 
-		// 
+		// 死区
 		for (int i = 0; i<4; i++)
 		{
 			for (int j = 0; j<4; j++)
@@ -728,14 +784,76 @@ mat4x4 CyberStation::GetRTraRealData()
 }
 
 
+// Get Left Tracker's Real Transformation Matrix, 
+// Must After a Left Tracker Calibration
+mat4x4 CyberStation::GetLTraRealData()
+{
+	if (m_bLTraCaliFin == true){
+		// update raw data
+		m_pLeftRcvr->update();
+		m_pLeftTracker->getLogicalDevice(0)->getTransform(&LTraXForm);
+		LTraXForm.getTransform(LFormMat);
+
+		mat4x4 LTransMat;		// 映射后
+		mat4x4 LTransMat_bf;		// 映射前
+		// translation data
+		for (int i = 0; i < 3; i++)
+		{
+			LTransMat_bf(i, 3) = LTransCoeffMat(i, 0)*LFormMat[0][3] + LTransCoeffMat(i, 1)*LFormMat[1][3]
+			+ LTransCoeffMat(i, 2)*LFormMat[2][3] + LTransCoeffMat(i, 3);
+		}
+
+		// vision data
+		LTransMat_bf(3, 0) = LTransMat_bf(3, 1) = LTransMat_bf(3, 2) = 0;
+		LTransMat_bf(3, 3) = 1;
+
+		// rotation data
+		mat3x3 LOOnMat;
+		LOOnMat << 0, 1, 0,
+			0, 0, 1,
+			1, 0, 0;
+		mat3x3 LOSMat;
+		for (int i = 0; i < 3; i++)
+		{
+			for (int j = 0; j < 3; j++)
+			{
+				LOSMat(i, j) = LFormMat[i][j];
+			}
+		}
+		LTransMat_bf.block<3, 3>(0, 0) = LOOnMat.inverse()*LOSMat*LRotCoeffMat;
+
+		// 得到映射后的值
+		LTraMapping(LTransMat_bf, LTransMat);
+
+		// 死区
+		for (int i = 0; i<4; i++)
+		{
+			for (int j = 0; j<4; j++)
+			{
+				if (abs(LTransMat(i,j))<1e-5)
+				{
+					LTransMat(i,j) = 0;
+				}
+			}
+		}
+
+		return LTransMat;
+	}
+
+	else{
+		return mat4x4::Identity();
+	}
+}
+
+
 void CyberStation::RTraMapping(const mat4x4 &Mat_In, mat4x4 &Mat_Out)
 {
-	// λӳ
+	// 位置映射
 	for (int i = 0; i < 3; ++i){
 		Mat_Out(i, 3) = Mat_In(i, 3)*10 + m_TransMapCoeff[i];
 	}
 
-// 	// Ƕӳ
+// 	// 变角度映射
 // 	mat3x3 RTrans_tmp;
 // 	for (int i = 0; i<3; i++)
 // 	{
@@ -753,7 +871,7 @@ void CyberStation::RTraMapping(const mat4x4 &Mat_In, mat4x4 &Mat_Out)
 // 		}
 // 	}
 
-	// ̶Ƕӳ
+	// 固定角度映射
 	mat3x3 RoboRot;
 	RoboRot << -0.176314, -0.984285, 0.00985975,
 		-0.703848, 0.119064, -0.700301,
@@ -767,11 +885,24 @@ void CyberStation::RTraMapping(const mat4x4 &Mat_In, mat4x4 &Mat_Out)
 		}
 	}
 
-	// Ӿ
+	// 视觉矩阵
 	Mat_Out(3, 0) = Mat_Out(3, 1) = Mat_Out(3, 2) = 0;
 	Mat_Out(3, 3) = 1;
 }
 
+// 左臂与右臂关于ARM_MIRROR_AXIS的法平面对称：先按右臂映射，再把位姿镜像到左臂
+void CyberStation::LTraMapping(const mat4x4 &Mat_In, mat4x4 &Mat_Out)
+{
+	RTraMapping(Mat_In, Mat_Out);
+
+	for (int i = 0; i < 4; ++i)
+	{
+		Mat_Out(ARM_MIRROR_AXIS, i) = -Mat_Out(ARM_MIRROR_AXIS, i);
+		Mat_Out(i, ARM_MIRROR_AXIS) = -Mat_Out(i, ARM_MIRROR_AXIS);
+	}
+}
+
+
 
 
 
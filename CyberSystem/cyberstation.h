@@ -6,6 +6,9 @@
 #define SETCUT(X, CUT) if(abs(X) < CUT) X = 0;
 #define SETRANGE(X,MIN_DATA,MAX_DATA) if(X < MIN_DATA) X = MIN_DATA; if(X > MAX_DATA) X = MAX_DATA;
 
+// 左右臂基坐标系互为镜像，镜像平面的法向轴（0 x，1 y，2 z）
+#define ARM_MIRROR_AXIS 1
+
 #include "inlib.h"
 
 #include <vector>
@@ -97,9 +100,13 @@ public:
 	void CalRTraMapCoeff();
 	void RTraMapping(const mat4x4 &in, mat4x4 &out);
 
+	// Get left tracker data
+	mat4x4 GetLRawTraData();
+	mat4x4 GetLTraRealData();
+
 	void CalLTraCoef(const double *, const int &);
 	void CalLTraCoef(const mat4x4 &);
-	void LTraMapping();
+	void LTraMapping(const mat4x4 &in, mat4x4 &out);
 
 	void UpdateTraCali(const mat4x4 &RTransMat, const mat3x3 &RRotMat);
 	bool GetCaliCoef(mat4x4 &RTransMat, mat3x3 &RRotMat);
@@ -118,6 +125,9 @@ private:
 	mat3x3 RotOSMat;
 	mat3x3 RotOOnMat;
 	mat3x3 RotOnPMat;
+	// Left tracker coefficient
+	mat4x4 LTransCoeffMat;
+	mat3x3 LRotCoeffMat;
 	// Mapping Coefficient
 	mat3x3 m_RotMapCoeff;
 	double m_TransMapCoeff[3];
@@ -4,16 +4,31 @@
 #include <sstream>
 
 #include "kine7.hpp"
+#include "diff_kine.hpp"
+#include "singular_value.hpp"
+#include "kine_solver.hpp"
+#include "kine_expanded.hpp"
+#include "ik_strategy.hpp"
+#include "ReachMap.h"
+#include "ArmChain.h"
+#include "trajectory.hpp"
 
 
 #define ArmDebug 0
+#define KineDebug 0		// 输出逆运动学修正及位姿缓存统计
+#define KineCachePosStep 0.5	// 位姿缓存的位置量化步长(mm)，0关闭缓存；跟踪器抖动在同一格内时由缓存的关节角迭代修正
+#define KineCacheRotStep 1e-3	// 位姿缓存的姿态矩阵元素量化步长
+#define ReachMapFile "./data/ReachMap.dat"	// 工作空间可达性地图，参数改变时自动重新生成
+#define LReachMapFile "./data/ReachMap_Left.dat"	// 左臂的可达性地图（关节限位与右臂不同）
+#define KineStrategy 2		// 逆运动学策略：0解析，1微分（首次解析求解），2解析为主、奇异附近及无解时微分
+#define PlanTimeScaling 1		// 规划的时间缩放：0匀速，1最小加加速度（五次多项式），2梯形速度
 
 #define DEG2ANG(x) (x*180/3.1415926535898)
 #define	ANG2DEG(x) (x*3.1415926535898/180)
 #define SGN(X) ((X>=0) ? 1:(-1))
 
 
-// ʼؽڽ
+// 初始关节角
 // #define INIT_JOINT1 -39.1323
 // #define INIT_JOINT2 -11.2267
 // #define INIT_JOINT3 96.994
@@ -31,7 +46,7 @@
 #define INIT_JOINT6 -28.523
 #define INIT_JOINT7 -29.902
 
-// ʼλ
+// 初始位置
 #define POS11 -0.176
 #define POS12 -0.984
 #define POS13 0.01
@@ -80,21 +95,43 @@ void PASCAL TimerProcVisionRecv(UINT wTimerID, UINT msg, DWORD dwUser, DWORD dwl
 	g_pCyberSys->RecvVision();
 }
 
-extern CRobonautData g_RobotCmdDeg;     //ȫֻ˿ָλǶ
-extern CRobonautData g_SRobotCmdDeg;    //͵İȫ˿ָλǶ
-extern CRobonautData g_RobotSensorDeg;  //ȫֻ˴ݵλǶ
+extern CRobonautData g_RobotCmdDeg;     //全局机器人控制指令单位角度
+extern CRobonautData g_SRobotCmdDeg;    //发送的安全机器人控制指令单位角度
+extern CRobonautData g_RobotSensorDeg;  //全局机器人传感器数据单位角度
 
 float g_rightArmJointBuf[7];	// global data from slider for joint control
 float g_leftArmJointBuf[7];		// global data from slider for joint control
 
 
 //typedef rpp::kine::Kine7<double> kine_type;
-rpp::kine::Kine7<double> m_Kine;
-rpp::kine::SingularityHandler<double> sh;
-rpp::kine::Kine7<double>::angular_interval_vector joint_limits;
+rpp::kine::KineSolver<double> m_KineSolver;
+rpp::kine::DiffKineSolver<double> m_DiffSolver;
+rpp::kine::SvMinEstimator<double> m_SvMin;
+
+// 逆运动学策略，各自统计耗时和成功次数；求解器在InitKine中赋值，策略只保存其地址
+rpp::kine::AnalyticIk<double> m_AnalyticIk(m_KineSolver);
+rpp::kine::DifferentialIk<double> m_DifferentialIk(m_DiffSolver);
+rpp::kine::HybridIk<double> m_HybridIk(m_AnalyticIk, m_DifferentialIk);
+ReachMap m_ReachMap;
+// 路径规划的采样在getPlanData中一次生成，控制循环按步读取
+rpp::kine::Trajectory<double> m_RPlanTraj;
+// 多路径点规划的关节位置、速度、加速度限制，在InitKine中赋值
+rpp::kine::JointPlanner<double>::limits_type m_PlanLimits;
+// 左臂使用自己的求解器（DH参数与右臂相同，关节限位见ROBO_LJ*_MIN/MAX），在m_ArmPool中与右臂同时求解；
+// 目标为LTraMapping镜像到左臂基坐标系中的位姿，关节角直接发送，不再变换
+static_assert(ARM_MIRROR_AXIS == 1, "mirror_joints only mirrors through the y axis");
+ArmChain m_LArmChain(KineStrategy);
+ReachMap m_LReachMap;
+#if KineStrategy == 0
+rpp::kine::IkStrategy<double> *m_IkStrategy = &m_AnalyticIk;
+#elif KineStrategy == 1
+rpp::kine::IkStrategy<double> *m_IkStrategy = &m_DifferentialIk;
+#else
+rpp::kine::IkStrategy<double> *m_IkStrategy = &m_HybridIk;
+#endif
 
 CyberSystem::CyberSystem(QWidget *parent)
-	: QMainWindow(parent), m_DisThread(this), m_CamThread(this)/*, m_RobonautCtrlThread(this)*/
+	: QMainWindow(parent), m_DisThread(this), m_CamThread(this), m_VisionLink(m_VisionRecv_Client)/*, m_RobonautCtrlThread(this)*/
 {
 	ui.setupUi(this);
 
@@ -214,9 +251,17 @@ CyberSystem::CyberSystem(QWidget *parent)
 		0, 0, 0, 0, 0, 0, 0,
 		0, 0, 0, 0, 0, 0, 0;
 
+	// 左臂的初始位姿和关节角与右臂镜像
+	m_LTraRealMat = rpp::kine::mirror_pose(m_RTraRealMat, ARM_MIRROR_AXIS);
+
 	// Initialize kinetic calculate
 	InitKine();
 	m_bJacoIsInit = false;
+	// 镜像位姿对应的关节角：关节0、2、4、6取反，臂角也取反
+	m_LArmChain.Reset(rpp::kine::mirror_joints(m_last_joint_angle, ARM_MIRROR_AXIS), -m_last_arm_angle);
+	m_ArmPool.setMaxThreadCount(1);
+	m_DiffKineIter = 0;
+	m_DiffKineResidual = 0;
 
 	// Vision Control
 	// Reference Pose
@@ -428,6 +473,7 @@ CyberSystem::~CyberSystem()
 
 	m_CamThread.stop();
 	m_CamThread.wait();
+	m_RobonautControl.Reactor().Remove(&m_VisionLink);
 
 	m_fRRealMat.clear();
 	m_fRRealMat.close();
@@ -666,12 +712,31 @@ void CyberSystem::DisTraData()
 		// Connected Left Tracker
 		if (m_LTraContr == true)
 		{
+			// 与右跟踪器相同，标定后显示映射到左臂的位姿
+			std::ostringstream l_tra_stream;
 			if (m_bLTraCaliFini == true)
 			{
+				m_LTraRealMat = m_CyberStation.GetLTraRealData();
+				l_tra_stream << "Real TransMat of Left Tracker is: " << std::endl;
 			} 
 			else
 			{
+				m_LTraRawMat = m_CyberStation.GetLRawTraData();
+				l_tra_stream << "Raw TransMat of Left Tracker is: " << std::endl;
+			}
+			const mat4x4 &LTraMat = m_bLTraCaliFini ? m_LTraRealMat : m_LTraRawMat;
+			l_tra_stream << std::fixed << std::left;
+			l_tra_stream.precision(3);
+			for (int i = 0; i < 4; i++)
+			{
+				for (int j = 0; j < 4; j++)
+				{
+					l_tra_stream.width(12);
+					l_tra_stream << LTraMat(i, j);
+				}
+				l_tra_stream << std::endl;
 			}
+			LTraStr = LTraStr.fromStdString(l_tra_stream.str());
 		}
 
 		Str = RTraStr + LTraStr;
@@ -815,12 +880,12 @@ void CyberSystem::LoadGloCaliData()
 		rapidxml::xml_document<> Calibration;
 		Calibration.parse<0>(fCalibration.data());
 
-		//ȡڵ
+		//获取根节点
 		rapidxml::xml_node<>* GloveCalibration = Calibration.first_node();
-		//ȡؾ
+		//获取相关矩阵
 		rapidxml::xml_node<>* CorrelationMatrix = GloveCalibration->first_node("CorrelationMatrix");
 		rapidxml::xml_attribute<>* CorrelationMatrix_DataType = CorrelationMatrix->first_attribute();
-		//Ĵָ
+		//拇指
 		rapidxml::xml_node<>* CorThumb = CorrelationMatrix->first_node("Thumb");
 		rapidxml::xml_node<>* CorThumbPIP = CorThumb->first_node("PIP");
 		m_RGloCaliK[0][0] = atof(CorThumbPIP->value());
@@ -828,7 +893,7 @@ void CyberSystem::LoadGloCaliData()
 		m_RGloCaliK[0][1] = atof(CorThumbMP->value());
 		rapidxml::xml_node<>* CorThumbABP = CorThumb->first_node("ABP");
 		m_RGloCaliK[0][2] = atof(CorThumbABP->value());
-		//ʳָ
+		//食指
 		rapidxml::xml_node<>* CorIndex = CorrelationMatrix->first_node("Index");
 		rapidxml::xml_node<>* CorIndexPIP = CorIndex->first_node("PIP");
 		m_RGloCaliK[1][0] = atof(CorIndexPIP->value());
@@ -836,7 +901,7 @@ void CyberSystem::LoadGloCaliData()
 		m_RGloCaliK[1][1] = atof(CorIndexMP->value());
 		rapidxml::xml_node<>* CorIndexABP = CorIndex->first_node("ABP");
 		m_RGloCaliK[1][2] = atof(CorIndexABP->value());
-		//ָ
+		//中指
 		rapidxml::xml_node<>* CorMiddle = CorrelationMatrix->first_node("Middle");
 		rapidxml::xml_node<>* CorMiddlePIP = CorMiddle->first_node("PIP");
 		m_RGloCaliK[2][0] = atof(CorMiddlePIP->value());
@@ -844,7 +909,7 @@ void CyberSystem::LoadGloCaliData()
 		m_RGloCaliK[2][1] = atof(CorMiddleMP->value());
 		rapidxml::xml_node<>* CorMiddleABP = CorMiddle->first_node("ABP");
 		m_RGloCaliK[2][2] = atof(CorMiddleABP->value());
-		//ָ
+		//无名指
 		rapidxml::xml_node<>* CorRing = CorrelationMatrix->first_node("Ring");
 		rapidxml::xml_node<>* CorRingPIP = CorRing->first_node("PIP");
 		m_RGloCaliK[3][0] = atof(CorRingPIP->value());
@@ -852,7 +917,7 @@ void CyberSystem::LoadGloCaliData()
 		m_RGloCaliK[3][1] = atof(CorRingMP->value());
 		rapidxml::xml_node<>* CorRingABP = CorRing->first_node("ABP");
 		m_RGloCaliK[3][2] = atof(CorRingABP->value());
-		//Сָ
+		//小指
 		rapidxml::xml_node<>* CorLittle = CorrelationMatrix->first_node("Little");
 		rapidxml::xml_node<>* CorLittlePIP = CorLittle->first_node("PIP");
 		m_RGloCaliK[4][0] = atof(CorLittlePIP->value());
@@ -861,10 +926,10 @@ void CyberSystem::LoadGloCaliData()
 		rapidxml::xml_node<>* CorLittleABP = CorLittle->first_node("ABP");
 		m_RGloCaliK[4][2] = atof(CorLittleABP->value());
 
-		//ȡƫþ
+		//获取偏置矩阵
 		rapidxml::xml_node<>* BiasMatrix = GloveCalibration->first_node("BiasMatrix");
 		rapidxml::xml_attribute<>* BiasMatrix_DataType = BiasMatrix->first_attribute();
-		//Ĵָ
+		//拇指
 		rapidxml::xml_node<>* BiasThumb = BiasMatrix->first_node("Thumb");
 		rapidxml::xml_node<>* BiasThumbPIP = BiasThumb->first_node("PIP");
 		m_RGloCaliB[0][0] = atof(BiasThumbPIP->value());
@@ -872,7 +937,7 @@ void CyberSystem::LoadGloCaliData()
 		m_RGloCaliB[0][1] = atof(BiasThumbMP->value());
 		rapidxml::xml_node<>* BiasThumbABP = BiasThumb->first_node("ABP");
 		m_RGloCaliB[0][2] = atof(BiasThumbABP->value());
-		//ʳָ
+		//食指
 		rapidxml::xml_node<>* BiasIndex = BiasMatrix->first_node("Index");
 		rapidxml::xml_node<>* BiasIndexPIP = BiasIndex->first_node("PIP");
 		m_RGloCaliB[1][0] = atof(BiasIndexPIP->value());
@@ -880,7 +945,7 @@ void CyberSystem::LoadGloCaliData()
 		m_RGloCaliB[1][1] = atof(BiasIndexMP->value());
 		rapidxml::xml_node<>* BiasIndexABP = BiasIndex->first_node("ABP");
 		m_RGloCaliB[1][2] = atof(BiasIndexABP->value());
-		//ָ
+		//中指
 		rapidxml::xml_node<>* BiasMiddle = BiasMatrix->first_node("Middle");
 		rapidxml::xml_node<>* BiasMiddlePIP = BiasMiddle->first_node("PIP");
 		m_RGloCaliB[2][0] = atof(BiasMiddlePIP->value());
@@ -888,7 +953,7 @@ void CyberSystem::LoadGloCaliData()
 		m_RGloCaliB[2][1] = atof(BiasMiddleMP->value());
 		rapidxml::xml_node<>* BiasMiddleABP = BiasMiddle->first_node("ABP");
 		m_RGloCaliB[2][2] = atof(BiasMiddleABP->value());
-		//ָ
+		//无名指
 		rapidxml::xml_node<>* BiasRing = BiasMatrix->first_node("Ring");
 		rapidxml::xml_node<>* BiasRingPIP = BiasRing->first_node("PIP");
 		m_RGloCaliB[3][0] = atof(BiasRingPIP->value());
@@ -896,7 +961,7 @@ void CyberSystem::LoadGloCaliData()
 		m_RGloCaliB[3][1] = atof(BiasRingMP->value());
 		rapidxml::xml_node<>* BiasRingABP = BiasRing->first_node("ABP");
 		m_RGloCaliB[3][2] = atof(BiasRingABP->value());
-		//Сָ
+		//小指
 		rapidxml::xml_node<>* BiasLittle = BiasMatrix->first_node("Little");
 		rapidxml::xml_node<>* BiasLittlePIP = BiasLittle->first_node("PIP");
 		m_RGloCaliB[4][0] = atof(BiasLittlePIP->value());
@@ -931,90 +996,90 @@ void CyberSystem::SaveGloCaliData()
 		}
 	}
 
-	//.xmlļڵ
+	//建立.xml文件节点
 	rapidxml::xml_document<> Calibration;
-	//ڵ
+	//建立声明节点
 	rapidxml::xml_node<>* prolog = Calibration.allocate_node(rapidxml::node_pi,Calibration.allocate_string("xml version='1.0' encoding='utf-8' standalone='yes'"));
 	Calibration.append_node(prolog);
-	//ڵ
+	//建立根节点
 	rapidxml::xml_node<>* GloveCalibration = Calibration.allocate_node(rapidxml::node_element,"GloveCalibration");
 	Calibration.append_node(GloveCalibration);
 
-	//ؾڵ
+	//建立相关矩阵节点
 	rapidxml::xml_node<>* CorrelationMatrix = Calibration.allocate_node(rapidxml::node_element,"CorrelationMatrix");
 	GloveCalibration->append_node(CorrelationMatrix);
 	rapidxml::xml_attribute<>* CorrelationMatrixAttribute = Calibration.allocate_attribute("DataType","float");
 	CorrelationMatrix->append_attribute(CorrelationMatrixAttribute);
 
 
-	//Ĵָ
+	//拇指
 	rapidxml::xml_node<>* CorThumb = Calibration.allocate_node(rapidxml::node_element,"Thumb");
 	CorrelationMatrix->append_node(CorThumb);
 	CorThumb->append_node(Calibration.allocate_node(rapidxml::node_element,"PIP",ch_Correlation[0][0]));
 	CorThumb->append_node(Calibration.allocate_node(rapidxml::node_element,"MP",ch_Correlation[0][1]));
 	CorThumb->append_node(Calibration.allocate_node(rapidxml::node_element,"ABP",ch_Correlation[0][2]));
-	//ʳָ
+	//食指
 	rapidxml::xml_node<>* CorIndex = Calibration.allocate_node(rapidxml::node_element,"Index");
 	CorrelationMatrix->append_node(CorIndex);
 	CorIndex->append_node(Calibration.allocate_node(rapidxml::node_element,"PIP",ch_Correlation[1][0]));
 	CorIndex->append_node(Calibration.allocate_node(rapidxml::node_element,"MP",ch_Correlation[1][1]));
 	CorIndex->append_node(Calibration.allocate_node(rapidxml::node_element,"ABP",ch_Correlation[1][2]));
-	//ָ
+	//中指
 	rapidxml::xml_node<>* CorMiddle = Calibration.allocate_node(rapidxml::node_element,"Middle");
 	CorrelationMatrix->append_node(CorMiddle);
 	CorMiddle->append_node(Calibration.allocate_node(rapidxml::node_element,"PIP",ch_Correlation[2][0]));
 	CorMiddle->append_node(Calibration.allocate_node(rapidxml::node_element,"MP",ch_Correlation[2][1]));
 	CorMiddle->append_node(Calibration.allocate_node(rapidxml::node_element,"ABP",ch_Correlation[2][2]));
-	//ָ
+	//无名指
 	rapidxml::xml_node<>* CorRing = Calibration.allocate_node(rapidxml::node_element,"Ring");
 	CorrelationMatrix->append_node(CorRing);
 	CorRing->append_node(Calibration.allocate_node(rapidxml::node_element,"PIP",ch_Correlation[3][0]));
 	CorRing->append_node(Calibration.allocate_node(rapidxml::node_element,"MP",ch_Correlation[3][1]));
 	CorRing->append_node(Calibration.allocate_node(rapidxml::node_element,"ABP",ch_Correlation[3][2]));
-	//Сָ
+	//小指
 	rapidxml::xml_node<>* CorLittle = Calibration.allocate_node(rapidxml::node_element,"Little");
 	CorrelationMatrix->append_node(CorLittle);
 	CorLittle->append_node(Calibration.allocate_node(rapidxml::node_element,"PIP",ch_Correlation[4][0]));
 	CorLittle->append_node(Calibration.allocate_node(rapidxml::node_element,"MP",ch_Correlation[4][1]));
 	CorLittle->append_node(Calibration.allocate_node(rapidxml::node_element,"ABP",ch_Correlation[4][2]));
 
-	//ƫþڵ
+	//建立偏置矩阵节点
 	rapidxml::xml_node<>* BiasMatrix = Calibration.allocate_node(rapidxml::node_element,"BiasMatrix");
 	GloveCalibration->append_node(BiasMatrix);
 	rapidxml::xml_attribute<>* BiasMatrixAttribute = Calibration.allocate_attribute("DataType","float");
 	BiasMatrix->append_attribute(BiasMatrixAttribute);
-	//Ĵָ
+	//拇指
 	rapidxml::xml_node<>* BiasThumb = Calibration.allocate_node(rapidxml::node_element,"Thumb");
 	BiasMatrix->append_node(BiasThumb);
 	BiasThumb->append_node(Calibration.allocate_node(rapidxml::node_element,"PIP",ch_Bias[0][0]));
 	BiasThumb->append_node(Calibration.allocate_node(rapidxml::node_element,"MP",ch_Bias[0][1]));
 	BiasThumb->append_node(Calibration.allocate_node(rapidxml::node_element,"ABP",ch_Bias[0][2]));
-	//ʳָ
+	//食指
 	rapidxml::xml_node<>* BiasIndex = Calibration.allocate_node(rapidxml::node_element,"Index");
 	BiasMatrix->append_node(BiasIndex);
 	BiasIndex->append_node(Calibration.allocate_node(rapidxml::node_element,"PIP",ch_Bias[1][0]));
 	BiasIndex->append_node(Calibration.allocate_node(rapidxml::node_element,"MP",ch_Bias[1][1]));
 	BiasIndex->append_node(Calibration.allocate_node(rapidxml::node_element,"ABP",ch_Bias[1][2]));
-	//ָ
+	//中指
 	rapidxml::xml_node<>* BiasMiddle = Calibration.allocate_node(rapidxml::node_element,"Middle");
 	BiasMatrix->append_node(BiasMiddle);
 	BiasMiddle->append_node(Calibration.allocate_node(rapidxml::node_element,"PIP",ch_Bias[2][0]));
 	BiasMiddle->append_node(Calibration.allocate_node(rapidxml::node_element,"MP",ch_Bias[2][1]));
 	BiasMiddle->append_node(Calibration.allocate_node(rapidxml::node_element,"ABP",ch_Bias[2][2]));
-	//ָ
+	//无名指
 	rapidxml::xml_node<>* BiasRing = Calibration.allocate_node(rapidxml::node_element,"Ring");
 	BiasMatrix->append_node(BiasRing);
 	BiasRing->append_node(Calibration.allocate_node(rapidxml::node_element,"PIP",ch_Bias[3][0]));
 	BiasRing->append_node(Calibration.allocate_node(rapidxml::node_element,"MP",ch_Bias[3][1]));
 	BiasRing->append_node(Calibration.allocate_node(rapidxml::node_element,"ABP",ch_Bias[3][2]));
-	//Сָ
+	//小指
 	rapidxml::xml_node<>* BiasLittle = Calibration.allocate_node(rapidxml::node_element,"Little");
 	BiasMatrix->append_node(BiasLittle);
 	BiasLittle->append_node(Calibration.allocate_node(rapidxml::node_element,"PIP",ch_Bias[4][0]));
 	BiasLittle->append_node(Calibration.allocate_node(rapidxml::node_element,"MP",ch_Bias[4][1]));
 	BiasLittle->append_node(Calibration.allocate_node(rapidxml::node_element,"ABP",ch_Bias[4][2]));
 
-	//д뵽.xmlļ
+	//写入到.xml文件
 	std::string PrintXml;
 	rapidxml::print(std::back_inserter(PrintXml), Calibration, 0);
 
@@ -1153,9 +1218,13 @@ void CyberSystem::CalTraData()
 		QString YOri = ui.m_pLOriYLiEd->text();
 		QString ZOri = ui.m_pLOriZLiEd->text();
 
+		// 与右臂相同的标定位置（右臂坐标系下），映射时镜像到左臂
 		double pose[6];
+		pose[0] = 0;
+		pose[1] = -33.7;
+		pose[2] = 30.7;
 
-		m_CyberStation.CalLTraCoef(pose, sizeof(pose));
+		m_CyberStation.CalLTraCoef(pose, 6);
 		m_bLTraCaliFini = true;
 	}
 }
@@ -1177,13 +1246,13 @@ void CyberSystem::LoadTraCaliData()
 		rapidxml::xml_document<> Calibration;
 		Calibration.parse<0>(fCalibration.data());
 
-		// ȡڵ
+		// 获取根节点
 		rapidxml::xml_node<>* TrackerCalibration = Calibration.first_node();
 
-		// ȡؾ
+		// 获取相关矩阵
 		rapidxml::xml_node<>* TransMatrix = TrackerCalibration->first_node("TransMatrix");
 		rapidxml::xml_attribute<>* TransMatrix_DataType = TransMatrix->first_attribute();
-		// һ
+		// 第一行
 		rapidxml::xml_node<>* TransFirst = TransMatrix->first_node("TransFirst");
 		rapidxml::xml_node<>* TransFirstA = TransFirst->first_node("A");
 		TransMat(0, 0) = atof(TransFirstA->value());
@@ -1194,7 +1263,7 @@ void CyberSystem::LoadTraCaliData()
 		rapidxml::xml_node<>* TransFirstD = TransFirst->first_node("D");
 		TransMat(0, 3) = atof(TransFirstD->value());
 
-		// ڶ
+		// 第二行
 		rapidxml::xml_node<>* TransSecond = TransMatrix->first_node("TransSecond");
 		rapidxml::xml_node<>* TransSecondA = TransSecond->first_node("A");
 		TransMat(1, 0) = atof(TransSecondA->value());
@@ -1205,7 +1274,7 @@ void CyberSystem::LoadTraCaliData()
 		rapidxml::xml_node<>* TransSecondD = TransSecond->first_node("D");
 		TransMat(1, 3) = atof(TransSecondD->value());
 
-		// 
+		// 第三行
 		rapidxml::xml_node<>* TransThird = TransMatrix->first_node("TransThird");
 		rapidxml::xml_node<>* TransThirdA = TransThird->first_node("A");
 		TransMat(2, 0) = atof(TransThirdA->value());
@@ -1216,7 +1285,7 @@ void CyberSystem::LoadTraCaliData()
 		rapidxml::xml_node<>* TransThirdD = TransThird->first_node("D");
 		TransMat(2, 3) = atof(TransThirdD->value());
 
-		// 
+		// 第四行
 		rapidxml::xml_node<>* TransFourth = TransMatrix->first_node("TransFourth");
 		rapidxml::xml_node<>* TransFourthA = TransFourth->first_node("A");
 		TransMat(3, 0) = atof(TransFourthA->value());
@@ -1231,7 +1300,7 @@ void CyberSystem::LoadTraCaliData()
 		//
 		rapidxml::xml_node<>* RotMatrix = TrackerCalibration->first_node("RotMatrix");
 		rapidxml::xml_attribute<>* RotMatrix_DataType = RotMatrix->first_attribute();
-		//һ
+		//第一行
 		rapidxml::xml_node<>* RotFirst = RotMatrix->first_node("RotFirst");
 		rapidxml::xml_node<>* RotFirstA = RotFirst->first_node("A");
 		RotMat(0, 0) = atof(RotFirstA->value());
@@ -1239,7 +1308,7 @@ void CyberSystem::LoadTraCaliData()
 		RotMat(0, 1) = atof(RotFirstB->value());
 		rapidxml::xml_node<>* RotFirstC = RotFirst->first_node("C");
 		RotMat(0, 2) = atof(RotFirstC->value());
-		//ڶ
+		//第二行
 		rapidxml::xml_node<>* RotSecond = RotMatrix->first_node("RotSecond");
 		rapidxml::xml_node<>* RotSecondA = RotSecond->first_node("A");
 		RotMat(1, 0) = atof(RotSecondA->value());
@@ -1247,7 +1316,7 @@ void CyberSystem::LoadTraCaliData()
 		RotMat(1, 1) = atof(RotSecondB->value());
 		rapidxml::xml_node<>* RotSecondC = RotSecond->first_node("C");
 		RotMat(1, 2) = atof(RotSecondC->value());
-		//
+		//第三行
 		rapidxml::xml_node<>* RotThird = RotMatrix->first_node("RotThird");
 		rapidxml::xml_node<>* RotThirdA = RotThird->first_node("A");
 		RotMat(2, 0) = atof(RotThirdA->value());
@@ -1274,7 +1343,7 @@ void CyberSystem::SaveTraCaliData()
 	Eigen::Matrix<double, 3, 3> RotMat;
 	m_CyberStation.GetCaliCoef(TransMat, RotMat);
 
-	// XMLҪchar͵ı
+	// XML中需要储存char型的变量
 	char ch_TransMat[4][4][8];
 	char ch_RotMat[3][3][8];
 
@@ -1302,44 +1371,44 @@ void CyberSystem::SaveTraCaliData()
 	}
 
 
-	//.xmlļڵ
+	//建立.xml文件节点
 	rapidxml::xml_document<> Calibration;
-	//ڵ
+	//建立声明节点
 	rapidxml::xml_node<>* prolog = Calibration.allocate_node(rapidxml::node_pi,Calibration.allocate_string("xml version='1.0' encoding='utf-8' standalone='yes'"));
 	Calibration.append_node(prolog);
-	//ڵ
+	//建立根节点
 	rapidxml::xml_node<>* TrackerCalibration = Calibration.allocate_node(rapidxml::node_element,"TrackerCalibration");
 	Calibration.append_node(TrackerCalibration);
 
 
-	//ؾڵ
+	//建立相关矩阵节点
 	rapidxml::xml_node<>* TransMatrix = Calibration.allocate_node(rapidxml::node_element,"TransMatrix");
 	TrackerCalibration->append_node(TransMatrix);
 	rapidxml::xml_attribute<>* TransMatrixAttribute = Calibration.allocate_attribute("DataType","float");
 	TransMatrix->append_attribute(TransMatrixAttribute);
 
-	//һ
+	//第一行
 	rapidxml::xml_node<>* TransFirst = Calibration.allocate_node(rapidxml::node_element,"TransFirst");
 	TransMatrix->append_node(TransFirst);
 	TransFirst->append_node(Calibration.allocate_node(rapidxml::node_element,"A",ch_TransMat[0][0]));
 	TransFirst->append_node(Calibration.allocate_node(rapidxml::node_element,"B",ch_TransMat[0][1]));
 	TransFirst->append_node(Calibration.allocate_node(rapidxml::node_element,"C",ch_TransMat[0][2]));
 	TransFirst->append_node(Calibration.allocate_node(rapidxml::node_element,"D",ch_TransMat[0][3]));
-	//ڶ
+	//第二行
 	rapidxml::xml_node<>* TransSecond = Calibration.allocate_node(rapidxml::node_element,"TransSecond");
 	TransMatrix->append_node(TransSecond);
 	TransSecond->append_node(Calibration.allocate_node(rapidxml::node_element,"A",ch_TransMat[1][0]));
 	TransSecond->append_node(Calibration.allocate_node(rapidxml::node_element,"B",ch_TransMat[1][1]));
 	TransSecond->append_node(Calibration.allocate_node(rapidxml::node_element,"C",ch_TransMat[1][2]));
 	TransSecond->append_node(Calibration.allocate_node(rapidxml::node_element,"D",ch_TransMat[1][3]));
-	//
+	//第三行
 	rapidxml::xml_node<>* TransThird = Calibration.allocate_node(rapidxml::node_element,"TransThird");
 	TransMatrix->append_node(TransThird);
 	TransThird->append_node(Calibration.allocate_node(rapidxml::node_element,"A",ch_TransMat[2][0]));
 	TransThird->append_node(Calibration.allocate_node(rapidxml::node_element,"B",ch_TransMat[2][1]));
 	TransThird->append_node(Calibration.allocate_node(rapidxml::node_element,"C",ch_TransMat[2][2]));
 	TransThird->append_node(Calibration.allocate_node(rapidxml::node_element,"D",ch_TransMat[2][3]));
-	//
+	//第四行
 	rapidxml::xml_node<>* TransFourth = Calibration.allocate_node(rapidxml::node_element,"TransFourth");
 	TransMatrix->append_node(TransFourth);
 	TransFourth->append_node(Calibration.allocate_node(rapidxml::node_element,"A",ch_TransMat[3][0]));
@@ -1349,24 +1418,24 @@ void CyberSystem::SaveTraCaliData()
 
 
 
-	// ת궨
+	// 旋转标定矩阵
 	rapidxml::xml_node<>* RotMatrix = Calibration.allocate_node(rapidxml::node_element,"RotMatrix");
 	TrackerCalibration->append_node(RotMatrix);
 	rapidxml::xml_attribute<>* RotMatrixAttribute = Calibration.allocate_attribute("DataType","float");
 	RotMatrix->append_attribute(RotMatrixAttribute);
-	// һ
+	// 第一行
 	rapidxml::xml_node<>* RotFirst = Calibration.allocate_node(rapidxml::node_element,"RotFirst");
 	RotMatrix->append_node(RotFirst);
 	RotFirst->append_node(Calibration.allocate_node(rapidxml::node_element,"A",ch_RotMat[0][0]));
 	RotFirst->append_node(Calibration.allocate_node(rapidxml::node_element,"B",ch_RotMat[0][1]));
 	RotFirst->append_node(Calibration.allocate_node(rapidxml::node_element,"C",ch_RotMat[0][2]));
-	// ڶ
+	// 第二行
 	rapidxml::xml_node<>* RotSecond = Calibration.allocate_node(rapidxml::node_element,"RotSecond");
 	RotMatrix->append_node(RotSecond);
 	RotSecond->append_node(Calibration.allocate_node(rapidxml::node_element,"A",ch_RotMat[1][0]));
 	RotSecond->append_node(Calibration.allocate_node(rapidxml::node_element,"B",ch_RotMat[1][1]));
 	RotSecond->append_node(Calibration.allocate_node(rapidxml::node_element,"C",ch_RotMat[1][2]));
-	// 
+	// 第三行
 	rapidxml::xml_node<>* RotThird = Calibration.allocate_node(rapidxml::node_element,"RotThird");
 	RotMatrix->append_node(RotThird);
 	RotThird->append_node(Calibration.allocate_node(rapidxml::node_element,"A",ch_RotMat[2][0]));
@@ -1374,7 +1443,7 @@ void CyberSystem::SaveTraCaliData()
 	RotThird->append_node(Calibration.allocate_node(rapidxml::node_element,"C",ch_RotMat[2][2]));
 
 
-	//д뵽.xmlļ
+	//写入到.xml文件
 	std::string PrintXml;
 	rapidxml::print(std::back_inserter(PrintXml), Calibration, 0);
 
@@ -1473,11 +1542,11 @@ void CyberSystem::DisRoboData()
 	}
 	sensor_out_str << std::endl;
 
-	// ûԱʵ
+	// 没有连接宇航员，不现实传感器数据
 	if (m_bRoboConn == false && m_bConsimuConn == true){
 		m_RoboStr = m_RoboStr.fromStdString(send_out_str.str());
 	}
-	// Աʾ͵ݺʹ
+	// 连接了宇航员，显示发送到数据和传感器数据
 	else if (m_bRoboConn == true){
 		m_RoboStr = m_RoboStr.fromStdString((send_out_str.str() + sensor_out_str.str()));
 	}
@@ -1492,7 +1561,7 @@ void CyberSystem::DisRoboData()
 
 
 
-// ѭ
+// 收数循环
 void CyberSystem::RecvSensor()
 {
 	if (m_bRoboConn == true)
@@ -1503,30 +1572,8 @@ void CyberSystem::RecvSensor()
 
 void CyberSystem::CyberCtrlMode()
 {
-	// joint angle
-	mat7x1 q;
-	if (m_bJacoIsInit == false)
-	{
-		q = CalKine(m_RTraRealMat, m_last_arm_angle, m_last_joint_angle);
-		m_bJacoIsInit = true;
-	} 
-	else
-	{
-		TransToQuater(m_last_RTraRealMat, m_last_RTraRealQuat);
-		TransToQuater(m_RTraRealMat, m_RTraRealQuat);
-		bool ret = DiffKine(m_RTraRealQuat, m_last_RTraRealQuat, m_last_joint_angle, q);  
-
-		m_last_RTraRealMat = m_RTraRealMat;
-		m_last_joint_angle = q;
-	}
-
-
-	// g_rightArmJointBuf is the Command Buffer
-	for (int i = 0; i < 7; ++i)
-	{
-		g_rightArmJointBuf[i] = DEG2ANG(q(i));
-		g_leftArmJointBuf[i] = 0;
-	}
+	// joint angle, g_rightArmJointBuf and g_leftArmJointBuf are the Command Buffer
+	SolveArms();
 
 	if (m_CtrlMode == CYBER_CTRL_ALL)
 	{
@@ -1544,8 +1591,9 @@ void CyberSystem::CyberCtrlMode()
 
 void CyberSystem::ClickCtrlMode()
 {
-	// лƣȽ΢˶ѧΪʼ״̬
+	// 切换到其他控制，首先将微分运动学置为初始状态
 	m_bJacoIsInit = false;
+	m_LArmChain.Restart();
 
 	if (m_CtrlMode == CLICK_CTRL_ALL)
 	{
@@ -1562,8 +1610,9 @@ void CyberSystem::ClickCtrlMode()
 
 void CyberSystem::OutCtrlMode()
 {
-	// лƣȽ΢˶ѧΪʼ״̬
+	// 切换到其他控制，首先将微分运动学置为初始状态
 	m_bJacoIsInit = false;
+	m_LArmChain.Restart();
 
 	if (m_bRoboConn == true)
 	{
@@ -1603,13 +1652,12 @@ void CyberSystem::PlanCtrlMode()
 {
 	if (m_plan_count < m_plan_count_max)
 	{
-		mat7x1 q;
+		// 关节角已在执行前求解并检查，每个周期只读取下一个
+		const mat7x1 &q = m_RPlanBuffer.Joints(m_plan_count);
+		m_RTraRealQuat = m_RPlanBuffer.Pose(m_plan_count);
 
 		m_plan_count++;
 
-		PosePlan(m_RPlanStartQuat, m_RPlanEndQuat, m_plan_count_max, m_plan_count, m_RTraRealQuat);
-		bool ret = DiffKine(m_RTraRealQuat, m_last_RTraRealQuat, m_last_joint_angle, q);  
-
 		m_last_RTraRealQuat = m_RTraRealQuat;	
 		m_last_joint_angle = q;
 
@@ -1643,8 +1691,8 @@ void CyberSystem::PlanCtrlMode()
 
 void CyberSystem::VisionCtrlMode()
 {
-	// һηͽǶο
-	// 봫ݲʹô¸
+	// 以上一次发送角度作参考
+	// 如果与传感器数据差别过大，使用传感器数据重新更新
 	mat7x1 jo_err;
 	for (int i = 0; i < 7; ++i)
 	{
@@ -1666,11 +1714,11 @@ void CyberSystem::VisionCtrlMode()
 	//
 	mat7x1 cmd_jo;
 
-	CalDirectKine(m_RArmJo, m_ViTransNow);
+	m_ViTransNow = m_KineSolver.kine().forward(m_RArmJo);
 	TransToQuater(m_ViTransNow, m_ViQuatNow);
 
 	int vi_flag = (int) m_ViRecv[0];
-	if (vi_flag == 1)		// Ч
+	if (vi_flag == 1)		// 相机数据有效
 	{
 		double fabs_pose_err[6];
 		for (int i = 0; i < 6; ++i)
@@ -1680,7 +1728,7 @@ void CyberSystem::VisionCtrlMode()
 		bool OriTrackFin = (fabs_pose_err[0] < EulerPoseCut[0]) && (fabs_pose_err[1] < EulerPoseCut[1]) && (fabs_pose_err[2] < EulerPoseCut[2]);
 		bool PoseTrackFin = (fabs_pose_err[3] < EulerPoseCut[3]) && (fabs_pose_err[4] < EulerPoseCut[4]) && (fabs_pose_err[5] < EulerPoseCut[5]);
 
-		if (OriTrackFin == false)	// û̬ĵ
+		if (OriTrackFin == false)	// 如果完成没完成姿态的调整
 		{
 			double ViQuatNow[7], ViQuatNext[7];
 			GetViNextOri(m_ViEulerRecv, ViQuatNow, ViQuatNext);
@@ -1689,19 +1737,19 @@ void CyberSystem::VisionCtrlMode()
 		}
 		else
 		{
-			if (PoseTrackFin == false)	// ̬ĵûλõĵ
+			if (PoseTrackFin == false)	// 完成了姿态的调整，但是没有完成位置的调整
 			{
 				GetViNextPos(m_ViRecv, m_ViQuatNow, m_ViQuatNext);
 
 				bool ret = DiffKine(m_ViQuatNext, m_ViQuatNow, m_RArmJo, cmd_jo);
 			} 
-			else	// λú̬ĵ
+			else	// 完成位置和姿态的调整
 			{
 				cmd_jo = m_RArmJo;
 			}
 		}
 	} 
-	else	// Ч
+	else	// 相机传回无效数据
 	{
 		cmd_jo = last_cmd_jo;
 	}
@@ -1717,36 +1765,14 @@ void CyberSystem::VisionCtrlMode()
 	bool ret = m_RobonautControl.SendRoboMsg();
 }
 
-// ѭ
+// 发数控制循环
 void CyberSystem::SendCmd()
 {
-	// ʹCyberѭ
+	// 使用Cyber控制循环
 	if (m_CtrlMode == CYBER_CTRL_ALL || m_CtrlMode == CYBER_CTRL_ROBO || m_CtrlMode == CYBER_CTRL_SIMU)
 	{
-		// joint angle
-		mat7x1 q;
-		if (m_bJacoIsInit == false)
-		{
-			q = CalKine(m_RTraRealMat, m_last_arm_angle, m_last_joint_angle);
-			m_bJacoIsInit = true;
-		} 
-		else
-		{
-			TransToQuater(m_last_RTraRealMat, m_last_RTraRealQuat);
-			TransToQuater(m_RTraRealMat, m_RTraRealQuat);
-			bool ret = DiffKine(m_RTraRealQuat, m_last_RTraRealQuat, m_last_joint_angle, q);  
-
-			m_last_RTraRealMat = m_RTraRealMat;
-			m_last_joint_angle = q;
-		}
-
-
-		// g_rightArmJointBuf is the Command Buffer
-		for (int i = 0; i < 7; ++i)
-		{
-			g_rightArmJointBuf[i] = DEG2ANG(q(i));
-			g_leftArmJointBuf[i] = 0;
-		}
+		// joint angle, g_rightArmJointBuf and g_leftArmJointBuf are the Command Buffer
+		SolveArms();
 
 		if (m_CtrlMode == CYBER_CTRL_ALL)
 		{
@@ -1761,11 +1787,12 @@ void CyberSystem::SendCmd()
 		}
 	}
 
-	// ʹClickƵѭ
+	// 使用Click控制的循环
 	else if (m_CtrlMode == CLICK_CTRL_ALL || m_CtrlMode == CLICK_CTRL_ROBO || m_CtrlMode == CLICK_CTRL_SIMU)
 	{
-		// лƣȽ΢˶ѧΪʼ״̬
+		// 切换到其他控制，首先将微分运动学置为初始状态
 		m_bJacoIsInit = false;
+		m_LArmChain.Restart();
 
 		if (m_CtrlMode == CLICK_CTRL_ALL)
 		{
@@ -1780,12 +1807,13 @@ void CyberSystem::SendCmd()
 		}
 	}
 
-	// ޿
-	// ԱԱݣûӣ0Ƕ
+	// 无控制
+	// 如果连接了宇航员，发送宇航员传感器数据；如果没有连接，发送0角度
 	else if (m_CtrlMode == OUT_CTRL)
 	{
-		// лƣȽ΢˶ѧΪʼ״̬
+		// 切换到其他控制，首先将微分运动学置为初始状态
 		m_bJacoIsInit = false;
+		m_LArmChain.Restart();
 
 		if (m_bRoboConn == true)
 		{
@@ -1825,13 +1853,12 @@ void CyberSystem::SendCmd()
 	{
 		if (m_plan_count < m_plan_count_max)
 		{
-			mat7x1 q;
+			// 关节角已在执行前求解并检查，每个周期只读取下一个
+			const mat7x1 &q = m_RPlanBuffer.Joints(m_plan_count);
+			m_RTraRealQuat = m_RPlanBuffer.Pose(m_plan_count);
 
 			m_plan_count++;
 
-			PosePlan(m_RPlanStartQuat, m_RPlanEndQuat, m_plan_count_max, m_plan_count, m_RTraRealQuat);
-			bool ret = DiffKine(m_RTraRealQuat, m_last_RTraRealQuat, m_last_joint_angle, q);  
-
 			m_last_RTraRealQuat = m_RTraRealQuat;	
 			m_last_joint_angle = q;
 
@@ -1874,7 +1901,7 @@ void CyberSystem::SendCmd()
 
 		mat7x1 cmd_jo;
 
-		CalDirectKine(m_RArmJo, m_ViTransNow);
+		m_ViTransNow = m_KineSolver.kine().forward(m_RArmJo);
 		TransToQuater(m_ViTransNow, m_ViQuatNow);
 
 		double ViQuatNow[7], ViQuatNext[7];
@@ -1891,7 +1918,7 @@ void CyberSystem::SendCmd()
 
 		bool ret = DiffKine(m_ViQuatNext, m_ViQuatNow, m_RArmJo, cmd_jo);
 
-		if (ret == false)		// ˶ѧ
+		if (ret == false)		// 运动学计算错误
 		{
 			m_CmdStr += "Kinetics Calculation Occur Error!!!\r\n";
 			InsertCmdStr(m_CmdStr);
@@ -1907,14 +1934,14 @@ void CyberSystem::SendCmd()
 			g_leftArmJointBuf[i] = 0;
 		}
 
-		// 
+		// 虚拟仿真测试
 		//bool send_ret = m_RobonautControl.SendConsimuMsg();
 
-		// ˲
+		// 机器人测试
 		bool send_ret = m_RobonautControl.SendRoboMsg();
 #else
-		// һηͽǶο
-		// 봫ݲʹô¸
+		// 以上一次发送角度作参考
+		// 如果与传感器数据差别过大，使用传感器数据重新更新
 		mat7x1 jo_err;
 		for (int i = 0; i < 7; ++i)
 		{
@@ -1938,14 +1965,14 @@ void CyberSystem::SendCmd()
 
 		//
 		mat7x1 cmd_jo;
-		CalDirectKine(m_RArmJo, m_ViTransNow);
+		m_ViTransNow = m_KineSolver.kine().forward(m_RArmJo);
 		TransToQuater(m_ViTransNow, m_ViQuatNow);
 
 
 		int vi_flag = (int) m_ViRecv[0];
-		if (vi_flag == 1)		// Ч
+		if (vi_flag == 1)		// 相机数据有效
 		{
-			// жλǷ
+			// 判断位姿是否调整完成
 			double fabs_pose_err[6];
 			for (int i = 0; i < 6; ++i)
 			{
@@ -1961,7 +1988,7 @@ void CyberSystem::SendCmd()
 			//PoseTrackFin = true;
 
 
-			if (OriTrackFin == false)	// û̬ĵ
+			if (OriTrackFin == false)	// 如果完成没完成姿态的调整
 			{
 				double ViQuatNow[7], ViQuatNext[7];
 				for (int i = 0; i < 7; ++i)
@@ -1975,7 +2002,7 @@ void CyberSystem::SendCmd()
 				}
 
 				bool ret = DiffKine(m_ViQuatNext, m_ViQuatNow, m_RArmJo, cmd_jo);
-				if (ret == false)		// ˶ѧ
+				if (ret == false)		// 运动学计算错误
 				{
 					m_CmdStr += "Kinetics Calculation Occur Error!!!\r\n";
 					InsertCmdStr(m_CmdStr);
@@ -1985,12 +2012,12 @@ void CyberSystem::SendCmd()
 			}
 			else
 			{
-				if (PoseTrackFin == false)	// ̬ĵûλõĵ
+				if (PoseTrackFin == false)	// 完成了姿态的调整，但是没有完成位置的调整
 				{
 					GetViNextPos(m_ViRecv, m_ViQuatNow, m_ViQuatNext);
 
 					bool ret = DiffKine(m_ViQuatNext, m_ViQuatNow, m_RArmJo, cmd_jo);
-					if (ret == false)		// ˶ѧ
+					if (ret == false)		// 运动学计算错误
 					{
 						m_CmdStr += "Kinetics Calculation Occur Error!!!\r\n";
 						InsertCmdStr(m_CmdStr);
@@ -2001,9 +2028,9 @@ void CyberSystem::SendCmd()
 				else
 				{
 					ui.m_pViApprBtn->setEnabled(true);
-					if (ApprTrackFin == false)	// λú̬δץȡӽ
+					if (ApprTrackFin == false)	// 完成位置和姿态调整，未完成抓取接近
 					{
-						if (m_bApprFlag == true)	// Խнӽ
+						if (m_bApprFlag == true)	// 可以进行接近
 						{
 							double ViQuatNow[7], ViQuatNext[7];
 							for (int i = 0; i < 7; ++i)
@@ -2017,7 +2044,7 @@ void CyberSystem::SendCmd()
 							}
 
 							bool ret = DiffKine(m_ViQuatNext, m_ViQuatNow, m_RArmJo, cmd_jo);
-							if (ret == false)		// ˶ѧ
+							if (ret == false)		// 运动学计算错误
 							{
 								m_CmdStr += "Kinetics Calculation Occur Error!!!\r\n";
 								InsertCmdStr(m_CmdStr);
@@ -2025,13 +2052,13 @@ void CyberSystem::SendCmd()
 								return;
 							}
 						} 
-						else		// Խнӽ
+						else		// 不可以进行接近
 						{
 							cmd_jo = m_RArmJo;
 						}
 						
 					}
-					else	// еĵ
+					else	// 完成所有的调整
 					{
 						m_bApprFlag = false;
 						cmd_jo = m_RArmJo;
@@ -2039,7 +2066,7 @@ void CyberSystem::SendCmd()
 				}
 			}
 		} 
-		else	// Ч
+		else	// 相机传回无效数据
 		{
 			cmd_jo = last_cmd_jo;
 		}
@@ -2094,6 +2121,11 @@ void CyberSystem::ConsimuConnCtrl()
 		if (ret == true)
 		{
 			m_CmdStr += "OK!\r\n";
+			const ConsimuStats stats = m_RobonautControl.GetConsimuStats();
+			m_CmdStr += QString("Consimu: sent %1, replies %2, timeouts %3, skipped %4, bad %5, stalls %6\r\n")
+				.arg(stats.sent).arg(stats.replies).arg(stats.timeouts).arg(stats.skipped).arg(stats.bad).arg(stats.stalls);
+			m_CmdStr += QString("Consimu RTT: mean %1 ms, p50 %2 ms, p99 %3 ms, max %4 ms\r\n")
+				.arg(stats.meanMs).arg(stats.p50Ms).arg(stats.p99Ms).arg(stats.maxMs);
 			emit InsertCmdStr(m_CmdStr);
 			m_bConsimuConn = false;
 			ui.m_pSimuConnBtn->setText("Conn Consimu");
@@ -2151,7 +2183,7 @@ void CyberSystem::RoboConnCtrl()
 }
 
 // TODO(CJH):Add Connection check and Calibration check
-// CyberťѡʹCyberģʽ
+// 点击Cyber按钮，选择使用Cyber的模式
 void CyberSystem::CyberCtrl()
 {
 	if (m_bRTraCaliFini == false && m_bLTraCaliFini == false)
@@ -2160,7 +2192,7 @@ void CyberSystem::CyberCtrl()
 		emit InsertCmdStr(m_CmdStr);
 		return;
 	}
-	// Cyberť
+	// 点击Cyber按钮
 	if (m_CtrlMode == OUT_CTRL && (m_bRoboConn == true || m_bConsimuConn == true) && (ui.m_pCyberCtrlBtn->text() == "Cyber"))
 	{
 		m_CmdStr += "Initializing DataSend Timer......";
@@ -2193,7 +2225,7 @@ void CyberSystem::CyberCtrl()
 		emit InsertCmdStr(m_CmdStr);
 	}
 
-	// Stopť
+	// 点击Stop按钮
 	else
 	{
 		m_CtrlMode = OUT_CTRL;
@@ -2225,7 +2257,7 @@ void CyberSystem::CyberCtrl()
 }
 
 
-// Startťʼ
+// 点击Start按钮，开始控制
 void CyberSystem::CyberCmd()
 {
 	m_CmdStr += "Start Cyber Control!!!\r\n";
@@ -2247,7 +2279,7 @@ void CyberSystem::CyberCmd()
 	ui.m_pCyberStartBtn->setEnabled(false);
 }
 
-// ͣʹCyber
+// 暂停使用Cyber控制
 void CyberSystem::CyberStop()
 {
 	m_CmdStr += "Pause Cyber Control!!!\r\n";
@@ -2262,7 +2294,7 @@ void CyberSystem::CyberStop()
 
 
 
-// Clickťʱ
+// 点击Click按钮，启动定时器
 void CyberSystem::ClickCtrl()
 {
 	if ((m_CtrlMode == OUT_CTRL) && ((m_bConsimuConn || m_bRoboConn) == true))
@@ -2330,7 +2362,7 @@ void CyberSystem::ClickCtrl()
 }
 
 
-// ȡsliderݣg_rightArmJointBuf
+// 获取slider数据，更新g_rightArmJointBuf
 void CyberSystem::getSliData()
 {
 	// Get Joint Data
@@ -2465,7 +2497,7 @@ void CyberSystem::SliUpdata()
 
 }
 
-// Slider
+// 设置Slider数据
 void CyberSystem::SetSliVal(float RJo[], float LJo[])
 {
 	// Robonaut joint move management
@@ -2486,7 +2518,7 @@ void CyberSystem::SetSliVal(float RJo[], float LJo[])
 	ui.m_pLJo6Sli->setValue(LJo[6]);
 }
 
-// Sliderɼ
+// 设置Slider可见
 void CyberSystem::SetCliUIVisi(bool flag)
 {
 	ui.m_pRJo0Sli->setEnabled(flag);
@@ -2710,7 +2742,7 @@ void CyberSystem::SendHandCmd()
 		m_RobonautControl.setHandMode(RobonautControl::ZeroForce);
 	}
 
-	// лģʽ
+	// 切换控制模式
 	if (m_HandCtrlMode == OUT_CTRL)
 	{	
 		CHandData RHandData, LHandData;
@@ -2771,7 +2803,7 @@ void CyberSystem::SendHandCmd()
 	{
 		CHandData RHandData, LHandData;
 
-		if (m_bHandGrasp == true)		// ץȡ
+		if (m_bHandGrasp == true)		// 发出抓取命令
 		{
 			for(int i = 0; i < 5; ++i)
 			{
@@ -2782,7 +2814,7 @@ void CyberSystem::SendHandCmd()
 				}
 			}
 		}
-		else		//	ͷ
+		else		//	发出释放命令
 		{
 			for(int i = 0; i < 5; ++i)
 			{
@@ -2820,7 +2852,7 @@ void CyberSystem::RecvHandSensor()
 			}
 		}
 
-		if (m_HandCtrlMode == HAND_CYBER_CTRL)		// CyberƵģʽ£ʩӷ
+		if (m_HandCtrlMode == HAND_CYBER_CTRL)		// 如果处在Cyber控制的模式下，施加反馈力
 		{
 			double Force[5];
 			Force[0] = (m_RHandData.torque[0][0]+m_RHandData.torque[0][1])*1.0;
@@ -2852,7 +2884,7 @@ void CyberSystem::RecvHandSensor()
 
 void CyberSystem::ClickHandMode()
 {
-	if (ui.m_pHandClickBtn->text() == "Click Mode")		// Click Mode
+	if (ui.m_pHandClickBtn->text() == "Click Mode")		// 进入Click Mode
 	{
 		// Initialize Click Hand Data
 		for (int i = 0; i < 5; ++i)
@@ -2875,7 +2907,7 @@ void CyberSystem::ClickHandMode()
 
 		ui.m_pHandClickBtn->setText("Stop Click");
 	}
-	else if (ui.m_pHandClickBtn->text() == "Stop Click")		// 뿪Click Mode
+	else if (ui.m_pHandClickBtn->text() == "Stop Click")		// 离开Click Mode
 	{
 		m_HandCtrlMode = HAND_OUT_CTRL;
 
@@ -2911,7 +2943,7 @@ void CyberSystem::UpdateHandSpin()
 
 void CyberSystem::CyberHandMode()
 {
-	if (ui.m_pHandCyberBtn->text() == "Cyber Mode")		// Cyber Mode
+	if (ui.m_pHandCyberBtn->text() == "Cyber Mode")		// 进入Cyber Mode
 	{
 		ui.m_pHandRunBtn->setEnabled(true);
 		ui.m_pHandPauseBtn->setEnabled(true);
@@ -2921,7 +2953,7 @@ void CyberSystem::CyberHandMode()
 
 		ui.m_pHandCyberBtn->setText("Stop Cyber");
 	}
-	else if (ui.m_pHandCyberBtn->text() == "Stop Cyber")		// 뿪Cyber Mode
+	else if (ui.m_pHandCyberBtn->text() == "Stop Cyber")		// 离开Cyber Mode
 	{
 		m_HandCtrlMode = HAND_OUT_CTRL;
 
@@ -2949,7 +2981,7 @@ void CyberSystem::PauseCyberHand()
 
 void CyberSystem::GraspHandMode()
 {
-	if (ui.m_pHandGraspBtn->text() == "Grasp Mode")		// Grasp Mode
+	if (ui.m_pHandGraspBtn->text() == "Grasp Mode")		// 进入Grasp Mode
 	{
 		m_bHandGrasp = false;
 		m_HandCtrlMode = HAND_GRASP_CTRL;
@@ -2962,7 +2994,7 @@ void CyberSystem::GraspHandMode()
 
 		ui.m_pHandGraspBtn->setText("Stop Grasp");
 	}
-	else if (ui.m_pHandGraspBtn->text() == "Stop Grasp")		// 뿪Grasp Mode
+	else if (ui.m_pHandGraspBtn->text() == "Stop Grasp")		// 离开Grasp Mode
 	{
 		m_HandCtrlMode = HAND_OUT_CTRL;
 
@@ -2991,29 +3023,29 @@ void CyberSystem::ReleaseHand()
 
 void CyberSystem::ReadHandSpinData(double RHandData[5][3], double LHandData[5][3])
 {
-	// 
-	// Ĵָ
+	// 右手
+	// 大拇指
 	RHandData[0][2] = ui.m_pRThumbBiasSpin->value();
 	RHandData[0][0] = ui.m_pRThumbBaseSpin->value();
 	RHandData[0][1] = ui.m_pRThumbOutSpin->value();
-	// ʳָ
+	// 食指
 	RHandData[1][2] = ui.m_pRIndexBiasSpin->value();
 	RHandData[1][0] = ui.m_pRIndexBaseSpin->value();
 	RHandData[1][1] = ui.m_pRIndexOutSpin->value();
-	// ָ
+	// 中指
 	RHandData[2][2] = ui.m_pRMidBiasSpin->value();
 	RHandData[2][0] = ui.m_pRMidBaseSpin->value();
 	RHandData[2][1] = ui.m_pRMidOutSpin->value();
-	// ָ
+	// 无名指
 	RHandData[3][2] = ui.m_pRRingBiasSpin->value();
 	RHandData[3][0] = ui.m_pRRingBaseSpin->value();
 	RHandData[3][1] = ui.m_pRRingOutSpin->value();
-	// Сָ
+	// 小指
 	RHandData[4][2] = ui.m_pRLitBiasSpin->value();
 	RHandData[4][0] = ui.m_pRLitBaseSpin->value();
 	RHandData[4][1] = ui.m_pRLitOutSpin->value();
 
-	// 
+	// 左手
 	for (int i = 0; i < 5; ++i)
 	{
 		for (int j = 0; j < 3; ++j)
@@ -3025,23 +3057,23 @@ void CyberSystem::ReadHandSpinData(double RHandData[5][3], double LHandData[5][3
 
 void CyberSystem::SetHandSpinData(const double RData[5][3], const double LData[5][3])
 {
-		// Ĵָ
+		// 拇指
 	ui.m_pRThumbBiasSpin->setValue(m_RHandRecvJoint[0][2]);
 	ui.m_pRThumbBaseSpin->setValue(m_RHandRecvJoint[0][0]);
 	ui.m_pRThumbOutSpin->setValue(m_RHandRecvJoint[0][1]);
-	// ʳָ
+	// 食指
 	ui.m_pRIndexBiasSpin->setValue(m_RHandRecvJoint[1][2]);
 	ui.m_pRIndexBaseSpin->setValue(m_RHandRecvJoint[1][0]);
 	ui.m_pRIndexOutSpin->setValue(m_RHandRecvJoint[1][1]);
-	// ָ
+	// 中指
 	ui.m_pRMidBiasSpin->setValue(m_RHandRecvJoint[2][2]);
 	ui.m_pRMidBaseSpin->setValue(m_RHandRecvJoint[2][0]);
 	ui.m_pRMidOutSpin->setValue(m_RHandRecvJoint[2][1]);
-	// ָ
+	// 无名指
 	ui.m_pRRingBiasSpin->setValue(m_RHandRecvJoint[3][2]);
 	ui.m_pRRingBaseSpin->setValue(m_RHandRecvJoint[3][0]);
 	ui.m_pRRingOutSpin->setValue(m_RHandRecvJoint[3][1]);
-	// Сָ
+	// 小指
 	ui.m_pRLitBiasSpin->setValue(m_RHandRecvJoint[4][2]);
 	ui.m_pRLitBaseSpin->setValue(m_RHandRecvJoint[4][0]);
 	ui.m_pRLitOutSpin->setValue(m_RHandRecvJoint[4][1]);
@@ -3128,6 +3160,7 @@ void CyberSystem::DisHandData()
 void CyberSystem::InitKine()
 {
 	// joint limitation
+	rpp::kine::Kine7<double>::angular_interval_vector joint_limits;
 	joint_limits.push_back(rpp::kine::Kine7<double>::angular_interval(-1.0472, 3.1416));
 	joint_limits.push_back(rpp::kine::Kine7<double>::angular_interval(-1.9199, 1.5708));
 	joint_limits.push_back(rpp::kine::Kine7<double>::angular_interval(-2.0944, 2.0944));
@@ -3136,163 +3169,198 @@ void CyberSystem::InitKine()
 	joint_limits.push_back(rpp::kine::Kine7<double>::angular_interval(-1.5708, 1.5708));
 	joint_limits.push_back(rpp::kine::Kine7<double>::angular_interval(-2.0944, 2.0944));
 
-	// Kine7˶ѧĻ
-	m_Kine = rpp::kine::Kine7<double>(400, 285, 300, 0, joint_limits);
-	// SingularHandler˶ѧе
-	sh = rpp::kine::SingularityHandler<double>(joint_limits);
+	// KineSolver包含Kine7（正逆运动学）、SingularityHandler（奇异处理）及臂角优化，
+	// 每个线程使用各自的实例，见KineBatch
+	m_KineSolver = rpp::kine::KineSolver<double>(400, 285, 300, 0, joint_limits);
+	// 重复的请求直接返回上一次的解；量化后相同的另一目标由缓存的关节角LM迭代修正，不收敛时重新求自运动
+	m_KineSolver.cache().set_quantization(KineCachePosStep, KineCacheRotStep);
+
+	// 微分逆运动学，零空间梯度使ROBO_J*_MIN/MAX范围内的关节居中
+	mat7x1 jo_min, jo_max;
+	jo_min << ROBO_J0_MIN, ROBO_J1_MIN, ROBO_J2_MIN, ROBO_J3_MIN, ROBO_J4_MIN, ROBO_J5_MIN, ROBO_J6_MIN;
+	jo_max << ROBO_J0_MAX, ROBO_J1_MAX, ROBO_J2_MAX, ROBO_J3_MAX, ROBO_J4_MAX, ROBO_J5_MAX, ROBO_J6_MAX;
+	for (int i = 0; i < 7; ++i)
+	{
+		jo_min(i) = ANG2DEG(jo_min(i));
+		jo_max(i) = ANG2DEG(jo_max(i));
+	}
+	m_DiffSolver = rpp::kine::DiffKineSolver<double>(m_KineSolver.kine(), jo_min, jo_max);
+
+	// 多路径点规划：关节范围与微分逆运动学相同，速度、加速度见ROBO_J*_VEL_MAX/ACC_MAX
+	m_PlanLimits.lower = jo_min;
+	m_PlanLimits.upper = jo_max;
+	m_PlanLimits.max_velocity << ROBO_J0_VEL_MAX, ROBO_J1_VEL_MAX, ROBO_J2_VEL_MAX, ROBO_J3_VEL_MAX,
+		ROBO_J4_VEL_MAX, ROBO_J5_VEL_MAX, ROBO_J6_VEL_MAX;
+	m_PlanLimits.max_acceleration << ROBO_J0_ACC_MAX, ROBO_J1_ACC_MAX, ROBO_J2_ACC_MAX, ROBO_J3_ACC_MAX,
+		ROBO_J4_ACC_MAX, ROBO_J5_ACC_MAX, ROBO_J6_ACC_MAX;
+	for (int i = 0; i < 7; ++i)
+	{
+		m_PlanLimits.max_velocity(i) = ANG2DEG(m_PlanLimits.max_velocity(i));
+		m_PlanLimits.max_acceleration(i) = ANG2DEG(m_PlanLimits.max_acceleration(i));
+	}
+
+	// 腕部中心可达性地图，文件不存在或关节限位、连杆长度改变时在后台线程中并行生成（需数秒），
+	// 不阻塞界面；生成完成前无解时不说明是否在工作空间外
+	m_ReachMap.OpenAsync(ReachMapFile, m_KineSolver);
+
+	// 左臂：与右臂相同的DH参数，SendRoboMsg中左臂的关节限位
+	rpp::kine::Kine7<double>::angular_interval_vector left_limits;
+	mat7x1 ljo_min, ljo_max;
+	ljo_min << ROBO_LJ0_MIN, ROBO_LJ1_MIN, ROBO_LJ2_MIN, ROBO_LJ3_MIN, ROBO_LJ4_MIN, ROBO_LJ5_MIN, ROBO_LJ6_MIN;
+	ljo_max << ROBO_LJ0_MAX, ROBO_LJ1_MAX, ROBO_LJ2_MAX, ROBO_LJ3_MAX, ROBO_LJ4_MAX, ROBO_LJ5_MAX, ROBO_LJ6_MAX;
+	for (int i = 0; i < 7; ++i)
+	{
+		ljo_min(i) = ANG2DEG(ljo_min(i));
+		ljo_max(i) = ANG2DEG(ljo_max(i));
+		left_limits.push_back(rpp::kine::Kine7<double>::angular_interval(ljo_min(i), ljo_max(i)));
+	}
+	rpp::kine::KineSolver<double> left_solver(400, 285, 300, 0, left_limits);
+	left_solver.cache().set_quantization(KineCachePosStep, KineCacheRotStep);
+	m_LReachMap.OpenAsync(LReachMapFile, left_solver);
+	m_LArmChain.Init(left_solver, rpp::kine::DiffKineSolver<double>(left_solver.kine(), ljo_min, ljo_max), &m_LReachMap);
 }
 
 
 mat7x1 CyberSystem::CalKine(const mat4x4 &T, double &last_arm_angle, mat7x1 &last_joint_angle)
 {
-	mat7x1 ref_angle;
-	ref_angle << (-1.0472 + 3.1416)/2, (-1.9199 + 1.5708)/2, (-2.0944 + 2.0944)/2, 
-		(-2.2689 + 0.1745)/2, (-2.0944 + 2.0944)/2, (-1.5708 + 1.5708)/2, (-2.0944 + 2.0944)/2;
-	//	ref_angle = last_joint_angle;
-
-	// ж˶ûУֱӷһεֵ
-	auto self_motions = m_Kine.inverse(T);
-	if (self_motions.empty())
-	{
+	// 在肘关节角度在关节限位内的自运动上搜索臂角，使关节角与上一次最接近，臂角连续；
+	// 误差过大时先用LM迭代修正解析解，而不是直接丢弃
+	mat7x1 q;
+	switch (m_KineSolver.solve(T, last_arm_angle, last_joint_angle, q))
+	{
+	case rpp::kine::KINE_OK:
+	case rpp::kine::KINE_REFINED:
+#if KineDebug
+		if (m_KineSolver.stats().refined > 0)
+		{
+			// 按求解次数统计；一次求解可能修正多个候选解，平均耗时按refine调用次数计
+			m_CmdStr += QString("Kine refine: %1 solves refined, rescued %2, rejected %3, %4 us/refine\r\n")
+				.arg(m_KineSolver.stats().refined)
+				.arg(m_KineSolver.stats().rescued).arg(m_KineSolver.stats().rejected)
+				.arg(m_KineSolver.stats().refine_ns/1000.0/m_KineSolver.stats().refine_calls);
+			emit InsertCmdStr(m_CmdStr);
+		}
+		m_CmdStr += QString("Kine cache: hit %1 (warm start %2), miss %3\r\n")
+			.arg(m_KineSolver.cache().hits()).arg(m_KineSolver.cache().warm_hits()).arg(m_KineSolver.cache().misses());
+		emit InsertCmdStr(m_CmdStr);
+#endif
+		return q;
+	case rpp::kine::KINE_NO_SELF_MOTION:
+		// 没有自运动，直接返回上一次的值
 		m_CmdStr += "No self_motion!!!\r\n";
 		emit InsertCmdStr(m_CmdStr);
 		return last_joint_angle;
+	default:
+		m_CmdStr += "Self_motions have no Reasonable Solution!!!\r\n";
+		emit InsertCmdStr(m_CmdStr);
+		return last_joint_angle;
 	}
+}
+
 
-	// ѡһؽڽǶڹؽλڵ˶< 0
-	auto it_self_motions = self_motions.begin();
-	for (; it_self_motions != self_motions.end(); ++it_self_motions)
+// 按KineStrategy求解目标位姿T，成功时更新m_last_arm_angle和m_last_joint_angle；
+// 还没有参考关节角（m_bJacoIsInit为false）时先解析求解一次，微分逆运动学从这里开始迭代
+mat7x1 CyberSystem::SolveKine(const mat4x4 &T)
+{
+	// 一定不可达（超出臂展或远离地图的可达区域）时不求逆解，保持上一次的值
+	if (m_ReachMap.IsUnreachable(T))
 	{
-		if (joint_limits[3].contains(it_self_motions->elbow_joint()))
-		{
-			break;
-		}
+		m_CmdStr += QString("Out of workspace!!! (%1 mm)\r\n").arg(m_ReachMap.Distance(T));
+		emit InsertCmdStr(m_CmdStr);
+		return m_last_joint_angle;
 	}
 
-	// ȡø˶ܵı۽ǷΧ
-	auto arm_angle_ranges = it_self_motions->arm_angle_range();
-
-	mat7x1 jo;
-	int jo_count = 0;
-	for (auto range = arm_angle_ranges.begin(); range != arm_angle_ranges.end(); ++range)
+	rpp::kine::IkStrategy<double> *strategy = m_bJacoIsInit ? m_IkStrategy : &m_AnalyticIk;
+	mat7x1 q;
+	rpp::kine::KineStatus status = strategy->solve(T, m_last_arm_angle, m_last_joint_angle, q);
+	if (status < 0)
 	{
-		auto arm_angle = (range->lower() + range->upper())/2.0;
-
-		auto joints = it_self_motions->get_joints(arm_angle, sh);
-		// б۽ǿȡõĹؽڽǶȣѡһӽĽǶ
-		for (auto it_joints = joints.begin(); it_joints != joints.end(); ++it_joints)
+		// 无解时保持上一次的值。边界附近地图由随机采样生成，不能据此拒绝求解，只用来说明无解的原因
+		if (m_ReachMap.IsHopeless(T))
 		{
-			auto q = *(it_joints);
-
-			// ĺж
-			auto q_valid = true;
-			for (int i = 0; i < 7; ++i)
-			{
-				q_valid = q_valid && joint_limits[i].contains(q[i]);
-			}
-			if (!q_valid)
-			{
-				continue;
-			}
-			auto TT = m_Kine.forward(q);
-			if ((TT - T).norm() > 0.05)
+			m_CmdStr += QString("Out of workspace!!! (%1 mm)\r\n").arg(m_ReachMap.Distance(T));
+		}
+		else
+		{
+			switch (status)
 			{
-				continue;
-			}
-			else{
-				// jo_count > 0 ٴһ
-				jo_count++;
+			case rpp::kine::KINE_NO_SELF_MOTION:
+				m_CmdStr += "No self_motion!!!\r\n";
+				break;
+			case rpp::kine::KINE_NOT_CONVERGED:
+				m_CmdStr += QString("Deviation is too Large!!! (iter: %1, residual: %2)\r\n")
+					.arg(m_DifferentialIk.result().iterations).arg(m_DifferentialIk.result().residual);
+				break;
+			default:
+				m_CmdStr += "Self_motions have no Reasonable Solution!!!\r\n";
+				break;
 			}
+		}
+		emit InsertCmdStr(m_CmdStr);
+		return m_last_joint_angle;
+	}
+	m_bJacoIsInit = true;
+#if KineDebug
+	const rpp::kine::IkStrategy<double>::stats_type &stats = strategy->stats();
+	m_CmdStr += QString("Kine %1: ok %2, failed %3, %4 us/solve, max %5 us\r\n")
+		.arg(strategy->name()).arg(stats.succeeded).arg(stats.failed)
+		.arg(stats.elapsed_ns/1000.0/stats.calls).arg(stats.max_ns/1000.0);
+	if (strategy == &m_HybridIk)
+	{
+		m_CmdStr += QString("Kine hybrid: near singular %1, analytic failed %2\r\n")
+			.arg(m_HybridIk.near_singular()).arg(m_HybridIk.analytic_failed());
+	}
+	emit InsertCmdStr(m_CmdStr);
+#endif
+	return q;
+}
 
-			// жǷһν
-			if (jo_count == 1)
-			{
-				jo = q;
-			} 
-			else
-			{
-				if ((q - ref_angle).norm() < (jo - ref_angle).norm())
-				{
-					jo = q;
-				}
-			}
+// 左右臂的逆运动学同时求解：左臂在m_ArmPool中，右臂在本线程，两臂的求解器和参考关节角互不共享，
+// 一个周期的耗时约为单臂的耗时。左跟踪器没有连接或没有标定时左臂指令为0
+void CyberSystem::SolveArms()
+{
+	bool bLeftArm = (m_LTraContr == true && m_bLTraCaliFini == true);
+	if (bLeftArm)
+	{
+		m_ArmPool.start(new ArmChainTask(m_LArmChain, m_LTraRealMat));
+	}
+
+	mat7x1 q = SolveKine(m_RTraRealMat);
+	m_last_RTraRealMat = m_RTraRealMat;
 
+	if (bLeftArm)
+	{
+		m_ArmPool.waitForDone();
 
+		// 日志只在本线程输出，无解时m_LArmChain保持上一次的值
+		if (m_LArmChain.OutOfWorkspace())
+		{
+			m_CmdStr += QString("Left arm: Out of workspace!!! (%1 mm)\r\n").arg(m_LArmChain.Distance());
+			emit InsertCmdStr(m_CmdStr);
+		}
+		else if (m_LArmChain.Status() < 0)
+		{
+			m_CmdStr += QString("Left arm: no solution (%1)!!!\r\n").arg(m_LArmChain.Status());
+			emit InsertCmdStr(m_CmdStr);
 		}
 	}
 
-	// ڽ
-	if (jo_count > 0)
-	{
-		last_joint_angle = jo;
-		return jo;
-	} 
-	else
+	for (int i = 0; i < 7; ++i)
 	{
-		m_CmdStr += "Self_motions have no Reasonable Solution!!!\r\n";
-		emit InsertCmdStr(m_CmdStr);
-		return last_joint_angle;
+		g_rightArmJointBuf[i] = DEG2ANG(q(i));
+		g_leftArmJointBuf[i] = bLeftArm ? DEG2ANG(m_LArmChain.Joints()(i)) : 0;
 	}
 }
 
 
-
-
 //*********************** Difference Kinetics ***********************//
 // Calculate Jacobi Matrix and SVD 
 void CyberSystem::CalJaco(const mat7x1 &mat_jo,mat6x7 &mat_jaco, double &sv_min)
 {
-	double q1 = mat_jo(0);
-	double q2 = mat_jo(1);
-	double q3 = mat_jo(2);
-	double q4 = mat_jo(3);
-	double q5 = mat_jo(4);
-	double q6 = mat_jo(5);
-	double q7 = mat_jo(6);
-
-	mat_jaco(0,0) = sin(q1)*sin(q2)*-4.0E2-cos(q6)*(sin(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))+cos(q4)*sin(q1)*sin(q2))*3.0E2-sin(q6)*(cos(q5)*(cos(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))-sin(q1)*sin(q2)*sin(q4))+sin(q5)*(cos(q1)*cos(q3)-cos(q2)*sin(q1)*sin(q3)))*3.0E2-sin(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))*2.85E2-cos(q4)*sin(q1)*sin(q2)*2.85E2;
-	mat_jaco(0,1) = cos(q1)*(cos(q2)*8.0E1+cos(q2)*cos(q4)*5.7E1+cos(q2)*cos(q4)*cos(q6)*6.0E1-cos(q3)*sin(q2)*sin(q4)*5.7E1-cos(q3)*cos(q6)*sin(q2)*sin(q4)*6.0E1-cos(q2)*cos(q5)*sin(q4)*sin(q6)*6.0E1+sin(q2)*sin(q3)*sin(q5)*sin(q6)*6.0E1-cos(q3)*cos(q4)*cos(q5)*sin(q2)*sin(q6)*6.0E1)*5.0;
-	mat_jaco(0,2) = sin(q4)*(cos(q3)*sin(q1)+cos(q1)*cos(q2)*sin(q3))*-2.85E2+sin(q6)*(sin(q5)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))-cos(q4)*cos(q5)*(cos(q3)*sin(q1)+cos(q1)*cos(q2)*sin(q3)))*3.0E2-cos(q6)*sin(q4)*(cos(q3)*sin(q1)+cos(q1)*cos(q2)*sin(q3))*3.0E2;
-	mat_jaco(0,3) = cos(q6)*(cos(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))+cos(q1)*sin(q2)*sin(q4))*-3.0E2-cos(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))*2.85E2+cos(q5)*sin(q6)*(sin(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))-cos(q1)*cos(q4)*sin(q2))*3.0E2-cos(q1)*sin(q2)*sin(q4)*2.85E2;
-	mat_jaco(0,4) = sin(q6)*(sin(q5)*(cos(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))+cos(q1)*sin(q2)*sin(q4))-cos(q5)*(cos(q3)*sin(q1)+cos(q1)*cos(q2)*sin(q3)))*3.0E2;
-	mat_jaco(0,5) = sin(q6)*(sin(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))-cos(q1)*cos(q4)*sin(q2))*3.0E2-cos(q6)*(cos(q5)*(cos(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))+cos(q1)*sin(q2)*sin(q4))+sin(q5)*(cos(q3)*sin(q1)+cos(q1)*cos(q2)*sin(q3)))*3.0E2;
-
-	mat_jaco(1,0) = cos(q1)*sin(q2)*4.0E2-cos(q6)*(sin(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))-cos(q1)*cos(q4)*sin(q2))*3.0E2-sin(q6)*(cos(q5)*(cos(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))+cos(q1)*sin(q2)*sin(q4))+sin(q5)*(cos(q3)*sin(q1)+cos(q1)*cos(q2)*sin(q3)))*3.0E2-sin(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))*2.85E2+cos(q1)*cos(q4)*sin(q2)*2.85E2;
-	mat_jaco(1,1) = sin(q1)*(cos(q2)*8.0E1+cos(q2)*cos(q4)*5.7E1+cos(q2)*cos(q4)*cos(q6)*6.0E1-cos(q3)*sin(q2)*sin(q4)*5.7E1-cos(q3)*cos(q6)*sin(q2)*sin(q4)*6.0E1-cos(q2)*cos(q5)*sin(q4)*sin(q6)*6.0E1+sin(q2)*sin(q3)*sin(q5)*sin(q6)*6.0E1-cos(q3)*cos(q4)*cos(q5)*sin(q2)*sin(q6)*6.0E1)*5.0;
-	mat_jaco(1,2) = sin(q4)*(cos(q1)*cos(q3)-cos(q2)*sin(q1)*sin(q3))*2.85E2-sin(q6)*(sin(q5)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))-cos(q4)*cos(q5)*(cos(q1)*cos(q3)-cos(q2)*sin(q1)*sin(q3)))*3.0E2+cos(q6)*sin(q4)*(cos(q1)*cos(q3)-cos(q2)*sin(q1)*sin(q3))*3.0E2;
-	mat_jaco(1,3) = cos(q6)*(cos(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))-sin(q1)*sin(q2)*sin(q4))*3.0E2+cos(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))*2.85E2-sin(q1)*sin(q2)*sin(q4)*2.85E2-cos(q5)*sin(q6)*(sin(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))+cos(q4)*sin(q1)*sin(q2))*3.0E2;
-	mat_jaco(1,4) = sin(q6)*(sin(q5)*(cos(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))-sin(q1)*sin(q2)*sin(q4))-cos(q5)*(cos(q1)*cos(q3)-cos(q2)*sin(q1)*sin(q3)))*-3.0E2;
-	mat_jaco(1,5) = sin(q6)*(sin(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))+cos(q4)*sin(q1)*sin(q2))*-3.0E2+cos(q6)*(cos(q5)*(cos(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))-sin(q1)*sin(q2)*sin(q4))+sin(q5)*(cos(q1)*cos(q3)-cos(q2)*sin(q1)*sin(q3)))*3.0E2;
-
-	mat_jaco(2,1) = sin(q2)*-4.0E2-cos(q4)*sin(q2)*2.85E2+sin(q6)*(cos(q5)*(sin(q2)*sin(q4)-cos(q2)*cos(q3)*cos(q4))+cos(q2)*sin(q3)*sin(q5))*3.0E2-cos(q6)*(cos(q4)*sin(q2)+cos(q2)*cos(q3)*sin(q4))*3.0E2-cos(q2)*cos(q3)*sin(q4)*2.85E2;
-	mat_jaco(2,2) = sin(q2)*(sin(q3)*sin(q4)*1.9E1+cos(q6)*sin(q3)*sin(q4)*2.0E1+cos(q3)*sin(q5)*sin(q6)*2.0E1+cos(q4)*cos(q5)*sin(q3)*sin(q6)*2.0E1)*1.5E1;
-	mat_jaco(2,3) = cos(q2)*sin(q4)*-2.85E2-cos(q6)*(cos(q2)*sin(q4)+cos(q3)*cos(q4)*sin(q2))*3.0E2-cos(q5)*sin(q6)*(cos(q2)*cos(q4)-cos(q3)*sin(q2)*sin(q4))*3.0E2-cos(q3)*cos(q4)*sin(q2)*2.85E2;
-	mat_jaco(2,4) = sin(q6)*(sin(q5)*(cos(q2)*sin(q4)+cos(q3)*cos(q4)*sin(q2))+cos(q5)*sin(q2)*sin(q3))*3.0E2;
-	mat_jaco(2,5) = cos(q6)*(cos(q5)*(cos(q2)*sin(q4)+cos(q3)*cos(q4)*sin(q2))-sin(q2)*sin(q3)*sin(q5))*-3.0E2-sin(q6)*(cos(q2)*cos(q4)-cos(q3)*sin(q2)*sin(q4))*3.0E2;
-
-	mat_jaco(3,1) = -sin(q1);
-	mat_jaco(3,2) = cos(q1)*sin(q2);
-	mat_jaco(3,3) = -cos(q3)*sin(q1)-cos(q1)*cos(q2)*sin(q3);
-	mat_jaco(3,4) = -sin(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))+cos(q1)*cos(q4)*sin(q2);
-	mat_jaco(3,5) = sin(q5)*(cos(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))+cos(q1)*sin(q2)*sin(q4))-cos(q5)*(cos(q3)*sin(q1)+cos(q1)*cos(q2)*sin(q3));
-	mat_jaco(3,6) = -cos(q6)*(sin(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))-cos(q1)*cos(q4)*sin(q2))-sin(q6)*(cos(q5)*(cos(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))+cos(q1)*sin(q2)*sin(q4))+sin(q5)*(cos(q3)*sin(q1)+cos(q1)*cos(q2)*sin(q3)));
-
-	mat_jaco(4,1) = cos(q1);
-	mat_jaco(4,2) = sin(q1)*sin(q2);
-	mat_jaco(4,3) = cos(q1)*cos(q3)-cos(q2)*sin(q1)*sin(q3);
-	mat_jaco(4,4) = sin(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))+cos(q4)*sin(q1)*sin(q2);
-	mat_jaco(4,5) = -sin(q5)*(cos(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))-sin(q1)*sin(q2)*sin(q4))+cos(q5)*(cos(q1)*cos(q3)-cos(q2)*sin(q1)*sin(q3));
-	mat_jaco(4,6) = cos(q6)*(sin(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))+cos(q4)*sin(q1)*sin(q2))+sin(q6)*(cos(q5)*(cos(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))-sin(q1)*sin(q2)*sin(q4))+sin(q5)*(cos(q1)*cos(q3)-cos(q2)*sin(q1)*sin(q3)));
-
-	mat_jaco(5,0) = 1.0;
-	mat_jaco(5,2) = cos(q2);
-	mat_jaco(5,3) = sin(q2)*sin(q3);
-	mat_jaco(5,4) = cos(q2)*cos(q4)-cos(q3)*sin(q2)*sin(q4);
-	mat_jaco(5,5) = sin(q5)*(cos(q2)*sin(q4)+cos(q3)*cos(q4)*sin(q2))+cos(q5)*sin(q2)*sin(q3);
-	mat_jaco(5,6) = -sin(q6)*(cos(q5)*(cos(q2)*sin(q4)+cos(q3)*cos(q4)*sin(q2))-sin(q2)*sin(q3)*sin(q5))+cos(q6)*(cos(q2)*cos(q4)-cos(q3)*sin(q2)*sin(q4));
-
-	mat6x1 sing_mat = mat_jaco.jacobiSvd().singularValues();
-	sv_min = sing_mat(5);
+	rpp::kine::jacobian_expanded(mat_jo, mat_jaco);
+
+	// 最小奇异值的估计方法由SV_MIN_METHOD选择
+	sv_min = m_SvMin(mat_jaco);
 }
 
 // Damper Least Square Method
@@ -3318,37 +3386,11 @@ double CyberSystem::DampLS(double svmin)
 	return lambda;
 }
 
-// Calculate Direct Kinetics
-void CyberSystem::CalDirectKine(const mat7x1 &mat_jo, mat4x4 &mat_trans)
-{
-	double q1 = mat_jo(0);
-	double q2 = mat_jo(1);
-	double q3 = mat_jo(2);
-	double q4 = mat_jo(3);
-	double q5 = mat_jo(4);
-	double q6 = mat_jo(5);
-	double q7 = mat_jo(6);
-
-	mat_trans(0,0) = cos(q7)*(sin(q6)*(sin(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))-cos(q1)*cos(q4)*sin(q2))-cos(q6)*(cos(q5)*(cos(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))+cos(q1)*sin(q2)*sin(q4))+sin(q5)*(cos(q3)*sin(q1)+cos(q1)*cos(q2)*sin(q3))))+sin(q7)*(sin(q5)*(cos(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))+cos(q1)*sin(q2)*sin(q4))-cos(q5)*(cos(q3)*sin(q1)+cos(q1)*cos(q2)*sin(q3)));
-	mat_trans(0,1) = -sin(q7)*(sin(q6)*(sin(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))-cos(q1)*cos(q4)*sin(q2))-cos(q6)*(cos(q5)*(cos(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))+cos(q1)*sin(q2)*sin(q4))+sin(q5)*(cos(q3)*sin(q1)+cos(q1)*cos(q2)*sin(q3))))+cos(q7)*(sin(q5)*(cos(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))+cos(q1)*sin(q2)*sin(q4))-cos(q5)*(cos(q3)*sin(q1)+cos(q1)*cos(q2)*sin(q3)));
-	mat_trans(0,2) = -cos(q6)*(sin(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))-cos(q1)*cos(q4)*sin(q2))-sin(q6)*(cos(q5)*(cos(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))+cos(q1)*sin(q2)*sin(q4))+sin(q5)*(cos(q3)*sin(q1)+cos(q1)*cos(q2)*sin(q3)));
-	mat_trans(0,3) = cos(q1)*sin(q2)*4.0E2-cos(q6)*(sin(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))-cos(q1)*cos(q4)*sin(q2))*3.0E2-sin(q6)*(cos(q5)*(cos(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))+cos(q1)*sin(q2)*sin(q4))+sin(q5)*(cos(q3)*sin(q1)+cos(q1)*cos(q2)*sin(q3)))*3.0E2-sin(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))*2.85E2+cos(q1)*cos(q4)*sin(q2)*2.85E2;
-	mat_trans(1,0) = -cos(q7)*(sin(q6)*(sin(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))+cos(q4)*sin(q1)*sin(q2))-cos(q6)*(cos(q5)*(cos(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))-sin(q1)*sin(q2)*sin(q4))+sin(q5)*(cos(q1)*cos(q3)-cos(q2)*sin(q1)*sin(q3))))-sin(q7)*(sin(q5)*(cos(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))-sin(q1)*sin(q2)*sin(q4))-cos(q5)*(cos(q1)*cos(q3)-cos(q2)*sin(q1)*sin(q3)));
-	mat_trans(1,1) = sin(q7)*(sin(q6)*(sin(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))+cos(q4)*sin(q1)*sin(q2))-cos(q6)*(cos(q5)*(cos(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))-sin(q1)*sin(q2)*sin(q4))+sin(q5)*(cos(q1)*cos(q3)-cos(q2)*sin(q1)*sin(q3))))-cos(q7)*(sin(q5)*(cos(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))-sin(q1)*sin(q2)*sin(q4))-cos(q5)*(cos(q1)*cos(q3)-cos(q2)*sin(q1)*sin(q3)));
-	mat_trans(1,2) = cos(q6)*(sin(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))+cos(q4)*sin(q1)*sin(q2))+sin(q6)*(cos(q5)*(cos(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))-sin(q1)*sin(q2)*sin(q4))+sin(q5)*(cos(q1)*cos(q3)-cos(q2)*sin(q1)*sin(q3)));
-	mat_trans(1,3) = sin(q1)*sin(q2)*4.0E2+cos(q6)*(sin(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))+cos(q4)*sin(q1)*sin(q2))*3.0E2+sin(q6)*(cos(q5)*(cos(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))-sin(q1)*sin(q2)*sin(q4))+sin(q5)*(cos(q1)*cos(q3)-cos(q2)*sin(q1)*sin(q3)))*3.0E2+sin(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))*2.85E2+cos(q4)*sin(q1)*sin(q2)*2.85E2;
-	mat_trans(2,0) = sin(q7)*(sin(q5)*(cos(q2)*sin(q4)+cos(q3)*cos(q4)*sin(q2))+cos(q5)*sin(q2)*sin(q3))-cos(q7)*(cos(q6)*(cos(q5)*(cos(q2)*sin(q4)+cos(q3)*cos(q4)*sin(q2))-sin(q2)*sin(q3)*sin(q5))+sin(q6)*(cos(q2)*cos(q4)-cos(q3)*sin(q2)*sin(q4)));
-	mat_trans(2,1) = cos(q7)*(sin(q5)*(cos(q2)*sin(q4)+cos(q3)*cos(q4)*sin(q2))+cos(q5)*sin(q2)*sin(q3))+sin(q7)*(cos(q6)*(cos(q5)*(cos(q2)*sin(q4)+cos(q3)*cos(q4)*sin(q2))-sin(q2)*sin(q3)*sin(q5))+sin(q6)*(cos(q2)*cos(q4)-cos(q3)*sin(q2)*sin(q4)));
-	mat_trans(2,2) = -sin(q6)*(cos(q5)*(cos(q2)*sin(q4)+cos(q3)*cos(q4)*sin(q2))-sin(q2)*sin(q3)*sin(q5))+cos(q6)*(cos(q2)*cos(q4)-cos(q3)*sin(q2)*sin(q4));
-	mat_trans(2,3) = cos(q2)*4.0E2+cos(q2)*cos(q4)*2.85E2-sin(q6)*(cos(q5)*(cos(q2)*sin(q4)+cos(q3)*cos(q4)*sin(q2))-sin(q2)*sin(q3)*sin(q5))*3.0E2+cos(q6)*(cos(q2)*cos(q4)-cos(q3)*sin(q2)*sin(q4))*3.0E2-cos(q3)*sin(q2)*sin(q4)*2.85E2;
-	mat_trans(3,0) = mat_trans(3,1) = mat_trans(3,2) = 0;
-	mat_trans(3,3) = 1.0;
-}
 
 
 
-// жϹؽڽǵķΧ
-// ڷΧڣtrueڷΧڣfalse 
+// 判断关节角的范围
+// 如果在范围内，返回true；如果不在范围内，返回false 
 bool CyberSystem::AngleRange(const mat7x1 &jo)
 {
 	bool ret = true;
@@ -3368,25 +3410,12 @@ bool CyberSystem::AngleRange(const mat7x1 &jo)
 
 
 
-// ΢˶ѧ
-// Ŀ̬pose_newο̬pose_refͲοǶjoint_ref˶ѧjoint
-// ˶ѧǷɹ
+// 微分运动学函数
+// 输入目标姿态pose_new，参考姿态pose_ref和参考角度joint_ref；求解逆运动学，更新joint变量
+// 输出逆运动学计算是否成功
 bool CyberSystem::DiffKine(const mat7x1 &pose_new, const mat7x1 &pose_ref, const mat7x1 &joint_ref, mat7x1 &joint)
 {
-	int cal_count = 200;		// 
-	double cal_period = 0.001;		// ڣλ
-
-	mat7x1 quat_ref = pose_ref;			// ǰ̬
-	mat4x4 trans_new;		// Ŀ̬תʾ
-	mat7x1 quat_next;		// һĿ̬
-
-	mat7x1 joint_feed = joint_ref;		// Ƕ
-	mat4x4 trans_feed;		// ̬תʾ
-	mat7x1 quat_feed = pose_ref;		// ̬Ԫʾ,ʼΪǰ̬
-
-	double sv_min;		// Сֵ
-	double lambda = 0;		// Сϵ
-
+	mat4x4 trans_new;		// 目标姿态的旋转矩阵表示
 
 	double pose_new_arr[7];
 	for (int i = 0; i < 7; ++i)
@@ -3395,176 +3424,65 @@ bool CyberSystem::DiffKine(const mat7x1 &pose_new, const mat7x1 &pose_ref, const
 	}
 	QuaterToTrans(pose_new_arr, trans_new);
 
-	for (int i = 0; i < cal_count; ++i)
-	{
-		PosePlan(pose_ref, pose_new, cal_count, (i+1), quat_next);
-
-		// Transform delta quaternion to delta omega
-		double Eta = quat_ref(3);
-		double Epsilon1 = quat_ref(4);
-		double Epsilon2 = quat_ref(5);
-		double Epsilon3 = quat_ref(6);
-
-		m_RQuatoOmega(0,0) = Eta;
-		m_RQuatoOmega(0,1) = Epsilon1;
-		m_RQuatoOmega(0,2) = Epsilon2;
-		m_RQuatoOmega(0,3) = Epsilon3;
-
-		m_RQuatoOmega(1,0) = -Epsilon1;
-		m_RQuatoOmega(1,1) = Eta;
-		m_RQuatoOmega(1,2) = Epsilon3;
-		m_RQuatoOmega(1,3) = -Epsilon2;
-
-		m_RQuatoOmega(2,0) = -Epsilon2;
-		m_RQuatoOmega(2,1) = -Epsilon3;
-		m_RQuatoOmega(2,2) = Eta;
-		m_RQuatoOmega(2,3) = Epsilon1;
-
-		m_RQuatoOmega(3,0) = -Epsilon3;
-		m_RQuatoOmega(3,1) = Epsilon2;
-		m_RQuatoOmega(3,2) = -Epsilon1;
-		m_RQuatoOmega(3,3) = Eta;
-
-		// 滮ٶȲ
-		for (int i = 0; i < 4; ++i)
-		{
-			m_RdQuat(i) = (quat_next(i + 3) - quat_ref(i + 3))/cal_period;
-		}
-
-		m_ROmega = 2*m_RQuatoOmega*m_RdQuat;
-		for (int i = 0; i < 3; ++i)
-		{
-			m_RVel(i) = (quat_next(i) - quat_ref(i))/cal_period;
-			m_RVel(i + 3) = m_ROmega(i + 1);
-		}
-
-
-		// 
-		des_Epsilon << quat_next(4), quat_next(5), quat_next(6);
-		feed_Epsilon << quat_feed(4), quat_feed(5), quat_feed(6);
-		CrossMat << 0, -des_Epsilon(2), des_Epsilon(1),
-			des_Epsilon(2), 0, -des_Epsilon(0),
-			-des_Epsilon(1), des_Epsilon(0), 0;
-		m_RRotErr = quat_feed(3)*feed_Epsilon - quat_next(3)*des_Epsilon - CrossMat*feed_Epsilon;
-
-		double K_Pos = 1;		// λ 
-		double K_Ori = 100;		// ̬
-		for (int i = 0; i < 3; ++i)
-		{
-			m_RPoseErr(i) = K_Pos*(quat_next(i) - quat_feed(i));		// λ
-			m_RPoseErr(i + 3) = K_Ori*m_RRotErr(i);		// ̬
-		}
-
-		// calculate jacobi
-		CalJaco(joint_feed, m_RJacoMat, sv_min);
-
-		// damper least square
-		lambda = DampLS(fabs(sv_min));		// ʹsv_minľֵ
-		auto damp_coeff = m_RJacoMat.transpose()*(m_RJacoMat*m_RJacoMat.transpose() + lambda*Eigen::MatrixXd::Identity(6,6)).inverse();
-
-		// gradient
-		double optimcoeff = 10;
-		mat7x1 jo_min, jo_max, jo_mid;
-		jo_min << ROBO_J0_MIN, ROBO_J1_MIN, ROBO_J2_MIN, ROBO_J3_MIN, ROBO_J4_MIN, ROBO_J5_MIN, ROBO_J6_MIN;
-		jo_max << ROBO_J0_MAX, ROBO_J1_MAX, ROBO_J2_MAX, ROBO_J3_MAX, ROBO_J4_MAX, ROBO_J5_MAX, ROBO_J6_MAX;
-
-		// transform joint angle to joint degree
-		for (int i = 0; i < 7; ++i)
-		{
-			jo_min(i) = ANG2DEG(jo_min(i));
-			jo_max(i) = ANG2DEG(jo_max(i));
-		}
-
-		jo_mid = (jo_min + jo_max)/2;
-		mat7x1 dq0;
-		for (int i = 0; i < 7; ++i)
-		{
-			// ıݶͶӰĲkԭΪ100
-			dq0(i) = -1*(1.0/7.0)*(joint_ref(i) - jo_mid(i))/pow((jo_max(i) - jo_min(i)),2);
-		}
-		auto grad_coeff = optimcoeff*(Eigen::MatrixXd::Identity(7,7) - m_RJacoMat.transpose()*(m_RJacoMat*m_RJacoMat.transpose()).inverse()*m_RJacoMat)*dq0;
-
-		// control
-		auto dx = m_RVel + m_RPoseErr;
-		auto dq = damp_coeff*dx + grad_coeff;
-
-		// integrate
-		joint = joint_feed + dq*cal_period;
+	// pose_ref不再用于前馈插值，保留参数以兼容调用
+	return DiffKine(pose_new, trans_new, joint_ref, joint);
+}
 
-		// жϼĽǶǷڻе۵Ĺؽλ
-		bool ret = AngleRange(joint);
-		if (ret == false)
-		{
-			m_CmdStr += "Arm Joints Out of Range!!!\r\n";
-			InsertCmdStr(m_CmdStr);
-			return false;
-		}
+// 目标姿态已有齐次变换trans_new时（如规划的采样）不再重复转换
+bool CyberSystem::DiffKine(const mat7x1 &pose_new, const mat4x4 &trans_new, const mat7x1 &joint_ref, mat7x1 &joint)
+{
+	// 闭环迭代求解，位姿误差小于阈值即提前结束，最多迭代200次
+	auto result = m_DiffSolver.solve(pose_new, joint_ref, joint);
+	m_DiffKineIter = result.iterations;
+	m_DiffKineResidual = result.residual;
+	double lambda = result.lambda;		// 阻尼最小二乘系数
 
-		// ˶ѧ
-		joint_feed = joint;
-		CalDirectKine(joint_feed, trans_feed);
-		TransToQuater(trans_feed, quat_feed);
-		quat_ref = quat_next;
+	// 判断计算的角度是否在机械臂的关节限位以内
+	bool ret = AngleRange(joint);
+	if (ret == false)
+	{
+		m_CmdStr += "Arm Joints Out of Range!!!\r\n";
+		InsertCmdStr(m_CmdStr);
+		return false;
 	}
 
-	// 
-	CalDirectKine(joint, m_RFeedTrans);
-	auto err = (m_RFeedTrans - trans_new).norm();
+	// 检测输出
+	m_RFeedTrans = result.pose;
+	QString iter_str = QString(" (iter: %1, residual: %2)\r\n").arg(m_DiffKineIter).arg(m_DiffKineResidual);
 
-	if (lambda == 0)		// С˲
+	if (lambda == 0)		// 阻尼最小二乘不起作用
 	{
 		if ((m_RFeedTrans - trans_new).norm() < 0.5)
 		{
-			m_CmdStr += "In Normal mode!!!\r\n";
+			m_CmdStr += "In Normal mode!!!" + iter_str;
 			InsertCmdStr(m_CmdStr);
 			return true;
 		} 
 		else
 		{
-			m_CmdStr += "In normal mode, Deviation is too Large!!!\r\n";
+			m_CmdStr += "In normal mode, Deviation is too Large!!!" + iter_str;
 			InsertCmdStr(m_CmdStr);
 			return false;
 		}
 	}
-	else		// С
+	else		// 阻尼最小二乘起作用
 	{
 		if ((m_RFeedTrans - trans_new).norm() < 2)
 		{
-			m_CmdStr += "In Damper mode!!!\r\n";
+			m_CmdStr += "In Damper mode!!!" + iter_str;
 			InsertCmdStr(m_CmdStr);
 			return true;
 		} 
 		else
 		{
-			m_CmdStr += "In Damper mode, Deviation is too Large!!!\r\n";
+			m_CmdStr += "In Damper mode, Deviation is too Large!!!" + iter_str;
 			InsertCmdStr(m_CmdStr);
 			return false;
 		}
 	}
 }
 
-// 滮ܲPlanTotalCountĿǰ滮Plancount滮StartPose滮յEndPose
-// ÿһ滮λ
-void CyberSystem::PosePlan(const mat7x1 &StartPose, const mat7x1 &EndPose, const int PlanTotalCount, const int PlanCount, mat7x1 &PoseOut)
-{
-	for (int i = 0; i < 3; ++i)
-	{
-		PoseOut(i) = StartPose(i) + (EndPose(i) - StartPose(i))/PlanTotalCount*PlanCount;
-	}
-
-	mat4x1 Ori_tmp;
-	for (int i = 0; i < 4; ++i)
-	{
-		Ori_tmp(i) = StartPose(i+3) + (EndPose(i+3) - StartPose(i+3))/PlanTotalCount*PlanCount;
-	}
-	Ori_tmp = Ori_tmp/(Ori_tmp.norm());
-	for (int i = 0; i < 4; ++i)
-	{
-		PoseOut(i+3) = Ori_tmp(i);
-	}
-}
-
-// Executeťһ·滮,ʼοǶ
+// 点击Execute按钮，进入一次路径规划控制,初始化参考角度
 void CyberSystem::ExecPlan()
 {
 	// 	m_CtrlMode = PLAN_WAIT;
@@ -3572,7 +3490,7 @@ void CyberSystem::ExecPlan()
 	// 	m_plan_count = 0;
 	// 	m_plan_count_max = m_RPlanTime/(RobonautCommPd/1000.0);
 	// 
-	// 	// ʼοǶ
+	// 	// 初始化参考角度
 	// 	double quat[7];
 	// 	for (int i = 0; i < 7; ++i)
 	// 	{
@@ -3581,7 +3499,7 @@ void CyberSystem::ExecPlan()
 	// 	QuaterToTrans(quat, m_RTraRealMat);
 	// 	mat7x1 q = CalKine(m_RTraRealMat, m_last_arm_angle, m_last_joint_angle);
 	// 
-	// 	// ͳʼǶ
+	// 	// 发送初始角度
 	// 	// g_rightArmJointBuf is the Command Buffer
 	// 	for (int i = 0; i < 7; ++i)
 	// 	{
@@ -3597,14 +3515,49 @@ void CyberSystem::ExecPlan()
 	// 		bool consimu_ret = m_RobonautControl.SendConsimuMsg();
 	// 	}
 	// 
-	// 	// еʼλ
+	// 	// 待机械臂来到初始的位置
 	// 	m_CmdStr += "Moving to init Pose......";
 	// 	InsertCmdStr(m_CmdStr);
 	// 	Sleep(500);
 	// 	m_CmdStr += "Success!!!\r\n";
 	// 	InsertCmdStr(m_CmdStr);
 
-	// ıģʽʱԹ滮
+	// 规划在后台求解完成且全部采样可行后才开始执行
+	switch (m_RPlanBuffer.GetState())
+	{
+	case PlanBuffer::Empty:
+		m_CmdStr += "No Plan, Read Pose First!!!\r\n";
+		emit InsertCmdStr(m_CmdStr);
+		return;
+	case PlanBuffer::Solving:
+		m_CmdStr += "Plan is Still Solving, Try Again Later!!!\r\n";
+		emit InsertCmdStr(m_CmdStr);
+		return;
+	case PlanBuffer::Failed:
+		if (m_RPlanBuffer.IsWaypointPlan() == false)
+		{
+			m_CmdStr += QString("Plan is Infeasible at Step %1 of %2 (residual: %3)!!!\r\n")
+				.arg(m_RPlanBuffer.FailedIndex() + 1).arg(m_RPlanBuffer.Size()).arg(m_RPlanBuffer.FailedResidual());
+		}
+		else if (m_RPlanBuffer.WaypointStatus() == rpp::kine::PLAN_NO_IK)
+		{
+			m_CmdStr += QString("Waypoint %1 has no IK Solution!!!\r\n").arg(m_RPlanBuffer.FailedIndex());
+		}
+		else
+		{
+			m_CmdStr += QString("Waypoint %1 is Out of Joint Range!!!\r\n").arg(m_RPlanBuffer.FailedIndex());
+		}
+		emit InsertCmdStr(m_CmdStr);
+		return;
+	default:
+		m_CmdStr += QString("Plan Solved: %1 Steps in %2 ms\r\n").arg(m_RPlanBuffer.Size()).arg(m_RPlanBuffer.SolveMs());
+		emit InsertCmdStr(m_CmdStr);
+		break;
+	}
+	// 路径点规划的步数由关节速度、加速度限制决定
+	m_plan_count_max = m_RPlanBuffer.Size();
+
+	// 改变控制模式，定时器进入周期性规划
 	if (m_bRoboConn == true && m_bConsimuConn == true)
 	{
 		m_CtrlMode = PLAN_CTRL_ALL;
@@ -3618,7 +3571,7 @@ void CyberSystem::ExecPlan()
 	}
 }
 
-// PlanťPlanģʽ
+// 点击Plan按钮，进入Plan控制模式
 void CyberSystem::PlanCtrl()
 {
 	if (m_CtrlMode == OUT_CTRL && (m_bRoboConn == true || m_bConsimuConn == true) && (ui.m_pPlanCtrlBtn->text() == "Plan"))
@@ -3658,7 +3611,7 @@ void CyberSystem::PlanCtrl()
 		}
 	}
 
-	// Stopť
+	// 点击Stop按钮
 	else
 	{
 		m_CtrlMode = OUT_CTRL;
@@ -3721,18 +3674,24 @@ void CyberSystem::getPlanData()
 		}
 
 		// Read Planning End Pose
-		int end_count = 0;
-		for (int i = 0; i < 7 && (!r_end_istr.eof()); ++i)
+		// 可以依次输入多个位姿（每个7个数），最后一个为终点，此时按路径点在关节空间规划
+		std::vector<double> end_data;
+		double end_value;
+		while (r_end_istr >> end_value)
 		{
-			r_end_istr >> m_RPlanEndQuat(i);
-			++end_count;
+			end_data.push_back(end_value);
 		}
-		if (end_count != 7)
+		if (end_data.size() < 7 || end_data.size() % 7 != 0)
 		{
 			m_CmdStr += "There is No Enough Inputs for Right Planning!!!\r\n";
 			emit InsertCmdStr(m_CmdStr);
 			return;
 		}
+		int waypoint_count = (int)end_data.size() / 7;
+		for (int i = 0; i < 7; ++i)
+		{
+			m_RPlanEndQuat(i) = end_data[(waypoint_count - 1) * 7 + i];
+		}
 
 		// Read Time
 		r_time_istr >> m_RPlanTime;
@@ -3746,8 +3705,13 @@ void CyberSystem::getPlanData()
 		m_last_RTraRealQuat = m_RPlanStartQuat;
 		m_plan_count = 0;
 		m_plan_count_max = m_RPlanTime/(RobonautCommPd/1000.0);
+		if (waypoint_count == 1)
+		{
+			m_RPlanTraj.plan(m_RPlanStartQuat, m_RPlanEndQuat, m_plan_count_max,
+				(rpp::kine::TimeScaling)PlanTimeScaling);
+		}
 
-		// ʼοǶ
+		// 初始化参考角度
 		double quat[7];
 		for (int i = 0; i < 7; ++i)
 		{
@@ -3756,7 +3720,7 @@ void CyberSystem::getPlanData()
 		QuaterToTrans(quat, m_RTraRealMat);
 		mat7x1 q = CalKine(m_RTraRealMat, m_last_arm_angle, m_last_joint_angle);
 
-		// ͳʼǶ
+		// 发送初始角度
 		// g_rightArmJointBuf is the Command Buffer
 		for (int i = 0; i < 7; ++i)
 		{
@@ -3772,12 +3736,33 @@ void CyberSystem::getPlanData()
 			bool consimu_ret = m_RobonautControl.SendConsimuMsg();
 		}
 
-		// еʼλ
+		// 待机械臂来到初始的位置
 		m_CmdStr += "Moving to init Pose......";
 		InsertCmdStr(m_CmdStr);
 		Sleep(500);
 		m_CmdStr += "Success!!!\r\n";
 		InsertCmdStr(m_CmdStr);
+
+		// 整条规划在后台求解到关节空间，全部采样可行后ExecPlan才开始执行
+		if (waypoint_count == 1)
+		{
+			// 一个终点：笛卡尔空间直线，用时m_RPlanTime
+			m_RPlanBuffer.Start(m_DiffSolver, m_RPlanTraj, q);
+			m_CmdStr += QString("Solving %1 Plan Steps in Background......\r\n").arg(m_RPlanTraj.size());
+		} 
+		else
+		{
+			// 多个路径点：关节空间时间最优，用时不少于m_RPlanTime
+			PlanBuffer::pose_vector waypoints(waypoint_count);
+			for (int i = 0; i < waypoint_count; ++i)
+			{
+				QuaterToTrans(&end_data[i * 7], waypoints[i]);
+			}
+			m_RPlanBuffer.StartWaypoints(m_KineSolver, waypoints, q, m_last_arm_angle, m_PlanLimits,
+				RobonautCommPd/1000.0, m_RPlanTime);
+			m_CmdStr += QString("Solving %1 Waypoints in Background......\r\n").arg(waypoint_count);
+		}
+		InsertCmdStr(m_CmdStr);
 	} 
 	else
 	{
@@ -3846,9 +3831,18 @@ void CyberSystem::ViCycle()
 }
 
 //Receive Vision Data from camera, then display in the QLineEdit
+// 取反应器收到的最新位姿，没有新数据时不更新
 void CyberSystem::RecvVision()
 {
-	int ret = m_VisionRecv_Client.RecvViData(m_ViRecv);
+	VisionSense sense;
+	if (m_VisionLink.Latest().Take(sense) == false)
+	{
+		return;
+	}
+	for (int i = 0; i < 7; ++i)
+	{
+		m_ViRecv[i] = sense.data[i];
+	}
 
 	ViRecvTrans(m_ViRecv, m_ViEulerRecv);
 
@@ -3888,6 +3882,7 @@ void CyberSystem::ConnVision()
 	char *Vision_ip = VISION_SENSE_IP;
 	UINT Vision_Port = VISION_SENSE_PORT; 
 
+	m_RobonautControl.Reactor().Remove(&m_VisionLink);
 	int recv_ret = m_VisionRecv_Client.ConnectServer(VISION_SENSE_IP,VISION_SENSE_PORT);
 
 	if (recv_ret == 0)
@@ -3895,6 +3890,8 @@ void CyberSystem::ConnVision()
 		m_CmdStr += "Success!\r\nCreating Vision Timer......";
 		InsertCmdStr(m_CmdStr);
 
+		m_RobonautControl.Reactor().Add(&m_VisionLink);
+
 		if (!(m_CamThread.isRunning()))
 		{
 			m_CamThread.start();
@@ -3967,7 +3964,7 @@ void CyberSystem::VisionCtrl()
 		}
 	}
 
-	// Stopť
+	// 点击Stop按钮
 	else
 	{
 		m_CtrlMode = OUT_CTRL;
@@ -4009,9 +4006,9 @@ void CyberSystem::VisionStart()
 
 #if ArmDebug
 
-	// 
+	// 虚拟仿真测试
 	//last_cmd_jo << ANG2DEG(-62.0591), ANG2DEG(-49.0389), ANG2DEG(-8.618), ANG2DEG(-57.4985), ANG2DEG(15.345), ANG2DEG(-37.3492), ANG2DEG(-21.9836);
-	// ʼؽڽ
+	// 初始化关节角
 	for (int i = 0; i < 7; ++i)
 	{
 	 	last_cmd_jo(i) = ANG2DEG(g_RobotSensorDeg.rightArmJoint[i]);
@@ -4030,14 +4027,14 @@ void CyberSystem::VisionStart()
 		g_leftArmJointBuf[i] = 0;
 	}
 
-	// ˲
-	// ʼؽڽ
+	// 机器人测试
+	// 初始化关节角
 	// 	for (int i = 0; i < 7; ++i)
 	// 	{
 	// 		last_cmd_jo(i) = g_RobotSensorDeg.rightArmJoint[i];
 	// 	}
 	// 
-	// 	// ͵
+	// 	// 更新命令发送到缓冲数组
 	// 	for (int i = 0; i < 7; ++i)
 	// 	{
 	// 		g_rightArmJointBuf[i] = DEG2ANG(last_cmd_jo(i));
@@ -4046,17 +4043,17 @@ void CyberSystem::VisionStart()
 	// 
 	// 	bool ret = m_RobonautControl.SendRoboMsg();
 	// 
-	// 	Sleep(1000);		// ȴе۶Ӧλ
+	// 	Sleep(1000);		// 等待机械臂动到相应的位置
 #else
 	//last_cmd_jo << ANG2DEG(-62.1245), ANG2DEG(-40.6436), ANG2DEG(-8.7226), ANG2DEG(-59.5151), ANG2DEG(14.3206), ANG2DEG(-38.3765), ANG2DEG(-21.8541);
-	// ʼؽڽ
+	// 初始化关节角
 	for (int i = 0; i < 7; ++i)
 	{
 		last_cmd_jo(i) = g_RobotSensorDeg.rightArmJoint[i];
 		last_cmd_jo(i) = ANG2DEG(last_cmd_jo(i));
 	}
 
-	// ͵
+	// 更新命令发送到缓冲数组
 	for (int i = 0; i < 7; ++i)
 	{
 		g_rightArmJointBuf[i] = DEG2ANG(last_cmd_jo(i));
@@ -4066,10 +4063,10 @@ void CyberSystem::VisionStart()
 	bool ret = m_RobonautControl.SendRoboMsg();
 	//bool send_ret = m_RobonautControl.SendConsimuMsg();
 
-	Sleep(1000);		// ȴе۶Ӧλ
+	Sleep(1000);		// 等待机械臂动到相应的位置
 #endif
 
-	// ѭ
+	// 进入控制循环
 	m_CtrlMode = VISION_CTRL;
 
 	ui.m_pViStartBtn->setEnabled(false);
@@ -4096,16 +4093,16 @@ void CyberSystem::VisionAppr()
 // 
 void CyberSystem::GetViNextAppr(const double ViEulerRecv[], const double Quat_Ref[7], double Quat_New[7])
 {
-	double ApprRef = RefFinAppr;		// УҪﵽĽӽ루Z
-	double ApprNow = ViEulerRecv[6];		// ĿǰеĽӽ루Z
+	double ApprRef = RefFinAppr;		// 相机中，需要达到的接近距离（Z向）
+	double ApprNow = ViEulerRecv[6];		// 目前相机中的接近距离（Z向）
 	double move_step = 1;
 	
-	if (fabs(ApprNow) > ApprRef)		// δ
+	if (fabs(ApprNow) > ApprRef)		// 距离调整未完成
 	{
-		mat4x4 trans_ref;		// ĩ˵ǰλ
-		mat4x4 trans_new;		// ĩ˸ºλ
+		mat4x4 trans_ref;		// 末端当前位姿
+		mat4x4 trans_new;		// 末端更新后位姿
 		QuaterToTrans(Quat_Ref, trans_ref);
-		mat4x4 move_mat;		// οеĩƶ
+		mat4x4 move_mat;		// 参考机械臂末端移动矩阵
 		move_mat << 1, 0, 0, 0,
 			0, 1, 0, 0,
 			0, 0, 1, SGN(ApprNow - ApprRef)*move_step,
@@ -4119,7 +4116,7 @@ void CyberSystem::GetViNextAppr(const double ViEulerRecv[], const double Quat_Re
 			Quat_New[i] = Quat_New_Mat(i);
 		}
 	}
-	else		// 
+	else		// 距离调整完成
 	{
 		for (int i = 0; i < 7; ++i)
 		{
@@ -4143,7 +4140,7 @@ void CyberSystem::GetViNextPos(const double ViRecv[], const mat7x1 &Quat_Ref, ma
 	mat3x1 BaseMove;
 	mat3x1 EndMove;
 	ViMove << (ViRecv[4] - ViRefPos[0]), (ViRecv[5] - ViRefPos[1]), (ViRecv[6] - ViRefPos[2]);
-	// ϵеĩϵı任
+	// 相机坐标系到机械臂末端坐标系的变换
 	EndMove(0) = -ViMove(1);
 	EndMove(1) = ViMove(0);
 	EndMove(2) = ViMove(2);
@@ -4263,55 +4260,55 @@ void CyberSystem::GetViNextPos(const double ViRecv[], const mat7x1 &Quat_Ref, ma
 // 		Euler[i] = ViEulerRecv[i+1];
 // 	}
 // 
-// 	// еĩ˵ı任
+// 	// 机械臂末端到相机的变换矩阵
 // 	mat4x4 EndToCamMat;
 // 	EndToCamMat << 1, 0, 0, 0, 
 // 		0, 1, 0, 0, 
 // 		0, 0, 1, 0, 
 // 		0, 0, 0, 1;
 // 
-// 	mat4x4 BaseToCamMat_Ref;	// ڻ
+// 	mat4x4 BaseToCamMat_Ref;	// 相机相对于基座
 // 	mat4x4 BaseToCamMat_New;
-// 	mat4x4 BaseToEndMat_Ref;	// еĩڻ
+// 	mat4x4 BaseToEndMat_Ref;	// 机械臂末端相对于基座
 // 	mat4x4 BaseToEndMat_New;
 // 
-// 	double adjust_euler[6] = {0, 0, 0, 0, 0, 0};		// Ƕȵŷ
-// 	mat4x4 AdjustMat;		// Ƕȵ
+// 	double adjust_euler[6] = {0, 0, 0, 0, 0, 0};		// 角度调节欧拉角
+// 	mat4x4 AdjustMat;		// 角度调整矩阵
 // 
 // 	QuaterToTrans(Quat_Ref, BaseToEndMat_Ref);
 // 	BaseToCamMat_Ref = BaseToEndMat_Ref*EndToCamMat;
 // 
 // 
 // 
-// #if ArmDebug		// ʹãÿѭĩϵתһǶ
+// #if ArmDebug		// 调试使用，每次循环更新绕末端坐标系旋转一个角度
 // 	adjust_euler[3] = ANG2DEG(1);
 // 	//	adjust_euler[4] = ANG2DEG(1);
 // 	//	adjust_euler[5] = ANG2DEG(1);
 // 
 // #else
-// 	if (fabs(Euler[0] - ZEulerDegRef) > ZEulerDegCut)		// Z
+// 	if (fabs(Euler[0] - ZEulerDegRef) > ZEulerDegCut)		// 调整Z角
 // 	{
 // 		adjust_euler[3] = SGN(Euler[0] - ZEulerDegRef)*move_step;
 // 		m_CmdStr += "Adjusting Z\r\n";
 // 		InsertCmdStr(m_CmdStr);
 // 	}
-// 	else		// Zǵ
+// 	else		// Z角调整完成
 // 	{
-// 		if (fabs(Euler[1] - YEulerDegRef) > YEulerDegCut)		// Y
+// 		if (fabs(Euler[1] - YEulerDegRef) > YEulerDegCut)		// 调整Y角
 // 		{
 // 			adjust_euler[4] = SGN(Euler[1] - YEulerDegRef)*move_step;
 // 			m_CmdStr += "Adjusting Y\r\n";
 // 			InsertCmdStr(m_CmdStr);
 // 		}
-// 		else		// Yǵ
+// 		else		// Y角调整完成
 // 		{
-// 			if (fabs(Euler[2] - XEulerDegRef) > XEulerDegCut)		// X
+// 			if (fabs(Euler[2] - XEulerDegRef) > XEulerDegCut)		// 调整X角
 // 			{
 // 				adjust_euler[5] = SGN(Euler[2] - XEulerDegRef)*move_step;
 // 				m_CmdStr += "Adjusting X\r\n";
 // 				InsertCmdStr(m_CmdStr);
 // 			} 
-// 			else		// ̬
+// 			else		// 姿态调整完成
 // 			{
 // 				for (int i = 0; i < 7; ++i)
 // 				{
@@ -4361,7 +4358,7 @@ void CyberSystem::GetViNextOri(const double ViEulerRecv[], const double Quat_Ref
 		Quat_Ref_Rot[i] = Quat_Ref[i+3];
 	}
 
-	mat4x4 EndToCamMat;		// еĩ˵ı任
+	mat4x4 EndToCamMat;		// 机械臂末端到相机的变换矩阵
 	EndToCamMat << 0, -1, 0, 0, 
 		1, 0, 0, 275, 
 		0, 0, 1, 0, 
@@ -4374,9 +4371,9 @@ void CyberSystem::GetViNextOri(const double ViEulerRecv[], const double Quat_Ref
 
 
 	// 
-	mat4x4 BaseToCamMat_Ref;	// ڻ
+	mat4x4 BaseToCamMat_Ref;	// 相机相对于基座
 	mat4x4 BaseToCamMat_New;
-	mat4x4 BaseToEndMat_Ref;	// еĩڻ
+	mat4x4 BaseToEndMat_Ref;	// 机械臂末端相对于基座
 	mat4x4 BaseToEndMat_New;
 
 	QuaterToTrans(Quat_Ref, BaseToEndMat_Ref);
@@ -4390,42 +4387,42 @@ void CyberSystem::GetViNextOri(const double ViEulerRecv[], const double Quat_Ref
 	}
 
 
-	double adjust_euler[3] = {0, 0, 0};		// Ƕȵŷ
-	mat3x3 AdjustMat;		// Ƕȵ
+	double adjust_euler[3] = {0, 0, 0};		// 角度调节欧拉角
+	mat3x3 AdjustMat;		// 角度调整矩阵
 
 
 
 
 
-#if ArmDebug		// ʹãÿѭĩϵתһǶ
+#if ArmDebug		// 调试使用，每次循环更新绕末端坐标系旋转一个角度
 	//adjust_euler[0] = ANG2DEG(1);
 	//adjust_euler[1] = ANG2DEG(1);
 	//adjust_euler[2] = ANG2DEG(1);
 
 #else
-	if (fabs(Euler[0] - ZEulerDegRef) > ZEulerDegCut)		// Z
+	if (fabs(Euler[0] - ZEulerDegRef) > ZEulerDegCut)		// 调整Z角
 	{
 		adjust_euler[0] = SGN(Euler[0] - ZEulerDegRef)*move_step;
 		m_CmdStr += "Adjusting Z\r\n";
 		InsertCmdStr(m_CmdStr);
 	}
-	else		// Zǵ
+	else		// Z角调整完成
 	{
-		if (fabs(Euler[1] - YEulerDegRef) > YEulerDegCut)		// Y
+		if (fabs(Euler[1] - YEulerDegRef) > YEulerDegCut)		// 调整Y角
 		{
 			adjust_euler[1] = SGN(Euler[1] - YEulerDegRef)*move_step;
 			m_CmdStr += "Adjusting Y\r\n";
 			InsertCmdStr(m_CmdStr);
 		}
-		else		// Yǵ
+		else		// Y角调整完成
 		{
-			if (fabs(Euler[2] - XEulerDegRef) > XEulerDegCut)		// X
+			if (fabs(Euler[2] - XEulerDegRef) > XEulerDegCut)		// 调整X角
 			{
 				adjust_euler[2] = SGN(Euler[2] - XEulerDegRef)*move_step;
 				m_CmdStr += "Adjusting X\r\n";
 				InsertCmdStr(m_CmdStr);
 			} 
-			else		// ̬
+			else		// 姿态调整完成
 			{
 				for (int i = 0; i < 7; ++i)
 				{
@@ -4479,7 +4476,7 @@ void CyberSystem::ViRecvTrans(const double ViRecv[7], double ViEulerRecv[7])
 	// orientation
 	mat3x1 Rod;
 	mat3x3 CamNowRot;
-	mat3x3 CamDesRot;		// ϵҪ̬
+	mat3x3 CamDesRot;		// 最终相机坐标系下要到达的姿态
 	mat3x3 RotCoeff;
 	double Euler[3];
 	//	double Euler[3];
@@ -6,6 +6,7 @@
 
 #include "RobonautControl.h"
 #include "CyberStation.h"
+#include "PlanBuffer.h"
 
 #include <QtWidgets/QMainWindow>
 #include <QMessageBox>
@@ -15,6 +16,7 @@
 #include <QString>
 #include <QFile>
 #include <QThread>
+#include <QThreadPool>
 
 #include "eigen3/Eigen/Eigen"
 #include "eigen3/Eigen/SVD"
@@ -120,27 +122,27 @@ private slots:
 private:
 	double m_RGloRawData[5][4];
 //	double m_RGloRawData[5][9];
-	double m_RGloRealData[5][3];		// 0ǻؽڣ1ָؽڣ2ǲ
+	double m_RGloRealData[5][3];		// 0是基关节，1是指尖关节，2是侧摆
 	double m_LGloRawData[5][4];
 	double m_LGloRealData[5][3];
 	double m_RGloCaliK[5][3];
 	double m_RGloCaliB[5][3];
 	double m_RGloCaliData[4][5][4];
-	double m_RHandRecvJoint[5][3];		// 0ǻؽڣ1ָؽڣ2ǲ
-	double m_LHandRecvJoint[5][3];		// 0ǻؽڣ1ָؽڣ2ǲ
+	double m_RHandRecvJoint[5][3];		// 0是基关节，1是指尖关节，2是侧摆
+	double m_LHandRecvJoint[5][3];		// 0是基关节，1是指尖关节，2是侧摆
 	double m_RHandRecvTorque[5][3];
 	double m_LHandRecvTorque[5][3];
 	double m_RHandSendData[5][3];
 	double m_LHandSendData[5][3];
-	double m_HandGraspJoint[5][3];		// ץȡʱָĹؽڽ
-	double m_HandReleaseJoint[5][3];		// ͷʱָĹؽڽ
+	double m_HandGraspJoint[5][3];		// 抓取时手指的关节角数据
+	double m_HandReleaseJoint[5][3];		// 释放时手指的关节角数据
 
-	bool m_bHandConn;		// ӱ־
-	bool m_bHandInit;		// ʼ־
-	bool m_bHandStop;		// ͣ־
-	bool m_bHandEnable;		// ʹܱ־
+	bool m_bHandConn;		// 灵巧手连接标志
+	bool m_bHandInit;		// 初始化标志
+	bool m_bHandStop;		// 急停标志
+	bool m_bHandEnable;		// 灵巧手使能标志
 
-	bool m_bHandGrasp;		// ץȡģʽл־
+	bool m_bHandGrasp;		// 抓取模式下切换标志
 
 	HANDCTRLMODE m_HandCtrlMode;
 	CHandData m_RHandData, m_LHandData;
@@ -150,7 +152,7 @@ private:
 	bool m_LGloConn;		// Left Glove Connection
 	
 public:
-	void SetGraspInit();		// ץȡʱָǶȵĳʼ
+	void SetGraspInit();		// 设置抓取时手指角度的初始化数据
 	void SendHandCmd();		// Multimedia Timer Function
 	void RecvHandSensor();	
 	void DisHandData();
@@ -203,6 +205,9 @@ private:
 	mat4x4 m_last_RTraRealMat;
 	mat7x1 m_last_RTraRealQuat;
 	mat4x4 m_RTraRawMat;
+	mat4x4 m_LTraRealMat;
+	mat4x4 m_LTraRawMat;
+	QThreadPool m_ArmPool;		// 左臂逆运动学的线程，见SolveArms
 	//*********************** Consimu Control ***********************//
 private slots:
 	void ConsimuConnCtrl();		// Connect Consimulate
@@ -213,13 +218,14 @@ private:
 
 	//*********************** Vision Serve ***********************//
 private:
-	// Ϊconst
+	// 申明为const
 	double RefEulerPose[6];
 	double RefFinAppr;
 	double EulerPoseCut[6];
 	double ApprCut;
 
 	CSocketBlockClient m_VisionRecv_Client;
+	VisionLink m_VisionLink;		// 视觉数据由反应器接收
 	mat4x4 m_ViTransNow;
 	mat4x4 m_ViTransNext;
 	mat7x1 m_ViQuatNow;
@@ -237,7 +243,7 @@ private:
 	bool m_bConnCam;
 	bool m_bViKineInit;
 	bool m_bTrackFinish;
-	bool m_bApprFlag;		// m_bApprFlag = true, ʾZ᷽ӽ
+	bool m_bApprFlag;		// 如果m_bApprFlag = true, 表示可以在Z轴方向接近
 
 	CamThread m_CamThread;
 
@@ -257,11 +263,6 @@ private slots:
 	void VisionAppr();
 
 	//*********************** Planning ***********************//
-public:
-	// Return next plan pose
-	void PosePlan(const mat7x1 &StartPose, const mat7x1 &EndPose, const int PlanTotalCount, const int PlanCount, mat7x1 &PoseOut);
-
-
 private:
 	mat7x1 m_RPlanStartQuat;
 	mat7x1 m_RPlanEndQuat;
@@ -269,6 +270,7 @@ private:
 
 	int m_plan_count;
 	int m_plan_count_max;
+	PlanBuffer m_RPlanBuffer;		// 整条规划在关节空间的解，getPlanData后在后台求解
 
 private slots:
 	void PlanCtrl();
@@ -279,10 +281,12 @@ private slots:
 public:
 	void InitKine();
 	mat7x1 CalKine(const mat4x4 &, double &, mat7x1 &);
+	mat7x1 SolveKine(const mat4x4 &T);		// 按KineStrategy选择的逆运动学策略求解
+	void SolveArms();		// 同时求解两臂，写入g_rightArmJointBuf和g_leftArmJointBuf
 
 	void CalJaco(const mat7x1 &mat_jo, mat6x7 &mat_jaco, double &sv_min);
-	void CalDirectKine(const mat7x1 &mat_jo_deg, mat4x4 &mat_trans);
 	bool DiffKine(const mat7x1 &quat_now, const mat7x1 &quat_last, const mat7x1 &last_joint, mat7x1 &joint);
+	bool DiffKine(const mat7x1 &quat_now, const mat4x4 &trans_now, const mat7x1 &last_joint, mat7x1 &joint);
 	double DampLS(double svmin);
 	bool AngleRange(const mat7x1 &jo);
 
@@ -300,18 +304,12 @@ public:
 
 private:
 	mat6x7 m_RJacoMat;
-	mat4x4 m_RQuatoOmega;
-	mat4x1 m_ROmega;
-	mat4x1 m_RdQuat;
-	mat6x1 m_RVel;
 
 	mat4x4 m_RFeedTrans;
 	mat7x1 m_RFeedQuat;
-	mat3x1 m_RRotErr;
-	mat6x1 m_RPoseErr;
-	mat3x3 CrossMat;
-	mat3x1 des_Epsilon;
-	mat3x1 feed_Epsilon;
+
+	int m_DiffKineIter;		// 上一次微分逆运动学的迭代次数
+	double m_DiffKineResidual;		// 上一次微分逆运动学的位姿残差
 
 	bool m_bJacoIsInit;		// if m_bJacoIsInit == 0, there is no reference joint for jacobi kine; if m_bJacoIsInit == 1 ......
 
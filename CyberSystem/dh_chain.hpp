@@ -0,0 +1,109 @@
+#ifndef DH_CHAIN_HPP__
+#define DH_CHAIN_HPP__
+#include <cmath>
+#include "eigen3/Eigen/Eigen"
+#include "angular_interval.hpp"
+namespace rpp
+{
+    namespace kine
+    {
+        // link lengths a row of the DH table may refer to
+        enum DhLength
+        {
+            DH_ZERO = 0,
+            DH_L1,
+            DH_L2,
+            DH_L3,
+            DH_D,
+            DH_MINUS_D,
+            DH_LENGTH_COUNT
+        };
+
+        // the DH description of the 7-dof arm, one row per joint:
+        // twist alpha in multiples of pi/2, link length a and offset d.
+        // All joint offsets theta are zero. Kine7 builds its _DH table and the
+        // unrolled forward kinematics below from these rows.
+        template <int I> struct Kine7DhRow;
+        template <> struct Kine7DhRow<0> { enum { twist = -1, a = DH_ZERO, d = DH_ZERO }; };
+        template <> struct Kine7DhRow<1> { enum { twist = 1, a = DH_ZERO, d = DH_ZERO }; };
+        template <> struct Kine7DhRow<2> { enum { twist = -1, a = DH_D, d = DH_L1 }; };
+        template <> struct Kine7DhRow<3> { enum { twist = 1, a = DH_MINUS_D, d = DH_ZERO }; };
+        template <> struct Kine7DhRow<4> { enum { twist = -1, a = DH_ZERO, d = DH_L2 }; };
+        template <> struct Kine7DhRow<5> { enum { twist = 1, a = DH_ZERO, d = DH_ZERO }; };
+        template <> struct Kine7DhRow<6> { enum { twist = 0, a = DH_ZERO, d = DH_L3 }; };
+
+        // rotation of the frame columns by a twist of TWIST*pi/2 about the new x
+        // axis, sin/cos of the twist are 0 or +-1 and fold away
+        template <typename T, int TWIST>
+        struct DhTwist
+        {
+            typedef Eigen::Matrix<T, 3, 1> vec3;
+            static void apply(const vec3 &w, vec3 &r1, vec3 &r2)
+            {
+                r1 = TWIST*r2;
+                r2 = -TWIST*w;
+            }
+        };
+        template <typename T>
+        struct DhTwist<T, 0>
+        {
+            typedef Eigen::Matrix<T, 3, 1> vec3;
+            static void apply(const vec3 &w, vec3 &r1, vec3 &)
+            {
+                r1 = w;
+            }
+        };
+
+        // T_0n = T_0(n-1)*dh2t(alpha, a, theta, d) on the frame columns r0, r1, r2
+        // and the origin p, unrolled over the rows I..N-1. Terms whose length is
+        // DH_ZERO are not emitted.
+        template <typename T, int I, int N>
+        struct DhChain
+        {
+            typedef Eigen::Matrix<T, 3, 1> vec3;
+            typedef Eigen::Matrix<T, 7, 1> vec7;
+            typedef Kine7DhRow<I> row;
+
+            static void fill(Eigen::Array<T, 7, 4> &dh, const T *length)
+            {
+                const T PI = ::rpp::util::Constants<T>::pi;
+                dh(I, 0) = row::twist*PI/2;
+                dh(I, 1) = length[row::a];
+                dh(I, 2) = 0;
+                dh(I, 3) = length[row::d];
+                DhChain<T, I + 1, N>::fill(dh, length);
+            }
+            // z and o receive the axis and origin of every joint frame, for the jacobian
+            template <bool FRAMES>
+            static void forward(const T *sc, const T *length,
+                    vec3 &r0, vec3 &r1, vec3 &r2, vec3 &p, vec3 *z, vec3 *o)
+            {
+                if (FRAMES)
+                {
+                    z[I] = r2;
+                    o[I] = p;
+                }
+                const T st = sc[I];
+                const T ct = sc[7 + I];
+                const vec3 u = ct*r0 + st*r1;
+                const vec3 w = ct*r1 - st*r0;
+                if (row::a != (int)DH_ZERO) p += length[row::a]*u;
+                if (row::d != (int)DH_ZERO) p += length[row::d]*r2;
+                r0 = u;
+                DhTwist<T, row::twist>::apply(w, r1, r2);
+                DhChain<T, I + 1, N>::template forward<FRAMES>(sc, length, r0, r1, r2, p, z, o);
+            }
+        };
+        template <typename T, int N>
+        struct DhChain<T, N, N>
+        {
+            typedef Eigen::Matrix<T, 3, 1> vec3;
+            typedef Eigen::Matrix<T, 7, 1> vec7;
+            static void fill(Eigen::Array<T, 7, 4> &, const T *) {}
+            template <bool FRAMES>
+            static void forward(const T *, const T *, vec3 &, vec3 &, vec3 &, vec3 &,
+                    vec3 *, vec3 *) {}
+        };
+    }
+}
+#endif // DH_CHAIN_HPP__
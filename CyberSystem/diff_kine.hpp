@@ -0,0 +1,181 @@
+#ifndef DIFF_KINE_HPP__
+#define DIFF_KINE_HPP__
+#include <cmath>
+#include "eigen3/Eigen/Eigen"
+#include "kine_util.hpp"
+#include "kine7.hpp"
+#include "singular_value.hpp"
+namespace rpp
+{
+    namespace kine
+    {
+        // closed-loop differential inverse kinematics on top of Kine7.
+        // Every iteration moves towards the target by a bounded sub-step,
+        // solves the damped least squares problem with one LDLT of J*J^T + lambda*I
+        // (the same factorization projects the joint-centering gradient into the
+        // null space) and stops as soon as the pose error is under tolerance.
+        // Only fixed-size Eigen types are used, nothing is allocated per call.
+        template <typename T>
+        class DiffKineSolver
+        {
+        public:
+            typedef T value_type;
+            typedef Eigen::Matrix<value_type, 4, 4> mat4x4;
+            typedef Eigen::Matrix<value_type, 6, 6> mat6x6;
+            typedef Eigen::Matrix<value_type, 6, 7> mat6x7;
+            typedef Eigen::Matrix<value_type, 7, 1> vec7;
+            typedef Eigen::Matrix<value_type, 6, 1> vec6;
+            typedef Eigen::Matrix<value_type, 3, 1> vec3;
+
+            struct params_type
+            {
+                int max_iterations;
+                value_type pos_tolerance;       // mm
+                value_type ori_tolerance;       // rad
+                value_type max_pos_step;        // mm per iteration
+                value_type max_ori_step;        // rad per iteration
+                value_type sv_threshold;        // damping starts below this singular value
+                value_type lambda_max;
+                value_type null_space_gain;     // joint-centering step per iteration
+            };
+            struct result_type
+            {
+                int iterations;
+                value_type pos_error;
+                value_type ori_error;
+                value_type residual;            // norm of [pos_error, ori_error]
+                value_type lambda;              // damping of the last iteration
+                bool converged;
+                mat4x4 pose;                    // forward kinematics of the returned joints
+            };
+
+            static params_type default_params()
+            {
+                params_type p;
+                p.max_iterations = 200;
+                p.pos_tolerance = value_type(0.05);
+                p.ori_tolerance = value_type(5e-4);
+                p.max_pos_step = 20;
+                p.max_ori_step = value_type(0.1);
+                p.sv_threshold = value_type(0.05);
+                p.lambda_max = 5;
+                p.null_space_gain = value_type(0.01);
+                return p;
+            }
+
+            DiffKineSolver() : _params(default_params())
+            {
+                _lower.setConstant(-::rpp::util::Constants<value_type>::pi);
+                _upper.setConstant(::rpp::util::Constants<value_type>::pi);
+            }
+            DiffKineSolver(const Kine7<value_type> &kine, const vec7 &lower, const vec7 &upper,
+                    const params_type &params = default_params())
+                : _kine(kine), _lower(lower), _upper(upper), _params(params) {}
+
+            params_type &params()
+            {
+                return _params;
+            }
+            const Kine7<value_type> &kine() const
+            {
+                return _kine;
+            }
+            // the joint range the null-space gradient centers in
+            const vec7 &lower() const
+            {
+                return _lower;
+            }
+            const vec7 &upper() const
+            {
+                return _upper;
+            }
+
+            // same damping law as CyberSystem::DampLS
+            value_type damping(const value_type sv_min) const
+            {
+                if (sv_min >= _params.sv_threshold) return 0;
+                const value_type r = sv_min/_params.sv_threshold;
+                const value_type lambda = _params.lambda_max*_params.lambda_max*(1 - r*r);
+                return lambda > _params.lambda_max ? _params.lambda_max : lambda;
+            }
+
+            // target: [x, y, z, eta, e1, e2, e3]; joint_ref: start configuration
+            result_type solve(const vec7 &target, const vec7 &joint_ref, vec7 &joint)
+            {
+                result_type res;
+                res.iterations = 0;
+                res.lambda = 0;
+                res.converged = false;
+                const vec3 p_d = target.template head<3>();
+                const value_type qn = target.template tail<4>().norm();
+                const value_type eta_d = target(3)/qn;
+                const vec3 eps_d = target.template tail<3>()/qn;
+                mat6x7 J;
+                vec6 dx;
+                joint = joint_ref;
+                for (;;)
+                {
+                    _kine.forward_jacobian(joint, res.pose, J);
+                    const vec7 x = ::rpp::kine::t2quater(res.pose);
+                    const vec3 e_p = p_d - x.template head<3>();
+                    // 2*e_o is the small-angle rotation vector towards the target
+                    const vec3 e_o = 2*::rpp::kine::quater_error(eta_d, eps_d,
+                            x(3), vec3(x.template tail<3>()));
+                    res.pos_error = e_p.norm();
+                    res.ori_error = e_o.norm();
+                    res.residual = sqrt(res.pos_error*res.pos_error + res.ori_error*res.ori_error);
+                    if (res.pos_error <= _params.pos_tolerance && res.ori_error <= _params.ori_tolerance)
+                    {
+                        res.converged = true;
+                        break;
+                    }
+                    if (res.iterations >= _params.max_iterations) break;
+
+                    // bounded sub-target along the error
+                    const value_type sp = (res.pos_error > _params.max_pos_step ?
+                            _params.max_pos_step/res.pos_error : 1);
+                    const value_type so = (res.ori_error > _params.max_ori_step ?
+                            _params.max_ori_step/res.ori_error : 1);
+                    dx << sp*e_p, so*e_o;
+
+                    const mat6x6 JJt = J*J.transpose();
+                    res.lambda = damping(_sv_min(J, JJt));
+                    Eigen::LDLT<mat6x6> ldlt(JJt + res.lambda*mat6x6::Identity());
+
+                    // dq = J^T (JJ^T + lambda I)^-1 (dx - J dq0) + dq0, the projection is
+                    // only exact without damping, so joint centering pauses near singularities
+                    if (res.lambda == 0)
+                    {
+                        const vec7 dq0 = _params.null_space_gain*centering_gradient(joint);
+                        joint += J.transpose()*ldlt.solve(dx - J*dq0) + dq0;
+                    }
+                    else
+                    {
+                        joint += J.transpose()*ldlt.solve(dx);
+                    }
+                    ++res.iterations;
+                }
+                return res;
+            }
+        private:
+            // gradient of -sum(((q - q_mid)/(q_max - q_min))^2)/14, pulls joints to mid-range
+            vec7 centering_gradient(const vec7 &q) const
+            {
+                vec7 g;
+                for (int i = 0; i < 7; ++i)
+                {
+                    const value_type range = _upper(i) - _lower(i);
+                    g(i) = -(q(i) - (_lower(i) + _upper(i))/2)/(7*range*range);
+                }
+                return g;
+            }
+
+            Kine7<value_type> _kine;
+            vec7 _lower;
+            vec7 _upper;
+            params_type _params;
+            SvMinEstimator<value_type> _sv_min;
+        };
+    }
+}
+#endif // DIFF_KINE_HPP__
@@ -0,0 +1,112 @@
+#ifndef FIXED_VECTOR_HPP__
+#define FIXED_VECTOR_HPP__
+
+#include <cstddef>
+namespace rpp
+{
+    namespace util
+    {
+        // vector-like container with inline storage, the kinematics code uses
+        // it instead of std::vector so that no heap allocation happens inside
+        // the control loop. The capacity is part of the type: every user sizes it
+        // from the proven maximum of what it stores, push_back() returns false
+        // and leaves the vector unchanged when it is full anyway.
+        template <typename T, std::size_t N>
+        class FixedVector
+        {
+        public:
+            typedef T value_type;
+            typedef T *iterator;
+            typedef const T *const_iterator;
+            FixedVector() : _size(0) {}
+            FixedVector(const FixedVector &other) : _size(other._size)
+            {
+                for (std::size_t i = 0; i < _size; ++i)
+                    _data[i] = other._data[i];
+            }
+            FixedVector &operator =(const FixedVector &other)
+            {
+                _size = other._size;
+                for (std::size_t i = 0; i < _size; ++i)
+                    _data[i] = other._data[i];
+                return *this;
+            }
+            bool push_back(const value_type &val)
+            {
+                if (_size == N) return false;
+                _data[_size++] = val;
+                return true;
+            }
+            // false when some elements did not fit
+            template <typename ITER>
+            bool append(ITER first, ITER last)
+            {
+                for (; first != last; ++first)
+                    if (!push_back(*first)) return false;
+                return true;
+            }
+            void pop_back()
+            {
+                if (_size > 0) --_size;
+            }
+            void clear()
+            {
+                _size = 0;
+            }
+            bool empty() const
+            {
+                return _size == 0;
+            }
+            bool full() const
+            {
+                return _size == N;
+            }
+            std::size_t size() const
+            {
+                return _size;
+            }
+            static std::size_t capacity()
+            {
+                return N;
+            }
+            value_type &operator [](const std::size_t i)
+            {
+                return _data[i];
+            }
+            const value_type &operator [](const std::size_t i) const
+            {
+                return _data[i];
+            }
+            value_type &back()
+            {
+                return _data[_size - 1];
+            }
+            const value_type &back() const
+            {
+                return _data[_size - 1];
+            }
+        public:
+            // iterator
+            iterator begin()
+            {
+                return _data;
+            }
+            iterator end()
+            {
+                return _data + _size;
+            }
+            const_iterator begin() const
+            {
+                return _data;
+            }
+            const_iterator end() const
+            {
+                return _data + _size;
+            }
+        private:
+            value_type _data[N];
+            std::size_t _size;
+        };
+    }
+}
+#endif // FIXED_VECTOR_HPP__
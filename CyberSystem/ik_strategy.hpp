@@ -0,0 +1,267 @@
+#ifndef IK_STRATEGY_HPP__
+#define IK_STRATEGY_HPP__
+#include <cassert>
+#include "eigen3/Eigen/Eigen"
+#include "kine7.hpp"
+#include "kine_solver.hpp"
+#include "diff_kine.hpp"
+#include "singular_value.hpp"
+#include "stopwatch.hpp"
+namespace rpp
+{
+    namespace kine
+    {
+        // how a target pose becomes joints. All strategies share the calling
+        // convention of KineSolver::solve: last_arm_angle and last_joints are the
+        // previous solution and are updated on success only. solve() counts the
+        // calls, successes and time of every strategy.
+        template <typename T>
+        class IkStrategy
+        {
+        public:
+            typedef T value_type;
+            typedef Eigen::Matrix<value_type, 4, 4> mat4x4;
+            typedef Eigen::Matrix<value_type, 7, 1> vec7;
+
+            struct stats_type
+            {
+                long long calls;
+                long long succeeded;
+                long long failed;
+                long long elapsed_ns;
+                long long max_ns;
+            };
+
+            IkStrategy()
+            {
+                reset_stats();
+            }
+            virtual ~IkStrategy() {}
+
+            virtual const char *name() const = 0;
+
+            KineStatus solve(const mat4x4 &T_07, value_type &last_arm_angle,
+                    vec7 &last_joints, vec7 &joints)
+            {
+                ::rpp::util::Stopwatch sw;
+                const KineStatus status = do_solve(T_07, last_arm_angle, last_joints, joints);
+                const long long ns = sw.elapsed_ns();
+                _stats.calls++;
+                if (status >= 0) _stats.succeeded++;
+                else _stats.failed++;
+                _stats.elapsed_ns += ns;
+                if (ns > _stats.max_ns) _stats.max_ns = ns;
+                return status;
+            }
+            const stats_type &stats() const
+            {
+                return _stats;
+            }
+            void reset_stats()
+            {
+                _stats.calls = _stats.succeeded = _stats.failed = _stats.elapsed_ns = _stats.max_ns = 0;
+            }
+        protected:
+            virtual KineStatus do_solve(const mat4x4 &T_07, value_type &last_arm_angle,
+                    vec7 &last_joints, vec7 &joints) = 0;
+        private:
+            stats_type _stats;
+        };
+
+        // closed form: KineSolver on every call
+        template <typename T>
+        class AnalyticIk : public IkStrategy<T>
+        {
+        public:
+            typedef IkStrategy<T> base_type;
+            typedef typename base_type::value_type value_type;
+            typedef typename base_type::mat4x4 mat4x4;
+            typedef typename base_type::vec7 vec7;
+
+            explicit AnalyticIk(KineSolver<value_type> &solver) : _solver(&solver) {}
+
+            const char *name() const
+            {
+                return "analytic";
+            }
+            KineSolver<value_type> &solver()
+            {
+                return *_solver;
+            }
+        protected:
+            KineStatus do_solve(const mat4x4 &T_07, value_type &last_arm_angle,
+                    vec7 &last_joints, vec7 &joints)
+            {
+                return _solver->solve(T_07, last_arm_angle, last_joints, joints);
+            }
+        private:
+            KineSolver<value_type> *_solver;
+        };
+
+        // DiffKineSolver iterating from the previous joints, accepted when it
+        // converges inside the solver's joint range. The arm angle is left as it
+        // was, the differential solution does not pick one.
+        template <typename T>
+        class DifferentialIk : public IkStrategy<T>
+        {
+        public:
+            typedef IkStrategy<T> base_type;
+            typedef typename base_type::value_type value_type;
+            typedef typename base_type::mat4x4 mat4x4;
+            typedef typename base_type::vec7 vec7;
+            typedef typename DiffKineSolver<value_type>::result_type result_type;
+
+            explicit DifferentialIk(DiffKineSolver<value_type> &solver) : _solver(&solver)
+            {
+                _result.iterations = 0;
+                _result.converged = false;
+            }
+
+            const char *name() const
+            {
+                return "differential";
+            }
+            DiffKineSolver<value_type> &solver()
+            {
+                return *_solver;
+            }
+            // iterations, residual and damping of the last call
+            const result_type &result() const
+            {
+                return _result;
+            }
+        protected:
+            KineStatus do_solve(const mat4x4 &T_07, value_type &,
+                    vec7 &last_joints, vec7 &joints)
+            {
+                vec7 q;
+                _result = _solver->solve(::rpp::kine::t2quater(T_07), last_joints, q);
+                if (!_result.converged) return KINE_NOT_CONVERGED;
+                for (int i = 0; i < 7; ++i)
+                    if (q[i] < _solver->lower()[i] || q[i] > _solver->upper()[i]) return KINE_NO_SOLUTION;
+                last_joints = q;
+                joints = q;
+                return KINE_DIFFERENTIAL;
+            }
+        private:
+            DiffKineSolver<value_type> *_solver;
+            result_type _result;
+        };
+
+        // the analytic solution where it exists and is well conditioned, the damped
+        // differential step from the previous joints when the analytic solve fails
+        // or its joints are within singular_threshold of a singularity (smallest
+        // singular value of the jacobian, same scale as DiffKineSolver's
+        // sv_threshold). A differential step that fails too keeps a well-defined
+        // analytic result. The two strategies keep counting on their own.
+        template <typename T>
+        class HybridIk : public IkStrategy<T>
+        {
+        public:
+            typedef IkStrategy<T> base_type;
+            typedef typename base_type::value_type value_type;
+            typedef typename base_type::mat4x4 mat4x4;
+            typedef typename base_type::vec7 vec7;
+            typedef Eigen::Matrix<value_type, 6, 6> mat6x6;
+            typedef Eigen::Matrix<value_type, 6, 7> mat6x7;
+
+            HybridIk(AnalyticIk<value_type> &analytic, DifferentialIk<value_type> &differential)
+                : _analytic(&analytic), _differential(&differential),
+                _singular_threshold(differential.solver().params().sv_threshold)
+            {
+                reset_switches();
+            }
+
+            const char *name() const
+            {
+                return "hybrid";
+            }
+            value_type &singular_threshold()
+            {
+                return _singular_threshold;
+            }
+            // how often the differential step was taken, and why
+            long long near_singular() const
+            {
+                return _near_singular;
+            }
+            long long analytic_failed() const
+            {
+                return _analytic_failed;
+            }
+            void reset_switches()
+            {
+                _near_singular = _analytic_failed = 0;
+            }
+        protected:
+            KineStatus do_solve(const mat4x4 &T_07, value_type &last_arm_angle,
+                    vec7 &last_joints, vec7 &joints)
+            {
+                value_type arm_angle = last_arm_angle;
+                vec7 q_prev = last_joints;
+                vec7 q;
+                const KineStatus status = _analytic->solve(T_07, arm_angle, q_prev, q);
+                if (status >= 0)
+                {
+                    mat4x4 T_q;
+                    mat6x7 J;
+                    _analytic->solver().kine().forward_jacobian(q, T_q, J);
+                    const mat6x6 JJt = J*J.transpose();
+                    if (_sv_min(J, JJt) >= _singular_threshold)
+                    {
+                        last_arm_angle = arm_angle;
+                        last_joints = q;
+                        joints = q;
+                        return status;
+                    }
+                    _near_singular++;
+                }
+                else
+                {
+                    _analytic_failed++;
+                }
+                const KineStatus diff_status = _differential->solve(T_07, last_arm_angle, last_joints, joints);
+                if (diff_status >= 0) return diff_status;
+                if (status < 0) return status;
+                last_arm_angle = arm_angle;
+                last_joints = q;
+                joints = q;
+                return status;
+            }
+        private:
+            AnalyticIk<value_type> *_analytic;
+            DifferentialIk<value_type> *_differential;
+            value_type _singular_threshold;
+            SvMinEstimator<value_type> _sv_min;
+            long long _near_singular;
+            long long _analytic_failed;
+        };
+
+        // reflection of a pose through the base plane normal to axis (0, 1, 2 for
+        // x, y, z): M*T*M with M = diag(1, 1, 1, 1) and -1 at axis. The rotation
+        // stays proper and reflecting twice gives T back.
+        template <typename T>
+        Eigen::Matrix<T, 4, 4> mirror_pose(const Eigen::Matrix<T, 4, 4> &T_07, const int axis)
+        {
+            Eigen::Matrix<T, 4, 4> res = T_07;
+            res.row(axis) = -res.row(axis);
+            res.col(axis) = -res.col(axis);
+            return res;
+        }
+
+        // joints of the same DH chain that reach the mirror image of forward(q):
+        // forward(mirror_joints(q, 1)) == mirror_pose(forward(q), 1) for the DH
+        // table of Kine7: joints 1, 3 and 5 keep their sign, joints 0, 2, 4 and 6
+        // are negated (CyberBench checks it). Only axis 1 is supported, through
+        // another plane the base and tool frames would have to turn as well.
+        template <typename T>
+        Eigen::Matrix<T, 7, 1> mirror_joints(const Eigen::Matrix<T, 7, 1> &q, const int axis)
+        {
+            assert(axis == 1);
+            Eigen::Matrix<T, 7, 1> res = q;
+            for (int i = 0; i < 7; i += 2) res(i) = -res(i);
+            return res;
+        }
+    }
+}
+#endif // IK_STRATEGY_HPP__
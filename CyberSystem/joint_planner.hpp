@@ -0,0 +1,301 @@
+#ifndef JOINT_PLANNER_HPP__
+#define JOINT_PLANNER_HPP__
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <algorithm>
+#include "eigen3/Eigen/Eigen"
+#include "eigen3/Eigen/StdVector"
+#include "ik_strategy.hpp"
+namespace rpp
+{
+    namespace kine
+    {
+        enum PlanStatus
+        {
+            PLAN_OK = 0,
+            PLAN_NO_WAYPOINT = -1,      // fewer than two waypoints or a non-positive period
+            PLAN_NO_IK = -2,            // a Cartesian waypoint has no IK solution
+            PLAN_OUT_OF_RANGE = -3      // a waypoint lies outside the joint range
+        };
+
+        // joint trajectory through a list of waypoints (linear segments with
+        // parabolic blends). Consecutive waypoints are joined by straight
+        // joint-space segments travelled at constant velocity, and the velocity
+        // changes around every waypoint in a parabolic blend of constant
+        // acceleration, so the arm does not stop at the intermediate waypoints but
+        // rounds them off; it starts and ends at rest exactly on the first and the
+        // last one. A segment runs as fast as the slowest joint allows, a blend
+        // lasts as long as the joint with the largest velocity change needs, and a
+        // segment too short for the blends at its two ends is slowed down until
+        // they fit. Each blend stays inside the triangle of its two segments, so
+        // waypoints inside the joint range (a box) keep the whole trajectory inside it.
+        // The result is sampled at a fixed period, ready to be streamed tick by tick.
+        template <typename T>
+        class JointPlanner
+        {
+        public:
+            typedef T value_type;
+            typedef Eigen::Matrix<value_type, 4, 4> mat4x4;
+            typedef Eigen::Matrix<value_type, 7, 1> vec7;
+            typedef std::vector<vec7, Eigen::aligned_allocator<vec7> > joint_vector;
+            typedef std::vector<mat4x4, Eigen::aligned_allocator<mat4x4> > pose_vector;
+
+            struct limits_type
+            {
+                vec7 lower;                 // rad
+                vec7 upper;
+                vec7 max_velocity;          // rad/s
+                vec7 max_acceleration;      // rad/s^2
+            };
+            struct segment_type
+            {
+                value_type duration;        // s, between the two waypoints along the straight line
+                value_type blend;           // s, parabolic blend centred on the waypoint at the start
+            };
+
+            JointPlanner() : _end_blend(0), _duration(0), _failed_index(-1) {}
+            explicit JointPlanner(const limits_type &limits) : _limits(limits), _end_blend(0), _duration(0), _failed_index(-1) {}
+
+            limits_type &limits()
+            {
+                return _limits;
+            }
+            const limits_type &limits() const
+            {
+                return _limits;
+            }
+
+            // joint waypoints, the first one is the current configuration. The total
+            // time is stretched to at least min_duration by slowing the whole
+            // trajectory down uniformly, which keeps the limits satisfied.
+            PlanStatus plan(const vec7 *waypoints, const int count, const value_type period,
+                    const value_type min_duration = 0)
+            {
+                _samples.clear();
+                _segments.clear();
+                _velocities.clear();
+                _end_blend = 0;
+                _failed_index = -1;
+                if (count < 2 || period <= 0) return PLAN_NO_WAYPOINT;
+                for (int i = 0; i < count; ++i)
+                {
+                    if ((waypoints[i].array() < _limits.lower.array()).any() ||
+                            (waypoints[i].array() > _limits.upper.array()).any())
+                    {
+                        _failed_index = i;
+                        return PLAN_OUT_OF_RANGE;
+                    }
+                }
+                _waypoints.assign(waypoints, waypoints + count);
+                time_blends();
+
+                value_type total = _segments[0].blend/2 + _end_blend/2;
+                for (std::size_t i = 0; i < _segments.size(); ++i)
+                {
+                    total += _segments[i].duration;
+                }
+                if (total < min_duration && total > 0)
+                {
+                    const value_type k = min_duration/total;
+                    for (std::size_t i = 0; i < _segments.size(); ++i)
+                    {
+                        _segments[i].duration *= k;
+                        _segments[i].blend *= k;
+                        _velocities[i] /= k;
+                    }
+                    _end_blend *= k;
+                    total = min_duration;
+                }
+                _duration = total;
+
+                // sample i is the configuration at (i + 1)*period, the last one is the
+                // final waypoint. Waypoint k is passed (by the straight lines) at
+                // pass, its blend covers pass -/+ blend/2.
+                const int n = static_cast<int>(ceil(total/period - value_type(1e-9)));
+                _samples.reserve(n > 0 ? n : 1);
+                const std::size_t last = _segments.size();
+                std::size_t k = 0;
+                value_type pass = _segments[0].blend/2;
+                for (int i = 1; i < n; ++i)
+                {
+                    const value_type t = i*period;
+                    while (k < last && t >= pass + _segments[k].duration - blend_time(k + 1)/2)
+                    {
+                        pass += _segments[k].duration;
+                        ++k;
+                    }
+                    const value_type dt = t - pass;
+                    const vec7 &v = (k < last) ? _velocities[k] : vec7::Zero().eval();
+                    const value_type tb = blend_time(k);
+                    if (dt < tb/2)
+                    {
+                        // inside the blend: the velocity goes linearly from the
+                        // incoming to the outgoing one
+                        const vec7 v0 = (k > 0) ? _velocities[k - 1] : vec7::Zero().eval();
+                        const value_type u = dt + tb/2;
+                        _samples.push_back(_waypoints[k] + v0*dt + (v - v0)*(u*u/(2*tb)));
+                    }
+                    else
+                    {
+                        _samples.push_back(_waypoints[k] + v*dt);
+                    }
+                }
+                _samples.push_back(_waypoints.back());
+                return PLAN_OK;
+            }
+
+            // Cartesian waypoints: every pose is solved by ik starting from the joints
+            // of the previous one (start for the first), then planned as above
+            PlanStatus plan(IkStrategy<value_type> &ik, const mat4x4 *poses, const int count,
+                    const vec7 &start, value_type arm_angle, const value_type period,
+                    const value_type min_duration = 0)
+            {
+                _samples.clear();
+                _segments.clear();
+                _failed_index = -1;
+                if (count < 1) return PLAN_NO_WAYPOINT;
+                joint_vector joints(count + 1);
+                joints[0] = start;
+                vec7 last = start;
+                for (int i = 0; i < count; ++i)
+                {
+                    if (ik.solve(poses[i], arm_angle, last, joints[i + 1]) < 0)
+                    {
+                        _failed_index = i + 1;
+                        return PLAN_NO_IK;
+                    }
+                }
+                return plan(&joints[0], count + 1, period, min_duration);
+            }
+
+            const joint_vector &samples() const
+            {
+                return _samples;
+            }
+            const joint_vector &waypoints() const
+            {
+                return _waypoints;
+            }
+            const std::vector<segment_type> &segments() const
+            {
+                return _segments;
+            }
+            // joint velocity on the straight part of every segment, rad/s
+            const joint_vector &velocities() const
+            {
+                return _velocities;
+            }
+            // blend into the final waypoint, s
+            value_type end_blend() const
+            {
+                return _end_blend;
+            }
+            value_type duration() const
+            {
+                return _duration;
+            }
+            // waypoint that failed, 0 is the start configuration
+            int failed_index() const
+            {
+                return _failed_index;
+            }
+
+            // shortest time to cover dq at constant velocity
+            value_type cruise_time(const vec7 &dq) const
+            {
+                value_type t = 0;
+                for (int j = 0; j < 7; ++j)
+                {
+                    t = std::max(t, value_type(fabs(dq(j))/_limits.max_velocity(j)));
+                }
+                return t;
+            }
+            // shortest time to change the joint velocity from v0 to v1
+            value_type blend_time(const vec7 &v0, const vec7 &v1) const
+            {
+                value_type t = 0;
+                for (int j = 0; j < 7; ++j)
+                {
+                    t = std::max(t, value_type(fabs(v1(j) - v0(j))/_limits.max_acceleration(j)));
+                }
+                return t;
+            }
+        private:
+            bool moving(const std::size_t segment) const
+            {
+                return _waypoints[segment + 1] != _waypoints[segment];
+            }
+            value_type blend_time(const std::size_t waypoint) const
+            {
+                return (waypoint < _segments.size()) ? _segments[waypoint].blend : _end_blend;
+            }
+
+            // segment durations and blend times for _waypoints. Every segment starts
+            // at its cruise time; a segment whose two half blends do not fit is
+            // lengthened to fit them (which lowers its velocity and so changes the
+            // blends around it), a few passes of that settle nearly every path. If
+            // some segment is still too short, all moving segments are lengthened by
+            // the square root of the worst ratio: blend times fall with the
+            // velocities, so the blends then fit everywhere.
+            void time_blends()
+            {
+                const std::size_t count = _waypoints.size() - 1;
+                _segments.resize(count);
+                _velocities.resize(count);
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    _segments[i].duration = cruise_time(_waypoints[i + 1] - _waypoints[i]);
+                }
+                for (int pass = 0; pass < 16; ++pass)
+                {
+                    for (std::size_t i = 0; i < count; ++i)
+                    {
+                        if (moving(i)) _velocities[i] = (_waypoints[i + 1] - _waypoints[i])/_segments[i].duration;
+                        else _velocities[i].setZero();
+                    }
+                    for (std::size_t i = 0; i < count; ++i)
+                    {
+                        _segments[i].blend = blend_time((i > 0) ? _velocities[i - 1] : vec7::Zero().eval(), _velocities[i]);
+                    }
+                    _end_blend = blend_time(_velocities[count - 1], vec7::Zero().eval());
+
+                    value_type worst = 1;
+                    for (std::size_t i = 0; i < count; ++i)
+                    {
+                        const value_type need = (_segments[i].blend + blend_time(i + 1))/2;
+                        if (!moving(i))
+                        {
+                            // a repeated waypoint: the arm rests there for the two blends
+                            _segments[i].duration = need;
+                        }
+                        else if (need > _segments[i].duration*(1 + value_type(1e-9)))
+                        {
+                            worst = std::max(worst, need/_segments[i].duration);
+                            if (pass < 8) _segments[i].duration = need;
+                        }
+                    }
+                    if (worst == 1) break;
+                    if (pass >= 8)
+                    {
+                        const value_type k = sqrt(worst)*(1 + value_type(1e-9));
+                        for (std::size_t i = 0; i < count; ++i)
+                        {
+                            if (moving(i)) _segments[i].duration *= k;
+                        }
+                    }
+                }
+            }
+
+            limits_type _limits;
+            joint_vector _waypoints;
+            joint_vector _samples;
+            joint_vector _velocities;
+            std::vector<segment_type> _segments;
+            value_type _end_blend;
+            value_type _duration;
+            int _failed_index;
+        };
+    }
+}
+#endif // JOINT_PLANNER_HPP__
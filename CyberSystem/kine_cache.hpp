@@ -0,0 +1,189 @@
+#ifndef KINE_CACHE_HPP__
+#define KINE_CACHE_HPP__
+#include <cmath>
+#include "eigen3/Eigen/Eigen"
+#include "kine7.hpp"
+namespace rpp
+{
+    namespace kine
+    {
+        // small LRU cache for KineSolver keyed on the target pose rounded to a grid:
+        // position_step (mm) for the translation, rotation_step for the entries of
+        // the rotation matrix. An entry keeps the self-motions of the target it was
+        // computed from and the last solve() on that target. An identical request
+        // is answered without searching the arm angle again; another target in the
+        // same cell is warm-started from the stored joints (KineSolver refines them
+        // onto the new target) and only recomputes the self-motions when that does
+        // not converge. The entries are stored inline and the cache never
+        // allocates. A step of 0 disables it.
+        template <typename T, int N = 8>
+        class KineCache
+        {
+        public:
+            typedef T value_type;
+            typedef Kine7<value_type> kine_type;
+            typedef typename kine_type::mat4x4 mat4x4;
+            typedef typename kine_type::vec7 vec7;
+            typedef typename kine_type::self_motion_vector self_motion_vector;
+            enum { CAPACITY = N };
+
+            struct key_type
+            {
+                int v[12];
+                bool operator ==(const key_type &other) const
+                {
+                    for (int i = 0; i < 12; ++i)
+                        if (v[i] != other.v[i]) return false;
+                    return true;
+                }
+            };
+            struct entry_type
+            {
+                key_type key;
+                unsigned long stamp;                // last use, for the LRU eviction
+                mat4x4 target;                      // the exact pose of self_motions
+                self_motion_vector self_motions;
+                // the last successful solve() on target, replayed when the
+                // previous state matches exactly
+                bool solved;
+                vec7 last_joints;
+                value_type last_arm_angle;
+                vec7 joints;
+                value_type arm_angle;
+                int status;
+            };
+
+            KineCache(const value_type position_step = value_type(0.5),
+                    const value_type rotation_step = value_type(1e-3))
+                : _position_step(position_step), _rotation_step(rotation_step),
+                _size(0), _clock(0), _hits(0), _warm_hits(0), _misses(0) {}
+
+            // changing the grid drops all entries
+            void set_quantization(const value_type position_step, const value_type rotation_step)
+            {
+                _position_step = position_step;
+                _rotation_step = rotation_step;
+                clear();
+            }
+            value_type position_step() const
+            {
+                return _position_step;
+            }
+            value_type rotation_step() const
+            {
+                return _rotation_step;
+            }
+            bool enabled() const
+            {
+                return _position_step > 0 && _rotation_step > 0;
+            }
+
+            key_type key(const mat4x4 &T_07) const
+            {
+                key_type k;
+                for (int j = 0; j < 4; ++j)
+                    for (int i = 0; i < 3; ++i)
+                        k.v[3*j + i] = (int)std::floor(T_07(i, j)/(j < 3 ? _rotation_step : _position_step)
+                                + value_type(0.5));
+                return k;
+            }
+            // the entry of key, nullptr if there is none
+            entry_type *find(const key_type &k)
+            {
+                for (int i = 0; i < _size; ++i)
+                {
+                    if (_entries[i].key == k)
+                    {
+                        _entries[i].stamp = ++_clock;
+                        return &_entries[i];
+                    }
+                }
+                return nullptr;
+            }
+            // true when e holds a solve() of exactly this request, whose result is
+            // then returned
+            bool replay(const entry_type *e, const mat4x4 &T_07,
+                    const value_type last_arm_angle, const vec7 &last_joints) const
+            {
+                return e && e->solved && e->target == T_07
+                    && e->last_arm_angle == last_arm_angle && e->last_joints == last_joints;
+            }
+            // counted by KineSolver: a hit is a replay or a warm start that
+            // converged, a miss recomputes the self-motions
+            void record_hit(const bool warm)
+            {
+                _hits++;
+                if (warm) _warm_hits++;
+            }
+            void record_miss()
+            {
+                _misses++;
+            }
+            // stores the self-motions of the target T_07 under key, in the entry of
+            // key if there is one, otherwise replacing the least recently used entry
+            // when the cache is full
+            entry_type *insert(const key_type &k, const mat4x4 &T_07,
+                    const self_motion_vector &self_motions)
+            {
+                int slot = 0;
+                while (slot < _size && !(_entries[slot].key == k)) slot++;
+                if (slot == _size)
+                {
+                    if (_size < N)
+                    {
+                        _size++;
+                    }
+                    else
+                    {
+                        slot = 0;
+                        for (int i = 1; i < N; ++i)
+                            if (_entries[i].stamp < _entries[slot].stamp) slot = i;
+                    }
+                }
+                entry_type &e = _entries[slot];
+                e.key = k;
+                e.stamp = ++_clock;
+                e.target = T_07;
+                e.self_motions = self_motions;
+                e.solved = false;
+                return &e;
+            }
+            void clear()
+            {
+                _size = 0;
+            }
+            int size() const
+            {
+                return _size;
+            }
+
+            long long hits() const
+            {
+                return _hits;
+            }
+            // the hits answered by a warm start rather than a replay
+            long long warm_hits() const
+            {
+                return _warm_hits;
+            }
+            long long misses() const
+            {
+                return _misses;
+            }
+            void reset_stats()
+            {
+                _hits = _warm_hits = _misses = 0;
+            }
+        private:
+            value_type _position_step;
+            value_type _rotation_step;
+            entry_type _entries[N];
+            int _size;
+            unsigned long _clock;
+            long long _hits;
+            long long _warm_hits;
+            long long _misses;
+        };
+    }
+}
+#endif // KINE_CACHE_HPP__
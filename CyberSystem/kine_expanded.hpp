@@ -0,0 +1,98 @@
+#ifndef KINE_EXPANDED_HPP__
+#define KINE_EXPANDED_HPP__
+#include <cmath>
+#include "eigen3/Eigen/Eigen"
+namespace rpp
+{
+    namespace kine
+    {
+        // symbolically expanded geometric jacobian and forward kinematics of the
+        // arm with L1 = 400, L2 = 285, L3 = 300 and D = 0 (the InitKine robot).
+        // They do not depend on Kine7 and serve as references for
+        // Kine7::forward_jacobian and Kine7::forward.
+        template <typename T>
+        void jacobian_expanded(const Eigen::Matrix<T, 7, 1> &mat_jo, Eigen::Matrix<T, 6, 7> &mat_jaco)
+        {
+            using std::sin;
+            using std::cos;
+            const T q1 = mat_jo(0);
+            const T q2 = mat_jo(1);
+            const T q3 = mat_jo(2);
+            const T q4 = mat_jo(3);
+            const T q5 = mat_jo(4);
+            const T q6 = mat_jo(5);
+
+            mat_jaco.setZero();
+            mat_jaco(0,0) = T(sin(q1)*sin(q2)*-4.0E2-cos(q6)*(sin(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))+cos(q4)*sin(q1)*sin(q2))*3.0E2-sin(q6)*(cos(q5)*(cos(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))-sin(q1)*sin(q2)*sin(q4))+sin(q5)*(cos(q1)*cos(q3)-cos(q2)*sin(q1)*sin(q3)))*3.0E2-sin(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))*2.85E2-cos(q4)*sin(q1)*sin(q2)*2.85E2);
+            mat_jaco(0,1) = T(cos(q1)*(cos(q2)*8.0E1+cos(q2)*cos(q4)*5.7E1+cos(q2)*cos(q4)*cos(q6)*6.0E1-cos(q3)*sin(q2)*sin(q4)*5.7E1-cos(q3)*cos(q6)*sin(q2)*sin(q4)*6.0E1-cos(q2)*cos(q5)*sin(q4)*sin(q6)*6.0E1+sin(q2)*sin(q3)*sin(q5)*sin(q6)*6.0E1-cos(q3)*cos(q4)*cos(q5)*sin(q2)*sin(q6)*6.0E1)*5.0);
+            mat_jaco(0,2) = T(sin(q4)*(cos(q3)*sin(q1)+cos(q1)*cos(q2)*sin(q3))*-2.85E2+sin(q6)*(sin(q5)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))-cos(q4)*cos(q5)*(cos(q3)*sin(q1)+cos(q1)*cos(q2)*sin(q3)))*3.0E2-cos(q6)*sin(q4)*(cos(q3)*sin(q1)+cos(q1)*cos(q2)*sin(q3))*3.0E2);
+            mat_jaco(0,3) = T(cos(q6)*(cos(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))+cos(q1)*sin(q2)*sin(q4))*-3.0E2-cos(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))*2.85E2+cos(q5)*sin(q6)*(sin(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))-cos(q1)*cos(q4)*sin(q2))*3.0E2-cos(q1)*sin(q2)*sin(q4)*2.85E2);
+            mat_jaco(0,4) = T(sin(q6)*(sin(q5)*(cos(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))+cos(q1)*sin(q2)*sin(q4))-cos(q5)*(cos(q3)*sin(q1)+cos(q1)*cos(q2)*sin(q3)))*3.0E2);
+            mat_jaco(0,5) = T(sin(q6)*(sin(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))-cos(q1)*cos(q4)*sin(q2))*3.0E2-cos(q6)*(cos(q5)*(cos(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))+cos(q1)*sin(q2)*sin(q4))+sin(q5)*(cos(q3)*sin(q1)+cos(q1)*cos(q2)*sin(q3)))*3.0E2);
+
+            mat_jaco(1,0) = T(cos(q1)*sin(q2)*4.0E2-cos(q6)*(sin(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))-cos(q1)*cos(q4)*sin(q2))*3.0E2-sin(q6)*(cos(q5)*(cos(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))+cos(q1)*sin(q2)*sin(q4))+sin(q5)*(cos(q3)*sin(q1)+cos(q1)*cos(q2)*sin(q3)))*3.0E2-sin(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))*2.85E2+cos(q1)*cos(q4)*sin(q2)*2.85E2);
+            mat_jaco(1,1) = T(sin(q1)*(cos(q2)*8.0E1+cos(q2)*cos(q4)*5.7E1+cos(q2)*cos(q4)*cos(q6)*6.0E1-cos(q3)*sin(q2)*sin(q4)*5.7E1-cos(q3)*cos(q6)*sin(q2)*sin(q4)*6.0E1-cos(q2)*cos(q5)*sin(q4)*sin(q6)*6.0E1+sin(q2)*sin(q3)*sin(q5)*sin(q6)*6.0E1-cos(q3)*cos(q4)*cos(q5)*sin(q2)*sin(q6)*6.0E1)*5.0);
+            mat_jaco(1,2) = T(sin(q4)*(cos(q1)*cos(q3)-cos(q2)*sin(q1)*sin(q3))*2.85E2-sin(q6)*(sin(q5)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))-cos(q4)*cos(q5)*(cos(q1)*cos(q3)-cos(q2)*sin(q1)*sin(q3)))*3.0E2+cos(q6)*sin(q4)*(cos(q1)*cos(q3)-cos(q2)*sin(q1)*sin(q3))*3.0E2);
+            mat_jaco(1,3) = T(cos(q6)*(cos(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))-sin(q1)*sin(q2)*sin(q4))*3.0E2+cos(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))*2.85E2-sin(q1)*sin(q2)*sin(q4)*2.85E2-cos(q5)*sin(q6)*(sin(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))+cos(q4)*sin(q1)*sin(q2))*3.0E2);
+            mat_jaco(1,4) = T(sin(q6)*(sin(q5)*(cos(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))-sin(q1)*sin(q2)*sin(q4))-cos(q5)*(cos(q1)*cos(q3)-cos(q2)*sin(q1)*sin(q3)))*-3.0E2);
+            mat_jaco(1,5) = T(sin(q6)*(sin(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))+cos(q4)*sin(q1)*sin(q2))*-3.0E2+cos(q6)*(cos(q5)*(cos(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))-sin(q1)*sin(q2)*sin(q4))+sin(q5)*(cos(q1)*cos(q3)-cos(q2)*sin(q1)*sin(q3)))*3.0E2);
+
+            mat_jaco(2,1) = T(sin(q2)*-4.0E2-cos(q4)*sin(q2)*2.85E2+sin(q6)*(cos(q5)*(sin(q2)*sin(q4)-cos(q2)*cos(q3)*cos(q4))+cos(q2)*sin(q3)*sin(q5))*3.0E2-cos(q6)*(cos(q4)*sin(q2)+cos(q2)*cos(q3)*sin(q4))*3.0E2-cos(q2)*cos(q3)*sin(q4)*2.85E2);
+            mat_jaco(2,2) = T(sin(q2)*(sin(q3)*sin(q4)*1.9E1+cos(q6)*sin(q3)*sin(q4)*2.0E1+cos(q3)*sin(q5)*sin(q6)*2.0E1+cos(q4)*cos(q5)*sin(q3)*sin(q6)*2.0E1)*1.5E1);
+            mat_jaco(2,3) = T(cos(q2)*sin(q4)*-2.85E2-cos(q6)*(cos(q2)*sin(q4)+cos(q3)*cos(q4)*sin(q2))*3.0E2-cos(q5)*sin(q6)*(cos(q2)*cos(q4)-cos(q3)*sin(q2)*sin(q4))*3.0E2-cos(q3)*cos(q4)*sin(q2)*2.85E2);
+            mat_jaco(2,4) = T(sin(q6)*(sin(q5)*(cos(q2)*sin(q4)+cos(q3)*cos(q4)*sin(q2))+cos(q5)*sin(q2)*sin(q3))*3.0E2);
+            mat_jaco(2,5) = T(cos(q6)*(cos(q5)*(cos(q2)*sin(q4)+cos(q3)*cos(q4)*sin(q2))-sin(q2)*sin(q3)*sin(q5))*-3.0E2-sin(q6)*(cos(q2)*cos(q4)-cos(q3)*sin(q2)*sin(q4))*3.0E2);
+
+            mat_jaco(3,1) = T(-sin(q1));
+            mat_jaco(3,2) = T(cos(q1)*sin(q2));
+            mat_jaco(3,3) = T(-cos(q3)*sin(q1)-cos(q1)*cos(q2)*sin(q3));
+            mat_jaco(3,4) = T(-sin(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))+cos(q1)*cos(q4)*sin(q2));
+            mat_jaco(3,5) = T(sin(q5)*(cos(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))+cos(q1)*sin(q2)*sin(q4))-cos(q5)*(cos(q3)*sin(q1)+cos(q1)*cos(q2)*sin(q3)));
+            mat_jaco(3,6) = T(-cos(q6)*(sin(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))-cos(q1)*cos(q4)*sin(q2))-sin(q6)*(cos(q5)*(cos(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))+cos(q1)*sin(q2)*sin(q4))+sin(q5)*(cos(q3)*sin(q1)+cos(q1)*cos(q2)*sin(q3))));
+
+            mat_jaco(4,1) = T(cos(q1));
+            mat_jaco(4,2) = T(sin(q1)*sin(q2));
+            mat_jaco(4,3) = T(cos(q1)*cos(q3)-cos(q2)*sin(q1)*sin(q3));
+            mat_jaco(4,4) = T(sin(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))+cos(q4)*sin(q1)*sin(q2));
+            mat_jaco(4,5) = T(-sin(q5)*(cos(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))-sin(q1)*sin(q2)*sin(q4))+cos(q5)*(cos(q1)*cos(q3)-cos(q2)*sin(q1)*sin(q3)));
+            mat_jaco(4,6) = T(cos(q6)*(sin(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))+cos(q4)*sin(q1)*sin(q2))+sin(q6)*(cos(q5)*(cos(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))-sin(q1)*sin(q2)*sin(q4))+sin(q5)*(cos(q1)*cos(q3)-cos(q2)*sin(q1)*sin(q3))));
+
+            mat_jaco(5,0) = T(1.0);
+            mat_jaco(5,2) = T(cos(q2));
+            mat_jaco(5,3) = T(sin(q2)*sin(q3));
+            mat_jaco(5,4) = T(cos(q2)*cos(q4)-cos(q3)*sin(q2)*sin(q4));
+            mat_jaco(5,5) = T(sin(q5)*(cos(q2)*sin(q4)+cos(q3)*cos(q4)*sin(q2))+cos(q5)*sin(q2)*sin(q3));
+            mat_jaco(5,6) = T(-sin(q6)*(cos(q5)*(cos(q2)*sin(q4)+cos(q3)*cos(q4)*sin(q2))-sin(q2)*sin(q3)*sin(q5))+cos(q6)*(cos(q2)*cos(q4)-cos(q3)*sin(q2)*sin(q4)));
+        }
+
+        template <typename T>
+        void forward_expanded(const Eigen::Matrix<T, 7, 1> &mat_jo, Eigen::Matrix<T, 4, 4> &mat_trans)
+        {
+            using std::sin;
+            using std::cos;
+            const T q1 = mat_jo(0);
+            const T q2 = mat_jo(1);
+            const T q3 = mat_jo(2);
+            const T q4 = mat_jo(3);
+            const T q5 = mat_jo(4);
+            const T q6 = mat_jo(5);
+            const T q7 = mat_jo(6);
+
+            mat_trans(0,0) = T(cos(q7)*(sin(q6)*(sin(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))-cos(q1)*cos(q4)*sin(q2))-cos(q6)*(cos(q5)*(cos(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))+cos(q1)*sin(q2)*sin(q4))+sin(q5)*(cos(q3)*sin(q1)+cos(q1)*cos(q2)*sin(q3))))+sin(q7)*(sin(q5)*(cos(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))+cos(q1)*sin(q2)*sin(q4))-cos(q5)*(cos(q3)*sin(q1)+cos(q1)*cos(q2)*sin(q3))));
+            mat_trans(0,1) = T(-sin(q7)*(sin(q6)*(sin(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))-cos(q1)*cos(q4)*sin(q2))-cos(q6)*(cos(q5)*(cos(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))+cos(q1)*sin(q2)*sin(q4))+sin(q5)*(cos(q3)*sin(q1)+cos(q1)*cos(q2)*sin(q3))))+cos(q7)*(sin(q5)*(cos(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))+cos(q1)*sin(q2)*sin(q4))-cos(q5)*(cos(q3)*sin(q1)+cos(q1)*cos(q2)*sin(q3))));
+            mat_trans(0,2) = T(-cos(q6)*(sin(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))-cos(q1)*cos(q4)*sin(q2))-sin(q6)*(cos(q5)*(cos(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))+cos(q1)*sin(q2)*sin(q4))+sin(q5)*(cos(q3)*sin(q1)+cos(q1)*cos(q2)*sin(q3))));
+            mat_trans(0,3) = T(cos(q1)*sin(q2)*4.0E2-cos(q6)*(sin(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))-cos(q1)*cos(q4)*sin(q2))*3.0E2-sin(q6)*(cos(q5)*(cos(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))+cos(q1)*sin(q2)*sin(q4))+sin(q5)*(cos(q3)*sin(q1)+cos(q1)*cos(q2)*sin(q3)))*3.0E2-sin(q4)*(sin(q1)*sin(q3)-cos(q1)*cos(q2)*cos(q3))*2.85E2+cos(q1)*cos(q4)*sin(q2)*2.85E2);
+            mat_trans(1,0) = T(-cos(q7)*(sin(q6)*(sin(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))+cos(q4)*sin(q1)*sin(q2))-cos(q6)*(cos(q5)*(cos(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))-sin(q1)*sin(q2)*sin(q4))+sin(q5)*(cos(q1)*cos(q3)-cos(q2)*sin(q1)*sin(q3))))-sin(q7)*(sin(q5)*(cos(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))-sin(q1)*sin(q2)*sin(q4))-cos(q5)*(cos(q1)*cos(q3)-cos(q2)*sin(q1)*sin(q3))));
+            mat_trans(1,1) = T(sin(q7)*(sin(q6)*(sin(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))+cos(q4)*sin(q1)*sin(q2))-cos(q6)*(cos(q5)*(cos(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))-sin(q1)*sin(q2)*sin(q4))+sin(q5)*(cos(q1)*cos(q3)-cos(q2)*sin(q1)*sin(q3))))-cos(q7)*(sin(q5)*(cos(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))-sin(q1)*sin(q2)*sin(q4))-cos(q5)*(cos(q1)*cos(q3)-cos(q2)*sin(q1)*sin(q3))));
+            mat_trans(1,2) = T(cos(q6)*(sin(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))+cos(q4)*sin(q1)*sin(q2))+sin(q6)*(cos(q5)*(cos(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))-sin(q1)*sin(q2)*sin(q4))+sin(q5)*(cos(q1)*cos(q3)-cos(q2)*sin(q1)*sin(q3))));
+            mat_trans(1,3) = T(sin(q1)*sin(q2)*4.0E2+cos(q6)*(sin(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))+cos(q4)*sin(q1)*sin(q2))*3.0E2+sin(q6)*(cos(q5)*(cos(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))-sin(q1)*sin(q2)*sin(q4))+sin(q5)*(cos(q1)*cos(q3)-cos(q2)*sin(q1)*sin(q3)))*3.0E2+sin(q4)*(cos(q1)*sin(q3)+cos(q2)*cos(q3)*sin(q1))*2.85E2+cos(q4)*sin(q1)*sin(q2)*2.85E2);
+            mat_trans(2,0) = T(sin(q7)*(sin(q5)*(cos(q2)*sin(q4)+cos(q3)*cos(q4)*sin(q2))+cos(q5)*sin(q2)*sin(q3))-cos(q7)*(cos(q6)*(cos(q5)*(cos(q2)*sin(q4)+cos(q3)*cos(q4)*sin(q2))-sin(q2)*sin(q3)*sin(q5))+sin(q6)*(cos(q2)*cos(q4)-cos(q3)*sin(q2)*sin(q4))));
+            mat_trans(2,1) = T(cos(q7)*(sin(q5)*(cos(q2)*sin(q4)+cos(q3)*cos(q4)*sin(q2))+cos(q5)*sin(q2)*sin(q3))+sin(q7)*(cos(q6)*(cos(q5)*(cos(q2)*sin(q4)+cos(q3)*cos(q4)*sin(q2))-sin(q2)*sin(q3)*sin(q5))+sin(q6)*(cos(q2)*cos(q4)-cos(q3)*sin(q2)*sin(q4))));
+            mat_trans(2,2) = T(-sin(q6)*(cos(q5)*(cos(q2)*sin(q4)+cos(q3)*cos(q4)*sin(q2))-sin(q2)*sin(q3)*sin(q5))+cos(q6)*(cos(q2)*cos(q4)-cos(q3)*sin(q2)*sin(q4)));
+            mat_trans(2,3) = T(cos(q2)*4.0E2+cos(q2)*cos(q4)*2.85E2-sin(q6)*(cos(q5)*(cos(q2)*sin(q4)+cos(q3)*cos(q4)*sin(q2))-sin(q2)*sin(q3)*sin(q5))*3.0E2+cos(q6)*(cos(q2)*cos(q4)-cos(q3)*sin(q2)*sin(q4))*3.0E2-cos(q3)*sin(q2)*sin(q4)*2.85E2);
+            mat_trans(3,0) = mat_trans(3,1) = mat_trans(3,2) = T(0);
+            mat_trans(3,3) = T(1.0);
+        }
+    }
+}
+#endif // KINE_EXPANDED_HPP__
@@ -0,0 +1,233 @@
+#ifndef KINE_SOLVER_HPP__
+#define KINE_SOLVER_HPP__
+#include <vector>
+#include "eigen3/Eigen/Eigen"
+#include "kine7.hpp"
+#include "arm_angle.hpp"
+#include "kine_cache.hpp"
+#include "stopwatch.hpp"
+namespace rpp
+{
+    namespace kine
+    {
+        enum KineStatus
+        {
+            KINE_OK = 0,                // analytic solution within tolerance
+            KINE_REFINED = 1,           // analytic seed polished by Kine7::refine
+            KINE_DIFFERENTIAL = 2,      // damped differential step from the previous joints
+            KINE_NO_SELF_MOTION = -1,   // the wrist position is out of reach
+            KINE_NO_ELBOW = -2,         // no self-motion has its elbow within limits
+            KINE_NO_SOLUTION = -3,      // no candidate passes pose check and joint limits
+            KINE_NOT_CONVERGED = -4     // the differential iteration stopped above tolerance
+        };
+
+        // everything one caller needs for the analytic inverse kinematics with
+        // joint selection: the kinematics, the singularity handler (which keeps the
+        // previous joints), the joint limits and the arm-angle optimizer.
+        // A context is not shared between threads, give every thread its own copy.
+        template <typename T>
+        class KineSolver
+        {
+        public:
+            typedef T value_type;
+            typedef Kine7<value_type> kine_type;
+            typedef typename kine_type::mat4x4 mat4x4;
+            typedef typename kine_type::vec7 vec7;
+            typedef typename kine_type::angular_interval angular_interval;
+            typedef typename kine_type::angular_interval_vector angular_interval_vector;
+            typedef typename kine_type::self_motion_vector self_motion_vector;
+            typedef KineCache<value_type> cache_type;
+            typedef ArmAngleOptimizer<value_type> optimizer_type;
+            typedef typename optimizer_type::candidate_type candidate_type;
+
+            // counted per solve() call, except refine_calls and refine_ns
+            struct stats_type
+            {
+                long long solved;       // calls that returned a solution
+                long long refined;      // calls that ran refine() at least once
+                long long rescued;      // calls answered with refined joints (KINE_REFINED)
+                long long rejected;     // calls that ran refine() and still found no solution
+                long long refine_calls; // refine() calls, one per candidate off the target
+                long long refine_ns;    // time spent in refine()
+            };
+
+            KineSolver()
+            {
+                reset_stats();
+            }
+            KineSolver(const value_type L1, const value_type L2,
+                    const value_type L3, const value_type D,
+                    const angular_interval_vector &joint_limits,
+                    const value_type tolerance = value_type(0.05))
+                : _kine(L1, L2, L3, D, joint_limits), _sh(joint_limits),
+                _joint_limits(joint_limits), _tolerance(tolerance)
+            {
+                reset_stats();
+            }
+
+            kine_type &kine()
+            {
+                return _kine;
+            }
+            const kine_type &kine() const
+            {
+                return _kine;
+            }
+            const angular_interval_vector &joint_limits() const
+            {
+                return _joint_limits;
+            }
+            // the pose cache, set_quantization(0, 0) turns it off
+            cache_type &cache()
+            {
+                return _cache;
+            }
+            const stats_type &stats() const
+            {
+                return _stats;
+            }
+            void reset_stats()
+            {
+                _stats.solved = _stats.refined = _stats.rescued = _stats.rejected = 0;
+                _stats.refine_calls = _stats.refine_ns = 0;
+            }
+
+            // on success joints, last_arm_angle and last_joints hold the new solution
+            KineStatus solve(const mat4x4 &T_07, value_type &last_arm_angle,
+                    vec7 &last_joints, vec7 &joints)
+            {
+                if (!_cache.enabled())
+                {
+                    self_motion_vector self_motions = _kine.inverse(T_07);
+                    return solve(T_07, self_motions, last_arm_angle, last_joints, joints);
+                }
+                const typename cache_type::key_type key = _cache.key(T_07);
+                typename cache_type::entry_type *entry = _cache.find(key);
+                if (_cache.replay(entry, T_07, last_arm_angle, last_joints))
+                {
+                    // same request as last time, the search would end the same way
+                    _cache.record_hit(false);
+                    _stats.solved++;
+                    last_arm_angle = entry->arm_angle;
+                    last_joints = entry->joints;
+                    joints = entry->joints;
+                    return (KineStatus)entry->status;
+                }
+                if (entry && entry->solved && entry->target != T_07)
+                {
+                    // a nearby target in the same cell: polish the joints solved
+                    // there onto this one instead of redoing the interval algebra
+                    vec7 q = entry->joints;
+                    ::rpp::util::Stopwatch sw;
+                    const value_type err = _kine.refine(T_07, q);
+                    _stats.refine_ns += sw.elapsed_ns();
+                    _stats.refine_calls++;
+                    if (err <= _tolerance && within_limits(q))
+                    {
+                        _cache.record_hit(true);
+                        _stats.solved++;
+                        last_arm_angle = entry->arm_angle;
+                        last_joints = q;
+                        joints = q;
+                        return KINE_REFINED;
+                    }
+                }
+                _cache.record_miss();
+                // the self-motions of another target in the cell do not fit this one
+                if (!entry || entry->target != T_07) entry = _cache.insert(key, T_07, _kine.inverse(T_07));
+                entry->solved = false;
+                const value_type request_arm_angle = last_arm_angle;
+                const vec7 request_joints = last_joints;
+                const KineStatus status = solve(T_07, entry->self_motions, last_arm_angle, last_joints, joints);
+                if (status >= 0)
+                {
+                    entry->solved = true;
+                    entry->last_arm_angle = request_arm_angle;
+                    entry->last_joints = request_joints;
+                    entry->arm_angle = last_arm_angle;
+                    entry->joints = joints;
+                    entry->status = status;
+                }
+                return status;
+            }
+            // the joint selection alone, on self_motions = kine().inverse(T_07)
+            // computed beforehand (KineBatch does that on other threads). The
+            // cache is not used. Same results as solve() above.
+            KineStatus solve(const mat4x4 &T_07, self_motion_vector &self_motions,
+                    value_type &last_arm_angle, vec7 &last_joints, vec7 &joints)
+            {
+                if (self_motions.empty()) return KINE_NO_SELF_MOTION;
+
+                _sh.update_current_joints(last_joints);
+                bool elbow = false, found = false, refined = false, tried_refine = false;
+                candidate_type best;
+                for (auto it = self_motions.begin(); it != self_motions.end(); ++it)
+                {
+                    if (!_joint_limits[3].contains(it->elbow_joint())) continue;
+                    elbow = true;
+                    const auto res = _optimizer.optimize(*it, _sh, last_arm_angle, last_joints);
+                    if (!res.found) continue;
+                    // the optimum first, then the best of the other branches, until
+                    // one passes the pose check or is polished to pass it
+                    ::rpp::util::FixedVector<candidate_type, optimizer_type::BRANCHES + 1> tries;
+                    candidate_type optimum = {res.arm_angle, res.cost, res.joints};
+                    tries.push_back(optimum);
+                    tries.append(res.fallbacks.begin(), res.fallbacks.end());
+                    for (auto c = tries.begin(); c != tries.end(); ++c)
+                    {
+                        bool polished = false;
+                        if ((_kine.forward(c->joints) - T_07).norm() > _tolerance)
+                        {
+                            ::rpp::util::Stopwatch sw;
+                            const value_type err = _kine.refine(T_07, c->joints);
+                            _stats.refine_ns += sw.elapsed_ns();
+                            _stats.refine_calls++;
+                            tried_refine = true;
+                            if (err > _tolerance || !within_limits(c->joints)) continue;
+                            // compared with the other self-motions by the cost of
+                            // the joints actually returned
+                            c->cost = _optimizer.cost(c->joints, c->arm_angle, last_arm_angle, last_joints);
+                            polished = true;
+                        }
+                        if (!found || c->cost < best.cost)
+                        {
+                            best = *c;
+                            found = true;
+                            refined = polished;
+                        }
+                        break;
+                    }
+                }
+                if (tried_refine)
+                {
+                    _stats.refined++;
+                    if (!found) _stats.rejected++;
+                }
+                if (!elbow) return KINE_NO_ELBOW;
+                if (!found) return KINE_NO_SOLUTION;
+                _stats.solved++;
+                if (refined) _stats.rescued++;
+                last_arm_angle = best.arm_angle;
+                last_joints = best.joints;
+                joints = best.joints;
+                return refined ? KINE_REFINED : KINE_OK;
+            }
+        private:
+            bool within_limits(const vec7 &q) const
+            {
+                for (int i = 0; i < 7; ++i)
+                    if (!_joint_limits[i].contains(q[i])) return false;
+                return true;
+            }
+
+            kine_type _kine;
+            SingularityHandler<value_type> _sh;
+            angular_interval_vector _joint_limits;
+            optimizer_type _optimizer;
+            cache_type _cache;
+            value_type _tolerance;
+            stats_type _stats;
+        };
+    }
+}
+#endif // KINE_SOLVER_HPP__
@@ -0,0 +1,140 @@
+#ifndef KINE_TRACE_HPP__
+#define KINE_TRACE_HPP__
+#include <cstddef>
+#include <vector>
+#include <ostream>
+#include "stopwatch.hpp"
+namespace rpp
+{
+    namespace kine
+    {
+        // what the kinematics internals report, see TraceRecord for the values
+        enum TraceEvent
+        {
+            TRACE_NO_THETA4 = 0,        // inverse(): wrist out of reach, v = |x_sw|^2
+            TRACE_SHOULDER_SINGULAR,    // get_joints(): v = arm angle, theta2, theta1 + theta3
+            TRACE_WRIST_SINGULAR,       // get_joints(): v = arm angle, theta6, theta5 + theta7
+            TRACE_SINGULAR_SPLIT,       // SingularityHandler: v = alpha, delta, t, tt, sum
+            TRACE_EVENT_COUNT
+        };
+
+        inline const char *trace_event_name(const int event)
+        {
+            static const char *names[TRACE_EVENT_COUNT] = {
+                "no_theta4", "shoulder_singular", "wrist_singular", "singular_split"
+            };
+            return (event >= 0 && event < TRACE_EVENT_COUNT) ? names[event] : "unknown";
+        }
+
+        struct TraceRecord
+        {
+            long long time_ns;          // Stopwatch::now()
+            int event;
+            double v[5];
+        };
+
+        // the trace policies of Kine7, SelfMotion and SingularityHandler. A policy
+        // is a small value the classes keep and copy around; record() is called
+        // at every event with up to five values.
+
+        // production: record() is empty and inline, the calls and their arguments
+        // are optimized away
+        struct NullTrace
+        {
+            enum { ENABLED = 0 };
+            template <typename T>
+            void record(const int, const T, const T = 0, const T = 0, const T = 0, const T = 0) const {}
+        };
+
+        // fixed-size ring of the latest records. The storage is allocated once by
+        // the constructor, push() only overwrites the oldest record, so tracing
+        // inside the control loop neither allocates nor blocks on I/O. Not
+        // synchronized: one buffer per thread, read it (write_trace()) when the
+        // loop is idle.
+        class TraceBuffer
+        {
+        public:
+            explicit TraceBuffer(const std::size_t capacity = 1024)
+                : _records(capacity > 0 ? capacity : 1), _total(0) {}
+
+            void push(const int event, const double v0, const double v1,
+                    const double v2, const double v3, const double v4)
+            {
+                TraceRecord &r = _records[_total % _records.size()];
+                r.time_ns = ::rpp::util::Stopwatch::now();
+                r.event = event;
+                r.v[0] = v0;
+                r.v[1] = v1;
+                r.v[2] = v2;
+                r.v[3] = v3;
+                r.v[4] = v4;
+                ++_total;
+            }
+            // records held, at most capacity()
+            std::size_t size() const
+            {
+                return _total < _records.size() ? static_cast<std::size_t>(_total) : _records.size();
+            }
+            std::size_t capacity() const
+            {
+                return _records.size();
+            }
+            // records pushed since the last clear(), the ones beyond size() are lost
+            unsigned long long total() const
+            {
+                return _total;
+            }
+            // i = 0 is the oldest record held
+            const TraceRecord &operator [](const std::size_t i) const
+            {
+                const unsigned long long first = _total - size();
+                return _records[(first + i) % _records.size()];
+            }
+            void clear()
+            {
+                _total = 0;
+            }
+        private:
+            std::vector<TraceRecord> _records;
+            unsigned long long _total;
+        };
+
+        // development: records into a TraceBuffer, nothing without one
+        class RingTrace
+        {
+        public:
+            enum { ENABLED = 1 };
+            RingTrace() : _buffer(0) {}
+            explicit RingTrace(TraceBuffer &buffer) : _buffer(&buffer) {}
+
+            template <typename T>
+            void record(const int event, const T v0, const T v1 = 0, const T v2 = 0,
+                    const T v3 = 0, const T v4 = 0) const
+            {
+                if (_buffer) _buffer->push(event, v0, v1, v2, v3, v4);
+            }
+            TraceBuffer *buffer() const
+            {
+                return _buffer;
+            }
+        private:
+            TraceBuffer *_buffer;
+        };
+
+        // one line per record, oldest first, times relative to the first record
+        inline void write_trace(std::ostream &os, const TraceBuffer &buffer)
+        {
+            if (buffer.total() > buffer.size())
+                os << (buffer.total() - buffer.size()) << " older records lost" << std::endl;
+            const long long t0 = buffer.size() > 0 ? buffer[0].time_ns : 0;
+            for (std::size_t i = 0; i < buffer.size(); ++i)
+            {
+                const TraceRecord &r = buffer[i];
+                os << (r.time_ns - t0)/1000 << "us " << trace_event_name(r.event);
+                for (int k = 0; k < 5; ++k) os << " " << r.v[k];
+                os << std::endl;
+            }
+        }
+    }
+}
+#endif // KINE_TRACE_HPP__
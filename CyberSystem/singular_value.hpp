@@ -0,0 +1,135 @@
+#ifndef SINGULAR_VALUE_HPP__
+#define SINGULAR_VALUE_HPP__
+#include <cmath>
+#include <limits>
+#include "eigen3/Eigen/Eigen"
+
+// estimator of the smallest singular value of the 6x7 jacobian, used for the damping
+#define SV_MIN_SVD 0                // JacobiSVD of J
+#define SV_MIN_EIGEN 1              // self-adjoint eigen solve of J*J^T
+#define SV_MIN_INVERSE_ITERATION 2  // inverse iteration on J*J^T, warm-started
+#ifndef SV_MIN_METHOD
+#define SV_MIN_METHOD SV_MIN_EIGEN
+#endif
+namespace rpp
+{
+    namespace kine
+    {
+        template <typename T>
+        T sv_min_svd(const Eigen::Matrix<T, 6, 7> &J)
+        {
+            Eigen::JacobiSVD<Eigen::Matrix<T, 6, 7> > svd(J);
+            return svd.singularValues()(5);
+        }
+
+        template <typename T>
+        T sv_min_eigen(const Eigen::Matrix<T, 6, 6> &JJt)
+        {
+            Eigen::SelfAdjointEigenSolver<Eigen::Matrix<T, 6, 6> > es(JJt, Eigen::EigenvaluesOnly);
+            const T ev = es.eigenvalues()(0);
+            return ev > 0 ? std::sqrt(ev) : 0;
+        }
+
+        // the same eigen solve, but the singular value is read off J along the
+        // eigenvector: the square root of a tiny eigenvalue of J*J^T is only good
+        // to sqrt(eps)*|J|, |J^T*v| is good to eps*|J| close to a singularity
+        template <typename T>
+        T sv_min_eigen(const Eigen::Matrix<T, 6, 7> &J, const Eigen::Matrix<T, 6, 6> &JJt)
+        {
+            Eigen::SelfAdjointEigenSolver<Eigen::Matrix<T, 6, 6> > es(JJt);
+            return (J.transpose()*es.eigenvectors().col(0)).norm();
+        }
+
+        // inverse iteration for the smallest eigenvalue of J*J^T. The joints move
+        // little between two calls, so the singular vector of the previous call is
+        // a good start and a couple of iterations are enough.
+        template <typename T>
+        class SvMinInverseIteration
+        {
+        public:
+            typedef T value_type;
+            typedef Eigen::Matrix<value_type, 6, 6> mat6x6;
+            typedef Eigen::Matrix<value_type, 6, 1> vec6;
+            explicit SvMinInverseIteration(const int iterations = 2)
+                : _iterations(iterations)
+            {
+                reset();
+            }
+            void reset()
+            {
+                _v.setConstant(1/std::sqrt(value_type(6)));
+            }
+            value_type operator ()(const mat6x6 &JJt)
+            {
+                // the shift keeps the factorization regular at an exact singularity
+                const value_type shift = JJt.trace()*value_type(1e-12);
+                Eigen::LDLT<mat6x6> ldlt(JJt + shift*mat6x6::Identity());
+                for (int i = 0; i < _iterations; ++i)
+                {
+                    vec6 w = ldlt.solve(_v);
+                    const value_type n = w.norm();
+                    if (!(n > 0) || !(n < std::numeric_limits<value_type>::infinity()))
+                    {
+                        reset();
+                        break;
+                    }
+                    _v = w/n;
+                }
+                const value_type ev = _v.dot(JJt*_v);
+                return ev > 0 ? std::sqrt(ev) : 0;
+            }
+            const vec6 &singular_vector() const
+            {
+                return _v;
+            }
+        private:
+            int _iterations;
+            vec6 _v;
+        };
+
+        // the estimator selected by SV_MIN_METHOD
+        template <typename T>
+        class SvMinEstimator
+        {
+        public:
+            typedef T value_type;
+            typedef Eigen::Matrix<value_type, 6, 7> mat6x7;
+            typedef Eigen::Matrix<value_type, 6, 6> mat6x6;
+            value_type operator ()(const mat6x7 &J)
+            {
+#if SV_MIN_METHOD == SV_MIN_SVD
+                return sv_min_svd(J);
+#else
+                return (*this)(J, J*J.transpose());
+#endif
+            }
+            // J*J^T is usually formed by the caller anyway. It gives the singular
+            // vector, the singular value itself is taken from J for accuracy near
+            // a singularity.
+            value_type operator ()(const mat6x7 &J, const mat6x6 &JJt)
+            {
+#if SV_MIN_METHOD == SV_MIN_SVD
+                return sv_min_svd(J);
+#elif SV_MIN_METHOD == SV_MIN_EIGEN
+                return sv_min_eigen(J, JJt);
+#elif SV_MIN_METHOD == SV_MIN_INVERSE_ITERATION
+                _inverse_iteration(JJt);
+                return (J.transpose()*_inverse_iteration.singular_vector()).norm();
+#else
+#error "unknown SV_MIN_METHOD"
+#endif
+            }
+            void reset()
+            {
+#if SV_MIN_METHOD == SV_MIN_INVERSE_ITERATION
+                _inverse_iteration.reset();
+#endif
+            }
+        private:
+#if SV_MIN_METHOD == SV_MIN_INVERSE_ITERATION
+            SvMinInverseIteration<value_type> _inverse_iteration;
+#endif
+        };
+    }
+}
+#endif // SINGULAR_VALUE_HPP__
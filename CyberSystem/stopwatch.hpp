@@ -0,0 +1,51 @@
+#ifndef STOPWATCH_HPP__
+#define STOPWATCH_HPP__
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <time.h>
+#endif
+namespace rpp
+{
+    namespace util
+    {
+        // monotonic high resolution timer for profiling the kinematics code
+        class Stopwatch
+        {
+        public:
+            Stopwatch()
+            {
+                start();
+            }
+            void start()
+            {
+                _start = now();
+            }
+            long long elapsed_ns() const
+            {
+                return now() - _start;
+            }
+            static long long now()
+            {
+#ifdef _WIN32
+                static LARGE_INTEGER freq = {0};
+                if (freq.QuadPart == 0) QueryPerformanceFrequency(&freq);
+                LARGE_INTEGER c;
+                QueryPerformanceCounter(&c);
+                return (long long)(c.QuadPart / freq.QuadPart) * 1000000000LL
+                    + (long long)(c.QuadPart % freq.QuadPart) * 1000000000LL / freq.QuadPart;
+#else
+                timespec ts;
+                clock_gettime(CLOCK_MONOTONIC, &ts);
+                return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#endif
+            }
+        private:
+            long long _start;
+        };
+    }
+}
+#endif // STOPWATCH_HPP__
@@ -0,0 +1,171 @@
+#ifndef TRAJECTORY_HPP__
+#define TRAJECTORY_HPP__
+#include <cmath>
+#include <vector>
+#include "eigen3/Eigen/Eigen"
+#include "eigen3/Eigen/StdVector"
+#include "kine_util.hpp"
+namespace rpp
+{
+    namespace kine
+    {
+        // how the path parameter s goes from 0 to 1 over the normalized time tau
+        enum TimeScaling
+        {
+            TIME_LINEAR = 0,        // constant velocity, s = tau
+            TIME_MIN_JERK = 1,      // quintic, zero velocity and acceleration at both ends
+            TIME_TRAPEZOID = 2      // constant acceleration, cruise, constant deceleration
+        };
+
+        // s(tau) for tau in [0, 1]; accel_fraction is the share of the duration
+        // spent accelerating (and decelerating) with TIME_TRAPEZOID, at most 0.5
+        template <typename T>
+        T time_scale(const TimeScaling scaling, T tau, T accel_fraction = T(0.25))
+        {
+            if (tau <= 0) return 0;
+            if (tau >= 1) return 1;
+            switch (scaling)
+            {
+            case TIME_MIN_JERK:
+                return tau*tau*tau*(10 + tau*(-15 + 6*tau));
+            case TIME_TRAPEZOID:
+                {
+                    if (accel_fraction > T(0.5)) accel_fraction = T(0.5);
+                    if (accel_fraction <= 0) return tau;
+                    // cruise velocity so that the area under the profile is 1
+                    const T v = 1/(1 - accel_fraction);
+                    if (tau < accel_fraction) return v*tau*tau/(2*accel_fraction);
+                    if (tau <= 1 - accel_fraction) return v*(tau - accel_fraction/2);
+                    const T r = 1 - tau;
+                    return 1 - v*r*r/(2*accel_fraction);
+                }
+            default:
+                return tau;
+            }
+        }
+
+        // spherical linear interpolation between unit quaternions along the
+        // shorter arc
+        template <typename T>
+        Eigen::Quaternion<T> quater_slerp(const Eigen::Quaternion<T> &q0, const Eigen::Quaternion<T> &q1,
+                const T s)
+        {
+            T d = q0.dot(q1);
+            T sign = 1;
+            if (d < 0)
+            {
+                d = -d;
+                sign = -1;
+            }
+            T w0, w1;
+            if (d > T(1) - T(1e-6))
+            {
+                // nearly parallel: sin(theta) underflows, lerp is exact to first order
+                w0 = 1 - s;
+                w1 = s;
+            }
+            else
+            {
+                const T theta = acos(d < T(-1) ? T(-1) : d);
+                const T st = sin(theta);
+                w0 = sin((1 - s)*theta)/st;
+                w1 = sin(s*theta)/st;
+            }
+            Eigen::Quaternion<T> q;
+            q.coeffs() = w0*q0.coeffs() + (sign*w1)*q1.coeffs();
+            q.normalize();
+            return q;
+        }
+
+        // pose [x, y, z, eta, e1, e2, e3] at path parameter s between start and end:
+        // straight line for the position, slerp for the orientation
+        template <typename T>
+        Eigen::Matrix<T, 7, 1> pose_interpolate(const Eigen::Matrix<T, 7, 1> &start,
+                const Eigen::Matrix<T, 7, 1> &end, const T s)
+        {
+            const Eigen::Quaternion<T> q0(start(3), start(4), start(5), start(6));
+            const Eigen::Quaternion<T> q1(end(3), end(4), end(5), end(6));
+            const Eigen::Quaternion<T> q = quater_slerp(q0.normalized(), q1.normalized(), s);
+            Eigen::Matrix<T, 7, 1> x;
+            x.template head<3>() = start.template head<3>() + s*(end.template head<3>() - start.template head<3>());
+            x(3) = q.w();
+            x.template tail<3>() = q.vec();
+            return x;
+        }
+
+        // a precomputed Cartesian trajectory: plan() samples the whole motion once,
+        // the control loop and the differential IK then read pose(i) and
+        // transform(i) of every tick instead of interpolating again. Sample i is
+        // the pose at tick i + 1, the last sample is the end pose. The buffers keep
+        // their capacity between plans.
+        template <typename T>
+        class Trajectory
+        {
+        public:
+            typedef T value_type;
+            typedef Eigen::Matrix<value_type, 4, 4> mat4x4;
+            typedef Eigen::Matrix<value_type, 7, 1> vec7;
+            typedef std::vector<vec7, Eigen::aligned_allocator<vec7> > pose_vector;
+            typedef std::vector<mat4x4, Eigen::aligned_allocator<mat4x4> > transform_vector;
+
+            Trajectory() {}
+
+            // count ticks from start to end, orientation by slerp
+            void plan(const vec7 &start, const vec7 &end, const int count,
+                    const TimeScaling scaling = TIME_MIN_JERK, const value_type accel_fraction = value_type(0.25))
+            {
+                resize(count);
+                for (int i = 0; i < count; ++i)
+                {
+                    const value_type s = time_scale(scaling, value_type(i + 1)/count, accel_fraction);
+                    set(i, pose_interpolate(start, end, s));
+                }
+            }
+
+            int size() const
+            {
+                return static_cast<int>(_poses.size());
+            }
+            bool empty() const
+            {
+                return _poses.empty();
+            }
+            const vec7 &pose(const int i) const
+            {
+                return _poses[i];
+            }
+            const mat4x4 &transform(const int i) const
+            {
+                return _transforms[i];
+            }
+            const pose_vector &poses() const
+            {
+                return _poses;
+            }
+            const transform_vector &transforms() const
+            {
+                return _transforms;
+            }
+            void clear()
+            {
+                _poses.clear();
+                _transforms.clear();
+            }
+        protected:
+            void resize(const int count)
+            {
+                _poses.resize(count > 0 ? count : 0);
+                _transforms.resize(count > 0 ? count : 0);
+            }
+            void set(const int i, const vec7 &x)
+            {
+                _poses[i] = x;
+                _transforms[i] = quater2t(x);
+            }
+        private:
+            pose_vector _poses;
+            transform_vector _transforms;
+        };
+    }
+}
+#endif // TRAJECTORY_HPP__